@@ -0,0 +1,393 @@
+#include<algorithm>
+#include<chrono>
+#include<cmath>
+#include<cstdint>
+#include<cstdio>
+#include<cstdlib>
+#include<cstring>
+#include<fstream>
+#include<functional>
+#include<iostream>
+#include<sstream>
+#include<stdexcept>
+#include<string>
+#include<vector>
+#include"../HDBSCAN-CPP/Runner/hdbscanRunner.hpp"
+#include"../HDBSCAN-CPP/Runner/hdbscanParameters.hpp"
+#include"../HDBSCAN-CPP/HdbscanStar/hdbscanAlgorithm.hpp"
+#include"../HDBSCAN-CPP/HdbscanStar/undirectedGraph.hpp"
+#include"../HDBSCAN-CPP/HdbscanStar/cluster.hpp"
+#include"../HDBSCAN-CPP/Utils/parallelFor.hpp"
+#include"../HDBSCAN-CPP/Dataset/datasetGenerator.hpp"
+#include"../HDBSCAN-CPP/Dataset/datasetFile.hpp"
+#include"../HDBSCAN-CPP/Index/nnDescent.hpp"
+#include"../HDBSCAN-CPP/Distance/EuclideanDistance.hpp"
+#include"../HDBSCAN-CPP/Distance/ManhattanDistance.hpp"
+#include"../HDBSCAN-CPP/Distance/HaversineDistance.hpp"
+#include"../HDBSCAN-CPP/Distance/CosineDistance.hpp"
+using namespace std;
+using namespace hdbscanStar;
+
+// Times every stage of the HDBSCAN* pipeline separately over a grid of dataset sizes, dimensions, thread
+// counts, distance functions and engines, and writes the median, 95th percentile and throughput of each stage
+// as JSON. Configurations which would not fit in the memory budget are reported as skipped rather than run.
+// Engines other than Dense compute core distances and the MST in one call, timed as a single stage.
+
+static const char* stageNames[] = {
+	"distanceFill",
+	"calculateCoreDistances",
+	"constructMst",
+	"quicksortByEdgeWeight",
+	"computeHierarchyAndClusterTree",
+	"propagateTree",
+	"findProminentClusters",
+	"findMembershipScore",
+	"calculateOutlierScores"
+};
+static const int numStages = sizeof(stageNames) / sizeof(stageNames[0]);
+//Other engines time their core distances and MST as one stage, in the slot of constructMst:
+static const int numDenseStages = 3;
+
+struct benchmarkOptions {
+	vector<int> numPoints;
+	vector<int> numAttributes;
+	vector<int> numThreads;
+	vector<string> distanceFunctions;
+	vector<string> engines;
+	vector<datasetShape> shapes;
+	int numClusters;
+	double noiseFraction;
+	string input;
+	int minPoints;
+	int minClusterSize;
+	int warmup;
+	int repetitions;
+	int recallSampleSize;
+	int numTimedStages;
+	double maxMemoryMb;
+	unsigned seed;
+	string output;
+};
+
+static vector<string> splitList(const string& list) {
+	vector<string> items;
+	stringstream s(list);
+	string item;
+	while (getline(s, item, ','))
+		if (item.length() != 0)
+			items.push_back(item);
+	return items;
+}
+
+static vector<int> parseIntList(const string& list) {
+	vector<int> values;
+	for (const string& item : splitList(list))
+		values.push_back(item == "all" ? resolveNumThreads(0) : atoi(item.c_str()));
+	return values;
+}
+
+static void printUsage() {
+	cerr << "usage: bench-hdbscan [options]" << endl
+		<< "  --n LIST              dataset sizes (default 1000,10000,100000,1000000)" << endl
+		<< "  --d LIST              dimensions (default 2,8,32,128,512)" << endl
+		<< "  --threads LIST        thread counts, 'all' for the hardware concurrency (default 1,all)" << endl
+		<< "  --metrics LIST        distance functions: Euclidean, Manhattan, Haversine (--d 2), Cosine or Angular (default Euclidean,Manhattan)" << endl
+		<< "  --engines LIST        Dense, BallTree, NNDescent or Delaunay (default Dense)" << endl
+		<< "  --shapes LIST         generated dataset shapes, see hdbscan-generate (default blobs)" << endl
+		<< "  --clusters N          clusters of the generated datasets (default 8)" << endl
+		<< "  --noise F             fraction of uniform noise in the generated datasets (default 0.1)" << endl
+		<< "  --input FILE          benchmark a CSV or binary dataset instead of generated ones" << endl
+		<< "  --min-points N        (default 5)" << endl
+		<< "  --min-cluster-size N  (default 5)" << endl
+		<< "  --warmup N            untimed runs per configuration (default 1)" << endl
+		<< "  --repetitions N       timed runs per configuration (default 5)" << endl
+		<< "  --recall-sample N     points checked by brute force for the NNDescent recall (default 1000)" << endl
+		<< "  --stages all|mst      time every stage, or stop each run after the MST (default all)" << endl
+		<< "  --max-memory-mb N     skip configurations needing more memory (default 4096)" << endl
+		<< "  --seed N              dataset seed (default 42)" << endl
+		<< "  --output FILE         write the JSON report to FILE instead of stdout" << endl;
+}
+
+static bool parseOptions(int argc, char** argv, benchmarkOptions& options) {
+	options.numPoints = parseIntList("1000,10000,100000,1000000");
+	options.numAttributes = parseIntList("2,8,32,128,512");
+	options.numThreads = parseIntList("1,all");
+	options.distanceFunctions = splitList("Euclidean,Manhattan");
+	options.engines = splitList("Dense");
+	options.shapes.assign(1, gaussianBlobs);
+	options.numClusters = 8;
+	options.noiseFraction = 0.1;
+	options.minPoints = 5;
+	options.minClusterSize = 5;
+	options.warmup = 1;
+	options.repetitions = 5;
+	options.recallSampleSize = 1000;
+	options.numTimedStages = numStages;
+	options.maxMemoryMb = 4096;
+	options.seed = 42;
+
+	for (int i = 1; i < argc; i++) {
+		string option = argv[i];
+		if (option == "--help" || option == "-h" || i + 1 >= argc)
+			return false;
+		string value = argv[++i];
+		if (option == "--n")
+			options.numPoints = parseIntList(value);
+		else if (option == "--d")
+			options.numAttributes = parseIntList(value);
+		else if (option == "--threads")
+			options.numThreads = parseIntList(value);
+		else if (option == "--metrics")
+			options.distanceFunctions = splitList(value);
+		else if (option == "--engines")
+			options.engines = splitList(value);
+		else if (option == "--shapes") {
+			options.shapes.clear();
+			for (const string& name : splitList(value)) {
+				datasetShape shape;
+				if (!datasetGenerator::parseShape(name, shape))
+					return false;
+				options.shapes.push_back(shape);
+			}
+		}
+		else if (option == "--clusters")
+			options.numClusters = atoi(value.c_str());
+		else if (option == "--noise")
+			options.noiseFraction = atof(value.c_str());
+		else if (option == "--input")
+			options.input = value;
+		else if (option == "--min-points")
+			options.minPoints = atoi(value.c_str());
+		else if (option == "--min-cluster-size")
+			options.minClusterSize = atoi(value.c_str());
+		else if (option == "--warmup")
+			options.warmup = atoi(value.c_str());
+		else if (option == "--repetitions")
+			options.repetitions = atoi(value.c_str());
+		else if (option == "--recall-sample")
+			options.recallSampleSize = atoi(value.c_str());
+		else if (option == "--stages") {
+			if (value != "all" && value != "mst")
+				return false;
+			options.numTimedStages = value == "mst" ? numDenseStages : numStages;
+		}
+		else if (option == "--max-memory-mb")
+			options.maxMemoryMb = atof(value.c_str());
+		else if (option == "--seed")
+			options.seed = strtoul(value.c_str(), NULL, 10);
+		else if (option == "--output")
+			options.output = value;
+		else
+			return false;
+	}
+	return options.repetitions >= 1 && options.warmup >= 0;
+}
+
+static bool isDense(const string& engine) {
+	return engine.length() == 0 || engine == "Dense";
+}
+
+/// <summary>
+/// Measures the recall of the NNDescent engine's kNN graph against brute force on a sample of points.
+/// </summary>
+template<class TDistance>
+static double measureRecall(const hdbscanParameters& parameters, int sampleSize) {
+	int numAttributes = parameters.dataset.size() ? parameters.dataset[0].size() : 0;
+	vector<double> dataset;
+	for (const vector<double>& row : parameters.dataset)
+		dataset.insert(dataset.end(), row.begin(), row.end());
+	nnDescent<TDistance> graph(dataset.data(), parameters.dataset.size(), numAttributes,
+		hdbscanRunner::getNumNeighbors(parameters), nnDescentOptions(), parameters.numThreads);
+	return graph.estimateRecall(sampleSize, parameters.numThreads);
+}
+
+/// <summary>
+/// Runs the whole pipeline once, or only up to the MST when numTimedStages says so, adding the seconds spent in
+/// each stage to stageSeconds.
+/// </summary>
+static void runPipeline(hdbscanParameters& parameters, vector<double>& stageSeconds, int numTimedStages) {
+	typedef chrono::steady_clock clock;
+	int numPoints = parameters.dataset.size();
+	int stage = 0;
+	clock::time_point start = clock::now();
+	auto lap = [&]() {
+		clock::time_point now = clock::now();
+		stageSeconds[stage++] = chrono::duration<double>(now - start).count();
+		start = now;
+	};
+
+	vector<double> coreDistances;
+	undirectedGraph mst;
+	if (isDense(parameters.engine)) {
+		vector<vector<double>> distances = hdbscanRunner::calculateDistances(parameters);
+		lap();
+		coreDistances = hdbscanAlgorithm::calculateCoreDistances(distances, parameters.minPoints);
+		lap();
+		mst = hdbscanAlgorithm::constructMst(distances, coreDistances, true);
+		lap();
+	}
+	else {
+		stage = numDenseStages - 1;
+		hdbscanRunner::calculateCoreDistancesAndMst(parameters, coreDistances, mst);
+		lap();
+	}
+	if (numTimedStages <= numDenseStages)
+		return;
+	mst.quicksortByEdgeWeight();
+	lap();
+
+	vector<double> pointNoiseLevels(numPoints);
+	vector<int> pointLastClusters(numPoints);
+	vector<vector<int>> hierarchy;
+	vector<cluster*> clusters;
+	hdbscanAlgorithm::computeHierarchyAndClusterTree(&mst, parameters.minClusterSize, parameters.constraints,
+		hierarchy, pointNoiseLevels, pointLastClusters, clusters);
+	lap();
+	hdbscanAlgorithm::propagateTree(clusters);
+	lap();
+	vector<int> prominentClusters = hdbscanAlgorithm::findProminentClusters(clusters, hierarchy, numPoints);
+	lap();
+	vector<double> membershipProbabilities = hdbscanAlgorithm::findMembershipScore(prominentClusters, coreDistances);
+	lap();
+	vector<outlierScore> scores = hdbscanAlgorithm::calculateOutlierScores(clusters, pointNoiseLevels, pointLastClusters, coreDistances);
+	lap();
+
+	for (cluster* treeCluster : clusters)
+		delete treeCluster;
+}
+
+static double percentile(vector<double> values, double fraction) {
+	sort(values.begin(), values.end());
+	size_t rank = (size_t)ceil(fraction * values.size());
+	return values[rank == 0 ? 0 : rank - 1];
+}
+
+static string jsonNumber(double value) {
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "%.9g", value);
+	return buffer;
+}
+
+int main(int argc, char** argv) {
+	benchmarkOptions options;
+	if (!parseOptions(argc, argv, options)) {
+		printUsage();
+		return 1;
+	}
+
+	ostringstream json;
+	json << "{\n  \"warmup\": " << options.warmup
+		<< ",\n  \"repetitions\": " << options.repetitions
+		<< ",\n  \"minPoints\": " << options.minPoints
+		<< ",\n  \"minClusterSize\": " << options.minClusterSize
+		<< ",\n  \"hardwareThreads\": " << resolveNumThreads(0)
+		<< ",\n  \"results\": [";
+	bool firstResult = true;
+	auto runDataset = [&](const string& datasetName, int numPoints, int numAttributes, const function<vector<vector<double>>()>& loadDataset) {
+		//The dense distance matrix dominates, and the legacy hierarchy can hold one label per point per level;
+		//the other engines keep a flat copy of the dataset and a few arrays per point:
+		double denseMemoryMb = ((double)numPoints * numPoints * (sizeof(double) + sizeof(int)) +
+			(double)numPoints * numAttributes * sizeof(double)) / (1024.0 * 1024.0);
+		double engineMemoryMb = (double)numPoints * (3 * numAttributes + 64) * sizeof(double) / (1024.0 * 1024.0);
+		bool anyFits = false;
+		for (const string& engine : options.engines)
+			anyFits = anyFits || (isDense(engine) ? denseMemoryMb : engineMemoryMb) <= options.maxMemoryMb;
+		vector<vector<double>> dataset;
+		if (anyFits)
+			dataset = loadDataset();
+
+		for (const string& engine : options.engines) {
+			double memoryMb = isDense(engine) ? denseMemoryMb : engineMemoryMb;
+			for (int numThreads : options.numThreads) {
+				for (const string& distanceFunction : options.distanceFunctions) {
+					json << (firstResult ? "\n" : ",\n") << "    {\"dataset\": \"" << datasetName << "\", \"n\": " << numPoints
+						<< ", \"d\": " << numAttributes << ", \"threads\": " << numThreads << ", \"metric\": \"" << distanceFunction
+						<< "\", \"engine\": \"" << (isDense(engine) ? "Dense" : engine) << "\"";
+					firstResult = false;
+					if (memoryMb > options.maxMemoryMb) {
+						json << ", \"skipped\": \"needs about " << (long long)memoryMb << " MB\"}";
+						cerr << "skipping " << datasetName << " n=" << numPoints << " d=" << numAttributes << " engine=" << engine << endl;
+						continue;
+					}
+					cerr << "running " << datasetName << " n=" << numPoints << " d=" << numAttributes << " threads=" << numThreads
+						<< " metric=" << distanceFunction << " engine=" << engine << endl;
+
+					hdbscanParameters parameters;
+					parameters.dataset = dataset;
+					parameters.distanceFunction = distanceFunction;
+					parameters.minPoints = options.minPoints;
+					parameters.minClusterSize = options.minClusterSize;
+					parameters.numThreads = numThreads;
+					parameters.engine = engine;
+
+					vector<vector<double>> samples(numStages);
+					vector<double> stageSeconds(numStages);
+					for (int run = 0; run < options.warmup + options.repetitions; run++) {
+						runPipeline(parameters, stageSeconds, options.numTimedStages);
+						if (run < options.warmup)
+							continue;
+						for (int stage = 0; stage < numStages; stage++)
+							samples[stage].push_back(stageSeconds[stage]);
+					}
+
+					if (engine == "NNDescent" && options.recallSampleSize > 0) {
+						double recall = distanceFunction == "Manhattan" ? measureRecall<ManhattanDistance>(parameters, options.recallSampleSize) :
+							distanceFunction == "Haversine" ? measureRecall<HaversineDistance>(parameters, options.recallSampleSize) :
+							distanceFunction == "Cosine" || distanceFunction == "Angular" ? measureRecall<CosineDistance>(parameters, options.recallSampleSize) :
+							measureRecall<EuclideanDistance>(parameters, options.recallSampleSize);
+						json << ", \"recall\": " << jsonNumber(recall);
+					}
+					json << ", \"stages\": {";
+					int firstStage = isDense(engine) ? 0 : numDenseStages - 1;
+					for (int stage = firstStage; stage < options.numTimedStages; stage++) {
+						double median = percentile(samples[stage], 0.5);
+						string stageName = stage < numDenseStages && !isDense(engine) ? "calculateCoreDistancesAndMst" : stageNames[stage];
+						json << (stage != firstStage ? ", " : "") << "\"" << stageName << "\": {\"medianSeconds\": " << jsonNumber(median)
+							<< ", \"p95Seconds\": " << jsonNumber(percentile(samples[stage], 0.95))
+							<< ", \"pointsPerSecond\": " << jsonNumber(median > 0 ? numPoints / median : 0) << "}";
+					}
+					json << "}}";
+				}
+			}
+		}
+	};
+
+	try {
+		if (options.input.length() != 0) {
+			vector<vector<double>> dataset = datasetFile::load(options.input);
+			int numAttributes = dataset.size() ? dataset[0].size() : 0;
+			runDataset(options.input, dataset.size(), numAttributes, [&]() { return dataset; });
+		}
+		else {
+			for (datasetShape shape : options.shapes) {
+				for (int numPoints : options.numPoints) {
+					for (int numAttributes : options.numAttributes) {
+						datasetGeneratorOptions generatorOptions;
+						generatorOptions.shape = shape;
+						generatorOptions.numPoints = numPoints;
+						generatorOptions.numAttributes = numAttributes;
+						generatorOptions.numClusters = options.numClusters;
+						generatorOptions.noiseFraction = options.noiseFraction;
+						generatorOptions.seed = options.seed;
+						runDataset(datasetGenerator::getShapeName(shape), numPoints, numAttributes, [&]() {
+							return datasetGenerator(generatorOptions).generateAll();
+						});
+					}
+				}
+			}
+		}
+	}
+	catch (exception& error) {
+		cerr << error.what() << endl;
+		return 1;
+	}
+	json << "\n  ]\n}\n";
+
+	if (options.output.length() == 0) {
+		cout << json.str();
+		return 0;
+	}
+	ofstream file(options.output);
+	file << json.str();
+	return file ? 0 : 1;
+}
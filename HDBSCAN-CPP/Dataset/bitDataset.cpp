@@ -0,0 +1,50 @@
+#include "bitDataset.hpp"
+#include<stdexcept>
+
+bitDataset::bitDataset(int numBits) {
+	if (numBits < 0)
+		throw std::invalid_argument("A binary dataset cannot have a negative number of bits.");
+	_numBits = numBits;
+	_numWords = (numBits + 63) / 64;
+}
+
+void bitDataset::addRow(const uint64_t* words) {
+	_words.insert(_words.end(), words, words + _numWords);
+	if (_numBits % 64 != 0)
+		_words.back() &= (1ULL << (_numBits % 64)) - 1;
+}
+
+void bitDataset::addRow(const std::vector<double>& attributes) {
+	if ((int)attributes.size() != _numBits)
+		throw std::invalid_argument("Every row of a binary dataset needs one attribute per bit.");
+	std::vector<uint64_t> words(_numWords);
+	for (int bit = 0; bit < _numBits; bit++) {
+		if (attributes[bit] != 0)
+			words[bit / 64] |= 1ULL << (bit % 64);
+	}
+	addRow(words.data());
+}
+
+bitRows bitDataset::getRows() const {
+	return bitRows(_words.data(), _numBits);
+}
+
+const uint64_t* bitDataset::getRow(int row) const {
+	return _words.data() + (size_t)row * _numWords;
+}
+
+bool bitDataset::getBit(int row, int bit) const {
+	return (getRow(row)[bit / 64] >> (bit % 64)) & 1;
+}
+
+int bitDataset::getNumRows() const {
+	return _numWords != 0 ? _words.size() / _numWords : 0;
+}
+
+int bitDataset::getNumBits() const {
+	return _numBits;
+}
+
+int bitDataset::getNumWords() const {
+	return _numWords;
+}
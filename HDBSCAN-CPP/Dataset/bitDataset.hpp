@@ -0,0 +1,49 @@
+#pragma once
+#include<cstdint>
+#include<vector>
+#include"datasetRows.hpp"
+
+/// <summary>
+/// A binary dataset, such as chemical fingerprints or SimHash signatures, with the bits of each row packed into
+/// 64 bit words. A row takes numBits / 8 bytes instead of numBits doubles, and the Hamming and Jaccard distances
+/// compare a whole word per instruction. The bits past numBits in a row's last word are always zero.
+/// </summary>
+class bitDataset
+{
+private:
+	int _numBits;
+	int _numWords;
+	std::vector<uint64_t> _words;
+
+public:
+	/// <summary>
+	/// Creates an empty dataset of rows with numBits bits.
+	/// </summary>
+	bitDataset(int numBits = 0);
+
+	/// <summary>
+	/// Appends a row given as (numBits + 63) / 64 words, bit i of the row being bit i % 64 of word i / 64.
+	/// </summary>
+	void addRow(const uint64_t* words);
+
+	/// <summary>
+	/// Appends a row whose bits are set where attributes are nonzero, throwing std::invalid_argument unless it
+	/// has numBits attributes.
+	/// </summary>
+	void addRow(const std::vector<double>& attributes);
+
+	/// <summary>
+	/// Returns a view of the rows, valid until the next row is added.
+	/// </summary>
+	bitRows getRows() const;
+
+	const uint64_t* getRow(int row) const;
+
+	bool getBit(int row, int bit) const;
+
+	int getNumRows() const;
+
+	int getNumBits() const;
+
+	int getNumWords() const;
+};
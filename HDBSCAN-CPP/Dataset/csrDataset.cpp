@@ -0,0 +1,80 @@
+#include "csrDataset.hpp"
+#include<algorithm>
+#include<cmath>
+#include<stdexcept>
+#include<utility>
+
+csrDataset::csrDataset(int numColumns) {
+	_numColumns = numColumns;
+	_rowStarts.push_back(0);
+}
+
+void csrDataset::addRow(const int* columns, const double* values, int length) {
+	std::vector<std::pair<int, double>> entries(length);
+	for (int i = 0; i < length; i++) {
+		if (columns[i] < 0)
+			throw std::invalid_argument("Sparse rows cannot have negative columns.");
+		entries[i] = std::make_pair(columns[i], values[i]);
+	}
+	std::sort(entries.begin(), entries.end(), [](const std::pair<int, double>& first, const std::pair<int, double>& second) {
+		return first.first < second.first;
+	});
+
+	for (size_t i = 0; i < entries.size(); ) {
+		int column = entries[i].first;
+		double value = 0;
+		for (; i < entries.size() && entries[i].first == column; i++)
+			value += entries[i].second;
+		if (value == 0)
+			continue;
+		_columns.push_back(column);
+		_values.push_back(value);
+		_numColumns = std::max(_numColumns, column + 1);
+	}
+	_rowStarts.push_back(_values.size());
+}
+
+void csrDataset::normalizeRows() {
+	for (int row = 0; row < getNumRows(); row++) {
+		double norm = 0;
+		for (size_t i = _rowStarts[row]; i < _rowStarts[row + 1]; i++)
+			norm += _values[i] * _values[i];
+		if (norm == 0)
+			continue;
+		double scale = 1 / sqrt(norm);
+		for (size_t i = _rowStarts[row]; i < _rowStarts[row + 1]; i++)
+			_values[i] *= scale;
+	}
+}
+
+csrRows csrDataset::getRows() const {
+	return csrRows(_rowStarts.data(), _columns.data(), _values.data(), _numColumns);
+}
+
+csrRow csrDataset::getRow(int row) const {
+	return getRows().getRow(row);
+}
+
+int csrDataset::getNumRows() const {
+	return _rowStarts.size() - 1;
+}
+
+int csrDataset::getNumColumns() const {
+	return _numColumns;
+}
+
+size_t csrDataset::getNumNonzeros() const {
+	return _values.size();
+}
+
+const std::vector<size_t>& csrDataset::getRowStarts() const {
+	return _rowStarts;
+}
+
+const std::vector<int>& csrDataset::getColumns() const {
+	return _columns;
+}
+
+const std::vector<double>& csrDataset::getValues() const {
+	return _values;
+}
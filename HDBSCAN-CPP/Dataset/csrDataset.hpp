@@ -0,0 +1,60 @@
+#pragma once
+#include<cstddef>
+#include<vector>
+#include"datasetRows.hpp"
+
+/// <summary>
+/// A sparse dataset in compressed sparse row (CSR) form: the nonzero values of all rows one after the other,
+/// with their columns, and where each row starts. Memory follows the number of nonzeros rather than rows times
+/// columns, so bag-of-words and TF-IDF vectors with hundreds of thousands of columns fit.
+/// </summary>
+class csrDataset
+{
+private:
+	int _numColumns;
+	std::vector<size_t> _rowStarts;
+	std::vector<int> _columns;
+	std::vector<double> _values;
+
+public:
+	/// <summary>
+	/// Creates an empty dataset; rows with columns at or beyond numColumns widen it.
+	/// </summary>
+	csrDataset(int numColumns = 0);
+
+	/// <summary>
+	/// Appends a row given as columns and values in any order, throwing std::invalid_argument for a negative
+	/// column. Values of a repeated column are added up and zeros are dropped.
+	/// </summary>
+	/// <param name="columns">The column of each value</param>
+	/// <param name="values">The values</param>
+	/// <param name="length">The number of values</param>
+	void addRow(const int* columns, const double* values, int length);
+
+	/// <summary>
+	/// Scales every row to unit Euclidean length, leaving rows without values as they are.
+	/// </summary>
+	void normalizeRows();
+
+	/// <summary>
+	/// Returns a view of the rows, valid until the next row is added.
+	/// </summary>
+	csrRows getRows() const;
+
+	csrRow getRow(int row) const;
+
+	int getNumRows() const;
+
+	int getNumColumns() const;
+
+	size_t getNumNonzeros() const;
+
+	/// <summary>
+	/// Where each row's values start, followed by the number of nonzeros: row i is [rowStarts[i], rowStarts[i + 1]).
+	/// </summary>
+	const std::vector<size_t>& getRowStarts() const;
+
+	const std::vector<int>& getColumns() const;
+
+	const std::vector<double>& getValues() const;
+};
@@ -0,0 +1,204 @@
+#include "datasetFile.hpp"
+#include<cstdio>
+#include<cstring>
+#include<memory>
+#include<cstdlib>
+#include<stdexcept>
+#include"../Utils/mappedFile.hpp"
+
+namespace
+{
+	const char datasetMagic[8] = { 'H', 'D', 'B', 'S', 'C', 'A', 'N', 'D' };
+	const uint32_t datasetByteOrderMark = 0x01020304;
+
+	struct datasetHeader
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t byteOrderMark;
+		uint64_t numPoints;
+		uint32_t numAttributes;
+		uint32_t reserved;
+	};
+}
+
+bool datasetFile::isBinaryFileName(std::string fileName) {
+	return fileName.length() >= 4 && fileName.compare(fileName.length() - 4, 4, ".bin") == 0;
+}
+
+std::vector<std::vector<double>> datasetFile::load(std::string fileName) {
+	if (!isBinaryFileName(fileName))
+		return loadCsv(fileName);
+
+	uint64_t numPoints;
+	int numAttributes;
+	sharedArray<double> values = mapBinary(fileName, numPoints, numAttributes);
+	std::vector<std::vector<double>> dataset(numPoints);
+	for (uint64_t i = 0; i < numPoints; i++)
+		dataset[i].assign(values.data() + i * numAttributes, values.data() + (i + 1) * numAttributes);
+	return dataset;
+}
+
+std::vector<std::vector<double>> datasetFile::loadCsv(std::string fileName, bool skipHeader) {
+	std::ifstream file(fileName, std::ios::in);
+	if (!file)
+		throw std::runtime_error("Cannot open " + fileName + ".");
+
+	std::vector<std::vector<double>> dataset;
+	std::string line;
+	if (skipHeader)
+		getline(file, line);
+	while (getline(file, line)) {
+		if (line.length() == 0)
+			continue;
+		std::vector<double> row;
+		const char* position = line.c_str();
+		while (*position) {
+			char* end;
+			row.push_back(strtod(position, &end));
+			if (end == position)
+				throw std::runtime_error(fileName + " has a malformed line: " + line);
+			position = *end == ',' ? end + 1 : end;
+		}
+		dataset.push_back(row);
+	}
+	return dataset;
+}
+
+csrDataset datasetFile::loadSparse(std::string fileName) {
+	std::ifstream file(fileName, std::ios::in);
+	if (!file)
+		throw std::runtime_error("Cannot open " + fileName + ".");
+
+	csrDataset dataset;
+	std::vector<int> columns;
+	std::vector<double> values;
+	std::string line;
+	while (getline(file, line)) {
+		if (line.length() == 0)
+			continue;
+		columns.clear();
+		values.clear();
+		const char* position = line.c_str();
+		while (*position == ' ' || *position == '\t')
+			position++;
+		const char* token = position;
+		while (*token && *token != ' ' && *token != '\t' && *token != ':')
+			token++;
+		if (*token != ':') {
+			while (*token && *token != ' ' && *token != '\t')
+				token++;
+			position = token;
+		}
+		while (*position) {
+			while (*position == ' ' || *position == '\t' || *position == '\r')
+				position++;
+			if (!*position)
+				break;
+			char* end;
+			long column = strtol(position, &end, 10);
+			if (end == position || *end != ':' || column < 0 || column > INT32_MAX)
+				throw std::runtime_error(fileName + " has a malformed line: " + line);
+			position = end + 1;
+			double value = strtod(position, &end);
+			if (end == position)
+				throw std::runtime_error(fileName + " has a malformed line: " + line);
+			position = end;
+			columns.push_back((int)column);
+			values.push_back(value);
+		}
+		dataset.addRow(columns.data(), values.data(), columns.size());
+	}
+	return dataset;
+}
+
+sharedArray<double> datasetFile::mapBinary(std::string fileName, uint64_t& numPoints, int& numAttributes) {
+	std::shared_ptr<mappedFile> file = std::make_shared<mappedFile>(fileName);
+	datasetHeader header;
+	if (file->getSize() < sizeof(header))
+		throw std::runtime_error(fileName + " is not a binary dataset.");
+	memcpy(&header, file->getData(), sizeof(header));
+	if (memcmp(header.magic, datasetMagic, sizeof(header.magic)) != 0)
+		throw std::runtime_error(fileName + " is not a binary dataset.");
+	if (header.byteOrderMark != datasetByteOrderMark)
+		throw std::runtime_error(fileName + " was written on a machine with a different byte order.");
+	if (header.version != formatVersion)
+		throw std::runtime_error(fileName + " has an unsupported dataset version.");
+	uint64_t numValues = header.numPoints * header.numAttributes;
+	if (header.numAttributes == 0 || numValues / header.numAttributes != header.numPoints ||
+		numValues > (file->getSize() - sizeof(header)) / sizeof(double))
+		throw std::runtime_error(fileName + " is truncated.");
+
+	numPoints = header.numPoints;
+	numAttributes = header.numAttributes;
+	return sharedArray<double>(file, (const double*)(file->getData() + sizeof(header)), numValues);
+}
+
+datasetWriter::datasetWriter(std::string fileName, bool binary, int numAttributes) {
+	static_assert(sizeof(datasetHeader) == datasetFile::headerSize, "The dataset header must stay 32 bytes.");
+	_fileName = fileName;
+	_binary = binary;
+	_numAttributes = numAttributes;
+	_numPoints = 0;
+	_file.open(fileName, binary ? std::ios::out | std::ios::binary | std::ios::trunc : std::ios::out | std::ios::trunc);
+	if (!_file)
+		throw std::runtime_error("Cannot create " + fileName + ".");
+	if (_binary)
+		writeHeader();
+}
+
+datasetWriter::~datasetWriter() {
+	if (_file.is_open()) {
+		try {
+			close();
+		}
+		catch (std::exception&) {
+		}
+	}
+}
+
+void datasetWriter::writeHeader() {
+	datasetHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, datasetMagic, sizeof(header.magic));
+	header.version = datasetFile::formatVersion;
+	header.byteOrderMark = datasetByteOrderMark;
+	header.numPoints = _numPoints;
+	header.numAttributes = _numAttributes;
+	_file.write((const char*)&header, sizeof(header));
+}
+
+void datasetWriter::writeRows(const double* rows, size_t numRows) {
+	_numPoints += numRows;
+	if (_binary) {
+		_file.write((const char*)rows, numRows * _numAttributes * sizeof(double));
+		return;
+	}
+
+	//%.17g round-trips every double exactly:
+	std::string text;
+	char buffer[32];
+	for (size_t i = 0; i < numRows; i++) {
+		for (int j = 0; j < _numAttributes; j++) {
+			snprintf(buffer, sizeof(buffer), j ? ",%.17g" : "%.17g", rows[i * _numAttributes + j]);
+			text += buffer;
+		}
+		text += '\n';
+	}
+	_file.write(text.data(), text.length());
+}
+
+void datasetWriter::close() {
+	if (_binary) {
+		_file.seekp(0);
+		writeHeader();
+	}
+	bool failed = !_file;
+	_file.close();
+	if (failed)
+		throw std::runtime_error("Cannot write " + _fileName + ".");
+}
+
+uint64_t datasetWriter::getNumPoints() {
+	return _numPoints;
+}
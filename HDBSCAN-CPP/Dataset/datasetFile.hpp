@@ -0,0 +1,89 @@
+#pragma once
+#include<cstdint>
+#include<fstream>
+#include<string>
+#include<vector>
+#include"../Utils/sharedArray.hpp"
+#include"csrDataset.hpp"
+
+/// <summary>
+/// Reads and writes datasets as CSV (one point per line, comma separated, no header) or as binary files.
+/// A binary dataset is a 32 byte header (magic "HDBSCAND", format version, byte order mark, number of
+/// points, number of attributes) followed by the points as row-major doubles, so it can be memory mapped
+/// and used in place.
+/// </summary>
+class datasetFile
+{
+public:
+	static const uint32_t formatVersion = 1;
+	static const size_t headerSize = 32;
+
+	/// <summary>
+	/// Returns true if the file name ends in ".bin", the extension used for binary datasets.
+	/// </summary>
+	static bool isBinaryFileName(std::string fileName);
+
+	/// <summary>
+	/// Loads a CSV or binary dataset (chosen by the file name) into memory, throwing std::runtime_error
+	/// if it cannot be read.
+	/// </summary>
+	static std::vector<std::vector<double>> load(std::string fileName);
+
+	/// <summary>
+	/// Loads every column of every line of a CSV file, throwing std::runtime_error if it cannot be read.
+	/// </summary>
+	static std::vector<std::vector<double>> loadCsv(std::string fileName, bool skipHeader = false);
+
+	/// <summary>
+	/// Loads a sparse dataset with one point per line of space separated column:value pairs, columns counted
+	/// from 0, as in the svmlight format. A leading token without a colon, such as a label, is skipped. Throws
+	/// std::runtime_error if the file cannot be read.
+	/// </summary>
+	static csrDataset loadSparse(std::string fileName);
+
+	/// <summary>
+	/// Memory maps a binary dataset, throwing std::runtime_error if it is not a valid binary dataset.
+	/// </summary>
+	/// <param name="fileName">The path of the file to map</param>
+	/// <param name="numPoints">Receives the number of points</param>
+	/// <param name="numAttributes">Receives the number of attributes of each point</param>
+	/// <returns>The row-major attributes, viewed in the mapping</returns>
+	static sharedArray<double> mapBinary(std::string fileName, uint64_t& numPoints, int& numAttributes);
+};
+
+/// <summary>
+/// Streams points to a CSV or binary dataset without holding the dataset in memory. The number of points
+/// in a binary header is filled in by close().
+/// </summary>
+class datasetWriter
+{
+private:
+	std::ofstream _file;
+	std::string _fileName;
+	bool _binary;
+	int _numAttributes;
+	uint64_t _numPoints;
+
+	void writeHeader();
+
+public:
+	/// <summary>
+	/// Creates the file, throwing std::runtime_error if it cannot be created.
+	/// </summary>
+	datasetWriter(std::string fileName, bool binary, int numAttributes);
+
+	~datasetWriter();
+
+	/// <summary>
+	/// Appends numRows points stored as row-major attributes.
+	/// </summary>
+	void writeRows(const double* rows, size_t numRows);
+
+	/// <summary>
+	/// Finishes the file, throwing std::runtime_error if any write failed.
+	/// </summary>
+	void close();
+
+	uint64_t getNumPoints();
+};
+
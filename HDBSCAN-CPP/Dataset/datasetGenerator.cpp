@@ -0,0 +1,220 @@
+#include "datasetGenerator.hpp"
+#include<algorithm>
+#include<cmath>
+#include<stdexcept>
+#include"datasetFile.hpp"
+#include"../Utils/parallelFor.hpp"
+
+namespace
+{
+	const double boxSize = 100.0;
+	const double chainLength = 100.0;
+	const uint64_t layoutStream = ~0ULL;
+
+	uint64_t mixBits(uint64_t value)
+	{
+		value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+		return value ^ (value >> 31);
+	}
+
+	/// <summary>
+	/// A splitmix64 generator with its own stream per point, so the points do not depend on the order or the
+	/// thread they are generated in. Normal variates use Box-Muller rather than std::normal_distribution,
+	/// whose output differs between standard libraries.
+	/// </summary>
+	class pointRandom
+	{
+	private:
+		uint64_t _state;
+
+	public:
+		pointRandom(uint64_t seed, uint64_t stream)
+		{
+			_state = mixBits(seed ^ mixBits(stream + 0x9E3779B97F4A7C15ULL));
+		}
+
+		uint64_t next()
+		{
+			_state += 0x9E3779B97F4A7C15ULL;
+			return mixBits(_state);
+		}
+
+		double uniform()
+		{
+			return (next() >> 11) * (1.0 / 9007199254740992.0);
+		}
+
+		double uniform(double low, double high)
+		{
+			return low + (high - low) * uniform();
+		}
+
+		double normal()
+		{
+			double radius = sqrt(-2.0 * log(1.0 - uniform()));
+			return radius * cos(6.283185307179586 * uniform());
+		}
+	};
+}
+
+datasetGenerator::datasetGenerator(datasetGeneratorOptions options) {
+	if (options.numAttributes < 1 || options.numClusters < 1 || options.duplicateCount < 1 || options.intrinsicDimension < 1)
+		throw std::invalid_argument("The dataset needs at least one attribute, cluster, copy and intrinsic dimension.");
+	if (options.noiseFraction < 0 || options.noiseFraction > 1)
+		throw std::invalid_argument("The noise fraction must be between 0 and 1.");
+	_options = options;
+
+	pointRandom random(options.seed, layoutStream);
+	int numClusters = options.numClusters;
+	int numAttributes = options.numAttributes;
+	_centerDimension = options.shape == highDimensional ? std::min(options.intrinsicDimension, numAttributes) : numAttributes;
+
+	//nestedClusters places four child clusters around every parent center:
+	int numCenters = options.shape == nestedClusters ? numClusters * 4 : numClusters;
+	_centers.resize(numCenters * _centerDimension);
+	_spreads.resize(numCenters);
+	for (int cluster = 0; cluster < numClusters; cluster++) {
+		for (int j = 0; j < _centerDimension; j++)
+			_centers[cluster * _centerDimension + j] = random.uniform(-boxSize, boxSize);
+		//Spreads grow from 2 to 8 so the blobs have different densities:
+		_spreads[cluster] = numClusters == 1 ? 2.0 : 2.0 + 6.0 * cluster / (numClusters - 1);
+	}
+	if (options.shape == nestedClusters) {
+		for (int cluster = numCenters - 1; cluster >= 0; cluster--) {
+			int parent = cluster / 4;
+			for (int j = 0; j < _centerDimension; j++)
+				_centers[cluster * _centerDimension + j] = _centers[parent * _centerDimension + j] + 15.0 * random.normal();
+			_spreads[cluster] = 1.5;
+		}
+	}
+	if (options.shape == longChains) {
+		_directions.resize(numClusters * numAttributes);
+		for (int chain = 0; chain < numClusters; chain++) {
+			double length = 0;
+			for (int j = 0; j < numAttributes; j++) {
+				double value = random.normal();
+				_directions[chain * numAttributes + j] = value;
+				length += value * value;
+			}
+			length = sqrt(length);
+			for (int j = 0; j < numAttributes; j++)
+				_directions[chain * numAttributes + j] = length > 0 ? _directions[chain * numAttributes + j] / length : (j == 0);
+		}
+	}
+	if (options.shape == highDimensional) {
+		_projection.resize(numAttributes * _centerDimension);
+		for (double& value : _projection)
+			value = random.normal() / sqrt((double)_centerDimension);
+	}
+}
+
+void datasetGenerator::generateClusteredPoint(uint64_t index, double* point) {
+	pointRandom random(_options.seed, index);
+	int numAttributes = _options.numAttributes;
+	if (random.uniform() < _options.noiseFraction) {
+		for (int j = 0; j < numAttributes; j++)
+			point[j] = random.uniform(-boxSize, boxSize);
+		return;
+	}
+
+	if (_options.shape == longChains) {
+		//Points are laid out round-robin over the chains at equal spacing, so every chain edge is tied:
+		uint64_t chain = index % _options.numClusters;
+		uint64_t pointsPerChain = (_options.numPoints + _options.numClusters - 1) / _options.numClusters;
+		double position = (double)(index / _options.numClusters) * chainLength / (double)std::max<uint64_t>(pointsPerChain, 1);
+		for (int j = 0; j < numAttributes; j++)
+			point[j] = _centers[chain * numAttributes + j] + position * _directions[chain * numAttributes + j];
+		return;
+	}
+
+	int numCenters = _spreads.size();
+	int center = random.next() % numCenters;
+	double spread = _spreads[center];
+	if (_options.shape != highDimensional) {
+		for (int j = 0; j < numAttributes; j++)
+			point[j] = _centers[center * numAttributes + j] + spread * random.normal();
+		return;
+	}
+
+	std::vector<double> latent(_centerDimension);
+	for (int j = 0; j < _centerDimension; j++)
+		latent[j] = _centers[center * _centerDimension + j] + spread * random.normal();
+	for (int j = 0; j < numAttributes; j++) {
+		double value = 0.5 * random.normal();
+		for (int k = 0; k < _centerDimension; k++)
+			value += _projection[j * _centerDimension + k] * latent[k];
+		point[j] = value;
+	}
+}
+
+void datasetGenerator::generatePoint(uint64_t index, double* point) {
+	int numAttributes = _options.numAttributes;
+	switch (_options.shape) {
+	case uniformNoise: {
+		pointRandom random(_options.seed, index);
+		for (int j = 0; j < numAttributes; j++)
+			point[j] = random.uniform(-boxSize, boxSize);
+		break;
+	}
+	case exactDuplicates: {
+		//Copies of a distinct point are spread through the file rather than stored next to each other:
+		uint64_t numDistinct = (_options.numPoints + _options.duplicateCount - 1) / _options.duplicateCount;
+		generateClusteredPoint(index % std::max<uint64_t>(numDistinct, 1), point);
+		break;
+	}
+	case integerGrid:
+		generateClusteredPoint(index, point);
+		for (int j = 0; j < numAttributes; j++)
+			point[j] = floor(point[j] + 0.5);
+		break;
+	default:
+		generateClusteredPoint(index, point);
+		break;
+	}
+}
+
+void datasetGenerator::generate(uint64_t begin, uint64_t end, double* rows) {
+	for (uint64_t index = begin; index < end; index++)
+		generatePoint(index, rows + (index - begin) * _options.numAttributes);
+}
+
+std::vector<std::vector<double>> datasetGenerator::generateAll() {
+	std::vector<std::vector<double>> dataset(_options.numPoints, std::vector<double>(_options.numAttributes));
+	for (uint64_t index = 0; index < _options.numPoints; index++)
+		generatePoint(index, dataset[index].data());
+	return dataset;
+}
+
+void datasetGenerator::write(std::string fileName, bool binary, int numThreads, uint64_t blockSize) {
+	datasetWriter writer(fileName, binary, _options.numAttributes);
+	std::vector<double> block(blockSize * _options.numAttributes);
+	for (uint64_t begin = 0; begin < _options.numPoints; begin += blockSize) {
+		uint64_t end = std::min(begin + blockSize, _options.numPoints);
+		parallelFor(0, end - begin, numThreads, [&](int chunkBegin, int chunkEnd) {
+			generate(begin + chunkBegin, begin + chunkEnd, block.data() + (uint64_t)chunkBegin * _options.numAttributes);
+		});
+		writer.writeRows(block.data(), end - begin);
+	}
+	writer.close();
+}
+
+const datasetGeneratorOptions& datasetGenerator::getOptions() {
+	return _options;
+}
+
+static const char* shapeNames[] = { "blobs", "nested", "uniform", "chains", "duplicates", "grid", "highdim" };
+
+bool datasetGenerator::parseShape(std::string name, datasetShape& shape) {
+	for (int i = 0; i <= highDimensional; i++) {
+		if (name == shapeNames[i]) {
+			shape = (datasetShape)i;
+			return true;
+		}
+	}
+	return false;
+}
+
+std::string datasetGenerator::getShapeName(datasetShape shape) {
+	return shapeNames[shape];
+}
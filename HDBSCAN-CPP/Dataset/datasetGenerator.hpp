@@ -0,0 +1,96 @@
+#pragma once
+#include<cstdint>
+#include<string>
+#include<vector>
+
+/// <summary>
+/// The kinds of synthetic datasets the generator produces.
+/// </summary>
+enum datasetShape
+{
+	/// Gaussian blobs whose spread grows from cluster to cluster, so densities vary, plus uniform noise.
+	gaussianBlobs,
+	/// Tight clusters grouped into looser parent clusters, giving a deep condensed tree.
+	nestedClusters,
+	/// Points spread uniformly over the bounding box, with no cluster structure at all.
+	uniformNoise,
+	/// Evenly spaced points along line segments, which produce long single linkage chains of equal edges.
+	longChains,
+	/// Gaussian blobs in which every point is repeated many times at exactly the same position.
+	exactDuplicates,
+	/// Gaussian blobs snapped to integer coordinates, so most mutual reachability distances are tied.
+	integerGrid,
+	/// Clusters on a low-dimensional subspace embedded into many dimensions with isotropic noise.
+	highDimensional
+};
+
+/// <summary>
+/// Options of a synthetic dataset. The same options always produce the same points.
+/// </summary>
+class datasetGeneratorOptions
+{
+public:
+	datasetShape shape = gaussianBlobs;
+	uint64_t numPoints = 1000;
+	int numAttributes = 2;
+	/// The number of clusters (blobs, parent clusters or chains).
+	int numClusters = 8;
+	/// The fraction of points replaced by uniform noise, for the clustered shapes.
+	double noiseFraction = 0.1;
+	/// How many copies of each distinct point exactDuplicates makes.
+	int duplicateCount = 10;
+	/// The dimension of the subspace highDimensional embeds its clusters from.
+	int intrinsicDimension = 8;
+	uint64_t seed = 42;
+};
+
+/// <summary>
+/// Generates reproducible synthetic datasets. Each point is a pure function of the options and its index,
+/// so any range of points can be generated on its own: datasets far larger than memory are streamed in
+/// blocks, and blocks can be generated in parallel.
+/// </summary>
+class datasetGenerator
+{
+private:
+	datasetGeneratorOptions _options;
+	std::vector<double> _centers;
+	std::vector<double> _spreads;
+	std::vector<double> _directions;
+	std::vector<double> _projection;
+	int _centerDimension;
+
+	void generateClusteredPoint(uint64_t index, double* point);
+	void generatePoint(uint64_t index, double* point);
+
+public:
+	/// <summary>
+	/// Prepares the cluster layout, throwing std::invalid_argument for invalid options.
+	/// </summary>
+	datasetGenerator(datasetGeneratorOptions options);
+
+	/// <summary>
+	/// Writes the points with indices [begin, end) as row-major attributes into rows.
+	/// </summary>
+	void generate(uint64_t begin, uint64_t end, double* rows);
+
+	/// <summary>
+	/// Generates the whole dataset in memory, in the layout the runner expects.
+	/// </summary>
+	std::vector<std::vector<double>> generateAll();
+
+	/// <summary>
+	/// Streams the whole dataset to a CSV or binary file (see datasetFile), in blocks of blockSize points.
+	/// </summary>
+	void write(std::string fileName, bool binary, int numThreads = 1, uint64_t blockSize = 65536);
+
+	const datasetGeneratorOptions& getOptions();
+
+	/// <summary>
+	/// Parses a shape name (blobs, nested, uniform, chains, duplicates, grid, highdim), returning false
+	/// for unknown names.
+	/// </summary>
+	static bool parseShape(std::string name, datasetShape& shape);
+
+	static std::string getShapeName(datasetShape shape);
+};
+
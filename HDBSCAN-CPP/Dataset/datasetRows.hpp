@@ -0,0 +1,135 @@
+#pragma once
+#include<cstddef>
+#include<cstdint>
+
+/// <summary>
+/// Views the rows of a row-major dataset, which must outlive the view. nnDescent and boruvkaMst read points
+/// through a view like this one, csrRows, bitRows or codeRows, and hand the rows it returns to their distance policy.
+/// </summary>
+class denseRows
+{
+private:
+	const double* _dataset;
+	int _numAttributes;
+
+public:
+	denseRows(const double* dataset, int numAttributes)
+	{
+		_dataset = dataset;
+		_numAttributes = numAttributes;
+	}
+
+	const double* getRow(int row) const
+	{
+		return _dataset + (size_t)row * _numAttributes;
+	}
+
+	int getNumAttributes() const
+	{
+		return _numAttributes;
+	}
+};
+
+/// <summary>
+/// A row of a sparse dataset: its nonzero values and their columns, in ascending column order.
+/// </summary>
+struct csrRow
+{
+	const int* columns;
+	const double* values;
+	int length;
+};
+
+/// <summary>
+/// Views the rows of a csrDataset, which must outlive the view.
+/// </summary>
+class csrRows
+{
+private:
+	const size_t* _rowStarts;
+	const int* _columns;
+	const double* _values;
+	int _numColumns;
+
+public:
+	csrRows(const size_t* rowStarts, const int* columns, const double* values, int numColumns)
+	{
+		_rowStarts = rowStarts;
+		_columns = columns;
+		_values = values;
+		_numColumns = numColumns;
+	}
+
+	csrRow getRow(int row) const
+	{
+		size_t start = _rowStarts[row];
+		csrRow sparseRow = { _columns + start, _values + start, (int)(_rowStarts[row + 1] - start) };
+		return sparseRow;
+	}
+
+	int getNumAttributes() const
+	{
+		return _numColumns;
+	}
+};
+
+/// <summary>
+/// Views the rows of a bitDataset, which must outlive the view. Each row is the packed words of its bits, and
+/// its number of attributes is the number of bits.
+/// </summary>
+class bitRows
+{
+private:
+	const uint64_t* _words;
+	int _numBits;
+	int _numWords;
+
+public:
+	bitRows(const uint64_t* words, int numBits)
+	{
+		_words = words;
+		_numBits = numBits;
+		_numWords = (numBits + 63) / 64;
+	}
+
+	const uint64_t* getRow(int row) const
+	{
+		return _words + (size_t)row * _numWords;
+	}
+
+	int getNumAttributes() const
+	{
+		return _numBits;
+	}
+};
+
+/// <summary>
+/// Views the rows of quantized codes, rowLength codes per row, which must outlive the view. The number of
+/// attributes is the one of the original points the codes stand for.
+/// </summary>
+template<class TCode>
+class codeRows
+{
+private:
+	const TCode* _codes;
+	int _rowLength;
+	int _numAttributes;
+
+public:
+	codeRows(const TCode* codes, int rowLength, int numAttributes)
+	{
+		_codes = codes;
+		_rowLength = rowLength;
+		_numAttributes = numAttributes;
+	}
+
+	const TCode* getRow(int row) const
+	{
+		return _codes + (size_t)row * _rowLength;
+	}
+
+	int getNumAttributes() const
+	{
+		return _numAttributes;
+	}
+};
@@ -0,0 +1,197 @@
+#include "productQuantizer.hpp"
+#include<algorithm>
+#include<cmath>
+#include<limits>
+#include<stdexcept>
+#include"../Utils/parallelFor.hpp"
+
+namespace
+{
+	const int maxCentroids = 256;
+	const int maxTrainingPoints = maxCentroids * 40;
+	const int numTrainingIterations = 20;
+}
+
+productQuantizer::productQuantizer(const double* dataset, int numPoints, int numAttributes, int numSubspaces, bool manhattan, int numThreads, uint64_t seed) {
+	if (numSubspaces < 1 || numSubspaces > numAttributes)
+		throw std::invalid_argument("Product quantization needs between 1 and the number of attributes subspaces.");
+	_numPoints = numPoints;
+	_numAttributes = numAttributes;
+	_numSubspaces = numSubspaces;
+	_numCentroids = std::max(1, std::min(maxCentroids, numPoints));
+	_manhattan = manhattan;
+
+	//Subspaces of consecutive attributes whose sizes differ by at most one:
+	_subspaceStarts.resize(numSubspaces + 1);
+	for (int subspace = 0; subspace <= numSubspaces; subspace++)
+		_subspaceStarts[subspace] = (int)((long long)subspace * numAttributes / numSubspaces);
+
+	_centroids.resize((size_t)_numCentroids * numAttributes);
+	parallelFor(0, numSubspaces, numThreads, [&](int begin, int end) {
+		for (int subspace = begin; subspace < end; subspace++)
+			train(dataset, subspace, seed);
+	});
+
+	_codes.resize((size_t)numPoints * numSubspaces);
+	parallelFor(0, numPoints, numThreads, [&](int begin, int end) {
+		for (int i = begin; i < end; i++) {
+			for (int subspace = 0; subspace < numSubspaces; subspace++) {
+				int start = _subspaceStarts[subspace];
+				int length = _subspaceStarts[subspace + 1] - start;
+				const double* attributes = dataset + (size_t)i * numAttributes + start;
+				int nearest = 0;
+				double nearestDistance = std::numeric_limits<double>::infinity();
+				for (int centroid = 0; centroid < _numCentroids; centroid++) {
+					double distance = measure(attributes, &_centroids[(size_t)centroid * numAttributes + start], length);
+					if (distance < nearestDistance) {
+						nearestDistance = distance;
+						nearest = centroid;
+					}
+				}
+				_codes[(size_t)i * numSubspaces + subspace] = (uint8_t)nearest;
+			}
+		}
+	});
+
+	size_t tableSize = (size_t)_numCentroids * _numCentroids;
+	_distanceTables.resize(tableSize * numSubspaces);
+	for (int subspace = 0; subspace < numSubspaces; subspace++) {
+		int start = _subspaceStarts[subspace];
+		int length = _subspaceStarts[subspace + 1] - start;
+		for (int first = 0; first < _numCentroids; first++) {
+			for (int second = 0; second < _numCentroids; second++) {
+				_distanceTables[subspace * tableSize + (size_t)first * _numCentroids + second] = (float)measure(
+					&_centroids[(size_t)first * numAttributes + start], &_centroids[(size_t)second * numAttributes + start], length);
+			}
+		}
+	}
+}
+
+//The per-subspace distance that adds up over subspaces: squared euclidean or manhattan.
+double productQuantizer::measure(const double* attributesOne, const double* attributesTwo, int numAttributes) const {
+	double distance = 0;
+	for (int i = 0; i < numAttributes; i++) {
+		double difference = attributesOne[i] - attributesTwo[i];
+		distance += _manhattan ? fabs(difference) : difference * difference;
+	}
+	return distance;
+}
+
+//Lloyd's k-means on an evenly spread sample, starting from sample points picked by the seed. A centroid
+//left without points keeps its place.
+void productQuantizer::train(const double* dataset, int subspace, uint64_t seed) {
+	int start = _subspaceStarts[subspace];
+	int length = _subspaceStarts[subspace + 1] - start;
+	int numSamples = std::min(_numPoints, maxTrainingPoints);
+	std::vector<double> samples((size_t)numSamples * length);
+	for (int sample = 0; sample < numSamples; sample++) {
+		const double* attributes = dataset + (size_t)((long long)sample * _numPoints / numSamples) * _numAttributes + start;
+		std::copy(attributes, attributes + length, &samples[(size_t)sample * length]);
+	}
+
+	std::vector<double> centroids((size_t)_numCentroids * length);
+	uint64_t offset = (seed ^ (uint64_t)subspace * 0x9E3779B97F4A7C15ULL) % (uint64_t)numSamples;
+	for (int centroid = 0; centroid < _numCentroids; centroid++) {
+		int sample = (int)(((long long)centroid * numSamples / _numCentroids + offset) % numSamples);
+		std::copy(&samples[(size_t)sample * length], &samples[(size_t)sample * length] + length, &centroids[(size_t)centroid * length]);
+	}
+
+	std::vector<int> assignments(numSamples, -1);
+	std::vector<double> sums((size_t)_numCentroids * length);
+	std::vector<int> counts(_numCentroids);
+	for (int iteration = 0; iteration < numTrainingIterations; iteration++) {
+		bool changed = false;
+		for (int sample = 0; sample < numSamples; sample++) {
+			int nearest = 0;
+			double nearestDistance = std::numeric_limits<double>::infinity();
+			for (int centroid = 0; centroid < _numCentroids; centroid++) {
+				double distance = 0;
+				for (int i = 0; i < length; i++) {
+					double difference = samples[(size_t)sample * length + i] - centroids[(size_t)centroid * length + i];
+					distance += difference * difference;
+				}
+				if (distance < nearestDistance) {
+					nearestDistance = distance;
+					nearest = centroid;
+				}
+			}
+			changed |= assignments[sample] != nearest;
+			assignments[sample] = nearest;
+		}
+		if (!changed)
+			break;
+
+		std::fill(sums.begin(), sums.end(), 0.0);
+		std::fill(counts.begin(), counts.end(), 0);
+		for (int sample = 0; sample < numSamples; sample++) {
+			counts[assignments[sample]]++;
+			for (int i = 0; i < length; i++)
+				sums[(size_t)assignments[sample] * length + i] += samples[(size_t)sample * length + i];
+		}
+		for (int centroid = 0; centroid < _numCentroids; centroid++) {
+			if (counts[centroid] == 0)
+				continue;
+			for (int i = 0; i < length; i++)
+				centroids[(size_t)centroid * length + i] = sums[(size_t)centroid * length + i] / counts[centroid];
+		}
+	}
+
+	for (int centroid = 0; centroid < _numCentroids; centroid++)
+		std::copy(&centroids[(size_t)centroid * length], &centroids[(size_t)centroid * length] + length, &_centroids[(size_t)centroid * _numAttributes + start]);
+}
+
+codeRows<uint8_t> productQuantizer::getRows() const {
+	return codeRows<uint8_t>(_codes.data(), _numSubspaces, _numAttributes);
+}
+
+const std::vector<float>& productQuantizer::getDistanceTables() const {
+	return _distanceTables;
+}
+
+void productQuantizer::computeQueryTable(const double* attributes, std::vector<float>& table) const {
+	table.resize((size_t)_numSubspaces * _numCentroids);
+	for (int subspace = 0; subspace < _numSubspaces; subspace++) {
+		int start = _subspaceStarts[subspace];
+		int length = _subspaceStarts[subspace + 1] - start;
+		for (int centroid = 0; centroid < _numCentroids; centroid++)
+			table[(size_t)subspace * _numCentroids + centroid] = (float)measure(attributes + start, &_centroids[(size_t)centroid * _numAttributes + start], length);
+	}
+}
+
+double productQuantizer::computeQueryDistance(const std::vector<float>& table, int row) const {
+	const uint8_t* codes = &_codes[(size_t)row * _numSubspaces];
+	double distance = 0;
+	for (int subspace = 0; subspace < _numSubspaces; subspace++)
+		distance += table[(size_t)subspace * _numCentroids + codes[subspace]];
+	return _manhattan ? distance : sqrt(distance);
+}
+
+void productQuantizer::decode(int row, double* attributes) const {
+	const uint8_t* codes = &_codes[(size_t)row * _numSubspaces];
+	for (int subspace = 0; subspace < _numSubspaces; subspace++) {
+		int start = _subspaceStarts[subspace];
+		int length = _subspaceStarts[subspace + 1] - start;
+		const double* centroid = &_centroids[(size_t)codes[subspace] * _numAttributes + start];
+		std::copy(centroid, centroid + length, attributes + start);
+	}
+}
+
+int productQuantizer::getNumPoints() const {
+	return _numPoints;
+}
+
+int productQuantizer::getNumAttributes() const {
+	return _numAttributes;
+}
+
+int productQuantizer::getNumSubspaces() const {
+	return _numSubspaces;
+}
+
+int productQuantizer::getNumCentroids() const {
+	return _numCentroids;
+}
+
+bool productQuantizer::isManhattan() const {
+	return _manhattan;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include<cstdint>
+#include<vector>
+#include"datasetRows.hpp"
+
+/// <summary>
+/// Compresses a dataset with product quantization: the attributes are split into subspaces of consecutive
+/// attributes, k-means learns up to 256 centroids in each, and a point is stored as the byte index of its
+/// nearest centroid per subspace. A 128 attribute point with 32 subspaces takes 32 bytes instead of 1 KB.
+/// Two coded points are compared through per-subspace tables of the distances between centroids, one lookup
+/// per subspace (ProductQuantizedDistance); a point whose attributes are known is compared with coded points
+/// through its asymmetric table of distances to every centroid, which only quantizes the coded side.
+/// </summary>
+class productQuantizer
+{
+private:
+	int _numPoints;
+	int _numAttributes;
+	int _numSubspaces;
+	int _numCentroids;
+	bool _manhattan;
+	std::vector<int> _subspaceStarts;
+	std::vector<double> _centroids;
+	std::vector<uint8_t> _codes;
+	std::vector<float> _distanceTables;
+
+	double measure(const double* attributesOne, const double* attributesTwo, int numAttributes) const;
+
+	void train(const double* dataset, int subspace, uint64_t seed);
+
+public:
+	/// <summary>
+	/// Trains the centroids on a sample of a row-major dataset, such as one mapped with
+	/// datasetFile::mapBinary(), and encodes every point; the dataset is not kept.
+	/// </summary>
+	/// <param name="dataset">numPoints rows of numAttributes values each</param>
+	/// <param name="numPoints">The number of points</param>
+	/// <param name="numAttributes">The number of attributes of each point</param>
+	/// <param name="numSubspaces">The number of subspaces and bytes per point, at most numAttributes</param>
+	/// <param name="manhattan">Whether distances are manhattan rather than euclidean</param>
+	/// <param name="numThreads">The number of threads; 0 uses all hardware threads</param>
+	/// <param name="seed">The seed of the k-means initialization</param>
+	productQuantizer(const double* dataset, int numPoints, int numAttributes, int numSubspaces, bool manhattan = false, int numThreads = 1, uint64_t seed = 0);
+
+	codeRows<uint8_t> getRows() const;
+
+	/// <summary>
+	/// The tables of distances between centroids: subspace s holds the numCentroids x numCentroids entries
+	/// starting at s * numCentroids * numCentroids, as squared euclidean or manhattan distances.
+	/// </summary>
+	const std::vector<float>& getDistanceTables() const;
+
+	/// <summary>
+	/// Fills the asymmetric table of a point: the numSubspaces x numCentroids distances, squared for the
+	/// euclidean distance, between the point's part in each subspace and each centroid.
+	/// </summary>
+	void computeQueryTable(const double* attributes, std::vector<float>& table) const;
+
+	/// <summary>
+	/// The distance between the point of a query table and a coded row.
+	/// </summary>
+	double computeQueryDistance(const std::vector<float>& table, int row) const;
+
+	/// <summary>
+	/// Writes the attributes a row's codes stand for.
+	/// </summary>
+	void decode(int row, double* attributes) const;
+
+	int getNumPoints() const;
+
+	int getNumAttributes() const;
+
+	int getNumSubspaces() const;
+
+	int getNumCentroids() const;
+
+	bool isManhattan() const;
+};
@@ -0,0 +1,60 @@
+#include "scalarQuantizer.hpp"
+#include<algorithm>
+#include<cmath>
+#include"../Utils/parallelFor.hpp"
+
+scalarQuantizer::scalarQuantizer(const double* dataset, int numPoints, int numAttributes, int numThreads) {
+	_numPoints = numPoints;
+	_numAttributes = numAttributes;
+	std::vector<double> minimums(numAttributes, INFINITY);
+	std::vector<double> maximums(numAttributes, -INFINITY);
+	for (int i = 0; i < numPoints; i++) {
+		const double* attributes = dataset + (size_t)i * numAttributes;
+		for (int attribute = 0; attribute < numAttributes; attribute++) {
+			minimums[attribute] = std::min(minimums[attribute], attributes[attribute]);
+			maximums[attribute] = std::max(maximums[attribute], attributes[attribute]);
+		}
+	}
+	double range = 0;
+	for (int attribute = 0; attribute < numAttributes; attribute++)
+		range = std::max(range, maximums[attribute] - minimums[attribute]);
+	_scale = range > 0 ? range / 255 : 1;
+
+	//Center each attribute's range on the codes -128 to 127:
+	_offsets.resize(numAttributes);
+	for (int attribute = 0; attribute < numAttributes; attribute++)
+		_offsets[attribute] = numPoints ? (minimums[attribute] + maximums[attribute]) / 2 : 0;
+	_codes.resize((size_t)numPoints * numAttributes);
+	parallelFor(0, numPoints, numThreads, [&](int begin, int end) {
+		for (int i = begin; i < end; i++) {
+			const double* attributes = dataset + (size_t)i * numAttributes;
+			int8_t* codes = &_codes[(size_t)i * numAttributes];
+			for (int attribute = 0; attribute < numAttributes; attribute++) {
+				double code = std::floor((attributes[attribute] - _offsets[attribute]) / _scale + 0.5);
+				codes[attribute] = (int8_t)std::max(-128.0, std::min(127.0, code));
+			}
+		}
+	});
+}
+
+codeRows<int8_t> scalarQuantizer::getRows() const {
+	return codeRows<int8_t>(_codes.data(), _numAttributes, _numAttributes);
+}
+
+void scalarQuantizer::decode(int row, double* attributes) const {
+	const int8_t* codes = &_codes[(size_t)row * _numAttributes];
+	for (int attribute = 0; attribute < _numAttributes; attribute++)
+		attributes[attribute] = _offsets[attribute] + codes[attribute] * _scale;
+}
+
+double scalarQuantizer::getScale() const {
+	return _scale;
+}
+
+int scalarQuantizer::getNumPoints() const {
+	return _numPoints;
+}
+
+int scalarQuantizer::getNumAttributes() const {
+	return _numAttributes;
+}
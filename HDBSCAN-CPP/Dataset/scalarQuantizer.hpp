@@ -0,0 +1,46 @@
+#pragma once
+#include<cstdint>
+#include<vector>
+#include"datasetRows.hpp"
+
+/// <summary>
+/// Compresses a dataset to one signed byte per attribute, an eighth of the memory of doubles. Each attribute
+/// is shifted by its own offset and all attributes share one step size, the widest attribute range over 255,
+/// so differences of codes are integers in a common unit and ScalarQuantizedDistance sums them in integer
+/// arithmetic, which compilers vectorize.
+/// </summary>
+class scalarQuantizer
+{
+private:
+	int _numPoints;
+	int _numAttributes;
+	double _scale;
+	std::vector<double> _offsets;
+	std::vector<int8_t> _codes;
+
+public:
+	/// <summary>
+	/// Quantizes a row-major dataset, such as one mapped with datasetFile::mapBinary(); it is not kept.
+	/// </summary>
+	/// <param name="dataset">numPoints rows of numAttributes values each</param>
+	/// <param name="numPoints">The number of points</param>
+	/// <param name="numAttributes">The number of attributes of each point</param>
+	/// <param name="numThreads">The number of threads; 0 uses all hardware threads</param>
+	scalarQuantizer(const double* dataset, int numPoints, int numAttributes, int numThreads = 1);
+
+	codeRows<int8_t> getRows() const;
+
+	/// <summary>
+	/// Writes the attributes a row's codes stand for.
+	/// </summary>
+	void decode(int row, double* attributes) const;
+
+	/// <summary>
+	/// The distance between two attributes whose codes differ by one.
+	/// </summary>
+	double getScale() const;
+
+	int getNumPoints() const;
+
+	int getNumAttributes() const;
+};
@@ -0,0 +1,52 @@
+#include"CosineDistance.hpp"
+#include<vector>
+#include<cmath>
+#include<limits>
+#include<algorithm>
+CosineDistance::CosineDistance(bool angular) {
+	_angular = angular;
+}
+
+double CosineDistance::computeDistance(std::vector<double> attributesOne, std::vector<double> attributesTwo) {
+	return computeDistance(attributesOne.data(), attributesTwo.data(), std::min(attributesOne.size(), attributesTwo.size()));
+}
+
+double CosineDistance::computeDistance(const double* attributesOne, const double* attributesTwo, int numAttributes) {
+	double normOne = 0;
+	double normTwo = 0;
+	for (int i = 0; i < numAttributes; i++) {
+		normOne += attributesOne[i] * attributesOne[i];
+		normTwo += attributesTwo[i] * attributesTwo[i];
+	}
+	double scaleOne = normOne > 0 ? 1 / sqrt(normOne) : 0;
+	double scaleTwo = normTwo > 0 ? 1 / sqrt(normTwo) : 0;
+	double chord = 0;
+	for (int i = 0; i < numAttributes; i++) {
+		double difference = attributesOne[i] * scaleOne - attributesTwo[i] * scaleTwo;
+		chord += difference * difference;
+	}
+
+	return chordToDistance(sqrt(chord));
+}
+
+void CosineDistance::normalize(const double* attributes, int numAttributes, double* unitVector) {
+	double norm = 0;
+	for (int i = 0; i < numAttributes; i++)
+		norm += attributes[i] * attributes[i];
+	double scale = norm > 0 ? 1 / sqrt(norm) : 0;
+	for (int i = 0; i < numAttributes; i++)
+		unitVector[i] = norm > 0 ? attributes[i] * scale : attributes[i];
+}
+
+double CosineDistance::chordToDistance(double chord) {
+	if (chord == std::numeric_limits<double>::max())
+		return chord;
+	if (_angular)
+		return 2 * asin(std::min(1.0, chord / 2));
+
+	return chord * chord / 2;
+}
+
+bool CosineDistance::isAngular() {
+	return _angular;
+}
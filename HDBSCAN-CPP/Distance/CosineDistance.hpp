@@ -0,0 +1,38 @@
+#pragma once
+#include"IDistanceCalculator.hpp"
+/// <summary>
+/// Computes the cosine distance between two points, d = 1 - (x . y) / (|x| * |y|), or with the angular flag the
+/// angle between them in radians, d = acos((x . y) / (|x| * |y|)), which is a true metric. Both only depend on
+/// the points' directions, so each row is normalized once with normalize() and pairs of unit rows are compared
+/// by their chord |x - y|: 1 - x . y = |x - y|^2 / 2 for unit rows, without the cancellation of the dot product
+/// for nearly parallel rows. A row of zeros has no direction and stays at the origin, a chord of 1 from every row.
+/// </summary>
+class CosineDistance : IDistanceCalculator
+{
+private:
+	bool _angular;
+
+public:
+	CosineDistance(bool angular = false);
+
+	double computeDistance(std::vector<double> attributesOne, std::vector<double> attributesTwo);
+
+	double computeDistance(const double* attributesOne, const double* attributesTwo, int numAttributes);
+
+	/// <summary>
+	/// Scales a row to unit length; a row of zeros is copied as it is.
+	/// </summary>
+	/// <param name="attributes">The attributes of the row</param>
+	/// <param name="numAttributes">The number of attributes of the row</param>
+	/// <param name="unitVector">Receives the normalized row; it may be attributes itself</param>
+	static void normalize(const double* attributes, int numAttributes, double* unitVector);
+
+	/// <summary>
+	/// Converts the chord between two normalized rows to this distance. The chord grows with both forms, so
+	/// Euclidean neighbor searches and MSTs over normalized rows order pairs exactly as this distance does. The
+	/// largest double stands for an infinite distance and is kept as it is.
+	/// </summary>
+	double chordToDistance(double chord);
+
+	bool isAngular();
+};
@@ -9,5 +9,15 @@ double EuclideanDistance::computeDistance(std::vector<double> attributesOne, std
 		distance += ((attributesOne[i] - attributesTwo[i]) * (attributesOne[i] - attributesTwo[i]));
 	}
 
+	return sqrt(distance);
+}
+
+double EuclideanDistance::computeDistance(const double* attributesOne, const double* attributesTwo, int numAttributes) {
+	double distance = 0;
+	for (int i = 0; i < numAttributes; i++) {
+		double difference = attributesOne[i] - attributesTwo[i];
+		distance += difference * difference;
+	}
+
 	return sqrt(distance);
 }
\ No newline at end of file
@@ -8,5 +8,7 @@ class EuclideanDistance : IDistanceCalculator
 public:
 	double computeDistance(std::vector<double> attributesOne, std::vector<double> attributesTwo);
 
+	double computeDistance(const double* attributesOne, const double* attributesTwo, int numAttributes);
+
 };
 
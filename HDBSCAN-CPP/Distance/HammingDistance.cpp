@@ -0,0 +1,5 @@
+#include"HammingDistance.hpp"
+#include"../Utils/popcount.hpp"
+double HammingDistance::computeDistance(const uint64_t* attributesOne, const uint64_t* attributesTwo, int numAttributes) {
+	return (double)popcount::countDifferentBits(attributesOne, attributesTwo, (numAttributes + 63) / 64);
+}
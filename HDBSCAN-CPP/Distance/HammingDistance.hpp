@@ -0,0 +1,11 @@
+#pragma once
+#include<cstdint>
+/// <summary>
+/// Computes the hamming distance between two bit-packed rows of a bitDataset: the number of bits that differ,
+/// counted a word at a time with popcount.
+/// </summary>
+class HammingDistance
+{
+public:
+	double computeDistance(const uint64_t* attributesOne, const uint64_t* attributesTwo, int numAttributes);
+};
@@ -0,0 +1,30 @@
+#include"HaversineDistance.hpp"
+#include<vector>
+#include<cmath>
+#include<limits>
+#include<algorithm>
+double HaversineDistance::computeDistance(std::vector<double> attributesOne, std::vector<double> attributesTwo) {
+	return computeDistance(attributesOne.data(), attributesTwo.data(), 2);
+}
+
+double HaversineDistance::computeDistance(const double* attributesOne, const double* attributesTwo, int numAttributes) {
+	double latitudeSine = sin((attributesTwo[0] - attributesOne[0]) / 2);
+	double longitudeSine = sin((attributesTwo[1] - attributesOne[1]) / 2);
+	double haversine = latitudeSine * latitudeSine + cos(attributesOne[0]) * cos(attributesTwo[0]) * longitudeSine * longitudeSine;
+
+	return 2 * asin(std::min(1.0, sqrt(haversine)));
+}
+
+void HaversineDistance::toUnitVector(const double* latitudeLongitude, double* unitVector) {
+	double latitudeCosine = cos(latitudeLongitude[0]);
+	unitVector[0] = latitudeCosine * cos(latitudeLongitude[1]);
+	unitVector[1] = latitudeCosine * sin(latitudeLongitude[1]);
+	unitVector[2] = sin(latitudeLongitude[0]);
+}
+
+double HaversineDistance::chordToAngle(double chord) {
+	if (chord == std::numeric_limits<double>::max())
+		return chord;
+
+	return 2 * asin(std::min(1.0, chord / 2));
+}
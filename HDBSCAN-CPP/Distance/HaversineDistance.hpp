@@ -0,0 +1,29 @@
+#pragma once
+#include"IDistanceCalculator.hpp"
+/// <summary>
+/// Computes the great-circle distance between two points given as (latitude, longitude) in radians, as the
+/// angle between them on the unit sphere: d = 2 * asin(sqrt(sin^2((y1-x1)/2) + cos(x1) * cos(y1) * sin^2((y2-x2)/2))).
+/// Multiply by the Earth's radius (about 6371 km) for a length.
+/// </summary>
+class HaversineDistance : IDistanceCalculator
+{
+public:
+	double computeDistance(std::vector<double> attributesOne, std::vector<double> attributesTwo);
+
+	double computeDistance(const double* attributesOne, const double* attributesTwo, int numAttributes);
+
+	/// <summary>
+	/// Maps a (latitude, longitude) pair in radians to its point on the unit sphere. The sines and cosines are
+	/// paid once per point: the straight-line (chord) distance between two such points grows with the angle
+	/// between them, so Euclidean neighbor searches and MSTs over them order pairs exactly as this distance does.
+	/// </summary>
+	/// <param name="latitudeLongitude">The latitude and longitude in radians</param>
+	/// <param name="unitVector">Receives the three coordinates of the point on the unit sphere</param>
+	static void toUnitVector(const double* latitudeLongitude, double* unitVector);
+
+	/// <summary>
+	/// Converts the chord distance between two points of the unit sphere to the angle between them. The
+	/// largest double stands for an infinite distance and is kept as it is.
+	/// </summary>
+	static double chordToAngle(double chord);
+};
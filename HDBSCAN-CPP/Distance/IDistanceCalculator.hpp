@@ -15,5 +15,14 @@ class IDistanceCalculator
 	/// <returns>A double for the distance between the two points</returns>
 public:
 	virtual double computeDistance(std::vector<double> attributesOne, std::vector<double> attributesTwo)=0;
+
+	/// <summary>
+	/// Computes the distance between two points stored as contiguous rows, without copying them.
+	/// </summary>
+	/// <param name="attributesOne">The attributes of the first point</param>
+	/// <param name="attributesTwo">The attributes of the second point</param>
+	/// <param name="numAttributes">The number of attributes of each point</param>
+	/// <returns>A double for the distance between the two points</returns>
+	virtual double computeDistance(const double* attributesOne, const double* attributesTwo, int numAttributes)=0;
 };
 
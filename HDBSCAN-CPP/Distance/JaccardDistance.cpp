@@ -0,0 +1,10 @@
+#include"JaccardDistance.hpp"
+#include"../Utils/popcount.hpp"
+double JaccardDistance::computeDistance(const uint64_t* attributesOne, const uint64_t* attributesTwo, int numAttributes) {
+	uint64_t numBoth;
+	uint64_t numEither;
+	popcount::countCommonBits(attributesOne, attributesTwo, (numAttributes + 63) / 64, numBoth, numEither);
+	if (numEither == 0)
+		return 0;
+	return 1 - (double)numBoth / numEither;
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include<cstdint>
+/// <summary>
+/// Computes the jaccard distance between two bit-packed rows of a bitDataset, 1 - |x ∩ y| / |x ∪ y|, which on
+/// fingerprints is one minus the Tanimoto similarity. Two rows without any bit set are at distance 0.
+/// </summary>
+class JaccardDistance
+{
+public:
+	double computeDistance(const uint64_t* attributesOne, const uint64_t* attributesTwo, int numAttributes);
+};
@@ -8,5 +8,14 @@ double ManhattanDistance::computeDistance(std::vector<double> attributesOne, std
 		distance += fabs(attributesOne[i] - attributesTwo[i]);
 	}
 
+	return distance;
+}
+
+double ManhattanDistance::computeDistance(const double* attributesOne, const double* attributesTwo, int numAttributes) {
+	double distance = 0;
+	for (int i = 0; i < numAttributes; i++) {
+		distance += fabs(attributesOne[i] - attributesTwo[i]);
+	}
+
 	return distance;
 }
\ No newline at end of file
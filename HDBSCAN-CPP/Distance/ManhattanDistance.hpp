@@ -7,5 +7,7 @@ class ManhattanDistance : IDistanceCalculator
 {
 public:
 	double computeDistance(std::vector<double> attributesOne, std::vector<double> attributesTwo);
+
+	double computeDistance(const double* attributesOne, const double* attributesTwo, int numAttributes);
 };
 
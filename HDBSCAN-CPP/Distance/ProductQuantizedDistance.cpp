@@ -0,0 +1,24 @@
+#include"ProductQuantizedDistance.hpp"
+#include<cmath>
+
+ProductQuantizedDistance::ProductQuantizedDistance() {
+	_distanceTables = nullptr;
+	_numSubspaces = 0;
+	_numCentroids = 0;
+	_manhattan = false;
+}
+
+ProductQuantizedDistance::ProductQuantizedDistance(const productQuantizer& quantizer) {
+	_distanceTables = quantizer.getDistanceTables().data();
+	_numSubspaces = quantizer.getNumSubspaces();
+	_numCentroids = quantizer.getNumCentroids();
+	_manhattan = quantizer.isManhattan();
+}
+
+double ProductQuantizedDistance::computeDistance(const uint8_t* attributesOne, const uint8_t* attributesTwo, int numAttributes) {
+	size_t tableSize = (size_t)_numCentroids * _numCentroids;
+	double distance = 0;
+	for (int subspace = 0; subspace < _numSubspaces; subspace++)
+		distance += _distanceTables[subspace * tableSize + (size_t)attributesOne[subspace] * _numCentroids + attributesTwo[subspace]];
+	return _manhattan ? distance : sqrt(distance);
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include<cstdint>
+#include"../Dataset/productQuantizer.hpp"
+/// <summary>
+/// Computes the euclidean or manhattan distance between two rows of productQuantizer codes from the
+/// quantizer's centroid distance tables, one lookup per subspace. The quantizer must outlive the distance.
+/// </summary>
+class ProductQuantizedDistance
+{
+private:
+	const float* _distanceTables;
+	int _numSubspaces;
+	int _numCentroids;
+	bool _manhattan;
+
+public:
+	ProductQuantizedDistance();
+
+	ProductQuantizedDistance(const productQuantizer& quantizer);
+
+	double computeDistance(const uint8_t* attributesOne, const uint8_t* attributesTwo, int numAttributes);
+};
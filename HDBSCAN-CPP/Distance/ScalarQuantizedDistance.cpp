@@ -0,0 +1,29 @@
+#include"ScalarQuantizedDistance.hpp"
+#include<algorithm>
+#include<cmath>
+
+ScalarQuantizedDistance::ScalarQuantizedDistance(double scale, bool manhattan) {
+	_scale = scale;
+	_manhattan = manhattan;
+}
+
+double ScalarQuantizedDistance::computeDistance(const int8_t* attributesOne, const int8_t* attributesTwo, int numAttributes) {
+	//A block of 32768 squared differences of at most 255 each still fits in 32 bits:
+	int64_t sum = 0;
+	for (int begin = 0; begin < numAttributes; begin += 32768) {
+		int end = std::min(numAttributes, begin + 32768);
+		int32_t blockSum = 0;
+		if (_manhattan) {
+			for (int i = begin; i < end; i++)
+				blockSum += std::abs((int32_t)attributesOne[i] - (int32_t)attributesTwo[i]);
+		}
+		else {
+			for (int i = begin; i < end; i++) {
+				int32_t difference = (int32_t)attributesOne[i] - (int32_t)attributesTwo[i];
+				blockSum += difference * difference;
+			}
+		}
+		sum += blockSum;
+	}
+	return _manhattan ? _scale * sum : _scale * sqrt((double)sum);
+}
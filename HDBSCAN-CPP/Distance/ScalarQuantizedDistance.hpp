@@ -0,0 +1,17 @@
+#pragma once
+#include<cstdint>
+/// <summary>
+/// Computes the euclidean or manhattan distance between two rows of scalarQuantizer codes. The codes share
+/// one step size, so the differences are summed as integers and scaled once.
+/// </summary>
+class ScalarQuantizedDistance
+{
+private:
+	double _scale;
+	bool _manhattan;
+
+public:
+	ScalarQuantizedDistance(double scale = 1, bool manhattan = false);
+
+	double computeDistance(const int8_t* attributesOne, const int8_t* attributesTwo, int numAttributes);
+};
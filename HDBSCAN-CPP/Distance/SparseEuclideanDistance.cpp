@@ -0,0 +1,23 @@
+#include"SparseEuclideanDistance.hpp"
+#include<cmath>
+double SparseEuclideanDistance::computeDistance(const csrRow& attributesOne, const csrRow& attributesTwo, int numAttributes) {
+	double distance = 0;
+	int i = 0;
+	int j = 0;
+	while (i < attributesOne.length && j < attributesTwo.length) {
+		double difference;
+		if (attributesOne.columns[i] == attributesTwo.columns[j])
+			difference = attributesOne.values[i++] - attributesTwo.values[j++];
+		else if (attributesOne.columns[i] < attributesTwo.columns[j])
+			difference = attributesOne.values[i++];
+		else
+			difference = attributesTwo.values[j++];
+		distance += difference * difference;
+	}
+	for (; i < attributesOne.length; i++)
+		distance += attributesOne.values[i] * attributesOne.values[i];
+	for (; j < attributesTwo.length; j++)
+		distance += attributesTwo.values[j] * attributesTwo.values[j];
+
+	return sqrt(distance);
+}
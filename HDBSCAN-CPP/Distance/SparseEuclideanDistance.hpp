@@ -0,0 +1,12 @@
+#pragma once
+#include"../Dataset/datasetRows.hpp"
+/// <summary>
+/// Computes the euclidean distance between two sparse rows by merging their sorted columns, so a pair costs
+/// O(nonzeros) instead of O(columns). Over rows normalized with csrDataset::normalizeRows() this is the chord
+/// that CosineDistance::chordToDistance() turns into the cosine or angular distance.
+/// </summary>
+class SparseEuclideanDistance
+{
+public:
+	double computeDistance(const csrRow& attributesOne, const csrRow& attributesTwo, int numAttributes);
+};
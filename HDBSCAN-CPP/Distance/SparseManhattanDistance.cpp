@@ -0,0 +1,21 @@
+#include"SparseManhattanDistance.hpp"
+#include<cmath>
+double SparseManhattanDistance::computeDistance(const csrRow& attributesOne, const csrRow& attributesTwo, int numAttributes) {
+	double distance = 0;
+	int i = 0;
+	int j = 0;
+	while (i < attributesOne.length && j < attributesTwo.length) {
+		if (attributesOne.columns[i] == attributesTwo.columns[j])
+			distance += fabs(attributesOne.values[i++] - attributesTwo.values[j++]);
+		else if (attributesOne.columns[i] < attributesTwo.columns[j])
+			distance += fabs(attributesOne.values[i++]);
+		else
+			distance += fabs(attributesTwo.values[j++]);
+	}
+	for (; i < attributesOne.length; i++)
+		distance += fabs(attributesOne.values[i]);
+	for (; j < attributesTwo.length; j++)
+		distance += fabs(attributesTwo.values[j]);
+
+	return distance;
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include"../Dataset/datasetRows.hpp"
+/// <summary>
+/// Computes the manhattan distance between two sparse rows by merging their sorted columns, so a pair costs
+/// O(nonzeros) instead of O(columns).
+/// </summary>
+class SparseManhattanDistance
+{
+public:
+	double computeDistance(const csrRow& attributesOne, const csrRow& attributesTwo, int numAttributes);
+};
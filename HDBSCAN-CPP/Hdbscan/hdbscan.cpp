@@ -61,6 +61,9 @@ void Hdbscan::execute(int minPoints, int minClusterSize, string distanceMetric)
 	parameters.minPoints = minPoints;
 	parameters.minClusterSize = minClusterSize;
 	parameters.distanceFunction = distanceMetric;
+	//Let the planner pick an engine which fits in memory, and say which if asked to:
+	parameters.engine = "Auto";
+	parameters.planLog = this->planLog;
     	this->result = runner.run(parameters);
 	this->labels_ = result.labels;
 	this->outlierScores_ = result.outliersScores;
@@ -1,5 +1,6 @@
 #pragma once
 #include<string>
+#include<ostream>
 #include<vector>
 #include"../Runner/hdbscanRunner.hpp"
 #include"../Runner/hdbscanParameters.hpp"
@@ -35,12 +36,17 @@ public:
 
 	uint32_t numClusters_;
 
+	//Where execute() writes the engine the planner picked and its estimates; null (the default) writes nothing:
+	ostream* planLog;
+
 
 
 	Hdbscan(string readFileName) {
 
 		fileName = readFileName;
 
+		planLog = NULL;
+
 	}
 
 	string getFileName();
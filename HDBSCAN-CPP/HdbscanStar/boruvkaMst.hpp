@@ -0,0 +1,526 @@
+#pragma once
+#include<vector>
+#include<limits>
+#include<algorithm>
+#include<cmath>
+#include<memory>
+#include<mutex>
+#include"undirectedGraph.hpp"
+#include"../Index/ballTree.hpp"
+#include"../Index/metricTree.hpp"
+#include"../Dataset/datasetRows.hpp"
+#include"../Utils/unionFind.hpp"
+#include"../Utils/concurrentUnionFind.hpp"
+#include"../Utils/parallelFor.hpp"
+
+namespace hdbscanStar
+{
+	/// <summary>
+	/// Builds mutual reachability MSTs with Boruvka's algorithm, over a ball tree or from a kNN graph: every
+	/// round, each component finds its lightest outgoing edge and all of these edges are added at once, so
+	/// there are at most log2(n) rounds.
+	/// Mutual reachability distances tie constantly, so ties are not broken by index, which would stop the
+	/// searches from pruning at equal bounds. Chosen edges of equal weight may then close a cycle; adding them
+	/// through a union-find drops exactly those, and what remains still belongs to a minimum spanning tree.
+	/// </summary>
+	class boruvkaMst
+	{
+	private:
+		struct candidateEdge
+		{
+			double weight;
+			int vertexA;
+			int vertexB;
+		};
+
+		/// <summary>
+		/// Sorts the points by component: the points of component c are componentPoints[componentStarts[c],
+		/// componentStarts[c + 1]), and componentRoots lists the components which have points.
+		/// </summary>
+		static void groupByComponent(const std::vector<int>& pointComponents, std::vector<int>& componentStarts,
+			std::vector<int>& componentPoints, std::vector<int>& componentRoots)
+		{
+			int numPoints = pointComponents.size();
+			componentStarts.assign(numPoints + 1, 0);
+			for (int point = 0; point < numPoints; point++)
+				componentStarts[pointComponents[point] + 1]++;
+			componentRoots.clear();
+			for (int component = 0; component < numPoints; component++)
+			{
+				if (componentStarts[component + 1] != 0)
+					componentRoots.push_back(component);
+				componentStarts[component + 1] += componentStarts[component];
+			}
+			componentPoints.resize(numPoints);
+			std::vector<int> componentFill(componentStarts.begin(), componentStarts.end() - 1);
+			for (int point = 0; point < numPoints; point++)
+				componentPoints[componentFill[pointComponents[point]]++] = point;
+		}
+
+		/// <summary>
+		/// Finds the lightest mutual reachability edge from a point to any point outside its component in a
+		/// metric tree, pruning nodes like the ball tree search does and, within a leaf, points whose distance
+		/// to the leaf's center differs from the query's by at least the best weight. Components are given by
+		/// point index and nodeComponents by node.
+		/// </summary>
+		template<class TDistance, class TRows>
+		static void searchNode(metricTree<TDistance, TRows>& tree, TDistance& distance, int point, int node, double centerDistance,
+			const std::vector<double>& coreDistances, const std::vector<double>& nodeMinCoreDistances,
+			const std::vector<int>& components, const std::vector<int>& nodeComponents, candidateEdge& best)
+		{
+			int component = components[point];
+			if (nodeComponents[node] == component)
+				return;
+			const std::vector<metricTreeNode>& nodes = tree.getNodes();
+			const metricTreeNode& treeNode = nodes[node];
+			if (treeNode.left < 0)
+			{
+				const std::vector<int>& indices = tree.getIndices();
+				const std::vector<double>& centerDistances = tree.getCenterDistances();
+				const TRows& rows = tree.getRows();
+				auto attributes = rows.getRow(point);
+				for (int i = treeNode.start; i < treeNode.end; i++)
+				{
+					int other = indices[i];
+					if (std::abs(centerDistance - centerDistances[i]) >= best.weight || components[other] == component ||
+						std::max(coreDistances[point], coreDistances[other]) >= best.weight)
+						continue;
+					double weight = distance.computeDistance(attributes, rows.getRow(other), rows.getNumAttributes());
+					weight = std::max(weight, std::max(coreDistances[point], coreDistances[other]));
+					if (weight < best.weight)
+					{
+						best.weight = weight;
+						best.vertexA = point;
+						best.vertexB = other;
+					}
+				}
+				return;
+			}
+
+			double leftDistance = tree.centerDistance(distance, point, treeNode.left);
+			double rightDistance = tree.centerDistance(distance, point, treeNode.right);
+			double leftBound = std::max(std::max(coreDistances[point], nodeMinCoreDistances[treeNode.left]),
+				leftDistance - nodes[treeNode.left].radius);
+			double rightBound = std::max(std::max(coreDistances[point], nodeMinCoreDistances[treeNode.right]),
+				rightDistance - nodes[treeNode.right].radius);
+			if (leftBound <= rightBound)
+			{
+				if (leftBound < best.weight)
+					searchNode(tree, distance, point, treeNode.left, leftDistance, coreDistances, nodeMinCoreDistances, components, nodeComponents, best);
+				if (rightBound < best.weight)
+					searchNode(tree, distance, point, treeNode.right, rightDistance, coreDistances, nodeMinCoreDistances, components, nodeComponents, best);
+			}
+			else
+			{
+				if (rightBound < best.weight)
+					searchNode(tree, distance, point, treeNode.right, rightDistance, coreDistances, nodeMinCoreDistances, components, nodeComponents, best);
+				if (leftBound < best.weight)
+					searchNode(tree, distance, point, treeNode.left, leftDistance, coreDistances, nodeMinCoreDistances, components, nodeComponents, best);
+			}
+		}
+
+		template<class TDistance>
+		static void searchNode(ballTree<TDistance>& tree, TDistance& distance, int point, int node,
+			const std::vector<double>& coreDistances, const std::vector<double>& nodeMinCoreDistances,
+			const std::vector<int>& components, const std::vector<int>& nodeComponents, candidateEdge& best)
+		{
+			int component = components[point];
+			if (nodeComponents[node] == component)
+				return;
+			const std::vector<ballTreeNode>& nodes = tree.getNodes();
+			const std::vector<double>& data = tree.getData();
+			int numAttributes = tree.getNumAttributes();
+			const double* attributes = &data[(size_t)point * numAttributes];
+			const ballTreeNode& treeNode = nodes[node];
+			if (treeNode.left < 0)
+			{
+				for (int other = treeNode.start; other < treeNode.end; other++)
+				{
+					if (components[other] == component || std::max(coreDistances[point], coreDistances[other]) >= best.weight)
+						continue;
+					double weight = distance.computeDistance(attributes, &data[(size_t)other * numAttributes], numAttributes);
+					weight = std::max(weight, std::max(coreDistances[point], coreDistances[other]));
+					if (weight < best.weight)
+					{
+						best.weight = weight;
+						best.vertexA = point;
+						best.vertexB = other;
+					}
+				}
+				return;
+			}
+
+			//The mutual reachability distance to a node is bounded by both core distances and the ball:
+			double leftBound = std::max(std::max(coreDistances[point], nodeMinCoreDistances[treeNode.left]),
+				tree.pointLowerBound(distance, attributes, treeNode.left));
+			double rightBound = std::max(std::max(coreDistances[point], nodeMinCoreDistances[treeNode.right]),
+				tree.pointLowerBound(distance, attributes, treeNode.right));
+			int first = leftBound <= rightBound ? treeNode.left : treeNode.right;
+			int second = leftBound <= rightBound ? treeNode.right : treeNode.left;
+			if (std::min(leftBound, rightBound) < best.weight)
+				searchNode(tree, distance, point, first, coreDistances, nodeMinCoreDistances, components, nodeComponents, best);
+			if (std::max(leftBound, rightBound) < best.weight)
+				searchNode(tree, distance, point, second, coreDistances, nodeMinCoreDistances, components, nodeComponents, best);
+		}
+
+	public:
+		/// <summary>
+		/// Constructs the mutual reachability MST of the points of a ball tree, pruning whole nodes with the
+		/// ball bounds, the smallest core distance in the node and nodes lying inside the query's component.
+		/// </summary>
+		/// <param name="tree">A ball tree over the data set</param>
+		/// <param name="coreDistances">The core distance of each point, in the original order</param>
+		/// <param name="selfEdges">Whether to add an edge from every point to itself weighted by its core distance</param>
+		/// <param name="numThreads">The number of threads searching for edges; 0 uses all hardware threads</param>
+		/// <returns>The MST, in the same form as hdbscanAlgorithm::constructMst()</returns>
+		template<class TDistance>
+		static undirectedGraph constructMst(ballTree<TDistance>& tree, const std::vector<double>& coreDistances, bool selfEdges, int numThreads)
+		{
+			int numPoints = tree.getNumPoints();
+			const std::vector<int>& indices = tree.getIndices();
+			const std::vector<ballTreeNode>& nodes = tree.getNodes();
+			int numNodes = nodes.size();
+
+			//Work in tree order, so that nodes are contiguous ranges of points:
+			std::vector<double> treeCoreDistances(numPoints);
+			for (int i = 0; i < numPoints; i++)
+				treeCoreDistances[i] = coreDistances[indices[i]];
+			std::vector<double> nodeMinCoreDistances(numNodes);
+			for (int node = numNodes - 1; node >= 0; node--)
+			{
+				const ballTreeNode& treeNode = nodes[node];
+				if (treeNode.left < 0)
+					nodeMinCoreDistances[node] = *std::min_element(treeCoreDistances.begin() + treeNode.start, treeCoreDistances.begin() + treeNode.end);
+				else
+					nodeMinCoreDistances[node] = std::min(nodeMinCoreDistances[treeNode.left], nodeMinCoreDistances[treeNode.right]);
+			}
+
+			std::vector<int> verticesA;
+			std::vector<int> verticesB;
+			std::vector<double> edgeWeights;
+			unionFind components(numPoints);
+			std::vector<int> pointComponents(numPoints);
+			std::vector<int> nodeComponents(numNodes);
+			std::vector<candidateEdge> componentEdges(numPoints);
+			while ((int)edgeWeights.size() < numPoints - 1)
+			{
+				for (int i = 0; i < numPoints; i++)
+					pointComponents[i] = components.find(i);
+				for (int node = numNodes - 1; node >= 0; node--)
+				{
+					const ballTreeNode& treeNode = nodes[node];
+					if (treeNode.left >= 0)
+					{
+						int leftComponent = nodeComponents[treeNode.left];
+						nodeComponents[node] = leftComponent == nodeComponents[treeNode.right] ? leftComponent : -1;
+						continue;
+					}
+					nodeComponents[node] = pointComponents[treeNode.start];
+					for (int i = treeNode.start + 1; i < treeNode.end && nodeComponents[node] != -1; i++)
+					{
+						if (pointComponents[i] != nodeComponents[node])
+							nodeComponents[node] = -1;
+					}
+				}
+
+				//Group the points by component, so that each component is searched by one thread and the
+				//lightest edge found so far for the component bounds the search from its remaining points:
+				std::vector<int> componentStarts;
+				std::vector<int> componentPoints;
+				std::vector<int> componentRoots;
+				groupByComponent(pointComponents, componentStarts, componentPoints, componentRoots);
+
+				parallelFor(0, componentRoots.size(), numThreads, [&](int begin, int end) {
+					TDistance distance = tree.getDistance();
+					for (int i = begin; i < end; i++)
+					{
+						int component = componentRoots[i];
+						candidateEdge best = { std::numeric_limits<double>::infinity(), -1, -1 };
+						for (int j = componentStarts[component]; j < componentStarts[component + 1]; j++)
+						{
+							int point = componentPoints[j];
+							//Every edge from the point weighs at least its core distance:
+							if (treeCoreDistances[point] >= best.weight)
+								continue;
+							searchNode(tree, distance, point, 0, treeCoreDistances, nodeMinCoreDistances, pointComponents, nodeComponents, best);
+						}
+						componentEdges[component] = best;
+					}
+				});
+
+				int numEdges = edgeWeights.size();
+				for (int component : componentRoots)
+				{
+					const candidateEdge& edge = componentEdges[component];
+					if (edge.vertexA < 0 || components.find(edge.vertexA) == components.find(edge.vertexB))
+						continue;
+					components.join(edge.vertexA, edge.vertexB);
+					verticesA.push_back(indices[edge.vertexA]);
+					verticesB.push_back(indices[edge.vertexB]);
+					edgeWeights.push_back(edge.weight);
+				}
+				if ((int)edgeWeights.size() == numEdges)
+					break;
+			}
+
+			if (selfEdges)
+			{
+				for (int vertex = 0; vertex < numPoints; vertex++)
+				{
+					verticesA.push_back(vertex);
+					verticesB.push_back(vertex);
+					edgeWeights.push_back(coreDistances[vertex]);
+				}
+			}
+			return undirectedGraph(numPoints, verticesA, verticesB, edgeWeights);
+		}
+
+		/// <summary>
+		/// Constructs the mutual reachability MST from a k-nearest-neighbor graph with Boruvka's algorithm. The
+		/// graph edges are taken in both directions. A component's lightest graph edge is only used when no edge
+		/// outside the graph can be lighter, which holds when it weighs at most the smallest
+		/// max(core distance, k-th neighbor distance) over the component's points: a point missing from p's list
+		/// is no nearer than p's k-th neighbor. Components without such an edge wait, and when no component has
+		/// one, every component without one finds its lightest edge in a metric tree over all points, searching
+		/// only from points whose bound is below the best edge found so far. The graph has no edges between
+		/// well-separated clusters, so this happens about log2(clusters) times rather than once per cluster.
+		/// Joins go through a lock-free union-find, so each round is parallel from the edge search to the merge.
+		///
+		/// The result always spans the data, but it is only the exact MST when the neighbor lists are exact. With
+		/// approximate lists (NN-Descent) a point missing from a list can be nearer than its k-th neighbor, so an
+		/// edge certified by the bound, or a search skipped by it, can leave the tree heavier than the exact MST.
+		/// </summary>
+		/// <param name="rows">The points, viewed as denseRows or another row view of datasetRows.hpp</param>
+		/// <param name="numPoints">The number of points</param>
+		/// <param name="distance">The distance the graph was built with</param>
+		/// <param name="neighbors">numNeighbors neighbors per point, nearest first, without the point itself</param>
+		/// <param name="neighborDistances">The distances matching neighbors</param>
+		/// <param name="numNeighbors">The number of neighbors per point</param>
+		/// <param name="coreDistances">The core distance of each point</param>
+		/// <param name="selfEdges">Whether to add an edge from every point to itself weighted by its core distance</param>
+		/// <param name="numThreads">The number of threads; 0 uses all hardware threads</param>
+		/// <param name="numBoundEdges">If not null, receives the number of MST edges certified by the neighbor lists' bound</param>
+		/// <returns>The MST, in the same form as hdbscanAlgorithm::constructMst()</returns>
+		template<class TDistance, class TRows>
+		static undirectedGraph constructMst(const TRows& rows, int numPoints, const TDistance& distance,
+			const std::vector<int>& neighbors, const std::vector<double>& neighborDistances, int numNeighbors,
+			const std::vector<double>& coreDistances, bool selfEdges, int numThreads, int* numBoundEdges = NULL)
+		{
+			//Adjacency lists holding every graph edge in both directions, weighted by mutual reachability:
+			std::vector<int> adjacencyStarts(numPoints + 1, 0);
+			for (int point = 0; point < numPoints; point++)
+			{
+				for (int i = 0; i < numNeighbors; i++)
+				{
+					int neighbor = neighbors[(size_t)point * numNeighbors + i];
+					if (neighbor < 0)
+						continue;
+					adjacencyStarts[point + 1]++;
+					adjacencyStarts[neighbor + 1]++;
+				}
+			}
+			for (int point = 0; point < numPoints; point++)
+				adjacencyStarts[point + 1] += adjacencyStarts[point];
+			std::vector<int> adjacency(adjacencyStarts[numPoints]);
+			std::vector<double> adjacencyWeights(adjacencyStarts[numPoints]);
+			std::vector<int> adjacencyFill(adjacencyStarts.begin(), adjacencyStarts.end() - 1);
+			std::vector<double> outsideBounds(numPoints);
+			for (int point = 0; point < numPoints; point++)
+			{
+				double kthDistance = 0;
+				for (int i = 0; i < numNeighbors; i++)
+				{
+					int neighbor = neighbors[(size_t)point * numNeighbors + i];
+					if (neighbor < 0)
+						continue;
+					kthDistance = neighborDistances[(size_t)point * numNeighbors + i];
+					double weight = std::max(kthDistance, std::max(coreDistances[point], coreDistances[neighbor]));
+					adjacency[adjacencyFill[point]] = neighbor;
+					adjacencyWeights[adjacencyFill[point]++] = weight;
+					adjacency[adjacencyFill[neighbor]] = point;
+					adjacencyWeights[adjacencyFill[neighbor]++] = weight;
+				}
+				//A list that is not full holds every other point, so nothing lies outside it:
+				bool fullList = numNeighbors > 0 && neighbors[(size_t)point * numNeighbors + numNeighbors - 1] >= 0;
+				outsideBounds[point] = fullList ? std::max(coreDistances[point], kthDistance) : std::numeric_limits<double>::infinity();
+			}
+
+			std::vector<int> verticesA;
+			std::vector<int> verticesB;
+			std::vector<double> edgeWeights;
+			if (numBoundEdges != NULL)
+				*numBoundEdges = 0;
+			concurrentUnionFind components(numPoints);
+			std::vector<int> pointComponents(numPoints);
+			std::vector<candidateEdge> pointEdges(numPoints);
+			std::vector<candidateEdge> componentEdges(numPoints);
+			std::vector<char> certified(numPoints);
+			std::vector<char> accepted(numPoints);
+			std::vector<int> componentStarts;
+			std::vector<int> componentPoints;
+			std::vector<int> componentRoots;
+			std::unique_ptr<metricTree<TDistance, TRows>> tree;
+			std::vector<double> nodeMinCoreDistances;
+			std::vector<int> nodeComponents;
+			while ((int)edgeWeights.size() < numPoints - 1)
+			{
+				parallelFor(0, numPoints, numThreads, [&](int begin, int end) {
+					for (int point = begin; point < end; point++)
+						pointComponents[point] = components.find(point);
+				});
+				parallelFor(0, numPoints, numThreads, [&](int begin, int end) {
+					for (int point = begin; point < end; point++)
+					{
+						candidateEdge best = { std::numeric_limits<double>::infinity(), -1, -1 };
+						for (int i = adjacencyStarts[point]; i < adjacencyStarts[point + 1]; i++)
+						{
+							if (adjacencyWeights[i] < best.weight && pointComponents[adjacency[i]] != pointComponents[point])
+							{
+								best.weight = adjacencyWeights[i];
+								best.vertexA = point;
+								best.vertexB = adjacency[i];
+							}
+						}
+						pointEdges[point] = best;
+					}
+				});
+				groupByComponent(pointComponents, componentStarts, componentPoints, componentRoots);
+
+				//Certify and join each component's lightest graph edge:
+				parallelFor(0, componentRoots.size(), numThreads, [&](int begin, int end) {
+					for (int i = begin; i < end; i++)
+					{
+						int component = componentRoots[i];
+						candidateEdge best = { std::numeric_limits<double>::infinity(), -1, -1 };
+						double outsideBound = std::numeric_limits<double>::infinity();
+						for (int j = componentStarts[component]; j < componentStarts[component + 1]; j++)
+						{
+							int point = componentPoints[j];
+							if (pointEdges[point].weight < best.weight)
+								best = pointEdges[point];
+							outsideBound = std::min(outsideBound, outsideBounds[point]);
+						}
+						componentEdges[component] = best;
+						certified[component] = best.vertexA >= 0 && best.weight <= outsideBound;
+						accepted[component] = certified[component] && components.join(best.vertexA, best.vertexB);
+					}
+				});
+
+				int numEdges = edgeWeights.size();
+				std::vector<int> uncertifiedRoots;
+				for (int component : componentRoots)
+				{
+					if (accepted[component])
+					{
+						const candidateEdge& edge = componentEdges[component];
+						verticesA.push_back(edge.vertexA);
+						verticesB.push_back(edge.vertexB);
+						edgeWeights.push_back(edge.weight);
+					}
+					else if (!certified[component])
+						uncertifiedRoots.push_back(component);
+				}
+				if (numBoundEdges != NULL)
+					*numBoundEdges += edgeWeights.size() - numEdges;
+				if ((int)edgeWeights.size() != numEdges || uncertifiedRoots.size() == 0)
+					continue;
+
+				//No graph edge could be certified, so every uncertified component searches outside the graph, in
+				//a metric tree built the first time this happens:
+				if (!tree)
+				{
+					tree.reset(new metricTree<TDistance, TRows>(rows, numPoints, 16, numThreads, distance));
+					const std::vector<metricTreeNode>& nodes = tree->getNodes();
+					const std::vector<int>& indices = tree->getIndices();
+					nodeMinCoreDistances.resize(nodes.size());
+					nodeComponents.resize(nodes.size());
+					for (int node = nodes.size() - 1; node >= 0; node--)
+					{
+						const metricTreeNode& treeNode = nodes[node];
+						if (treeNode.left >= 0)
+						{
+							nodeMinCoreDistances[node] = std::min(nodeMinCoreDistances[treeNode.left], nodeMinCoreDistances[treeNode.right]);
+							continue;
+						}
+						nodeMinCoreDistances[node] = std::numeric_limits<double>::infinity();
+						for (int i = treeNode.start; i < treeNode.end; i++)
+							nodeMinCoreDistances[node] = std::min(nodeMinCoreDistances[node], coreDistances[indices[i]]);
+					}
+				}
+				const std::vector<metricTreeNode>& nodes = tree->getNodes();
+				const std::vector<int>& indices = tree->getIndices();
+				for (int node = nodes.size() - 1; node >= 0; node--)
+				{
+					const metricTreeNode& treeNode = nodes[node];
+					if (treeNode.left >= 0)
+					{
+						int leftComponent = nodeComponents[treeNode.left];
+						nodeComponents[node] = leftComponent == nodeComponents[treeNode.right] ? leftComponent : -1;
+						continue;
+					}
+					nodeComponents[node] = pointComponents[indices[treeNode.start]];
+					for (int i = treeNode.start + 1; i < treeNode.end && nodeComponents[node] != -1; i++)
+					{
+						if (pointComponents[indices[i]] != nodeComponents[node])
+							nodeComponents[node] = -1;
+					}
+				}
+
+				//A point's lightest edge out of its component is its lightest graph edge or weighs at least its
+				//outside bound, so only points whose bound is below the best edge so far are searched. The points
+				//are split over the threads regardless of their components, since the last components are few
+				//and large; each thread merges its best edge into its component's when it moves on to the next:
+				std::vector<int> searchPoints;
+				for (int component : uncertifiedRoots)
+					searchPoints.insert(searchPoints.end(), componentPoints.begin() + componentStarts[component], componentPoints.begin() + componentStarts[component + 1]);
+				std::mutex edgeMutex;
+				parallelFor(0, searchPoints.size(), numThreads, [&](int begin, int end) {
+					TDistance searchDistance = tree->getDistance();
+					int component = -1;
+					candidateEdge best = { std::numeric_limits<double>::infinity(), -1, -1 };
+					for (int j = begin; j <= end; j++)
+					{
+						if (j == end || pointComponents[searchPoints[j]] != component)
+						{
+							std::lock_guard<std::mutex> lock(edgeMutex);
+							if (component >= 0 && best.weight < componentEdges[component].weight)
+								componentEdges[component] = best;
+							if (j == end)
+								break;
+							component = pointComponents[searchPoints[j]];
+							best = componentEdges[component];
+						}
+						int point = searchPoints[j];
+						if (outsideBounds[point] >= best.weight)
+							continue;
+						searchNode(*tree, searchDistance, point, 0, tree->centerDistance(searchDistance, point, 0), coreDistances,
+							nodeMinCoreDistances, pointComponents, nodeComponents, best);
+					}
+				});
+				for (int component : uncertifiedRoots)
+				{
+					const candidateEdge& edge = componentEdges[component];
+					if (edge.vertexA < 0 || !components.join(edge.vertexA, edge.vertexB))
+						continue;
+					verticesA.push_back(edge.vertexA);
+					verticesB.push_back(edge.vertexB);
+					edgeWeights.push_back(edge.weight);
+				}
+				if ((int)edgeWeights.size() == numEdges)
+					break;
+			}
+
+			if (selfEdges)
+			{
+				for (int vertex = 0; vertex < numPoints; vertex++)
+				{
+					verticesA.push_back(vertex);
+					verticesB.push_back(vertex);
+					edgeWeights.push_back(coreDistances[vertex]);
+				}
+			}
+			return undirectedGraph(numPoints, verticesA, verticesB, edgeWeights);
+		}
+	};
+}
+
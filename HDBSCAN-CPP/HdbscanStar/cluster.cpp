@@ -7,7 +7,7 @@ cluster::cluster()
 	_id = ++counter;
 }
 
-cluster::cluster(int label, cluster* parent, double birthLevel, int numPoints) //:Label(label), Parent(parent), _birthLevel(birthLevel), _numPoints(numPoints)
+cluster::cluster(int label, cluster* parent, double birthLevel, double numPoints) //:Label(label), Parent(parent), _birthLevel(birthLevel), _numPoints(numPoints)
 {
 	_id = ++counter;
 	_deathLevel = 0;
@@ -20,6 +20,7 @@ cluster::cluster(int label, cluster* parent, double birthLevel, int numPoints) /
 	Label = label;
 	_birthLevel = birthLevel;
 	_numPoints = numPoints;
+	_numPointsTolerance = numPoints * 1e-9;
 	HierarchyPosition = 0;
 	Stability = 0;
 	PropagatedLowestChildDeathLevel = std::numeric_limits<double>::max();
@@ -32,15 +33,19 @@ cluster::cluster(int label, cluster* parent, double birthLevel, int numPoints) /
 bool cluster ::operator==(const cluster& other) const {
 	return (this->_id == other._id);
 }
-void cluster::detachPoints(int numPoints, double level)
+void cluster::detachPoints(double numPoints, double level)
 {
 	_numPoints -= numPoints;
 	Stability += (numPoints * (1 / level - 1 / _birthLevel));
 
-	if (_numPoints == 0)
-		_deathLevel = level;
-	else if (_numPoints < 0)
+	//Point counts are sums of point weights, which may be fractional and leave rounding residue:
+	if (_numPoints < -_numPointsTolerance)
 		throw std::invalid_argument("Cluster cannot have less than 0 points.");
+	else if (_numPoints <= _numPointsTolerance)
+	{
+		_numPoints = 0;
+		_deathLevel = level;
+	}
 }
 
 void cluster::propagate()
@@ -87,17 +92,20 @@ void cluster::propagate()
 		}
 	}
 }
-void cluster::addPointsToVirtualChildCluster(std::set<int> points)
+void cluster::addPointsToVirtualChildCluster(const std::set<int>& points)
 {
-	for (std::set<int>::iterator it = points.begin(); it != points.end(); ++it) {
-		_virtualChildCluster.insert(*it);
-	}
+	_virtualChildCluster.insert(points.begin(), points.end());
 }
 bool cluster::virtualChildClusterConstraintsPoint(int point)
 {
 	return (_virtualChildCluster.find(point) != _virtualChildCluster.end());
 }
 
+const std::set<int>& cluster::getVirtualChildCluster() const
+{
+	return _virtualChildCluster;
+}
+
 void cluster::addVirtualChildConstraintsSatisfied(int numConstraints)
 {
 	_propagatedNumConstraintsSatisfied += numConstraints;
@@ -10,7 +10,8 @@ private:
 	int _id;
 	double _birthLevel;
 	double _deathLevel;
-	int _numPoints;
+	double _numPoints;
+	double _numPointsTolerance;
 	double _propagatedStability;
 	int _numConstraintsSatisfied;
 	int _propagatedNumConstraintsSatisfied;
@@ -28,14 +29,19 @@ public:
 
 	cluster();
 
-	cluster(int label, cluster *parent, double birthLevel, int numPoints);
+	cluster(int label, cluster *parent, double birthLevel, double numPoints);
 	bool operator==(const cluster& other) const;
-	void detachPoints(int numPoints, double level);
+	void detachPoints(double numPoints, double level);
 	void propagate();
-	void addPointsToVirtualChildCluster(std::set<int> points);
+	void addPointsToVirtualChildCluster(const std::set<int>& points);
 	
 	bool virtualChildClusterConstraintsPoint(int point);
 
+	/// <summary>
+	/// The points that became noise in this cluster since the virtual child cluster was last released.
+	/// </summary>
+	const std::set<int>& getVirtualChildCluster() const;
+
 	void addVirtualChildConstraintsSatisfied(int numConstraints);
 	
 
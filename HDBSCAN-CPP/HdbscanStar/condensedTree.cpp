@@ -0,0 +1,327 @@
+#include "condensedTree.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+condensedTree::condensedTree() {
+	numPoints = 0;
+	numClusters = 0;
+}
+
+condensedTree::condensedTree(singleLinkageTree& tree, int minClusterSize) {
+	numPoints = tree.numPoints;
+	numClusters = numPoints > 0 ? 1 : 0;
+	std::vector<int> rowParents;
+	std::vector<int> rowChildren;
+	std::vector<double> rowLambdas;
+	std::vector<int> rowChildSizes;
+	if (numPoints <= 1)
+	{
+		for (int point = 0; point < numPoints; point++)
+		{
+			rowParents.push_back(numPoints);
+			rowChildren.push_back(point);
+			rowLambdas.push_back(0);
+			rowChildSizes.push_back(1);
+		}
+		parent = rowParents;
+		child = rowChildren;
+		lambda = rowLambdas;
+		childSize = rowChildSizes;
+		return;
+	}
+	//A single point is never a cluster on its own:
+	if (minClusterSize < 2)
+		minClusterSize = 2;
+
+	int root = tree.getRoot();
+	std::vector<int> relabel(root + 1, -1);
+	std::vector<int> queue;
+	std::vector<int> components;
+	std::vector<int> subtreeStack;
+	relabel[root] = numPoints;
+	int nextLabel = numPoints + 1;
+
+	queue.push_back(root);
+	for (size_t queueIndex = 0; queueIndex < queue.size(); queueIndex++)
+	{
+		int node = queue[queueIndex];
+		double distance = tree.distance[node - numPoints];
+		double level = distance > 0 ? 1 / distance : std::numeric_limits<double>::infinity();
+
+		//Every merge at the same distance is undone at once, as the hierarchy removes all edges of equal
+		//weight together, so the cluster splits into the components below the merges of that distance:
+		components.clear();
+		subtreeStack.push_back(tree.left[node - numPoints]);
+		subtreeStack.push_back(tree.right[node - numPoints]);
+		while (subtreeStack.size())
+		{
+			int subNode = subtreeStack.back();
+			subtreeStack.pop_back();
+			if (subNode >= numPoints && tree.distance[subNode - numPoints] == distance)
+			{
+				subtreeStack.push_back(tree.left[subNode - numPoints]);
+				subtreeStack.push_back(tree.right[subNode - numPoints]);
+			}
+			else
+				components.push_back(subNode);
+		}
+		int numChildClusters = 0;
+		for (int component : components)
+		{
+			if (component >= numPoints && tree.getNodeSize(component) >= minClusterSize)
+				numChildClusters++;
+		}
+
+		for (int component : components)
+		{
+			if (component >= numPoints && tree.getNodeSize(component) >= minClusterSize)
+			{
+				if (numChildClusters >= 2)
+				{
+					//A true split, the component becomes a new cluster:
+					relabel[component] = nextLabel++;
+					rowParents.push_back(relabel[node]);
+					rowChildren.push_back(relabel[component]);
+					rowLambdas.push_back(level);
+					rowChildSizes.push_back(tree.getNodeSize(component));
+				}
+				else
+				{
+					//The other components are too small, so this one carries on as the parent cluster:
+					relabel[component] = relabel[node];
+				}
+				queue.push_back(component);
+				continue;
+			}
+			//Every point of this component falls out of the parent cluster at this level:
+			subtreeStack.push_back(component);
+			while (subtreeStack.size())
+			{
+				int subNode = subtreeStack.back();
+				subtreeStack.pop_back();
+				if (subNode < numPoints)
+				{
+					rowParents.push_back(relabel[node]);
+					rowChildren.push_back(subNode);
+					rowLambdas.push_back(level);
+					rowChildSizes.push_back(1);
+				}
+				else
+				{
+					subtreeStack.push_back(tree.left[subNode - numPoints]);
+					subtreeStack.push_back(tree.right[subNode - numPoints]);
+				}
+			}
+		}
+	}
+	numClusters = nextLabel - numPoints;
+	parent = rowParents;
+	child = rowChildren;
+	lambda = rowLambdas;
+	childSize = rowChildSizes;
+}
+
+condensedTree::condensedTree(int numPoints, int numClusters, sharedArray<int> parent, sharedArray<int> child, sharedArray<double> lambda, sharedArray<int> childSize) {
+	this->numPoints = numPoints;
+	this->numClusters = numClusters;
+	this->parent = parent;
+	this->child = child;
+	this->lambda = lambda;
+	this->childSize = childSize;
+}
+
+std::vector<int> condensedTree::getClusterParents() {
+	std::vector<int> clusterParents(numClusters, -1);
+	for (size_t row = 0; row < child.size(); row++)
+	{
+		if (child[row] >= numPoints)
+			clusterParents[child[row] - numPoints] = parent[row];
+	}
+	return clusterParents;
+}
+
+std::vector<double> condensedTree::getBirthLambdas() {
+	std::vector<double> birthLambdas(numClusters, 0);
+	for (size_t row = 0; row < child.size(); row++)
+	{
+		if (child[row] >= numPoints)
+			birthLambdas[child[row] - numPoints] = lambda[row];
+	}
+	return birthLambdas;
+}
+
+std::vector<double> condensedTree::getMaxLambdas() {
+	std::vector<double> maxLambdas(numClusters, 0);
+	for (size_t row = 0; row < child.size(); row++)
+	{
+		int cluster = parent[row] - numPoints;
+		if (child[row] < numPoints && lambda[row] > maxLambdas[cluster])
+			maxLambdas[cluster] = lambda[row];
+	}
+	//Children are numbered after their parents, so a reverse sweep visits every child before its parent:
+	std::vector<int> clusterParents = getClusterParents();
+	for (int cluster = numClusters - 1; cluster > 0; cluster--)
+	{
+		int parentCluster = clusterParents[cluster] - numPoints;
+		if (maxLambdas[cluster] > maxLambdas[parentCluster])
+			maxLambdas[parentCluster] = maxLambdas[cluster];
+	}
+	return maxLambdas;
+}
+
+std::vector<double> condensedTree::calculateStabilities() {
+	std::vector<double> birthLambdas = getBirthLambdas();
+	std::vector<double> stabilities(numClusters, 0);
+	for (size_t row = 0; row < child.size(); row++)
+	{
+		int cluster = parent[row] - numPoints;
+		if (lambda[row] != birthLambdas[cluster])
+			stabilities[cluster] += (lambda[row] - birthLambdas[cluster]) * childSize[row];
+	}
+	return stabilities;
+}
+
+std::vector<int> condensedTree::selectClusters(hdbscanClusterSelectionMethod method, double clusterSelectionEpsilon, bool& infiniteStability) {
+	std::vector<int> clusterParents = getClusterParents();
+	std::vector<double> stabilities = calculateStabilities();
+	std::vector<bool> hasChildren(numClusters, false);
+	std::vector<bool> choosesItself(numClusters, false);
+	std::vector<double> childrenStabilities(numClusters, 0);
+	infiniteStability = false;
+
+	for (int cluster = 1; cluster < numClusters; cluster++)
+		hasChildren[clusterParents[cluster] - numPoints] = true;
+
+	//Bottom-up: decide whether each cluster beats the best selection among its descendants:
+	for (int cluster = numClusters - 1; cluster > 0; cluster--)
+	{
+		if (stabilities[cluster] == std::numeric_limits<double>::infinity())
+			infiniteStability = true;
+
+		double selectedStability = stabilities[cluster];
+		if (method == leaf)
+		{
+			choosesItself[cluster] = !hasChildren[cluster];
+		}
+		else if (hasChildren[cluster] && childrenStabilities[cluster] > stabilities[cluster])
+		{
+			choosesItself[cluster] = false;
+			selectedStability = childrenStabilities[cluster];
+		}
+		else
+		{
+			choosesItself[cluster] = true;
+		}
+		childrenStabilities[clusterParents[cluster] - numPoints] += selectedStability;
+	}
+
+	std::vector<bool> selected(numClusters, false);
+	std::vector<bool> covered(numClusters, false);
+	for (int cluster = 1; cluster < numClusters; cluster++)
+	{
+		int parentCluster = clusterParents[cluster] - numPoints;
+		covered[cluster] = covered[parentCluster] || selected[parentCluster];
+		selected[cluster] = !covered[cluster] && choosesItself[cluster];
+	}
+
+	if (clusterSelectionEpsilon > 0)
+	{
+		//Replace clusters born below epsilon by their closest ancestor born at or above it:
+		std::vector<double> birthLambdas = getBirthLambdas();
+		std::vector<bool> merged(numClusters, false);
+		for (int cluster = 1; cluster < numClusters; cluster++)
+		{
+			if (!selected[cluster])
+				continue;
+			int current = cluster;
+			while (clusterParents[current] != numPoints && 1 / birthLambdas[current] < clusterSelectionEpsilon)
+				current = clusterParents[current] - numPoints;
+			merged[current] = true;
+		}
+		for (int cluster = 1; cluster < numClusters; cluster++)
+		{
+			int parentCluster = clusterParents[cluster] - numPoints;
+			covered[cluster] = parentCluster > 0 && (covered[parentCluster] || merged[parentCluster]);
+			selected[cluster] = !covered[cluster] && merged[cluster];
+		}
+	}
+
+	std::vector<int> selectedClusters;
+	for (int cluster = 1; cluster < numClusters; cluster++)
+	{
+		if (selected[cluster])
+			selectedClusters.push_back(numPoints + cluster);
+	}
+	return selectedClusters;
+}
+
+std::vector<int> condensedTree::getSelectedAncestors(const std::vector<int>& selectedClusters) {
+	std::vector<int> clusterParents = getClusterParents();
+	std::vector<int> selectedAncestors(numClusters, -1);
+	std::vector<bool> selected(numClusters, false);
+	for (int cluster : selectedClusters)
+		selected[cluster - numPoints] = true;
+
+	for (int cluster = 0; cluster < numClusters; cluster++)
+	{
+		if (selected[cluster])
+			selectedAncestors[cluster] = numPoints + cluster;
+		else if (cluster > 0)
+			selectedAncestors[cluster] = selectedAncestors[clusterParents[cluster] - numPoints];
+	}
+	return selectedAncestors;
+}
+
+std::vector<int> condensedTree::labelPoints(const std::vector<int>& selectedClusters) {
+	std::vector<int> selectedAncestors = getSelectedAncestors(selectedClusters);
+	std::vector<int> labels(numPoints, 0);
+	for (size_t row = 0; row < child.size(); row++)
+	{
+		if (child[row] >= numPoints)
+			continue;
+		int selectedCluster = selectedAncestors[parent[row] - numPoints];
+		if (selectedCluster >= 0)
+			labels[child[row]] = selectedCluster - numPoints + 1;
+	}
+	return labels;
+}
+
+std::vector<double> condensedTree::calculateMembershipProbabilities(const std::vector<int>& selectedClusters) {
+	std::vector<int> selectedAncestors = getSelectedAncestors(selectedClusters);
+	std::vector<double> maxLambdas = getMaxLambdas();
+	std::vector<double> probabilities(numPoints, 0);
+	for (size_t row = 0; row < child.size(); row++)
+	{
+		if (child[row] >= numPoints)
+			continue;
+		int selectedCluster = selectedAncestors[parent[row] - numPoints];
+		if (selectedCluster < 0)
+			continue;
+		double maxLambda = maxLambdas[selectedCluster - numPoints];
+		double pointLambda = std::min(lambda[row], maxLambda);
+		if (maxLambda == 0 || !std::isfinite(pointLambda))
+			probabilities[child[row]] = 1;
+		else
+			probabilities[child[row]] = pointLambda / maxLambda;
+	}
+	return probabilities;
+}
+
+std::vector<double> condensedTree::calculateOutlierScores() {
+	std::vector<double> maxLambdas = getMaxLambdas();
+	std::vector<double> scores(numPoints, 0);
+	for (size_t row = 0; row < child.size(); row++)
+	{
+		if (child[row] >= numPoints)
+			continue;
+		double maxLambda = maxLambdas[parent[row] - numPoints];
+		if (maxLambda == 0 || !std::isfinite(lambda[row]))
+			continue;
+		if (std::isfinite(maxLambda))
+			scores[child[row]] = (maxLambda - lambda[row]) / maxLambda;
+		else
+			scores[child[row]] = 1;
+	}
+	return scores;
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include<vector>
+#include"singleLinkageTree.hpp"
+enum hdbscanClusterSelectionMethod{excessOfMass, leaf};
+/// <summary>
+/// The condensed cluster tree derived from a single linkage tree for a given minimum cluster size.
+/// Each row records a child (a point if it is below numPoints, a cluster otherwise) leaving its parent
+/// cluster at level lambda = 1 / distance. Clusters are numbered from numPoints, which is the root, and
+/// every cluster has a larger number than its parent.
+/// </summary>
+class condensedTree
+{
+public:
+	int numPoints;
+	int numClusters;
+	sharedArray<int> parent;
+	sharedArray<int> child;
+	sharedArray<double> lambda;
+	sharedArray<int> childSize;
+
+	condensedTree();
+
+	/// <summary>
+	/// Condenses a single linkage tree in a single top-down pass, so the cost is linear in the number of
+	/// points. Merges at the same distance are undone together, as one split into every component below
+	/// them, which is how the hierarchy of hdbscanRunner::run() removes edges of equal weight. Components
+	/// with fewer than minClusterSize points are treated as those points falling out of the parent cluster
+	/// rather than as new clusters, and the parent carries on when only one component is large enough.
+	/// </summary>
+	/// <param name="tree">The single linkage tree of the mutual reachability MST</param>
+	/// <param name="minClusterSize">The minimum number of points which a cluster needs to be a valid cluster</param>
+	condensedTree(singleLinkageTree& tree, int minClusterSize);
+
+	/// <summary>
+	/// Wraps existing condensed tree arrays, for example ones viewed from a model file.
+	/// </summary>
+	condensedTree(int numPoints, int numClusters, sharedArray<int> parent, sharedArray<int> child, sharedArray<double> lambda, sharedArray<int> childSize);
+
+	/// <summary>
+	/// Returns the parent cluster of every cluster, indexed by cluster number - numPoints (-1 for the root).
+	/// </summary>
+	std::vector<int> getClusterParents();
+
+	/// <summary>
+	/// Returns the lambda at which every cluster was born, indexed by cluster number - numPoints.
+	/// </summary>
+	std::vector<double> getBirthLambdas();
+
+	/// <summary>
+	/// Returns the largest lambda at which any point leaves each cluster or one of its descendants,
+	/// indexed by cluster number - numPoints.
+	/// </summary>
+	std::vector<double> getMaxLambdas();
+
+	/// <summary>
+	/// Returns the excess of mass stability of every cluster, indexed by cluster number - numPoints.
+	/// </summary>
+	std::vector<double> calculateStabilities();
+
+	/// <summary>
+	/// Selects the flat clustering, either by excess of mass or by taking the leaves of the cluster tree.
+	/// With a positive clusterSelectionEpsilon, selected clusters born below that distance are replaced by
+	/// their closest ancestor born at or above it. The root is never selected.
+	/// </summary>
+	/// <param name="method">excessOfMass or leaf</param>
+	/// <param name="clusterSelectionEpsilon">A distance threshold below which clusters are not split</param>
+	/// <param name="infiniteStability">Set to true if any cluster has infinite stability</param>
+	/// <returns>The numbers of the selected clusters, in ascending order</returns>
+	std::vector<int> selectClusters(hdbscanClusterSelectionMethod method, double clusterSelectionEpsilon, bool& infiniteStability);
+
+	/// <summary>
+	/// Returns, for every cluster, the selected cluster it belongs to (itself or an ancestor), or -1.
+	/// Indexed by cluster number - numPoints.
+	/// </summary>
+	std::vector<int> getSelectedAncestors(const std::vector<int>& selectedClusters);
+
+	/// <summary>
+	/// Labels every point with the selected cluster it belongs to. Cluster number c gets the label
+	/// c - numPoints + 1 (so the root would be 1, as in computeHierarchyAndClusterTree()) and noise gets 0.
+	/// </summary>
+	std::vector<int> labelPoints(const std::vector<int>& selectedClusters);
+
+	/// <summary>
+	/// Calculates each point's membership probability: the lambda at which it leaves its selected cluster
+	/// relative to the largest lambda in that cluster. Noise points get 0.
+	/// </summary>
+	std::vector<double> calculateMembershipProbabilities(const std::vector<int>& selectedClusters);
+
+	/// <summary>
+	/// Calculates the GLOSH outlier score of every point, indexed by point.
+	/// </summary>
+	std::vector<double> calculateOutlierScores();
+};
+
@@ -0,0 +1,151 @@
+#pragma once
+#include<vector>
+#include<algorithm>
+#include<cmath>
+#include<limits>
+#include<mutex>
+#include<utility>
+#include"undirectedGraph.hpp"
+#include"kruskalMst.hpp"
+#include"../Distance/EuclideanDistance.hpp"
+#include"../Index/uniformGrid.hpp"
+#include"../Index/delaunayTriangulation.hpp"
+#include"../Utils/parallelFor.hpp"
+
+namespace hdbscanStar
+{
+	/// <summary>
+	/// Builds exact Euclidean mutual reachability MSTs of 2D and 3D points from O(n) candidate edges instead of
+	/// searching the whole space. The Euclidean MST lies in the Delaunay triangulation, but core distances can
+	/// make an edge the lightest way across even when a sparse point between its ends blocks it from the
+	/// triangulation. An MST edge (p, q) is either within the core distance of one of its ends, or lighter
+	/// than any detour through a third point r, so no point r with core distance at most max(core(p), core(q))
+	/// lies in the ball with diameter pq: (p, q) is then a Delaunay edge of the points with the smallest core
+	/// distances, up to the later of p and q. The candidates are therefore
+	///  - every pair within the core distance of one of its ends, found with a uniform grid, and
+	///  - every edge a point gets when it is inserted into a Delaunay triangulation in ascending core distance order,
+	/// and filter-Kruskal over them reweighted by mutual reachability gives the MST. Exact duplicates share their
+	/// core distance, so they are inserted once and chained to their first occurrence.
+	/// </summary>
+	class delaunayMst
+	{
+	public:
+		/// <summary>
+		/// Computes the core distances and builds an MST in the form of hdbscanAlgorithm::constructMst().
+		/// </summary>
+		/// <param name="dataset">The points as contiguous rows of dimensions attributes</param>
+		/// <param name="numPoints">The number of points</param>
+		/// <param name="minPoints">The number of points, counting itself, within a point's core distance</param>
+		/// <param name="coreDistances">Receives the core distance of each point</param>
+		/// <param name="selfEdges">Whether to add an edge from every point to itself weighted by its core distance</param>
+		/// <param name="numThreads">The number of threads for the core distances, below 1 for the hardware concurrency</param>
+		template<int dimensions>
+		static undirectedGraph constructMst(const double* dataset, int numPoints, int minPoints, std::vector<double>& coreDistances, bool selfEdges, int numThreads)
+		{
+			//Duplicates sort next to each other; the first occurrence of each point represents it:
+			std::vector<int> order(numPoints);
+			for (int i = 0; i < numPoints; i++)
+				order[i] = i;
+			std::sort(order.begin(), order.end(), [dataset](int first, int second) {
+				const double* a = dataset + (size_t)first * dimensions;
+				const double* b = dataset + (size_t)second * dimensions;
+				for (int attribute = 0; attribute < dimensions; attribute++)
+				{
+					if (a[attribute] != b[attribute])
+						return a[attribute] < b[attribute];
+				}
+				return first < second;
+			});
+			std::vector<int> representatives(numPoints);
+			for (int i = 0; i < numPoints; i++)
+			{
+				bool duplicate = i > 0 && std::equal(dataset + (size_t)order[i] * dimensions, dataset + (size_t)order[i] * dimensions + dimensions,
+					dataset + (size_t)order[i - 1] * dimensions);
+				representatives[order[i]] = duplicate ? representatives[order[i - 1]] : order[i];
+			}
+
+			//Core distances and the pairs within them, gathered per chunk and concatenated in chunk order. The
+			//cells of the grid over the bounding box fill up inside clusters, so the neighbors are searched in a
+			//finer grid fitted to the crowding the points see first, and in the coarse grid where that is too
+			//sparse. Points are queried in the fine grid's cell order:
+			uniformGrid grid(dataset, numPoints, dimensions);
+			double crowding = std::max(2.0, minPoints / 2.0);
+			double fineCellSize = grid.getCellSize() * std::pow(crowding / std::max(grid.getCrowding(), crowding), 1.0 / dimensions);
+			uniformGrid fineGrid(dataset, fineCellSize < grid.getCellSize() ? numPoints : 0, dimensions, fineCellSize);
+			const std::vector<int>& queryOrder = fineGrid.getNumPoints() ? fineGrid.getCellPoints() : grid.getCellPoints();
+			coreDistances.assign(numPoints, 0);
+			std::vector<std::pair<int, std::vector<weightedEdge>>> chunkEdges;
+			std::mutex chunkMutex;
+			parallelFor(0, numPoints, numThreads, [&](int begin, int end) {
+				std::vector<weightedEdge> edges;
+				std::vector<std::pair<double, int>> neighbors;
+				for (int i = begin; i < end; i++)
+				{
+					int point = queryOrder[i];
+					if (representatives[point] != point || minPoints <= 1)
+						continue;
+					const double* attributes = dataset + (size_t)point * dimensions;
+					coreDistances[point] = fineGrid.queryNeighborhood(attributes, minPoints, neighbors, 2);
+					if (neighbors.size() == 0)
+						coreDistances[point] = grid.queryNeighborhood(attributes, minPoints, neighbors);
+					for (const std::pair<double, int>& neighbor : neighbors)
+					{
+						if (representatives[neighbor.second] == neighbor.second && neighbor.second != point)
+							edges.push_back({ neighbor.first, point, neighbor.second });
+					}
+				}
+				std::lock_guard<std::mutex> lock(chunkMutex);
+				chunkEdges.push_back(std::make_pair(begin, std::move(edges)));
+			});
+			std::sort(chunkEdges.begin(), chunkEdges.end(),
+				[](const std::pair<int, std::vector<weightedEdge>>& first, const std::pair<int, std::vector<weightedEdge>>& second) {
+					return first.first < second.first;
+				});
+
+			//A pair within both core distances was found from both ends; the lower index keeps it:
+			std::vector<weightedEdge> edges;
+			for (std::pair<int, std::vector<weightedEdge>>& chunk : chunkEdges)
+			{
+				for (const weightedEdge& edge : chunk.second)
+				{
+					if (edge.vertexB > edge.vertexA || edge.weight > coreDistances[edge.vertexB])
+						edges.push_back(edge);
+				}
+				std::vector<weightedEdge>().swap(chunk.second);
+			}
+			for (int point = 0; point < numPoints; point++)
+			{
+				if (representatives[point] != point)
+				{
+					coreDistances[point] = coreDistances[representatives[point]];
+					edges.push_back({ 0, representatives[point], point });
+				}
+			}
+
+			//Insert the representatives by ascending core distance:
+			std::vector<int> insertionOrder;
+			for (int point = 0; point < numPoints; point++)
+			{
+				if (representatives[point] == point)
+					insertionOrder.push_back(point);
+			}
+			std::sort(insertionOrder.begin(), insertionOrder.end(), [&coreDistances](int first, int second) {
+				return coreDistances[first] != coreDistances[second] ? coreDistances[first] < coreDistances[second] : first < second;
+			});
+			delaunayTriangulation<dimensions> triangulation(dataset, numPoints);
+			std::vector<int> adjacentVertices;
+			EuclideanDistance distance;
+			for (int point : insertionOrder)
+			{
+				const double* attributes = dataset + (size_t)point * dimensions;
+				triangulation.insert(point, adjacentVertices);
+				for (int other : adjacentVertices)
+					edges.push_back({ distance.computeDistance(attributes, dataset + (size_t)other * dimensions, dimensions), point, other });
+			}
+
+			for (weightedEdge& edge : edges)
+				edge.weight = std::max(edge.weight, std::max(coreDistances[edge.vertexA], coreDistances[edge.vertexB]));
+			return kruskalMst::constructMst(numPoints, edges, coreDistances, selfEdges);
+		}
+	};
+}
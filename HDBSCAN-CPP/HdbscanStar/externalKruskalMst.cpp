@@ -0,0 +1,220 @@
+#include "externalKruskalMst.hpp"
+#include<algorithm>
+#include<atomic>
+#include<cstdio>
+#include<fstream>
+#include<functional>
+#include<memory>
+#include<queue>
+#include<stdexcept>
+#include<string>
+#if !defined(_WIN32)
+#include<unistd.h>
+#endif
+
+using namespace hdbscanStar;
+
+//Runs are read and written in blocks of at least this many edges (64 KiB):
+static const size_t minBlockEdges = 4096;
+
+//No merge pass opens more runs than this at once, to stay well below the open file limit:
+static const size_t maxOpenRuns = 256;
+
+//Filter-Kruskal drops most edges of runs with this many edges per vertex unsorted; sparser runs are sorted whole:
+static const size_t filterEdgesPerVertex = 3;
+
+static std::atomic<int> nextFileId(0);
+
+//The union-find, and a forest of as many edges as it can hold:
+static size_t getFixedBytes(int numVertices) {
+	return (size_t)numVertices * 2 * sizeof(int) + (size_t)std::max(numVertices - 1, 0) * sizeof(weightedEdge);
+}
+
+externalKruskalMst::externalKruskalMst(int numVertices, std::string workDirectory, size_t memoryBudget) {
+	if (memoryBudget < getMinMemoryBudget(numVertices))
+		throw std::invalid_argument("A memory budget of " + std::to_string(memoryBudget) + " bytes is below the " +
+			std::to_string(getMinMemoryBudget(numVertices)) + " bytes an external MST of " + std::to_string(numVertices) + " vertices needs.");
+	_numVertices = numVertices;
+	_workDirectory = workDirectory;
+	_fileId = nextFileId++;
+	_bufferCapacity = (memoryBudget - getFixedBytes(numVertices)) / sizeof(weightedEdge);
+	_numRunFiles = 0;
+}
+
+externalKruskalMst::~externalKruskalMst() {
+	//Runs are removed once merged, so only an interrupted constructMst() leaves any:
+	for (int run = 0; run < _numRunFiles; run++)
+		std::remove(getRunFileName(run).c_str());
+}
+
+size_t externalKruskalMst::getMinMemoryBudget(int numVertices) {
+	return getFixedBytes(numVertices) + 3 * minBlockEdges * sizeof(weightedEdge);
+}
+
+std::string externalKruskalMst::getRunFileName(int run) {
+	std::string fileName = _workDirectory + "/kruskal-";
+#if !defined(_WIN32)
+	fileName += std::to_string(getpid()) + "-";
+#endif
+	return fileName + std::to_string(_fileId) + "-" + std::to_string(run) + ".edges";
+}
+
+void externalKruskalMst::writeRun(const std::vector<weightedEdge>& edges, std::string fileName) {
+	std::ofstream file(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+	file.write((const char*)edges.data(), edges.size() * sizeof(weightedEdge));
+	if (!file)
+		throw std::runtime_error("Cannot write " + fileName + ".");
+}
+
+void externalKruskalMst::addEdge(int vertexA, int vertexB, double weight) {
+	if (vertexA < 0 || vertexA >= _numVertices || vertexB < 0 || vertexB >= _numVertices)
+		throw std::invalid_argument("An edge of an external MST has a vertex out of range.");
+	if (vertexA == vertexB)
+		return;
+	if (_buffer.capacity() == 0)
+		_buffer.reserve(_bufferCapacity);
+	_buffer.push_back({ weight, vertexA, vertexB });
+	if (_buffer.size() == _bufferCapacity)
+		flushBuffer();
+}
+
+/// <summary>
+/// Writes the minimum spanning forest of the buffered edges as a run; the other edges each close a cycle
+/// among lighter edges of the run, so they cannot be MST edges.
+/// </summary>
+void externalKruskalMst::flushBuffer() {
+	if (_buffer.empty())
+		return;
+	unionFind components(_numVertices);
+	_forest.clear();
+	_forest.reserve(std::max(_numVertices - 1, 0));
+	if (_buffer.size() >= filterEdgesPerVertex * _numVertices)
+		kruskalMst::constructForest(_buffer, components, _forest);
+	else {
+		std::sort(_buffer.begin(), _buffer.end(), [](const weightedEdge& edgeOne, const weightedEdge& edgeTwo) {
+			return edgeOne.weight < edgeTwo.weight;
+		});
+		for (const weightedEdge& edge : _buffer) {
+			if (components.find(edge.vertexA) == components.find(edge.vertexB))
+				continue;
+			components.join(edge.vertexA, edge.vertexB);
+			_forest.push_back(edge);
+		}
+	}
+	_buffer.clear();
+	std::string fileName = getRunFileName(_numRunFiles++);
+	writeRun(_forest, fileName);
+	_runFileNames.push_back(fileName);
+}
+
+/// <summary>
+/// Merges sorted runs by weight into Kruskal's algorithm, keeping the edges which join two components of
+/// components. They go to forest, or to a new run when forest is null. The runs are removed.
+/// </summary>
+void externalKruskalMst::mergeRuns(const std::vector<std::string>& fileNames, unionFind& components, std::vector<weightedEdge>* forest, std::string outputFileName) {
+	int numRuns = fileNames.size();
+	size_t blockEdges = _bufferCapacity / (numRuns + 1);
+	std::vector<std::unique_ptr<std::ifstream>> files(numRuns);
+	std::vector<std::vector<weightedEdge>> blocks(numRuns);
+	std::vector<size_t> positions(numRuns, 0);
+	std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int>>, std::greater<std::pair<double, int>>> heads;
+
+	std::function<bool(int)> readBlock = [&](int run) {
+		blocks[run].resize(blockEdges);
+		files[run]->read((char*)blocks[run].data(), blockEdges * sizeof(weightedEdge));
+		if (files[run]->bad())
+			throw std::runtime_error("Cannot read " + fileNames[run] + ".");
+		blocks[run].resize(files[run]->gcount() / sizeof(weightedEdge));
+		positions[run] = 0;
+		return !blocks[run].empty();
+	};
+	for (int run = 0; run < numRuns; run++) {
+		files[run].reset(new std::ifstream(fileNames[run], std::ios::in | std::ios::binary));
+		if (!*files[run])
+			throw std::runtime_error("Cannot open " + fileNames[run] + ".");
+		if (readBlock(run))
+			heads.push(std::make_pair(blocks[run][0].weight, run));
+	}
+
+	std::ofstream output;
+	std::vector<weightedEdge> outputBlock;
+	if (forest == NULL) {
+		output.open(outputFileName, std::ios::out | std::ios::binary | std::ios::trunc);
+		outputBlock.reserve(blockEdges);
+	}
+	int numJoined = 0;
+	while (!heads.empty() && numJoined < _numVertices - 1) {
+		int run = heads.top().second;
+		heads.pop();
+		weightedEdge edge = blocks[run][positions[run]++];
+		if (positions[run] < blocks[run].size() || readBlock(run))
+			heads.push(std::make_pair(blocks[run][positions[run]].weight, run));
+
+		if (components.find(edge.vertexA) == components.find(edge.vertexB))
+			continue;
+		components.join(edge.vertexA, edge.vertexB);
+		numJoined++;
+		if (forest != NULL)
+			forest->push_back(edge);
+		else {
+			outputBlock.push_back(edge);
+			if (outputBlock.size() == blockEdges) {
+				output.write((const char*)outputBlock.data(), outputBlock.size() * sizeof(weightedEdge));
+				outputBlock.clear();
+			}
+		}
+	}
+	if (forest == NULL) {
+		output.write((const char*)outputBlock.data(), outputBlock.size() * sizeof(weightedEdge));
+		output.close();
+		if (!output)
+			throw std::runtime_error("Cannot write " + outputFileName + ".");
+	}
+	for (int run = 0; run < numRuns; run++) {
+		files[run].reset();
+		std::remove(fileNames[run].c_str());
+	}
+}
+
+undirectedGraph externalKruskalMst::constructMst(const std::vector<double>& coreDistances, bool selfEdges) {
+	if (!_runFileNames.empty()) {
+		flushBuffer();
+		std::vector<weightedEdge>().swap(_buffer);
+		std::vector<weightedEdge>().swap(_forest);
+
+		//Merge groups of runs into single runs until the rest can be merged at once:
+		size_t maxMergedRuns = std::min(maxOpenRuns, _bufferCapacity / minBlockEdges - 1);
+		while (_runFileNames.size() > maxMergedRuns) {
+			std::vector<std::string> mergedFileNames;
+			for (size_t begin = 0; begin < _runFileNames.size(); begin += maxMergedRuns) {
+				size_t end = std::min(begin + maxMergedRuns, _runFileNames.size());
+				if (end - begin == 1) {
+					mergedFileNames.push_back(_runFileNames[begin]);
+					continue;
+				}
+				unionFind components(_numVertices);
+				std::string fileName = getRunFileName(_numRunFiles++);
+				mergeRuns(std::vector<std::string>(_runFileNames.begin() + begin, _runFileNames.begin() + end), components, NULL, fileName);
+				mergedFileNames.push_back(fileName);
+			}
+			_runFileNames = mergedFileNames;
+		}
+	}
+
+	unionFind components(_numVertices);
+	_forest.clear();
+	_forest.reserve(std::max(_numVertices - 1, 0));
+	if (_runFileNames.empty())
+		kruskalMst::constructForest(_buffer, components, _forest);
+	else
+		mergeRuns(_runFileNames, components, &_forest, "");
+	_runFileNames.clear();
+	std::vector<weightedEdge>().swap(_buffer);
+	undirectedGraph mst = kruskalMst::joinForest(_numVertices, _forest, components, coreDistances, selfEdges);
+	std::vector<weightedEdge>().swap(_forest);
+	return mst;
+}
+
+int externalKruskalMst::getNumRunFiles() {
+	return _numRunFiles;
+}
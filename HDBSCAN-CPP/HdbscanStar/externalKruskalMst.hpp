@@ -0,0 +1,74 @@
+#pragma once
+#include<cstddef>
+#include<string>
+#include<vector>
+#include"kruskalMst.hpp"
+#include"undirectedGraph.hpp"
+#include"../Utils/unionFind.hpp"
+
+namespace hdbscanStar
+{
+	/// <summary>
+	/// Builds an MST from a stream of candidate edges which need not fit in memory. Edges are collected in a
+	/// buffer, and whenever it is full its minimum spanning forest is written to disk as a run sorted by weight;
+	/// every MST edge is in the forest of the run holding it, so a run never has more than numVertices - 1 edges
+	/// however many edges it was built from. The runs are then k-way merged by weight into Kruskal's algorithm,
+	/// in several passes when there are too many to read at once. The buffer, the read blocks of the merge, the
+	/// union-find and the forest all fit in the memory budget; the returned MST is built after they are freed.
+	/// </summary>
+	class externalKruskalMst
+	{
+	private:
+		int _numVertices;
+		std::string _workDirectory;
+		int _fileId;
+		size_t _bufferCapacity;
+		std::vector<weightedEdge> _buffer;
+		std::vector<weightedEdge> _forest;
+		std::vector<std::string> _runFileNames;
+		int _numRunFiles;
+
+		externalKruskalMst(const externalKruskalMst&);
+		externalKruskalMst& operator=(const externalKruskalMst&);
+
+		std::string getRunFileName(int run);
+		void writeRun(const std::vector<weightedEdge>& edges, std::string fileName);
+		void flushBuffer();
+		void mergeRuns(const std::vector<std::string>& fileNames, unionFind& components, std::vector<weightedEdge>* forest, std::string outputFileName);
+
+	public:
+		/// <summary>
+		/// Prepares an empty edge stream.
+		/// </summary>
+		/// <param name="numVertices">The number of vertices</param>
+		/// <param name="workDirectory">An existing directory for the run files, which are removed as soon as they are merged</param>
+		/// <param name="memoryBudget">The bytes the edges, the union-find and the forest may take, at least getMinMemoryBudget(numVertices)</param>
+		externalKruskalMst(int numVertices, std::string workDirectory, size_t memoryBudget);
+
+		~externalKruskalMst();
+
+		/// <summary>
+		/// Returns the smallest memory budget for the number of vertices: the union-find, a forest and room to
+		/// merge two runs.
+		/// </summary>
+		static size_t getMinMemoryBudget(int numVertices);
+
+		/// <summary>
+		/// Adds a candidate edge, weighted by mutual reachability. Edges from a vertex to itself are ignored.
+		/// </summary>
+		void addEdge(int vertexA, int vertexB, double weight);
+
+		/// <summary>
+		/// Builds an MST in the form of hdbscanAlgorithm::constructMst() from the edges added, joining the
+		/// components they leave as kruskalMst::constructMst() does. The stream is empty afterwards.
+		/// </summary>
+		/// <param name="coreDistances">The core distance of each vertex</param>
+		/// <param name="selfEdges">Whether to add an edge from every vertex to itself weighted by its core distance</param>
+		undirectedGraph constructMst(const std::vector<double>& coreDistances, bool selfEdges);
+
+		/// <summary>
+		/// The number of runs written to disk so far, including those of merge passes.
+		/// </summary>
+		int getNumRunFiles();
+	};
+}
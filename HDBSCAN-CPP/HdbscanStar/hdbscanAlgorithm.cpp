@@ -11,9 +11,12 @@
 #include"cluster.hpp"
 #include"hdbscanConstraint.hpp"
 #include"hdbscanAlgorithm.hpp"
+#include"../Utils/parallelFor.hpp"
+#include<mutex>
+#include<tuple>
 
 
-std::vector<double> hdbscanStar::hdbscanAlgorithm::calculateCoreDistances(std::vector<std::vector<double>> distances, int k)
+std::vector<double> hdbscanStar::hdbscanAlgorithm::calculateCoreDistances(const std::vector<std::vector<double>>& distances, int k)
 {
 	int length = distances.size();
 
@@ -61,7 +64,135 @@ std::vector<double> hdbscanStar::hdbscanAlgorithm::calculateCoreDistances(std::v
 	}
 	return coreDistances;
 }
-undirectedGraph hdbscanStar::hdbscanAlgorithm::constructMst(std::vector<std::vector<double>> distances, std::vector<double> coreDistances, bool selfEdges)
+std::vector<double> hdbscanStar::hdbscanAlgorithm::calculateCoreDistances(const std::vector<std::vector<double>>& distances, int k, const std::vector<double>& pointWeights)
+{
+	int length = distances.size();
+	std::vector<double> coreDistances(length, 0);
+	std::vector<std::pair<double, double>> neighbors;
+	for (int point = 0; point < length; point++)
+	{
+		//The point's own copies are at distance 0:
+		double neighborhoodWeight = pointWeights[point];
+		if (neighborhoodWeight >= k)
+			continue;
+
+		neighbors.clear();
+		for (int neighbor = 0; neighbor < length; neighbor++)
+		{
+			if (point != neighbor)
+				neighbors.push_back(std::make_pair(distances[point][neighbor], pointWeights[neighbor]));
+		}
+		//Points weigh at least 1 unless the caller gave fractional weights, so the k - 1 nearest neighbors
+		//usually suffice and the rest is only sorted when they do not:
+		size_t numSorted = std::min(neighbors.size(), (size_t)std::max(k - 1, 1));
+		std::partial_sort(neighbors.begin(), neighbors.begin() + numSorted, neighbors.end());
+		coreDistances[point] = std::numeric_limits<double>::max();
+		for (size_t i = 0; i < neighbors.size(); i++)
+		{
+			if (i == numSorted)
+			{
+				std::sort(neighbors.begin() + numSorted, neighbors.end());
+				numSorted = neighbors.size();
+			}
+			neighborhoodWeight += neighbors[i].second;
+			if (neighborhoodWeight >= k)
+			{
+				coreDistances[point] = neighbors[i].first;
+				break;
+			}
+		}
+	}
+	return coreDistances;
+}
+
+std::vector<double> hdbscanStar::hdbscanAlgorithm::calculateCoreDistances(sparseDistanceGraph& graph, int k)
+{
+	int numVertices = graph.getNumVertices();
+	const std::vector<int>& verticesA = graph.getVerticesA();
+	const std::vector<int>& verticesB = graph.getVerticesB();
+	const std::vector<double>& distances = graph.getDistances();
+	std::vector<double> coreDistances(numVertices, 0);
+	if (k <= 1)
+		return coreDistances;
+
+	//Gather the distances of the edges incident to each vertex:
+	std::vector<int> incidentStarts(numVertices + 1, 0);
+	for (size_t edge = 0; edge < distances.size(); edge++)
+	{
+		if (verticesA[edge] == verticesB[edge])
+			continue;
+		incidentStarts[verticesA[edge] + 1]++;
+		incidentStarts[verticesB[edge] + 1]++;
+	}
+	for (int vertex = 0; vertex < numVertices; vertex++)
+		incidentStarts[vertex + 1] += incidentStarts[vertex];
+	std::vector<double> incidentDistances(incidentStarts[numVertices]);
+	std::vector<int> incidentFill(incidentStarts.begin(), incidentStarts.end() - 1);
+	for (size_t edge = 0; edge < distances.size(); edge++)
+	{
+		if (verticesA[edge] == verticesB[edge])
+			continue;
+		incidentDistances[incidentFill[verticesA[edge]]++] = distances[edge];
+		incidentDistances[incidentFill[verticesB[edge]]++] = distances[edge];
+	}
+
+	int numNeighbors = k - 1;
+	for (int vertex = 0; vertex < numVertices; vertex++)
+	{
+		std::vector<double>::iterator begin = incidentDistances.begin() + incidentStarts[vertex];
+		std::vector<double>::iterator end = incidentDistances.begin() + incidentStarts[vertex + 1];
+		if (end - begin < numNeighbors)
+		{
+			coreDistances[vertex] = std::numeric_limits<double>::max();
+			continue;
+		}
+		std::nth_element(begin, begin + numNeighbors - 1, end);
+		coreDistances[vertex] = begin[numNeighbors - 1];
+	}
+	return coreDistances;
+}
+
+std::vector<std::vector<double>> hdbscanStar::hdbscanAlgorithm::calculateNearestNeighborDistances(const std::vector<std::vector<double>>& distances, int k)
+{
+	int length = distances.size();
+	int numNeighbors = std::max(0, std::min(k - 1, length - 1));
+	std::vector<std::vector<double>> nearestNeighborDistances(length);
+	std::vector<double> rowDistances;
+	for (int point = 0; point < length; point++)
+	{
+		rowDistances.clear();
+		for (int neighbor = 0; neighbor < length; neighbor++)
+		{
+			if (point != neighbor)
+				rowDistances.push_back(distances[point][neighbor]);
+		}
+		std::partial_sort(rowDistances.begin(), rowDistances.begin() + numNeighbors, rowDistances.end());
+		nearestNeighborDistances[point].assign(rowDistances.begin(), rowDistances.begin() + numNeighbors);
+	}
+	return nearestNeighborDistances;
+}
+
+std::vector<double> hdbscanStar::hdbscanAlgorithm::calculateCoreDistancesFromNeighbors(const std::vector<std::vector<double>>& nearestNeighborDistances, int k)
+{
+	int length = nearestNeighborDistances.size();
+	int numNeighbors = k - 1;
+	std::vector<double> coreDistances(length, 0);
+	if (k <= 1)
+		return coreDistances;
+
+	for (int point = 0; point < length; point++)
+	{
+		const std::vector<double>& kNNDistances = nearestNeighborDistances[point];
+		//Fewer neighbors than requested behaves like calculateCoreDistances(), which leaves the slot unfilled:
+		if (numNeighbors <= (int)kNNDistances.size())
+			coreDistances[point] = kNNDistances[numNeighbors - 1];
+		else
+			coreDistances[point] = std::numeric_limits<double>::max();
+	}
+	return coreDistances;
+}
+
+undirectedGraph hdbscanStar::hdbscanAlgorithm::constructMst(const std::vector<std::vector<double>>& distances, const std::vector<double>& coreDistances, bool selfEdges)
 {
 	int length = distances.size();
 	int selfEdgeCapacity = 0;
@@ -139,6 +270,14 @@ undirectedGraph hdbscanStar::hdbscanAlgorithm::constructMst(std::vector<std::vec
 
 void hdbscanStar::hdbscanAlgorithm::computeHierarchyAndClusterTree(undirectedGraph* mst, int minClusterSize, std::vector<hdbscanConstraint> constraints, std::vector<std::vector<int>>& hierarchy, std::vector<double>& pointNoiseLevels, std::vector<int>& pointLastClusters, std::vector<cluster*>& clusters)
 {
+	computeHierarchyAndClusterTree(mst, minClusterSize, constraints, hierarchy, pointNoiseLevels, pointLastClusters, clusters, std::vector<double>());
+}
+
+void hdbscanStar::hdbscanAlgorithm::computeHierarchyAndClusterTree(undirectedGraph* mst, int minClusterSize, std::vector<hdbscanConstraint> constraints, std::vector<std::vector<int>>& hierarchy, std::vector<double>& pointNoiseLevels, std::vector<int>& pointLastClusters, std::vector<cluster*>& clusters, const std::vector<double>& pointWeights)
+{
+	bool weighted = pointWeights.size() != 0;
+	auto pointWeight = [&](int point) { return weighted ? pointWeights[point] : 1.0; };
+
 	int hierarchyPosition = 0;
 
 	//The current edge being removed from the MST:
@@ -158,15 +297,34 @@ void hdbscanStar::hdbscanAlgorithm::computeHierarchyAndClusterTree(undirectedGra
 	//std::vector<cluster *> clusters;
 	clusters.push_back(NULL);
 	//cluster cluster_object(1, NULL, std::numeric_limits<double>::quiet_NaN(),  mst->getNumVertices());
-	clusters.push_back(new cluster(1, NULL, std::numeric_limits<double>::quiet_NaN(), mst->getNumVertices()));
+	double totalWeight = mst->getNumVertices();
+	if (weighted)
+	{
+		totalWeight = 0;
+		for (double weight : pointWeights)
+			totalWeight += weight;
+	}
+	clusters.push_back(new cluster(1, NULL, std::numeric_limits<double>::quiet_NaN(), totalWeight));
 
+	//Constraints are looked up by point, and noise points are only tracked for them:
+	bool constrained = constraints.size() != 0;
+	hdbscanConstraintIndex constraintIndex(constraints, constrained ? mst->getNumVertices() : 0);
+	std::vector<int> newClusterPoints;
+	if (constrained)
+	{
+		for (int point = 0; point < mst->getNumVertices(); point++)
+			newClusterPoints.push_back(point);
+	}
 	std::set<int> clusterOne;
 	clusterOne.insert(1);
 	calculateNumConstraintsSatisfied(
 		clusterOne,
 		clusters,
 		constraints,
-		currentClusterLabels);
+		currentClusterLabels,
+		newClusterPoints,
+		constraintIndex);
+	newClusterPoints.clear();
 	std::set<int> affectedClusterLabels;
 	std::set<int> affectedVertices;
 	while (currentEdgeIndex >= 0)
@@ -218,18 +376,21 @@ void hdbscanStar::hdbscanAlgorithm::computeHierarchyAndClusterTree(undirectedGra
 				}
 			}
 			std::set<int> firstChildCluster;
+			double firstChildClusterWeight = 0;
 			std::list<int> unexploredFirstChildClusterPoints;
 			int numChildClusters = 0;
 			while (examinedVertices.size())
 			{
 
 				std::set<int> constructingSubCluster;
+				double constructingSubClusterWeight = 0;
 				int iters = 0;
 				std::list<int> unexploredSubClusterPoints;
 				bool anyEdges = false;
 				bool incrementedChildCount = false;
 				int rootVertex = *prev(examinedVertices.end());
 				constructingSubCluster.insert(rootVertex);
+				constructingSubClusterWeight += pointWeight(rootVertex);
 				unexploredSubClusterPoints.push_back(rootVertex);
 				examinedVertices.erase(prev(examinedVertices.end()));
 				while (unexploredSubClusterPoints.size())
@@ -244,6 +405,7 @@ void hdbscanStar::hdbscanAlgorithm::computeHierarchyAndClusterTree(undirectedGra
 						if (std::find(constructingSubCluster.begin(), constructingSubCluster.end(), neighbor) == constructingSubCluster.end())
 						{
 							constructingSubCluster.insert(neighbor);
+							constructingSubClusterWeight += pointWeight(neighbor);
 							unexploredSubClusterPoints.push_back(neighbor);
 							if (std::find(examinedVertices.begin(), examinedVertices.end(), neighbor) != examinedVertices.end())
 								examinedVertices.erase(std::find(examinedVertices.begin(), examinedVertices.end(), neighbor));
@@ -253,7 +415,7 @@ void hdbscanStar::hdbscanAlgorithm::computeHierarchyAndClusterTree(undirectedGra
 							++it;
 						}
 					}
-					if (!incrementedChildCount && constructingSubCluster.size() >= minClusterSize && anyEdges)
+					if (!incrementedChildCount && constructingSubClusterWeight >= minClusterSize && anyEdges)
 					{
 						incrementedChildCount = true;
 						numChildClusters++;
@@ -262,6 +424,7 @@ void hdbscanStar::hdbscanAlgorithm::computeHierarchyAndClusterTree(undirectedGra
 						if (firstChildCluster.size() == 0)
 						{
 							firstChildCluster = constructingSubCluster;
+							firstChildClusterWeight = constructingSubClusterWeight;
 							unexploredFirstChildClusterPoints = unexploredSubClusterPoints;
 							break;
 						}
@@ -269,7 +432,7 @@ void hdbscanStar::hdbscanAlgorithm::computeHierarchyAndClusterTree(undirectedGra
 
 				}
 				//If there could be a split, and this child cluster is valid:
-				if (numChildClusters >= 2 && constructingSubCluster.size() >= minClusterSize && anyEdges)
+				if (numChildClusters >= 2 && constructingSubClusterWeight >= minClusterSize && anyEdges)
 				{
 					//Check this child cluster is not equal to the unexplored first child cluster:
 					int firstChildClusterMember = *prev(firstChildCluster.end());
@@ -279,16 +442,18 @@ void hdbscanStar::hdbscanAlgorithm::computeHierarchyAndClusterTree(undirectedGra
 					else
 					{
 						cluster* newCluster = createNewCluster(constructingSubCluster, currentClusterLabels,
-							clusters[examinedClusterLabel], nextClusterLabel, currentEdgeWeight);
+							clusters[examinedClusterLabel], nextClusterLabel, currentEdgeWeight, constructingSubClusterWeight, constrained);
+						if (constrained)
+							newClusterPoints.insert(newClusterPoints.end(), constructingSubCluster.begin(), constructingSubCluster.end());
 						newClusters.push_back(newCluster);
 						clusters.push_back(newCluster);
 						nextClusterLabel++;
 					}
 				}
-				else if (constructingSubCluster.size() < minClusterSize || !anyEdges)
+				else if (constructingSubClusterWeight < minClusterSize || !anyEdges)
 				{
 					createNewCluster(constructingSubCluster, currentClusterLabels,
-						clusters[examinedClusterLabel], 0, currentEdgeWeight);
+						clusters[examinedClusterLabel], 0, currentEdgeWeight, constructingSubClusterWeight, constrained);
 
 					for (std::set<int>::iterator it = constructingSubCluster.begin(); it != constructingSubCluster.end(); it++)
 					{
@@ -310,12 +475,15 @@ void hdbscanStar::hdbscanAlgorithm::computeHierarchyAndClusterTree(undirectedGra
 						if (std::find(firstChildCluster.begin(), firstChildCluster.end(), neighbor) == firstChildCluster.end())
 						{
 							firstChildCluster.insert(neighbor);
+							firstChildClusterWeight += pointWeight(neighbor);
 							unexploredFirstChildClusterPoints.push_back(neighbor);
 						}
 					}
 				}
 				cluster* newCluster = createNewCluster(firstChildCluster, currentClusterLabels,
-					clusters[examinedClusterLabel], nextClusterLabel, currentEdgeWeight);
+					clusters[examinedClusterLabel], nextClusterLabel, currentEdgeWeight, firstChildClusterWeight, constrained);
+				if (constrained)
+					newClusterPoints.insert(newClusterPoints.end(), firstChildCluster.begin(), firstChildCluster.end());
 				newClusters.push_back(newCluster);
 				clusters.push_back(newCluster);
 				nextClusterLabel++;
@@ -337,7 +505,8 @@ void hdbscanStar::hdbscanAlgorithm::computeHierarchyAndClusterTree(undirectedGra
 			newClusterLabels.insert(newCluster->Label);
 		}
 		if (newClusterLabels.size())
-			calculateNumConstraintsSatisfied(newClusterLabels, clusters, constraints, currentClusterLabels);
+			calculateNumConstraintsSatisfied(newClusterLabels, clusters, constraints, currentClusterLabels, newClusterPoints, constraintIndex);
+		newClusterPoints.clear();
 
 		for (int i = 0; i < previousClusterLabels.size(); i++)
 		{
@@ -507,8 +676,26 @@ std::vector<outlierScore> hdbscanStar::hdbscanAlgorithm::calculateOutlierScores(
 	std::vector<int>& pointLastClusters,
 	std::vector<double> coreDistances)
 {
-	int numPoints = pointNoiseLevels.size();
+	std::vector<double> scores = calculateOutlierScoreValues(clusters, pointNoiseLevels, pointLastClusters);
+	int numPoints = scores.size();
 	std::vector<outlierScore> outlierScores;
+	outlierScores.reserve(numPoints);
+	for (int i = 0; i < numPoints; i++)
+		outlierScores.push_back(outlierScore(scores[i], coreDistances[i], i));
+
+	//Sort the outlier scores:
+	sort(outlierScores.begin(), outlierScores.end());
+
+	return outlierScores;
+}
+
+std::vector<double> hdbscanStar::hdbscanAlgorithm::calculateOutlierScoreValues(
+	std::vector<cluster*>& clusters,
+	std::vector<double>& pointNoiseLevels,
+	std::vector<int>& pointLastClusters)
+{
+	int numPoints = pointNoiseLevels.size();
+	std::vector<double> scores(numPoints);
 
 	//Iterate through each point, calculating its outlier score:
 	for (int i = 0; i < numPoints; i++)
@@ -520,11 +707,67 @@ std::vector<outlierScore> hdbscanStar::hdbscanAlgorithm::calculateOutlierScores(
 		if (epsilon != 0)
 			score = 1 - (epsilonMax / epsilon);
 
-		outlierScores.push_back(outlierScore(score, coreDistances[i], i));
+		scores[i] = score;
 	}
-	//Sort the outlier scores:
-	sort(outlierScores.begin(), outlierScores.end());
+	return scores;
+}
+
+std::vector<outlierScore> hdbscanStar::hdbscanAlgorithm::selectOutlierScores(
+	const std::vector<double>& scores,
+	const std::vector<double>& coreDistances,
+	const outlierScoreSelection& selection,
+	int numThreads)
+{
+	int numPoints = scores.size();
+	//The order of outlierScore, on point indices:
+	auto isLower = [&](int first, int second) {
+		return std::tie(scores[first], coreDistances[first], first) < std::tie(scores[second], coreDistances[second], second);
+	};
+	std::vector<int> selected;
+	if (selection.output == sortedScores)
+	{
+		selected.resize(numPoints);
+		for (int i = 0; i < numPoints; i++)
+			selected[i] = i;
+	}
+	else if (selection.output == topScores)
+	{
+		//Every chunk keeps its own numTop highest, and the highest of those are the numTop highest overall:
+		int numTop = std::max(0, std::min(selection.numTop, numPoints));
+		std::mutex selectedMutex;
+		parallelFor(0, numPoints, numThreads, [&](int begin, int end) {
+			std::vector<int> candidates;
+			for (int i = begin; i < end; i++)
+				candidates.push_back(i);
+			if ((int)candidates.size() > numTop)
+			{
+				std::nth_element(candidates.begin(), candidates.end() - numTop, candidates.end(), isLower);
+				candidates.erase(candidates.begin(), candidates.end() - numTop);
+			}
+			std::lock_guard<std::mutex> lock(selectedMutex);
+			selected.insert(selected.end(), candidates.begin(), candidates.end());
+		});
+		std::nth_element(selected.begin(), selected.end() - numTop, selected.end(), isLower);
+		selected.erase(selected.begin(), selected.end() - numTop);
+	}
+	else if (selection.output == quantileScores && numPoints != 0)
+	{
+		std::vector<double> scoreOrder(scores);
+		size_t rank = (size_t)std::max(0.0, std::min(1.0, selection.quantile) * (numPoints - 1));
+		std::nth_element(scoreOrder.begin(), scoreOrder.begin() + rank, scoreOrder.end());
+		double threshold = scoreOrder[rank];
+		for (int i = 0; i < numPoints; i++)
+		{
+			if (scores[i] >= threshold)
+				selected.push_back(i);
+		}
+	}
+	std::sort(selected.begin(), selected.end(), isLower);
 
+	std::vector<outlierScore> outlierScores;
+	outlierScores.reserve(selected.size());
+	for (int point : selected)
+		outlierScores.push_back(outlierScore(scores[point], coreDistances[point], point));
 	return outlierScores;
 }
 
@@ -544,6 +787,18 @@ cluster* hdbscanStar::hdbscanAlgorithm::createNewCluster(
 	cluster* parentCluster,
 	int clusterLabel,
 	double edgeWeight)
+{
+	return createNewCluster(points, clusterLabels, parentCluster, clusterLabel, edgeWeight, points.size());
+}
+
+cluster* hdbscanStar::hdbscanAlgorithm::createNewCluster(
+	std::set<int>& points,
+	std::vector<int>& clusterLabels,
+	cluster* parentCluster,
+	int clusterLabel,
+	double edgeWeight,
+	double pointsWeight,
+	bool trackVirtualChild)
 {
 	std::set<int>::iterator it = points.begin();
 	while (it != points.end())
@@ -551,77 +806,93 @@ cluster* hdbscanStar::hdbscanAlgorithm::createNewCluster(
 		clusterLabels[*it] = clusterLabel;
 		++it;
 	}
-	parentCluster->detachPoints(points.size(), edgeWeight);
+	parentCluster->detachPoints(pointsWeight, edgeWeight);
 
 	if (clusterLabel != 0)
 	{
-		return new cluster(clusterLabel, parentCluster, edgeWeight, points.size());
+		return new cluster(clusterLabel, parentCluster, edgeWeight, pointsWeight);
 	}
 
-	parentCluster->addPointsToVirtualChildCluster(points);
+	if (trackVirtualChild)
+		parentCluster->addPointsToVirtualChildCluster(points);
 	return NULL;
 }
 /// <summary>
 /// Calculates the number of constraints satisfied by the new clusters and virtual children of the
-/// parents of the new clusters.
+/// parents of the new clusters, evaluating only the constraints of their points.
 /// </summary>
 /// <param name="newClusterLabels">Labels of new clusters</param>
 /// <param name="clusters">An List of clusters</param>
 /// <param name="constraints">An List of constraints</param>
 /// <param name="clusterLabels">An array of current cluster labels for points</param>
+/// <param name="newClusterPoints">The points of the new clusters</param>
+/// <param name="constraintIndex">The constraints of each point</param>
 void hdbscanStar::hdbscanAlgorithm::calculateNumConstraintsSatisfied(
 	std::set<int>& newClusterLabels,
 	std::vector<cluster*>& clusters,
 	std::vector<hdbscanConstraint>& constraints,
-	std::vector<int>& clusterLabels)
+	std::vector<int>& clusterLabels,
+	const std::vector<int>& newClusterPoints,
+	hdbscanConstraintIndex& constraintIndex)
 {
 
 	if (constraints.size() == 0)
 		return;
 
-	std::vector<cluster> parents;
-	std::vector<cluster> ::iterator it;
+	std::vector<cluster*> parents;
 	for (int label : newClusterLabels)
 	{
 		cluster* parent = clusters[label]->Parent;
-		if (parent != NULL && !(find(parents.begin(), parents.end(), *parent) != parents.end()))
-			parents.push_back(*parent);
+		if (parent != NULL && find(parents.begin(), parents.end(), parent) == parents.end())
+			parents.push_back(parent);
+	}
+
+	//Only constraints with a point in a new cluster or a virtual child can be satisfied by them:
+	std::vector<int> constraintIndices;
+	constraintIndex.beginRound();
+	for (int point : newClusterPoints)
+		constraintIndex.visitConstraints(point, constraintIndices);
+	for (cluster* parent : parents)
+	{
+		for (int point : parent->getVirtualChildCluster())
+			constraintIndex.visitConstraints(point, constraintIndices);
 	}
 
-	for (hdbscanConstraint constraint : constraints)
+	for (int index : constraintIndices)
 	{
+		hdbscanConstraint& constraint = constraints[index];
 		int labelA = clusterLabels[constraint.getPointA()];
 		int labelB = clusterLabels[constraint.getPointB()];
 
 		if (constraint.getConstraintType() == hdbscanConstraintType::mustLink && labelA == labelB)
 		{
-			if (find(newClusterLabels.begin(), newClusterLabels.end(), labelA) != newClusterLabels.end())
+			if (newClusterLabels.count(labelA))
 				clusters[labelA]->addConstraintsSatisfied(2);
 		}
 		else if (constraint.getConstraintType() == hdbscanConstraintType::cannotLink && (labelA != labelB || labelA == 0))
 		{
-			if (labelA != 0 && find(newClusterLabels.begin(), newClusterLabels.end(), labelA) != newClusterLabels.end())
+			if (labelA != 0 && newClusterLabels.count(labelA))
 				clusters[labelA]->addConstraintsSatisfied(1);
-			if (labelB != 0 && (find(newClusterLabels.begin(), newClusterLabels.end(), labelA) != newClusterLabels.end()))
+			if (labelB != 0 && newClusterLabels.count(labelB))
 				clusters[labelB]->addConstraintsSatisfied(1);
 			if (labelA == 0)
 			{
-				for (cluster parent : parents)
+				for (cluster* parent : parents)
 				{
-					if (parent.virtualChildClusterConstraintsPoint(constraint.getPointA()))
+					if (parent->virtualChildClusterConstraintsPoint(constraint.getPointA()))
 					{
-						parent.addVirtualChildConstraintsSatisfied(1);
+						parent->addVirtualChildConstraintsSatisfied(1);
 						break;
 					}
 				}
 			}
 			if (labelB == 0)
 			{
-				for (cluster parent : parents)
+				for (cluster* parent : parents)
 				{
-					if (parent.virtualChildClusterConstraintsPoint(constraint.getPointB()))
+					if (parent->virtualChildClusterConstraintsPoint(constraint.getPointB()))
 					{
-						parent.addVirtualChildConstraintsSatisfied(1);
+						parent->addVirtualChildConstraintsSatisfied(1);
 						break;
 					}
 				}
@@ -629,8 +900,8 @@ void hdbscanStar::hdbscanAlgorithm::calculateNumConstraintsSatisfied(
 		}
 	}
 
-	for (cluster parent : parents)
+	for (cluster* parent : parents)
 	{
-		parent.releaseVirtualChildCluster();
+		parent->releaseVirtualChildCluster();
 	}
 }
@@ -1,3 +1,4 @@
+#pragma once
 #include <limits>
 #include <vector>
 #include <set>
@@ -9,6 +10,8 @@
 #include"outlierScore.hpp"
 #include"cluster.hpp"
 #include"hdbscanConstraint.hpp"
+#include"hdbscanConstraintIndex.hpp"
+#include"sparseDistanceGraph.hpp"
 
 namespace hdbscanStar
 {
@@ -21,9 +24,47 @@ namespace hdbscanStar
 		/// <param name="distances">A vector of vectors where index [i][j] indicates the jth attribute of data point i</param>
 		/// <param name="k">Each point's core distance will be it's distance to the kth nearest neighbor</param>
 		/// <returns> An array of core distances</returns>
-		static std::vector<double> calculateCoreDistances(std::vector<std::vector<double>> distances, int k);
+		static std::vector<double> calculateCoreDistances(const std::vector<std::vector<double>>& distances, int k);
+
+		/// <summary>
+		/// Calculates the core distances of weighted points, where a point of weight w stands for w identical
+		/// points. Each point's core distance is the smallest distance at which the total weight of the point
+		/// and its neighbors reaches k, which matches calculateCoreDistances() on the expanded data set.
+		/// </summary>
+		/// <param name="distances">A vector of vectors where index [i][j] indicates the distance between points i and j</param>
+		/// <param name="k">The total weight each point's neighborhood needs to reach</param>
+		/// <param name="pointWeights">The weight of each point</param>
+		/// <returns> An array of core distances</returns>
+		static std::vector<double> calculateCoreDistances(const std::vector<std::vector<double>>& distances, int k, const std::vector<double>& pointWeights);
+
+		/// <summary>
+		/// Calculates the core distances from sparse distances, where each point's neighbors are the points it
+		/// shares an edge with. Points with fewer than k - 1 edges get the largest finite core distance.
+		/// </summary>
+		/// <param name="graph">The known distances</param>
+		/// <param name="k">Each point's core distance will be it's distance to the kth nearest neighbor</param>
+		/// <returns> An array of core distances</returns>
+		static std::vector<double> calculateCoreDistances(sparseDistanceGraph& graph, int k);
+
+		/// <summary>
+		/// Calculates the sorted distances from each point to its k - 1 nearest neighbors, so that core
+		/// distances for any smaller k can be read off without scanning the distance matrix again.
+		/// </summary>
+		/// <param name="distances">A vector of vectors where index [i][j] indicates the distance between points i and j</param>
+		/// <param name="k">The largest value of k the neighbor lists will be used for</param>
+		/// <returns>For each point, the ascending distances to its k - 1 nearest neighbors</returns>
+		static std::vector<std::vector<double>> calculateNearestNeighborDistances(const std::vector<std::vector<double>>& distances, int k);
+
+		/// <summary>
+		/// Calculates the core distances for each point from neighbor lists produced by
+		/// calculateNearestNeighborDistances() with a value of k at least as large as this one.
+		/// </summary>
+		/// <param name="nearestNeighborDistances">The sorted nearest neighbor distances of each point</param>
+		/// <param name="k">Each point's core distance will be it's distance to the kth nearest neighbor</param>
+		/// <returns> An array of core distances</returns>
+		static std::vector<double> calculateCoreDistancesFromNeighbors(const std::vector<std::vector<double>>& nearestNeighborDistances, int k);
 		
-		static undirectedGraph constructMst(std::vector<std::vector<double>> distances, std::vector<double> coreDistances, bool selfEdges);
+		static undirectedGraph constructMst(const std::vector<std::vector<double>>& distances, const std::vector<double>& coreDistances, bool selfEdges);
 		
 	
 		/// <summary>
@@ -36,6 +77,12 @@ namespace hdbscanStar
 
 
 		static void computeHierarchyAndClusterTree(undirectedGraph *mst, int minClusterSize, std::vector<hdbscanConstraint> constraints, std::vector<std::vector<int>> &hierarchy, std::vector<double> &pointNoiseLevels, std::vector<int> &pointLastClusters, std::vector<cluster*> &clusters);
+
+		/// <summary>
+		/// Computes the hierarchy and cluster tree of weighted points: cluster sizes, the minimum cluster size
+		/// test and stabilities count each point by its weight. An empty pointWeights weighs every point as 1.
+		/// </summary>
+		static void computeHierarchyAndClusterTree(undirectedGraph *mst, int minClusterSize, std::vector<hdbscanConstraint> constraints, std::vector<std::vector<int>> &hierarchy, std::vector<double> &pointNoiseLevels, std::vector<int> &pointLastClusters, std::vector<cluster*> &clusters, const std::vector<double>& pointWeights);
 		
 		static std::vector<int> findProminentClusters(std::vector<cluster*> &clusters, std::vector<std::vector<int>> &hierarchy, int numPoints);
 
@@ -57,6 +104,32 @@ namespace hdbscanStar
 			std::vector<double> &pointNoiseLevels,
 			std::vector<int> &pointLastClusters,
 			std::vector<double> coreDistances);
+
+		/// <summary>
+		/// Like calculateOutlierScores(), but returns only the score of each point, in point order.
+		/// </summary>
+		static std::vector<double> calculateOutlierScoreValues(
+			std::vector<cluster*> &clusters,
+			std::vector<double> &pointNoiseLevels,
+			std::vector<int> &pointLastClusters);
+
+		/// <summary>
+		/// Selects outlier scores without sorting more than is returned. sortedScores sorts every point;
+		/// topScores selects the numTop highest in parallel chunks and sorts only those; quantileScores keeps the
+		/// points whose score is at least the score at the quantile, found by selection. The selected scores come
+		/// in ascending order, as from calculateOutlierScores(), so they are its last entries. indexedScores
+		/// selects nothing, as the scores themselves are the result.
+		/// </summary>
+		/// <param name="scores">The outlier score of each point</param>
+		/// <param name="coreDistances">The core distance of each point, which breaks score ties</param>
+		/// <param name="selection">The output and its number of points or quantile</param>
+		/// <param name="numThreads">The number of threads; 0 uses all hardware threads</param>
+		/// <returns>The selected outlier scores, in ascending order</returns>
+		static std::vector<outlierScore> selectOutlierScores(
+			const std::vector<double> &scores,
+			const std::vector<double> &coreDistances,
+			const outlierScoreSelection &selection,
+			int numThreads);
 		
 		/// <summary>
 		/// Removes the set of points from their parent Cluster, and creates a new Cluster, provided the
@@ -74,20 +147,38 @@ namespace hdbscanStar
 			cluster *parentCluster,
 			int clusterLabel,
 			double edgeWeight);
+
+		/// <summary>
+		/// Like createNewCluster(), for points whose weights add up to pointsWeight. Noise points are only
+		/// kept in the parent's virtual child cluster when trackVirtualChild is set, as only constraints use it.
+		/// </summary>
+		static cluster* createNewCluster(
+			std::set<int>& points,
+			std::vector<int> &clusterLabels,
+			cluster *parentCluster,
+			int clusterLabel,
+			double edgeWeight,
+			double pointsWeight,
+			bool trackVirtualChild = true);
 		
 		/// <summary>
 		/// Calculates the number of constraints satisfied by the new clusters and virtual children of the
-		/// parents of the new clusters.
+		/// parents of the new clusters. Only the constraints of the points of the new clusters and of the
+		/// virtual children can be satisfied by them, so only those are looked up in the index and evaluated.
 		/// </summary>
 		/// <param name="newClusterLabels">Labels of new clusters</param>
 		/// <param name="clusters">An List of clusters</param>
 		/// <param name="constraints">An List of constraints</param>
 		/// <param name="clusterLabels">An array of current cluster labels for points</param>
+		/// <param name="newClusterPoints">The points of the new clusters</param>
+		/// <param name="constraintIndex">The constraints of each point</param>
 		static void calculateNumConstraintsSatisfied(
 			std::set<int>& newClusterLabels,
 			std::vector<cluster*>& clusters,
 			std::vector<hdbscanConstraint>& constraints,
-			std::vector<int>& clusterLabels);
+			std::vector<int>& clusterLabels,
+			const std::vector<int>& newClusterPoints,
+			hdbscanConstraintIndex& constraintIndex);
 		
 	};
 
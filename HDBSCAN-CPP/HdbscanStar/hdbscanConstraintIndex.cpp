@@ -0,0 +1,43 @@
+#include "hdbscanConstraintIndex.hpp"
+#include<stdexcept>
+
+hdbscanConstraintIndex::hdbscanConstraintIndex(std::vector<hdbscanConstraint>& constraints, int numPoints) {
+	_pointStarts.assign(numPoints + 1, 0);
+	for (hdbscanConstraint& constraint : constraints) {
+		int pointA = constraint.getPointA();
+		int pointB = constraint.getPointB();
+		if (pointA < 0 || pointA >= numPoints || pointB < 0 || pointB >= numPoints)
+			throw std::invalid_argument("Constraints must be between points of the dataset.");
+		_pointStarts[pointA + 1]++;
+		if (pointB != pointA)
+			_pointStarts[pointB + 1]++;
+	}
+	for (int point = 0; point < numPoints; point++)
+		_pointStarts[point + 1] += _pointStarts[point];
+
+	std::vector<int> positions(_pointStarts.begin(), _pointStarts.end() - 1);
+	_pointConstraints.resize(_pointStarts[numPoints]);
+	for (size_t i = 0; i < constraints.size(); i++) {
+		int pointA = constraints[i].getPointA();
+		int pointB = constraints[i].getPointB();
+		_pointConstraints[positions[pointA]++] = i;
+		if (pointB != pointA)
+			_pointConstraints[positions[pointB]++] = i;
+	}
+	_constraintRounds.assign(constraints.size(), 0);
+	_round = 0;
+}
+
+void hdbscanConstraintIndex::beginRound() {
+	_round++;
+}
+
+void hdbscanConstraintIndex::visitConstraints(int point, std::vector<int>& constraintIndices) {
+	for (int i = _pointStarts[point]; i < _pointStarts[point + 1]; i++) {
+		int constraint = _pointConstraints[i];
+		if (_constraintRounds[constraint] != _round) {
+			_constraintRounds[constraint] = _round;
+			constraintIndices.push_back(constraint);
+		}
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include<vector>
+#include"hdbscanConstraint.hpp"
+
+/// <summary>
+/// Lists the constraints of each point, so that a level of the hierarchy only evaluates the constraints of the
+/// points it relabels instead of every constraint. Visits are grouped in rounds, and a constraint is visited
+/// at most once per round even when both of its points are.
+/// </summary>
+class hdbscanConstraintIndex
+{
+private:
+	std::vector<int> _pointStarts;
+	std::vector<int> _pointConstraints;
+	std::vector<int> _constraintRounds;
+	int _round;
+
+public:
+	/// <summary>
+	/// Indexes the constraints of numPoints points, throwing std::invalid_argument if a constraint names a
+	/// point outside of them.
+	/// </summary>
+	hdbscanConstraintIndex(std::vector<hdbscanConstraint>& constraints, int numPoints);
+
+	/// <summary>
+	/// Starts a new round, in which every constraint can be visited again.
+	/// </summary>
+	void beginRound();
+
+	/// <summary>
+	/// Appends the indices of the constraints of point not yet visited in this round.
+	/// </summary>
+	void visitConstraints(int point, std::vector<int>& constraintIndices);
+};
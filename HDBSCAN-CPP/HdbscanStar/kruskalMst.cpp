@@ -0,0 +1,90 @@
+#include "kruskalMst.hpp"
+#include<algorithm>
+#include<limits>
+
+using namespace hdbscanStar;
+
+//Below this many edges, a range is sorted and scanned directly:
+static const int baseCaseEdges = 1024;
+
+static bool lighterEdge(const weightedEdge& edgeOne, const weightedEdge& edgeTwo) {
+	return edgeOne.weight < edgeTwo.weight;
+}
+
+static void sortAndScan(weightedEdge* begin, weightedEdge* end, unionFind& components, std::vector<weightedEdge>& forest) {
+	std::sort(begin, end, lighterEdge);
+	for (weightedEdge* edge = begin; edge != end; edge++) {
+		if (components.find(edge->vertexA) == components.find(edge->vertexB))
+			continue;
+		components.join(edge->vertexA, edge->vertexB);
+		forest.push_back(*edge);
+	}
+}
+
+void kruskalMst::filterKruskal(weightedEdge* begin, weightedEdge* end, unionFind& components, std::vector<weightedEdge>& forest) {
+	if ((int)forest.size() == components.getNumElements() - 1)
+		return;
+	if (end - begin <= baseCaseEdges) {
+		sortAndScan(begin, end, components, forest);
+		return;
+	}
+
+	//Split at the median of three weights; a range of equal weights cannot be split and is scanned directly:
+	double first = begin->weight;
+	double middle = begin[(end - begin) / 2].weight;
+	double last = end[-1].weight;
+	double pivot = std::max(std::min(first, middle), std::min(std::max(first, middle), last));
+	weightedEdge* split = std::partition(begin, end, [pivot](const weightedEdge& edge) { return edge.weight < pivot; });
+	if (split == begin)
+		split = std::partition(begin, end, [pivot](const weightedEdge& edge) { return edge.weight <= pivot; });
+	if (split == end) {
+		sortAndScan(begin, end, components, forest);
+		return;
+	}
+
+	filterKruskal(begin, split, components, forest);
+	weightedEdge* heavyEnd = std::remove_if(split, end, [&components](const weightedEdge& edge) {
+		return components.find(edge.vertexA) == components.find(edge.vertexB);
+	});
+	filterKruskal(split, heavyEnd, components, forest);
+}
+
+void kruskalMst::constructForest(std::vector<weightedEdge>& edges, unionFind& components, std::vector<weightedEdge>& forest) {
+	if (edges.size() != 0)
+		filterKruskal(&edges[0], &edges[0] + edges.size(), components, forest);
+}
+
+undirectedGraph kruskalMst::constructMst(int numVertices, std::vector<weightedEdge>& edges, const std::vector<double>& coreDistances, bool selfEdges) {
+	unionFind components(numVertices);
+	std::vector<weightedEdge> forest;
+	constructForest(edges, components, forest);
+	return joinForest(numVertices, forest, components, coreDistances, selfEdges);
+}
+
+undirectedGraph kruskalMst::joinForest(int numVertices, const std::vector<weightedEdge>& forest, unionFind& components, const std::vector<double>& coreDistances, bool selfEdges) {
+	std::vector<int> verticesA;
+	std::vector<int> verticesB;
+	std::vector<double> edgeWeights;
+	for (const weightedEdge& edge : forest) {
+		verticesA.push_back(edge.vertexA);
+		verticesB.push_back(edge.vertexB);
+		edgeWeights.push_back(edge.weight);
+	}
+	//Join the components of the forest at the top of the hierarchy:
+	for (int vertex = 1; vertex < numVertices; vertex++) {
+		if (components.find(vertex) == components.find(0))
+			continue;
+		components.join(0, vertex);
+		verticesA.push_back(0);
+		verticesB.push_back(vertex);
+		edgeWeights.push_back(std::numeric_limits<double>::max());
+	}
+	if (selfEdges) {
+		for (int vertex = 0; vertex < numVertices; vertex++) {
+			verticesA.push_back(vertex);
+			verticesB.push_back(vertex);
+			edgeWeights.push_back(coreDistances[vertex]);
+		}
+	}
+	return undirectedGraph(numVertices, verticesA, verticesB, edgeWeights);
+}
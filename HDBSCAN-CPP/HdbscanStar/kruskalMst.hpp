@@ -0,0 +1,62 @@
+#pragma once
+#include<vector>
+#include"undirectedGraph.hpp"
+#include"../Utils/unionFind.hpp"
+
+namespace hdbscanStar
+{
+	/// <summary>
+	/// An edge of a candidate edge list, weighted by mutual reachability.
+	/// </summary>
+	struct weightedEdge
+	{
+		double weight;
+		int vertexA;
+		int vertexB;
+	};
+
+	/// <summary>
+	/// Builds minimum spanning forests from explicit edge lists with filter-Kruskal (Osipov, Sanders and
+	/// Singler, 2009): the edges are split around a pivot weight like in quicksort, the light half is solved
+	/// first, and heavy edges whose endpoints are already connected are dropped before the heavy half is
+	/// sorted. On dense candidate lists most heavy edges never need to be sorted at all.
+	/// </summary>
+	class kruskalMst
+	{
+	private:
+		static void filterKruskal(weightedEdge* begin, weightedEdge* end, unionFind& components, std::vector<weightedEdge>& forest);
+
+	public:
+		/// <summary>
+		/// Adds the minimum spanning forest of the edges to forest, joining components as it goes. The edges are
+		/// reordered. Edges between vertices that components already connects are never added, so the forest of
+		/// several edge lists can be built one list after the other.
+		/// </summary>
+		/// <param name="edges">The candidate edges</param>
+		/// <param name="components">The connectivity so far, which is updated</param>
+		/// <param name="forest">Receives the forest edges, lightest first</param>
+		static void constructForest(std::vector<weightedEdge>& edges, unionFind& components, std::vector<weightedEdge>& forest);
+
+		/// <summary>
+		/// Builds an MST in the form of hdbscanAlgorithm::constructMst() from candidate edges. When the edges do
+		/// not connect every vertex, the components of the forest are joined by edges of the largest finite
+		/// weight, so each component splits off the root of the cluster tree as its own top-level cluster.
+		/// </summary>
+		/// <param name="numVertices">The number of vertices</param>
+		/// <param name="edges">The candidate edges, which are reordered</param>
+		/// <param name="coreDistances">The core distance of each vertex</param>
+		/// <param name="selfEdges">Whether to add an edge from every vertex to itself weighted by its core distance</param>
+		static undirectedGraph constructMst(int numVertices, std::vector<weightedEdge>& edges, const std::vector<double>& coreDistances, bool selfEdges);
+
+		/// <summary>
+		/// Turns a minimum spanning forest into an MST in the form of hdbscanAlgorithm::constructMst(), joining
+		/// its components by edges of the largest finite weight as constructMst() does.
+		/// </summary>
+		/// <param name="numVertices">The number of vertices</param>
+		/// <param name="forest">The forest edges</param>
+		/// <param name="components">The components of the forest, which are joined</param>
+		/// <param name="coreDistances">The core distance of each vertex</param>
+		/// <param name="selfEdges">Whether to add an edge from every vertex to itself weighted by its core distance</param>
+		static undirectedGraph joinForest(int numVertices, const std::vector<weightedEdge>& forest, unionFind& components, const std::vector<double>& coreDistances, bool selfEdges);
+	};
+}
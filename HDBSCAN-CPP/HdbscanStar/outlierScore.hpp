@@ -1,4 +1,22 @@
 #pragma once
+
+/// <summary>
+/// Which outlier scores a run returns: all of them sorted (the default), an index-aligned array without
+/// sorting, the numTop highest, or those at or above the score at a quantile.
+/// </summary>
+enum outlierScoreOutput{sortedScores, indexedScores, topScores, quantileScores};
+
+/// <summary>
+/// How the outlier scores of a run are returned: the output, the number of points kept by topScores, and the
+/// quantile, between 0 and 1, whose score is the threshold of quantileScores.
+/// </summary>
+struct outlierScoreSelection
+{
+	outlierScoreOutput output = sortedScores;
+	int numTop = 0;
+	double quantile = 0.999;
+};
+
 	/// <summary>
 	/// Simple storage class that keeps the outlier score, core distance, and id (index) for a single point.
 	/// OutlierScores are sorted in ascending order by outlier score, with core distances used to break
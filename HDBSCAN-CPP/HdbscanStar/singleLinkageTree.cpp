@@ -0,0 +1,65 @@
+#include "singleLinkageTree.hpp"
+#include "../Utils/unionFind.hpp"
+#include <stdexcept>
+
+singleLinkageTree::singleLinkageTree() {
+	numPoints = 0;
+}
+
+singleLinkageTree::singleLinkageTree(int numPoints, const sharedArray<int>& verticesA, const sharedArray<int>& verticesB, const sharedArray<double>& edgeWeights) {
+	this->numPoints = numPoints;
+	int numEdges = edgeWeights.size();
+	if (numPoints > 0 && numEdges != numPoints - 1)
+		throw std::invalid_argument("A single linkage tree needs a spanning tree with numPoints - 1 edges.");
+
+	std::vector<int> mergeLeft(numEdges);
+	std::vector<int> mergeRight(numEdges);
+	std::vector<double> mergeDistance(numEdges);
+	std::vector<int> mergeSize(numEdges);
+
+	//The dendrogram node currently representing each union-find component, indexed by component root:
+	unionFind components(numPoints);
+	std::vector<int> componentNodes(numPoints);
+	for (int i = 0; i < numPoints; i++)
+		componentNodes[i] = i;
+
+	for (int i = 0; i < numEdges; i++)
+	{
+		int rootA = components.find(verticesA[i]);
+		int rootB = components.find(verticesB[i]);
+		if (rootA == rootB)
+			throw std::invalid_argument("The edges given to the single linkage tree contain a cycle.");
+
+		int nodeA = componentNodes[rootA];
+		int nodeB = componentNodes[rootB];
+		mergeLeft[i] = nodeA;
+		mergeRight[i] = nodeB;
+		mergeDistance[i] = edgeWeights[i];
+		mergeSize[i] = (nodeA < numPoints ? 1 : mergeSize[nodeA - numPoints]) + (nodeB < numPoints ? 1 : mergeSize[nodeB - numPoints]);
+		componentNodes[components.join(rootA, rootB)] = numPoints + i;
+	}
+	left = mergeLeft;
+	right = mergeRight;
+	distance = mergeDistance;
+	size = mergeSize;
+}
+
+singleLinkageTree::singleLinkageTree(int numPoints, sharedArray<int> left, sharedArray<int> right, sharedArray<double> distance, sharedArray<int> size) {
+	this->numPoints = numPoints;
+	this->left = left;
+	this->right = right;
+	this->distance = distance;
+	this->size = size;
+}
+
+int singleLinkageTree::getRoot() {
+	return numPoints == 1 ? 0 : 2 * numPoints - 2;
+}
+
+int singleLinkageTree::getNumMerges() {
+	return left.size();
+}
+
+int singleLinkageTree::getNodeSize(int node) {
+	return node < numPoints ? 1 : size[node - numPoints];
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include<vector>
+#include"../Utils/sharedArray.hpp"
+/// <summary>
+/// The single linkage dendrogram of a minimum spanning tree. Leaves are the points 0..n-1 and merge i
+/// creates node n + i, joining the nodes left[i] and right[i] at height distance[i]. The last merge is
+/// the root.
+/// </summary>
+class singleLinkageTree
+{
+public:
+	int numPoints;
+	sharedArray<int> left;
+	sharedArray<int> right;
+	sharedArray<double> distance;
+	sharedArray<int> size;
+
+	singleLinkageTree();
+
+	/// <summary>
+	/// Builds the dendrogram from MST edges sorted in ascending order of weight, using a union-find.
+	/// </summary>
+	/// <param name="numPoints">The number of points (vertices) spanned by the MST</param>
+	/// <param name="verticesA">The first vertex of each edge</param>
+	/// <param name="verticesB">The second vertex of each edge</param>
+	/// <param name="edgeWeights">The ascending weight of each edge</param>
+	singleLinkageTree(int numPoints, const sharedArray<int>& verticesA, const sharedArray<int>& verticesB, const sharedArray<double>& edgeWeights);
+
+	/// <summary>
+	/// Wraps existing dendrogram arrays, for example ones viewed from a model file.
+	/// </summary>
+	singleLinkageTree(int numPoints, sharedArray<int> left, sharedArray<int> right, sharedArray<double> distance, sharedArray<int> size);
+
+	int getRoot();
+
+	int getNumMerges();
+
+	/// <summary>
+	/// Returns the number of points under a node (1 for a leaf).
+	/// </summary>
+	int getNodeSize(int node);
+};
+
@@ -0,0 +1,52 @@
+#include "sparseDistanceGraph.hpp"
+#include<stdexcept>
+#include<string>
+
+sparseDistanceGraph::sparseDistanceGraph() {
+	_numVertices = 0;
+}
+
+sparseDistanceGraph::sparseDistanceGraph(int numVertices) {
+	_numVertices = numVertices;
+}
+
+sparseDistanceGraph::sparseDistanceGraph(int numVertices, std::vector<int> verticesA, std::vector<int> verticesB, std::vector<double> distances) {
+	if (verticesA.size() != verticesB.size() || verticesA.size() != distances.size())
+		throw std::invalid_argument("The edge arrays of a sparseDistanceGraph must have the same length.");
+	_numVertices = numVertices;
+	for (size_t i = 0; i < verticesA.size(); i++) {
+		if (verticesA[i] < 0 || verticesA[i] >= numVertices || verticesB[i] < 0 || verticesB[i] >= numVertices)
+			throw std::invalid_argument("Edge " + std::to_string(i) + " of a sparseDistanceGraph has a vertex out of range.");
+	}
+	_verticesA = verticesA;
+	_verticesB = verticesB;
+	_distances = distances;
+}
+
+void sparseDistanceGraph::addEdge(int vertexA, int vertexB, double distance) {
+	if (vertexA < 0 || vertexA >= _numVertices || vertexB < 0 || vertexB >= _numVertices)
+		throw std::invalid_argument("An edge of a sparseDistanceGraph has a vertex out of range.");
+	_verticesA.push_back(vertexA);
+	_verticesB.push_back(vertexB);
+	_distances.push_back(distance);
+}
+
+int sparseDistanceGraph::getNumVertices() const {
+	return _numVertices;
+}
+
+int sparseDistanceGraph::getNumEdges() const {
+	return _distances.size();
+}
+
+const std::vector<int>& sparseDistanceGraph::getVerticesA() {
+	return _verticesA;
+}
+
+const std::vector<int>& sparseDistanceGraph::getVerticesB() {
+	return _verticesB;
+}
+
+const std::vector<double>& sparseDistanceGraph::getDistances() {
+	return _distances;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include<vector>
+/// <summary>
+/// Distances that are only known for some pairs of points, such as candidate pairs from blocking, as an
+/// edge list over a fixed number of points. Pairs which are not listed are treated as infinitely far apart.
+/// Each pair should be listed once, in either direction.
+/// </summary>
+class sparseDistanceGraph
+{
+private:
+	int _numVertices;
+	std::vector<int> _verticesA;
+	std::vector<int> _verticesB;
+	std::vector<double> _distances;
+
+public:
+	sparseDistanceGraph();
+
+	sparseDistanceGraph(int numVertices);
+
+	/// <summary>
+	/// Creates a graph from parallel edge arrays.
+	/// </summary>
+	/// <param name="numVertices">The number of points, including points without any edge</param>
+	/// <param name="verticesA">The first point of each edge</param>
+	/// <param name="verticesB">The second point of each edge</param>
+	/// <param name="distances">The distance between the points of each edge</param>
+	sparseDistanceGraph(int numVertices, std::vector<int> verticesA, std::vector<int> verticesB, std::vector<double> distances);
+
+	void addEdge(int vertexA, int vertexB, double distance);
+
+	int getNumVertices() const;
+
+	int getNumEdges() const;
+
+	const std::vector<int>& getVerticesA();
+
+	const std::vector<int>& getVerticesB();
+
+	const std::vector<double>& getDistances();
+};
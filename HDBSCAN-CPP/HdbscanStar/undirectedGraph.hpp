@@ -10,6 +10,11 @@ private:
 	std::vector<std::vector<int>> _edges;
 
 public:
+	undirectedGraph()
+	{
+		_numVertices = 0;
+	}
+
 	undirectedGraph(int numVertices, std::vector<int> verticesA, std::vector<int> verticesB, std::vector<double> edgeWeights)
 	{
 		_numVertices = numVertices;
@@ -0,0 +1,282 @@
+#pragma once
+#include<vector>
+#include<algorithm>
+#include<limits>
+#include<thread>
+#include"spatialIndex.hpp"
+#include"../Utils/parallelFor.hpp"
+
+/// <summary>
+/// A node of a ballTree: the rows [start, end) in tree order, the child nodes (-1 for a leaf) and the
+/// radius of the ball around the node's center which holds all of its points.
+/// </summary>
+struct ballTreeNode
+{
+	int start;
+	int end;
+	int left;
+	int right;
+	double radius;
+};
+
+/// <summary>
+/// A ball tree over a fixed set of points for any distance policy which satisfies the triangle inequality
+/// (EuclideanDistance, ManhattanDistance, ...). Each node keeps the centroid of its points and a covering
+/// radius under the policy, so the distance from a query (or another node) to the ball bounds the distance
+/// to every point in it.
+///
+/// Nodes are stored contiguously in depth-first order, and since nodes are split at the median the layout
+/// is a function of the node sizes alone: the subtrees are built in parallel straight into their final
+/// slots. Points are copied into tree order, so every node is a contiguous block of rows.
+/// </summary>
+template<class TDistance>
+class ballTree : public spatialIndex
+{
+private:
+	int _numPoints;
+	int _numAttributes;
+	int _leafSize;
+	std::vector<double> _data;
+	std::vector<int> _indices;
+	std::vector<ballTreeNode> _nodes;
+	std::vector<double> _centers;
+	TDistance _distance;
+
+	static int countNodes(int numPoints, int leafSize)
+	{
+		if (numPoints <= leafSize)
+			return 1;
+		int leftPoints = numPoints / 2;
+		return 1 + countNodes(leftPoints, leafSize) + countNodes(numPoints - leftPoints, leafSize);
+	}
+
+	void buildNode(const double* dataset, int node, int start, int end, int parallelDepth)
+	{
+		TDistance distance = _distance;
+		double* center = &_centers[(size_t)node * _numAttributes];
+		std::vector<double> lower(_numAttributes, std::numeric_limits<double>::max());
+		std::vector<double> upper(_numAttributes, -std::numeric_limits<double>::max());
+		for (int i = start; i < end; i++)
+		{
+			const double* row = dataset + (size_t)_indices[i] * _numAttributes;
+			for (int attribute = 0; attribute < _numAttributes; attribute++)
+			{
+				center[attribute] += row[attribute];
+				lower[attribute] = std::min(lower[attribute], row[attribute]);
+				upper[attribute] = std::max(upper[attribute], row[attribute]);
+			}
+		}
+		for (int attribute = 0; attribute < _numAttributes; attribute++)
+			center[attribute] /= end - start;
+		double radius = 0;
+		for (int i = start; i < end; i++)
+			radius = std::max(radius, distance.computeDistance(center, dataset + (size_t)_indices[i] * _numAttributes, _numAttributes));
+
+		ballTreeNode treeNode = { start, end, -1, -1, radius };
+		_nodes[node] = treeNode;
+		if (end - start <= _leafSize)
+			return;
+
+		//Split at the median of the widest attribute:
+		int splitAttribute = 0;
+		for (int attribute = 1; attribute < _numAttributes; attribute++)
+		{
+			if (upper[attribute] - lower[attribute] > upper[splitAttribute] - lower[splitAttribute])
+				splitAttribute = attribute;
+		}
+		int middle = start + (end - start) / 2;
+		int numAttributes = _numAttributes;
+		std::nth_element(_indices.begin() + start, _indices.begin() + middle, _indices.begin() + end,
+			[dataset, numAttributes, splitAttribute](int first, int second) {
+				return dataset[(size_t)first * numAttributes + splitAttribute] < dataset[(size_t)second * numAttributes + splitAttribute];
+			});
+		int left = node + 1;
+		int right = left + countNodes(middle - start, _leafSize);
+		_nodes[node].left = left;
+		_nodes[node].right = right;
+
+		if (parallelDepth > 0)
+		{
+			std::thread leftThread(&ballTree::buildNode, this, dataset, left, start, middle, parallelDepth - 1);
+			buildNode(dataset, right, middle, end, parallelDepth - 1);
+			leftThread.join();
+		}
+		else
+		{
+			buildNode(dataset, left, start, middle, 0);
+			buildNode(dataset, right, middle, end, 0);
+		}
+	}
+
+	void searchNode(TDistance& distance, const double* point, int node, double nodeDistance, int k, int& numFound, int* indices, double* distances)
+	{
+		if (numFound == k && nodeDistance >= distances[k - 1])
+			return;
+		const ballTreeNode& treeNode = _nodes[node];
+		if (treeNode.left < 0)
+		{
+			for (int i = treeNode.start; i < treeNode.end; i++)
+			{
+				double pointDistance = distance.computeDistance(point, &_data[(size_t)i * _numAttributes], _numAttributes);
+				if (numFound == k && pointDistance >= distances[k - 1])
+					continue;
+				//Insert into the sorted neighbor list:
+				int position = numFound < k ? numFound++ : k - 1;
+				while (position > 0 && distances[position - 1] > pointDistance)
+				{
+					distances[position] = distances[position - 1];
+					indices[position] = indices[position - 1];
+					position--;
+				}
+				distances[position] = pointDistance;
+				indices[position] = i;
+			}
+			return;
+		}
+
+		double leftDistance = pointLowerBound(distance, point, treeNode.left);
+		double rightDistance = pointLowerBound(distance, point, treeNode.right);
+		if (leftDistance <= rightDistance)
+		{
+			searchNode(distance, point, treeNode.left, leftDistance, k, numFound, indices, distances);
+			searchNode(distance, point, treeNode.right, rightDistance, k, numFound, indices, distances);
+		}
+		else
+		{
+			searchNode(distance, point, treeNode.right, rightDistance, k, numFound, indices, distances);
+			searchNode(distance, point, treeNode.left, leftDistance, k, numFound, indices, distances);
+		}
+	}
+
+	/// <summary>
+	/// Finds the k nearest neighbors of a query, reporting them as tree positions.
+	/// </summary>
+	int queryTreePositions(TDistance& distance, const double* point, int k, int* positions, double* distances)
+	{
+		if (k > _numPoints)
+			k = _numPoints;
+		if (k <= 0)
+			return 0;
+		int numFound = 0;
+		searchNode(distance, point, 0, pointLowerBound(distance, point, 0), k, numFound, positions, distances);
+		return numFound;
+	}
+
+public:
+	/// <summary>
+	/// Builds the tree over a row-major dataset.
+	/// </summary>
+	/// <param name="dataset">numPoints rows of numAttributes doubles</param>
+	/// <param name="numPoints">The number of points</param>
+	/// <param name="numAttributes">The number of attributes of each point</param>
+	/// <param name="leafSize">The largest number of points kept in a leaf</param>
+	/// <param name="numThreads">The number of threads building subtrees; 0 uses all hardware threads</param>
+	ballTree(const double* dataset, int numPoints, int numAttributes, int leafSize = 32, int numThreads = 1)
+	{
+		_numPoints = numPoints;
+		_numAttributes = numAttributes;
+		_leafSize = leafSize < 1 ? 1 : leafSize;
+		_indices.resize(numPoints);
+		for (int i = 0; i < numPoints; i++)
+			_indices[i] = i;
+		if (numPoints > 0)
+		{
+			int numNodes = countNodes(numPoints, _leafSize);
+			_nodes.resize(numNodes);
+			_centers.assign((size_t)numNodes * numAttributes, 0.0);
+			int parallelDepth = 0;
+			for (int threads = resolveNumThreads(numThreads); threads > 1; threads /= 2)
+				parallelDepth++;
+			buildNode(dataset, 0, 0, numPoints, parallelDepth);
+		}
+
+		_data.resize((size_t)numPoints * numAttributes);
+		for (int i = 0; i < numPoints; i++)
+			std::copy(dataset + (size_t)_indices[i] * numAttributes, dataset + (size_t)_indices[i] * numAttributes + numAttributes, _data.begin() + (size_t)i * numAttributes);
+	}
+
+	int queryNearestNeighbors(const double* point, int k, int* indices, double* distances)
+	{
+		TDistance distance = _distance;
+		int numFound = queryTreePositions(distance, point, k, indices, distances);
+		for (int i = 0; i < numFound; i++)
+			indices[i] = _indices[indices[i]];
+		return numFound;
+	}
+
+	/// <summary>
+	/// Finds the k nearest neighbors of every indexed point (each point is its own nearest neighbor), with
+	/// the points split over threads.
+	/// </summary>
+	/// <param name="k">The number of neighbors to find per point</param>
+	/// <param name="numThreads">The number of threads; 0 uses all hardware threads</param>
+	/// <param name="positions">Receives numPoints rows of k tree positions, one row per tree position</param>
+	/// <param name="distances">Receives the matching distances, in ascending order per row</param>
+	/// <returns>The number of neighbors found per point, which is k unless fewer points are indexed</returns>
+	int queryAllNearestNeighbors(int k, int numThreads, std::vector<int>& positions, std::vector<double>& distances)
+	{
+		k = std::max(0, std::min(k, _numPoints));
+		positions.assign((size_t)_numPoints * k, -1);
+		distances.assign((size_t)_numPoints * k, std::numeric_limits<double>::max());
+		parallelFor(0, _numPoints, numThreads, [&](int begin, int end) {
+			TDistance distance = _distance;
+			for (int i = begin; i < end; i++)
+				queryTreePositions(distance, &_data[(size_t)i * _numAttributes], k, &positions[(size_t)i * k], &distances[(size_t)i * k]);
+		});
+		return k;
+	}
+
+	/// <summary>
+	/// A lower bound on the distance from a point to every point of a node.
+	/// </summary>
+	double pointLowerBound(TDistance& distance, const double* point, int node)
+	{
+		double centerDistance = distance.computeDistance(point, &_centers[(size_t)node * _numAttributes], _numAttributes);
+		return std::max(0.0, centerDistance - _nodes[node].radius);
+	}
+
+	int getNumPoints()
+	{
+		return _numPoints;
+	}
+
+	int getNumAttributes()
+	{
+		return _numAttributes;
+	}
+
+	int getNumNodes()
+	{
+		return _nodes.size();
+	}
+
+	TDistance& getDistance()
+	{
+		return _distance;
+	}
+
+	/// <summary>
+	/// The nodes in depth-first order; the root is node 0 and children follow their parents.
+	/// </summary>
+	const std::vector<ballTreeNode>& getNodes()
+	{
+		return _nodes;
+	}
+
+	/// <summary>
+	/// The points in tree order.
+	/// </summary>
+	const std::vector<double>& getData()
+	{
+		return _data;
+	}
+
+	/// <summary>
+	/// The original index of each point in tree order.
+	/// </summary>
+	const std::vector<int>& getIndices()
+	{
+		return _indices;
+	}
+};
+
@@ -0,0 +1,356 @@
+#pragma once
+#include<vector>
+#include<algorithm>
+#include<utility>
+#include<limits>
+#include<cmath>
+#include"../Utils/exactPredicates.hpp"
+
+/// <summary>
+/// A Delaunay triangulation (dimensions = 2) or tetrahedralization (dimensions = 3) built by inserting points
+/// one at a time in any order chosen by the caller (Bowyer-Watson): every simplex whose circumsphere strictly
+/// holds the new point is removed and the cavity is re-triangulated from the point. All predicates are exact,
+/// so degenerate inputs such as grids (with many cospherical points) produce a valid Delaunay triangulation.
+///
+/// The points live inside a super simplex whose vertices are far enough away that they never fall inside the
+/// ball with any two points as diameter. Every edge which has such an empty diametral ball (every Gabriel edge,
+/// and so every Euclidean MST edge) is therefore an edge of the triangulation at every stage of the insertion.
+/// </summary>
+template<int dimensions>
+class delaunayTriangulation
+{
+private:
+	/// <summary>
+	/// A positively oriented simplex; neighbors[i] shares the facet opposite vertices[i], -1 outside the super simplex.
+	/// </summary>
+	struct simplex
+	{
+		int vertices[dimensions + 1];
+		int neighbors[dimensions + 1];
+	};
+
+	/// <summary>
+	/// A facet of a new simplex through the inserted point, keyed by its other vertices.
+	/// </summary>
+	struct ridge
+	{
+		int key[2];
+		int simplex;
+		int facet;
+
+		bool operator<(const ridge& other) const
+		{
+			return key[0] != other.key[0] ? key[0] < other.key[0] : key[1] < other.key[1];
+		}
+	};
+
+	const double* _dataset;
+	int _numPoints;
+	double _superVertices[(dimensions + 1) * dimensions];
+	std::vector<simplex> _simplices;
+	std::vector<int> _freeSimplices;
+	std::vector<int> _vertexSimplices;
+	std::vector<int> _marks;
+	int _stamp;
+	int _lastSimplex;
+	double _lower[dimensions];
+	double _cellSize;
+	std::vector<int> _levelCells;
+	std::vector<std::vector<int>> _cellVertices;
+	std::vector<int> _cavity;
+	std::vector<std::pair<int, int>> _boundary;
+	std::vector<simplex> _created;
+	std::vector<int> _outsideFacets;
+	std::vector<int> _createdIndices;
+	std::vector<ridge> _ridges;
+
+	const double* getPoint(int vertex)
+	{
+		return vertex < _numPoints ? _dataset + (size_t)vertex * dimensions : _superVertices + (size_t)(vertex - _numPoints) * dimensions;
+	}
+
+	bool containsInSphere(int simplexIndex, const double* point)
+	{
+		const double* points[dimensions + 2];
+		for (int i = 0; i <= dimensions; i++)
+			points[i] = getPoint(_simplices[simplexIndex].vertices[i]);
+		points[dimensions + 1] = point;
+		return exactPredicates::inSphere(dimensions, points) > 0;
+	}
+
+	/// <summary>
+	/// Walks from a simplex towards the point, always crossing a facet which separates them, and returns a
+	/// simplex which contains the point. The visibility walk always terminates in a Delaunay triangulation.
+	/// </summary>
+	int locate(const double* point, int start)
+	{
+		int current = start;
+		for (int step = 0; ; step++)
+		{
+			const simplex& currentSimplex = _simplices[current];
+			const double* points[dimensions + 1];
+			for (int i = 0; i <= dimensions; i++)
+				points[i] = getPoint(currentSimplex.vertices[i]);
+			int next = -1;
+			for (int offset = 0; offset <= dimensions; offset++)
+			{
+				int facet = (step + offset) % (dimensions + 1);
+				const double* replaced = points[facet];
+				points[facet] = point;
+				int orientation = exactPredicates::orient(dimensions, points);
+				points[facet] = replaced;
+				if (orientation < 0 && currentSimplex.neighbors[facet] >= 0)
+				{
+					next = currentSimplex.neighbors[facet];
+					break;
+				}
+			}
+			if (next < 0)
+				return current;
+			current = next;
+		}
+	}
+
+	/// <summary>
+	/// The cell of a point in a level of the pyramid of location grids, whose cells double in size per level,
+	/// from its coordinates in the finest grid.
+	/// </summary>
+	size_t getCell(const int* coordinates, int level)
+	{
+		size_t cell = 0;
+		for (int attribute = 0; attribute < dimensions; attribute++)
+			cell = cell * _levelCells[level * dimensions + attribute] + (coordinates[attribute] >> level);
+		return cell;
+	}
+
+	int allocateSimplex()
+	{
+		if (_freeSimplices.size() != 0)
+		{
+			int index = _freeSimplices.back();
+			_freeSimplices.pop_back();
+			return index;
+		}
+		_simplices.push_back(simplex());
+		_marks.push_back(0);
+		return _simplices.size() - 1;
+	}
+
+public:
+	/// <summary>
+	/// Starts the triangulation with the super simplex around the points; none of them is inserted yet.
+	/// </summary>
+	/// <param name="dataset">The points as contiguous rows of dimensions attributes, which must outlive the triangulation</param>
+	/// <param name="numPoints">The number of points</param>
+	delaunayTriangulation(const double* dataset, int numPoints)
+	{
+		_dataset = dataset;
+		_numPoints = numPoints;
+		_stamp = 0;
+		double lower[dimensions], upper[dimensions];
+		std::fill(lower, lower + dimensions, numPoints ? std::numeric_limits<double>::max() : 0.0);
+		std::fill(upper, upper + dimensions, numPoints ? -std::numeric_limits<double>::max() : 0.0);
+		for (int i = 0; i < numPoints; i++)
+		{
+			for (int attribute = 0; attribute < dimensions; attribute++)
+			{
+				lower[attribute] = std::min(lower[attribute], dataset[(size_t)i * dimensions + attribute]);
+				upper[attribute] = std::max(upper[attribute], dataset[(size_t)i * dimensions + attribute]);
+			}
+		}
+		double extent = 0;
+		for (int attribute = 0; attribute < dimensions; attribute++)
+			extent = std::max(extent, upper[attribute] - lower[attribute]);
+		if (extent == 0)
+			extent = 1;
+
+		//Point location starts from the last point inserted into the same cell of a grid with about one cell
+		//per point, or into the same cell of the next coarser grid while that cell is still empty:
+		std::copy(lower, lower + dimensions, _lower);
+		_cellSize = extent / std::max(1.0, std::floor(std::pow((double)numPoints, 1.0 / dimensions)));
+		for (int level = 0; ; level++)
+		{
+			size_t numCells = 1;
+			for (int attribute = 0; attribute < dimensions; attribute++)
+			{
+				int cells = level == 0 ? (int)std::floor((upper[attribute] - lower[attribute]) / _cellSize) + 1 : ((_levelCells[attribute] - 1) >> level) + 1;
+				_levelCells.push_back(cells);
+				numCells *= cells;
+			}
+			_cellVertices.push_back(std::vector<int>(numCells, -1));
+			if (numCells == 1)
+				break;
+		}
+
+		//The corner at center - scale and the corners (2 * dimensions + 1) * scale further along each axis
+		//enclose the bounding box and stay out of every ball whose diameter is inside it:
+		double scale = 4 * extent;
+		for (int vertex = 0; vertex <= dimensions; vertex++)
+		{
+			for (int attribute = 0; attribute < dimensions; attribute++)
+			{
+				double center = lower[attribute] + (upper[attribute] - lower[attribute]) / 2;
+				double offset = vertex == attribute + 1 ? 2 * dimensions * scale : -scale;
+				_superVertices[vertex * dimensions + attribute] = center + offset;
+			}
+		}
+		simplex superSimplex;
+		for (int i = 0; i <= dimensions; i++)
+		{
+			superSimplex.vertices[i] = numPoints + i;
+			superSimplex.neighbors[i] = -1;
+		}
+		const double* points[dimensions + 1];
+		for (int i = 0; i <= dimensions; i++)
+			points[i] = getPoint(superSimplex.vertices[i]);
+		if (exactPredicates::orient(dimensions, points) < 0)
+			std::swap(superSimplex.vertices[0], superSimplex.vertices[1]);
+		_simplices.push_back(superSimplex);
+		_marks.push_back(0);
+		_vertexSimplices.assign(numPoints + dimensions + 1, -1);
+		for (int i = 0; i <= dimensions; i++)
+			_vertexSimplices[numPoints + i] = 0;
+		_lastSimplex = 0;
+	}
+
+	/// <summary>
+	/// Inserts a point and reports the points it is connected to in the new triangulation. A point with the same
+	/// coordinates as an inserted one is not inserted.
+	/// </summary>
+	/// <param name="vertex">The index of the point to insert</param>
+	/// <param name="adjacentVertices">Receives the inserted points sharing an edge with the new point</param>
+	/// <returns>Whether the point was inserted</returns>
+	bool insert(int vertex, std::vector<int>& adjacentVertices)
+	{
+		adjacentVertices.clear();
+		const double* point = getPoint(vertex);
+		int coordinates[dimensions];
+		for (int attribute = 0; attribute < dimensions; attribute++)
+		{
+			double position = std::floor((point[attribute] - _lower[attribute]) / _cellSize);
+			coordinates[attribute] = (int)std::max<double>(0, std::min<double>(position, _levelCells[attribute] - 1));
+		}
+		int start = _lastSimplex;
+		for (size_t level = 0; level < _cellVertices.size(); level++)
+		{
+			int nearby = _cellVertices[level][getCell(coordinates, level)];
+			if (nearby >= 0)
+			{
+				start = _vertexSimplices[nearby];
+				break;
+			}
+		}
+		int located = locate(point, start);
+		for (int i = 0; i <= dimensions; i++)
+		{
+			if (std::equal(point, point + dimensions, getPoint(_simplices[located].vertices[i])))
+				return false;
+		}
+
+		//Grow the cavity from the simplex holding the point; its boundary facets each get a new simplex:
+		_stamp++;
+		int inCavity = 2 * _stamp + 1, outsideCavity = 2 * _stamp;
+		std::vector<int>& cavity = _cavity;
+		std::vector<std::pair<int, int>>& boundary = _boundary;
+		cavity.assign(1, located);
+		boundary.clear();
+		_marks[located] = inCavity;
+		for (size_t i = 0; i < cavity.size(); i++)
+		{
+			for (int facet = 0; facet <= dimensions; facet++)
+			{
+				int neighbor = _simplices[cavity[i]].neighbors[facet];
+				if (neighbor >= 0 && _marks[neighbor] != inCavity && _marks[neighbor] != outsideCavity)
+				{
+					if (containsInSphere(neighbor, point))
+					{
+						_marks[neighbor] = inCavity;
+						cavity.push_back(neighbor);
+						continue;
+					}
+					_marks[neighbor] = outsideCavity;
+				}
+				if (neighbor < 0 || _marks[neighbor] == outsideCavity)
+					boundary.push_back(std::make_pair(cavity[i], facet));
+			}
+		}
+
+		//Each boundary facet with the new point replacing the opposite vertex keeps the orientation, since the
+		//cavity is star-shaped around the point. Two simplices share at most one facet with each other or the
+		//cavity, so each outside simplex's facet back to it is found before the removed slots are reused:
+		std::vector<simplex>& created = _created;
+		std::vector<int>& outsideFacets = _outsideFacets;
+		created.resize(boundary.size());
+		outsideFacets.assign(boundary.size(), -1);
+		for (size_t i = 0; i < boundary.size(); i++)
+		{
+			created[i] = _simplices[boundary[i].first];
+			created[i].vertices[boundary[i].second] = vertex;
+			int outside = created[i].neighbors[boundary[i].second];
+			for (int j = 0; outside >= 0 && j <= dimensions; j++)
+			{
+				if (_simplices[outside].neighbors[j] == boundary[i].first)
+					outsideFacets[i] = j;
+			}
+		}
+		for (int removed : cavity)
+			_freeSimplices.push_back(removed);
+		std::vector<int>& createdIndices = _createdIndices;
+		std::vector<ridge>& ridges = _ridges;
+		createdIndices.resize(boundary.size());
+		ridges.clear();
+		for (size_t i = 0; i < boundary.size(); i++)
+		{
+			int index = allocateSimplex();
+			createdIndices[i] = index;
+			_simplices[index] = created[i];
+			_marks[index] = 0;
+			int facet = boundary[i].second;
+			int outside = created[i].neighbors[facet];
+			if (outside >= 0)
+				_simplices[outside].neighbors[outsideFacets[i]] = index;
+			for (int j = 0; j <= dimensions; j++)
+			{
+				if (j == facet)
+					continue;
+				ridge shared;
+				shared.key[1] = -1;
+				for (int k = 0, position = 0; k <= dimensions; k++)
+				{
+					if (k != facet && k != j)
+						shared.key[position++] = created[i].vertices[k];
+				}
+				if (dimensions == 3 && shared.key[0] > shared.key[1])
+					std::swap(shared.key[0], shared.key[1]);
+				shared.simplex = index;
+				shared.facet = j;
+				ridges.push_back(shared);
+			}
+		}
+
+		//The new simplices meet in pairs along the facets through the new point:
+		std::sort(ridges.begin(), ridges.end());
+		for (size_t i = 0; i + 1 < ridges.size(); i += 2)
+		{
+			_simplices[ridges[i].simplex].neighbors[ridges[i].facet] = ridges[i + 1].simplex;
+			_simplices[ridges[i + 1].simplex].neighbors[ridges[i + 1].facet] = ridges[i].simplex;
+		}
+
+		for (int index : createdIndices)
+		{
+			for (int i = 0; i <= dimensions; i++)
+			{
+				int other = _simplices[index].vertices[i];
+				_vertexSimplices[other] = index;
+				if (other != vertex && other < _numPoints)
+					adjacentVertices.push_back(other);
+			}
+		}
+		_lastSimplex = createdIndices[0];
+		for (size_t level = 0; level < _cellVertices.size(); level++)
+			_cellVertices[level][getCell(coordinates, level)] = vertex;
+		std::sort(adjacentVertices.begin(), adjacentVertices.end());
+		adjacentVertices.erase(std::unique(adjacentVertices.begin(), adjacentVertices.end()), adjacentVertices.end());
+		return true;
+	}
+};
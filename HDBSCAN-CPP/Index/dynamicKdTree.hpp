@@ -0,0 +1,369 @@
+#pragma once
+#include<vector>
+#include<algorithm>
+#include<limits>
+#include<utility>
+#include"dynamicSpatialIndex.hpp"
+
+/// <summary>
+/// A node of a dynamicKdTree. Internal nodes route insertions by splitValue on splitAttribute; leaves hold
+/// the indices of their points.
+/// </summary>
+struct dynamicKdTreeNode
+{
+	int parent;
+	int left;
+	int right;
+	int splitAttribute;
+	double splitValue;
+	std::vector<int> points;
+};
+
+/// <summary>
+/// A kd-tree for a Minkowski-type distance (EuclideanDistance or ManhattanDistance) which points can be
+/// inserted into and removed from. Inserted points descend to a leaf, growing the bounding boxes on the way,
+/// and a leaf that fills up is split at the median of its widest attribute, so the tree stays as deep as a
+/// tree built over the same points at once as long as new points do not arrive in sorted order. Every node
+/// also keeps bounds on the core distances below it, which prune reverse and mutual reachability neighbor
+/// queries. Removals and changed core distances only loosen the boxes and bounds, which stay valid.
+/// </summary>
+template<class TDistance>
+class dynamicKdTree : public dynamicSpatialIndex
+{
+private:
+	int _numPoints;
+	int _numLivePoints;
+	int _numAttributes;
+	int _leafSize;
+	std::vector<double> _data;
+	std::vector<dynamicKdTreeNode> _nodes;
+	std::vector<double> _lowerBounds;
+	std::vector<double> _upperBounds;
+	std::vector<double> _minCoreDistances;
+	std::vector<double> _maxCoreDistances;
+	std::vector<int> _pointLeaves;
+	TDistance _distance;
+
+	int addNode(int parent)
+	{
+		int node = _nodes.size();
+		dynamicKdTreeNode treeNode;
+		treeNode.parent = parent;
+		treeNode.left = -1;
+		treeNode.right = -1;
+		treeNode.splitAttribute = 0;
+		treeNode.splitValue = 0;
+		_nodes.push_back(treeNode);
+		_lowerBounds.resize(_lowerBounds.size() + _numAttributes, std::numeric_limits<double>::max());
+		_upperBounds.resize(_upperBounds.size() + _numAttributes, -std::numeric_limits<double>::max());
+		_minCoreDistances.push_back(std::numeric_limits<double>::max());
+		_maxCoreDistances.push_back(0);
+		return node;
+	}
+
+	void growBounds(int node, const double* point)
+	{
+		double* lower = &_lowerBounds[(size_t)node * _numAttributes];
+		double* upper = &_upperBounds[(size_t)node * _numAttributes];
+		for (int attribute = 0; attribute < _numAttributes; attribute++)
+		{
+			lower[attribute] = std::min(lower[attribute], point[attribute]);
+			upper[attribute] = std::max(upper[attribute], point[attribute]);
+		}
+	}
+
+	/// <summary>
+	/// Splits a leaf holding more than leafSize points at the median of its widest attribute, and its
+	/// children too while they are still too large.
+	/// </summary>
+	void splitLeaf(int node)
+	{
+		if ((int)_nodes[node].points.size() <= _leafSize)
+			return;
+		const double* lower = &_lowerBounds[(size_t)node * _numAttributes];
+		const double* upper = &_upperBounds[(size_t)node * _numAttributes];
+		int splitAttribute = 0;
+		for (int attribute = 1; attribute < _numAttributes; attribute++)
+		{
+			if (upper[attribute] - lower[attribute] > upper[splitAttribute] - lower[splitAttribute])
+				splitAttribute = attribute;
+		}
+		if (upper[splitAttribute] == lower[splitAttribute])
+			return;
+
+		std::vector<int> points;
+		points.swap(_nodes[node].points);
+		size_t middle = points.size() / 2;
+		int numAttributes = _numAttributes;
+		const double* data = _data.data();
+		std::nth_element(points.begin(), points.begin() + middle, points.end(), [data, numAttributes, splitAttribute](int first, int second) {
+			return data[(size_t)first * numAttributes + splitAttribute] < data[(size_t)second * numAttributes + splitAttribute];
+		});
+		double splitValue = data[(size_t)points[middle] * numAttributes + splitAttribute];
+		if (splitValue == lower[splitAttribute])
+		{
+			//Most points share the lowest value, so they all go left and the rest right:
+			splitValue = upper[splitAttribute];
+			for (int point : points)
+			{
+				double value = data[(size_t)point * numAttributes + splitAttribute];
+				if (value > lower[splitAttribute] && value < splitValue)
+					splitValue = value;
+			}
+		}
+
+		//Route by value, so that later insertions with the same value go the same way:
+		int left = addNode(node);
+		int right = addNode(node);
+		_nodes[node].left = left;
+		_nodes[node].right = right;
+		_nodes[node].splitAttribute = splitAttribute;
+		_nodes[node].splitValue = splitValue;
+		for (int point : points)
+		{
+			int child = data[(size_t)point * numAttributes + splitAttribute] < splitValue ? left : right;
+			_nodes[child].points.push_back(point);
+			_pointLeaves[point] = child;
+			growBounds(child, data + (size_t)point * numAttributes);
+			_minCoreDistances[child] = _minCoreDistances[node];
+			_maxCoreDistances[child] = _maxCoreDistances[node];
+		}
+		splitLeaf(left);
+		splitLeaf(right);
+	}
+
+	double distanceToNode(TDistance& distance, const double* point, int node, double* nearestPoint)
+	{
+		const double* lower = &_lowerBounds[(size_t)node * _numAttributes];
+		const double* upper = &_upperBounds[(size_t)node * _numAttributes];
+		for (int attribute = 0; attribute < _numAttributes; attribute++)
+			nearestPoint[attribute] = std::min(std::max(point[attribute], lower[attribute]), upper[attribute]);
+		return distance.computeDistance(point, nearestPoint, _numAttributes);
+	}
+
+	void searchNode(TDistance& distance, const double* point, int node, double nodeDistance, int k, int& numFound, int* indices, double* distances, double* nearestPoint)
+	{
+		if (numFound == k && nodeDistance >= distances[k - 1])
+			return;
+		const dynamicKdTreeNode& treeNode = _nodes[node];
+		if (treeNode.left < 0)
+		{
+			for (int index : treeNode.points)
+			{
+				double pointDistance = distance.computeDistance(point, &_data[(size_t)index * _numAttributes], _numAttributes);
+				if (numFound == k && pointDistance >= distances[k - 1])
+					continue;
+				//Insert into the sorted neighbor list:
+				int position = numFound < k ? numFound++ : k - 1;
+				while (position > 0 && distances[position - 1] > pointDistance)
+				{
+					distances[position] = distances[position - 1];
+					indices[position] = indices[position - 1];
+					position--;
+				}
+				distances[position] = pointDistance;
+				indices[position] = index;
+			}
+			return;
+		}
+
+		double leftDistance = distanceToNode(distance, point, treeNode.left, nearestPoint);
+		double rightDistance = distanceToNode(distance, point, treeNode.right, nearestPoint);
+		if (leftDistance <= rightDistance)
+		{
+			searchNode(distance, point, treeNode.left, leftDistance, k, numFound, indices, distances, nearestPoint);
+			searchNode(distance, point, treeNode.right, rightDistance, k, numFound, indices, distances, nearestPoint);
+		}
+		else
+		{
+			searchNode(distance, point, treeNode.right, rightDistance, k, numFound, indices, distances, nearestPoint);
+			searchNode(distance, point, treeNode.left, leftDistance, k, numFound, indices, distances, nearestPoint);
+		}
+	}
+
+	void searchReachable(TDistance& distance, const double* point, int node, double nodeReachability, const std::vector<double>& coreDistances,
+		int k, int& numFound, int* indices, double* distances, double* reachabilities, double* nearestPoint)
+	{
+		if (numFound == k && nodeReachability >= reachabilities[k - 1])
+			return;
+		const dynamicKdTreeNode& treeNode = _nodes[node];
+		if (treeNode.left < 0)
+		{
+			for (int index : treeNode.points)
+			{
+				if (numFound == k && coreDistances[index] >= reachabilities[k - 1])
+					continue;
+				double pointDistance = distance.computeDistance(point, &_data[(size_t)index * _numAttributes], _numAttributes);
+				double reachability = std::max(pointDistance, coreDistances[index]);
+				if (numFound == k && reachability >= reachabilities[k - 1])
+					continue;
+				int position = numFound < k ? numFound++ : k - 1;
+				while (position > 0 && reachabilities[position - 1] > reachability)
+				{
+					reachabilities[position] = reachabilities[position - 1];
+					distances[position] = distances[position - 1];
+					indices[position] = indices[position - 1];
+					position--;
+				}
+				reachabilities[position] = reachability;
+				distances[position] = pointDistance;
+				indices[position] = index;
+			}
+			return;
+		}
+
+		double leftReachability = std::max(distanceToNode(distance, point, treeNode.left, nearestPoint), _minCoreDistances[treeNode.left]);
+		double rightReachability = std::max(distanceToNode(distance, point, treeNode.right, nearestPoint), _minCoreDistances[treeNode.right]);
+		if (leftReachability <= rightReachability)
+		{
+			searchReachable(distance, point, treeNode.left, leftReachability, coreDistances, k, numFound, indices, distances, reachabilities, nearestPoint);
+			searchReachable(distance, point, treeNode.right, rightReachability, coreDistances, k, numFound, indices, distances, reachabilities, nearestPoint);
+		}
+		else
+		{
+			searchReachable(distance, point, treeNode.right, rightReachability, coreDistances, k, numFound, indices, distances, reachabilities, nearestPoint);
+			searchReachable(distance, point, treeNode.left, leftReachability, coreDistances, k, numFound, indices, distances, reachabilities, nearestPoint);
+		}
+	}
+
+	void searchReverse(TDistance& distance, const double* point, int node, const std::vector<double>& coreDistances,
+		std::vector<std::pair<double, int>>& neighbors, double* nearestPoint)
+	{
+		if (distanceToNode(distance, point, node, nearestPoint) > _maxCoreDistances[node])
+			return;
+		const dynamicKdTreeNode& treeNode = _nodes[node];
+		if (treeNode.left < 0)
+		{
+			for (int index : treeNode.points)
+			{
+				double pointDistance = distance.computeDistance(point, &_data[(size_t)index * _numAttributes], _numAttributes);
+				if (pointDistance <= coreDistances[index])
+					neighbors.push_back(std::make_pair(pointDistance, index));
+			}
+			return;
+		}
+		searchReverse(distance, point, treeNode.left, coreDistances, neighbors, nearestPoint);
+		searchReverse(distance, point, treeNode.right, coreDistances, neighbors, nearestPoint);
+	}
+
+public:
+	/// <summary>
+	/// Builds the tree over an initial row-major dataset, which may be empty.
+	/// </summary>
+	/// <param name="dataset">numPoints rows of numAttributes doubles</param>
+	/// <param name="numPoints">The number of points</param>
+	/// <param name="numAttributes">The number of attributes of each point</param>
+	/// <param name="leafSize">The largest number of points kept in a leaf</param>
+	dynamicKdTree(const double* dataset, int numPoints, int numAttributes, int leafSize = 16)
+	{
+		_numPoints = numPoints;
+		_numLivePoints = numPoints;
+		_numAttributes = numAttributes;
+		_leafSize = leafSize < 1 ? 1 : leafSize;
+		_data.assign(dataset, dataset + (size_t)numPoints * numAttributes);
+		_pointLeaves.assign(numPoints, 0);
+		addNode(-1);
+		for (int i = 0; i < numPoints; i++)
+		{
+			_nodes[0].points.push_back(i);
+			growBounds(0, dataset + (size_t)i * numAttributes);
+		}
+		splitLeaf(0);
+	}
+
+	int insert(const double* point)
+	{
+		int index = _numPoints++;
+		_numLivePoints++;
+		_data.insert(_data.end(), point, point + _numAttributes);
+		int node = 0;
+		while (true)
+		{
+			growBounds(node, point);
+			const dynamicKdTreeNode& treeNode = _nodes[node];
+			if (treeNode.left < 0)
+				break;
+			node = point[treeNode.splitAttribute] < treeNode.splitValue ? treeNode.left : treeNode.right;
+		}
+		_nodes[node].points.push_back(index);
+		_pointLeaves.push_back(node);
+		splitLeaf(node);
+		return index;
+	}
+
+	void remove(int point)
+	{
+		std::vector<int>& points = _nodes[_pointLeaves[point]].points;
+		std::vector<int>::iterator it = std::find(points.begin(), points.end(), point);
+		if (it == points.end())
+			return;
+		*it = points.back();
+		points.pop_back();
+		_numLivePoints--;
+	}
+
+	void updateCoreDistance(int point, double coreDistance)
+	{
+		for (int node = _pointLeaves[point]; node >= 0; node = _nodes[node].parent)
+		{
+			if (_minCoreDistances[node] <= coreDistance && _maxCoreDistances[node] >= coreDistance)
+				break;
+			_minCoreDistances[node] = std::min(_minCoreDistances[node], coreDistance);
+			_maxCoreDistances[node] = std::max(_maxCoreDistances[node], coreDistance);
+		}
+	}
+
+	int queryReachableNeighbors(const double* point, int k, const std::vector<double>& coreDistances, int* indices, double* distances)
+	{
+		if (k > _numLivePoints)
+			k = _numLivePoints;
+		if (k <= 0)
+			return 0;
+		TDistance distance = _distance;
+		std::vector<double> nearestPoint(_numAttributes);
+		std::vector<double> reachabilities(k);
+		int numFound = 0;
+		double rootReachability = std::max(distanceToNode(distance, point, 0, nearestPoint.data()), _minCoreDistances[0]);
+		searchReachable(distance, point, 0, rootReachability, coreDistances, k, numFound, indices, distances, reachabilities.data(), nearestPoint.data());
+		return numFound;
+	}
+
+	void queryReverseNeighbors(const double* point, const std::vector<double>& coreDistances, std::vector<std::pair<double, int>>& neighbors)
+	{
+		neighbors.clear();
+		if (_numLivePoints == 0)
+			return;
+		TDistance distance = _distance;
+		std::vector<double> nearestPoint(_numAttributes);
+		searchReverse(distance, point, 0, coreDistances, neighbors, nearestPoint.data());
+	}
+
+	int queryNearestNeighbors(const double* point, int k, int* indices, double* distances)
+	{
+		if (k > _numLivePoints)
+			k = _numLivePoints;
+		if (k <= 0)
+			return 0;
+		TDistance distance = _distance;
+		std::vector<double> nearestPoint(_numAttributes);
+		int numFound = 0;
+		double rootDistance = distanceToNode(distance, point, 0, nearestPoint.data());
+		searchNode(distance, point, 0, rootDistance, k, numFound, indices, distances, nearestPoint.data());
+		return numFound;
+	}
+
+	const double* getPoint(int point)
+	{
+		return &_data[(size_t)point * _numAttributes];
+	}
+
+	int getNumPoints()
+	{
+		return _numPoints;
+	}
+
+	int getNumAttributes()
+	{
+		return _numAttributes;
+	}
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include<vector>
+#include<utility>
+#include"spatialIndex.hpp"
+/// <summary>
+/// An interface for indexes which points can be inserted into and removed from, and which also find the points
+/// that have a query point within their core distance (the reverse k nearest neighbors, for the k of the core
+/// distances). Removed points keep their index but are no longer found by queries.
+/// </summary>
+class dynamicSpatialIndex : public spatialIndex
+{
+public:
+	/// <summary>
+	/// Copies a point into the index.
+	/// </summary>
+	/// <returns>The index of the point, which is the number of points inserted before it</returns>
+	virtual int insert(const double* point)=0;
+
+	/// <summary>
+	/// Removes an indexed point from the results of every later query.
+	/// </summary>
+	virtual void remove(int point)=0;
+
+	/// <summary>
+	/// Records the core distance of a new point, or the changed core distance of an indexed one, for the
+	/// queries which take core distances.
+	/// </summary>
+	virtual void updateCoreDistance(int point, double coreDistance)=0;
+
+	/// <summary>
+	/// Finds the k indexed points with the smallest mutual reachability from the query point, leaving out its
+	/// own core distance, which is the same for all of them: the largest of the distance and the point's core distance.
+	/// </summary>
+	/// <param name="point">The attributes of the query point</param>
+	/// <param name="k">The number of neighbors to find</param>
+	/// <param name="coreDistances">The current core distance of every indexed point</param>
+	/// <param name="indices">Receives the indices of the neighbors, most reachable first</param>
+	/// <param name="distances">Receives the distances to the neighbors</param>
+	/// <returns>The number of neighbors found, which is k unless fewer points are indexed</returns>
+	virtual int queryReachableNeighbors(const double* point, int k, const std::vector<double>& coreDistances, int* indices, double* distances)=0;
+
+	/// <summary>
+	/// Finds every indexed point which is not farther from the query point than its core distance.
+	/// </summary>
+	/// <param name="point">The attributes of the query point</param>
+	/// <param name="coreDistances">The current core distance of every indexed point</param>
+	/// <param name="neighbors">Receives (distance, index) pairs of the points found, in no particular order</param>
+	virtual void queryReverseNeighbors(const double* point, const std::vector<double>& coreDistances, std::vector<std::pair<double, int>>& neighbors)=0;
+
+	virtual const double* getPoint(int point)=0;
+};
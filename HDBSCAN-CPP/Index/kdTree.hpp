@@ -0,0 +1,232 @@
+#pragma once
+#include<vector>
+#include<algorithm>
+#include<limits>
+#include"spatialIndex.hpp"
+#include"../Utils/sharedArray.hpp"
+
+/// <summary>
+/// A node of a kdTree: the rows [start, end) in tree order and the child nodes (-1 for a leaf).
+/// </summary>
+struct kdTreeNode
+{
+	int start;
+	int end;
+	int left;
+	int right;
+};
+
+/// <summary>
+/// A kd-tree over a fixed set of points for a Minkowski-type distance (EuclideanDistance or
+/// ManhattanDistance). Nodes store axis-aligned bounding boxes, and the distance from a query to the
+/// nearest point of a box is used to prune nodes. Points are copied into tree order, so every leaf is a
+/// contiguous block of rows. All arrays are flat, so a tree can also be wrapped around a mapped file.
+/// </summary>
+template<class TDistance>
+class kdTree : public spatialIndex
+{
+private:
+	int _numPoints;
+	int _numAttributes;
+	sharedArray<double> _data;
+	sharedArray<int> _indices;
+	sharedArray<kdTreeNode> _nodes;
+	sharedArray<double> _lowerBounds;
+	sharedArray<double> _upperBounds;
+	TDistance _distance;
+
+	int buildNode(const double* dataset, int leafSize, std::vector<int>& indices, std::vector<kdTreeNode>& nodes, std::vector<double>& lowerBounds, std::vector<double>& upperBounds, int start, int end)
+	{
+		int node = nodes.size();
+		kdTreeNode treeNode = { start, end, -1, -1 };
+		nodes.push_back(treeNode);
+		lowerBounds.resize(lowerBounds.size() + _numAttributes, std::numeric_limits<double>::max());
+		upperBounds.resize(upperBounds.size() + _numAttributes, -std::numeric_limits<double>::max());
+		double* lower = &lowerBounds[(size_t)node * _numAttributes];
+		double* upper = &upperBounds[(size_t)node * _numAttributes];
+		for (int i = start; i < end; i++)
+		{
+			const double* row = dataset + (size_t)indices[i] * _numAttributes;
+			for (int attribute = 0; attribute < _numAttributes; attribute++)
+			{
+				lower[attribute] = std::min(lower[attribute], row[attribute]);
+				upper[attribute] = std::max(upper[attribute], row[attribute]);
+			}
+		}
+		if (end - start <= leafSize)
+			return node;
+
+		//Split at the median of the widest attribute:
+		int splitAttribute = 0;
+		for (int attribute = 1; attribute < _numAttributes; attribute++)
+		{
+			if (upper[attribute] - lower[attribute] > upper[splitAttribute] - lower[splitAttribute])
+				splitAttribute = attribute;
+		}
+		if (upper[splitAttribute] == lower[splitAttribute])
+			return node;
+
+		int middle = start + (end - start) / 2;
+		int numAttributes = _numAttributes;
+		std::nth_element(indices.begin() + start, indices.begin() + middle, indices.begin() + end,
+			[dataset, numAttributes, splitAttribute](int first, int second) {
+				return dataset[(size_t)first * numAttributes + splitAttribute] < dataset[(size_t)second * numAttributes + splitAttribute];
+			});
+		int left = buildNode(dataset, leafSize, indices, nodes, lowerBounds, upperBounds, start, middle);
+		int right = buildNode(dataset, leafSize, indices, nodes, lowerBounds, upperBounds, middle, end);
+		nodes[node].left = left;
+		nodes[node].right = right;
+		return node;
+	}
+
+	double distanceToNode(TDistance& distance, const double* point, int node, double* nearestPoint)
+	{
+		const double* lower = &_lowerBounds[(size_t)node * _numAttributes];
+		const double* upper = &_upperBounds[(size_t)node * _numAttributes];
+		for (int attribute = 0; attribute < _numAttributes; attribute++)
+			nearestPoint[attribute] = std::min(std::max(point[attribute], lower[attribute]), upper[attribute]);
+		return distance.computeDistance(point, nearestPoint, _numAttributes);
+	}
+
+	void searchNode(TDistance& distance, const double* point, int node, double nodeDistance, int k, int& numFound, int* indices, double* distances, double* nearestPoint)
+	{
+		if (numFound == k && nodeDistance >= distances[k - 1])
+			return;
+		const kdTreeNode& treeNode = _nodes[node];
+		if (treeNode.left < 0)
+		{
+			for (int i = treeNode.start; i < treeNode.end; i++)
+			{
+				double pointDistance = distance.computeDistance(point, &_data[(size_t)i * _numAttributes], _numAttributes);
+				if (numFound == k && pointDistance >= distances[k - 1])
+					continue;
+				//Insert into the sorted neighbor list:
+				int position = numFound < k ? numFound++ : k - 1;
+				while (position > 0 && distances[position - 1] > pointDistance)
+				{
+					distances[position] = distances[position - 1];
+					indices[position] = indices[position - 1];
+					position--;
+				}
+				distances[position] = pointDistance;
+				indices[position] = _indices[i];
+			}
+			return;
+		}
+
+		double leftDistance = distanceToNode(distance, point, treeNode.left, nearestPoint);
+		double rightDistance = distanceToNode(distance, point, treeNode.right, nearestPoint);
+		if (leftDistance <= rightDistance)
+		{
+			searchNode(distance, point, treeNode.left, leftDistance, k, numFound, indices, distances, nearestPoint);
+			searchNode(distance, point, treeNode.right, rightDistance, k, numFound, indices, distances, nearestPoint);
+		}
+		else
+		{
+			searchNode(distance, point, treeNode.right, rightDistance, k, numFound, indices, distances, nearestPoint);
+			searchNode(distance, point, treeNode.left, leftDistance, k, numFound, indices, distances, nearestPoint);
+		}
+	}
+
+public:
+	/// <summary>
+	/// Builds the tree over a row-major dataset.
+	/// </summary>
+	/// <param name="dataset">numPoints rows of numAttributes doubles</param>
+	/// <param name="numPoints">The number of points</param>
+	/// <param name="numAttributes">The number of attributes of each point</param>
+	/// <param name="leafSize">The largest number of points kept in a leaf</param>
+	kdTree(const double* dataset, int numPoints, int numAttributes, int leafSize = 16)
+	{
+		_numPoints = numPoints;
+		_numAttributes = numAttributes;
+		std::vector<int> indices(numPoints);
+		std::vector<kdTreeNode> nodes;
+		std::vector<double> lowerBounds;
+		std::vector<double> upperBounds;
+		for (int i = 0; i < numPoints; i++)
+			indices[i] = i;
+		if (numPoints > 0)
+			buildNode(dataset, leafSize < 1 ? 1 : leafSize, indices, nodes, lowerBounds, upperBounds, 0, numPoints);
+
+		std::vector<double> data((size_t)numPoints * numAttributes);
+		for (int i = 0; i < numPoints; i++)
+			std::copy(dataset + (size_t)indices[i] * numAttributes, dataset + (size_t)indices[i] * numAttributes + numAttributes, data.begin() + (size_t)i * numAttributes);
+
+		_data = data;
+		_indices = indices;
+		_nodes = nodes;
+		_lowerBounds = lowerBounds;
+		_upperBounds = upperBounds;
+	}
+
+	/// <summary>
+	/// Wraps the arrays of an existing tree, for example ones viewed from a model file.
+	/// </summary>
+	kdTree(int numPoints, int numAttributes, sharedArray<double> data, sharedArray<int> indices, sharedArray<kdTreeNode> nodes, sharedArray<double> lowerBounds, sharedArray<double> upperBounds)
+	{
+		_numPoints = numPoints;
+		_numAttributes = numAttributes;
+		_data = data;
+		_indices = indices;
+		_nodes = nodes;
+		_lowerBounds = lowerBounds;
+		_upperBounds = upperBounds;
+	}
+
+	int queryNearestNeighbors(const double* point, int k, int* indices, double* distances)
+	{
+		if (k > _numPoints)
+			k = _numPoints;
+		if (k <= 0)
+			return 0;
+		TDistance distance = _distance;
+		std::vector<double> nearestPoint(_numAttributes);
+		int numFound = 0;
+		double rootDistance = distanceToNode(distance, point, 0, nearestPoint.data());
+		searchNode(distance, point, 0, rootDistance, k, numFound, indices, distances, nearestPoint.data());
+		return numFound;
+	}
+
+	int getNumPoints()
+	{
+		return _numPoints;
+	}
+
+	int getNumAttributes()
+	{
+		return _numAttributes;
+	}
+
+	/// <summary>
+	/// The points in tree order.
+	/// </summary>
+	sharedArray<double>& getData()
+	{
+		return _data;
+	}
+
+	/// <summary>
+	/// The original index of each point in tree order.
+	/// </summary>
+	sharedArray<int>& getIndices()
+	{
+		return _indices;
+	}
+
+	sharedArray<kdTreeNode>& getNodes()
+	{
+		return _nodes;
+	}
+
+	sharedArray<double>& getLowerBounds()
+	{
+		return _lowerBounds;
+	}
+
+	sharedArray<double>& getUpperBounds()
+	{
+		return _upperBounds;
+	}
+};
+
@@ -0,0 +1,197 @@
+#pragma once
+#include<vector>
+#include<algorithm>
+#include<limits>
+#include<thread>
+#include"../Utils/parallelFor.hpp"
+#include"../Dataset/datasetRows.hpp"
+
+/// <summary>
+/// A node of a metricTree: the points [start, end) in tree order, the child nodes (-1 for a leaf), the point
+/// the node's ball is centered on and the radius of that ball.
+/// </summary>
+struct metricTreeNode
+{
+	int start;
+	int end;
+	int left;
+	int right;
+	int center;
+	double radius;
+};
+
+/// <summary>
+/// A ball tree whose balls are centered on points of the data set instead of centroids, so that it only needs
+/// distances between points: it works on any row view (denseRows, csrRows, bitRows or codeRows) with any
+/// distance policy which satisfies the triangle inequality, and keeps no copy of the rows.
+///
+/// Each node is split by two pivots, a point far from the node's first point and the point farthest from
+/// that one, at the median of the difference of the distances to the pivots. The ball is centered on the
+/// point whose larger distance to the two pivots is the smallest. Like ballTree, nodes are stored in depth-first
+/// order in a layout fixed by the node sizes, so subtrees are built in parallel straight into their slots.
+/// </summary>
+template<class TDistance, class TRows = denseRows>
+class metricTree
+{
+private:
+	TRows _rows;
+	int _numPoints;
+	int _leafSize;
+	std::vector<int> _indices;
+	std::vector<double> _centerDistances;
+	std::vector<metricTreeNode> _nodes;
+	TDistance _distance;
+
+	static int countNodes(int numPoints, int leafSize)
+	{
+		if (numPoints <= leafSize)
+			return 1;
+		int leftPoints = numPoints / 2;
+		return 1 + countNodes(leftPoints, leafSize) + countNodes(numPoints - leftPoints, leafSize);
+	}
+
+	double computeDistance(TDistance& distance, int pointOne, int pointTwo)
+	{
+		return distance.computeDistance(_rows.getRow(pointOne), _rows.getRow(pointTwo), _rows.getNumAttributes());
+	}
+
+	void buildNode(int node, int start, int end, int parallelDepth)
+	{
+		TDistance distance = _distance;
+		int numNodePoints = end - start;
+		std::vector<double> firstDistances(numNodePoints);
+		std::vector<double> secondDistances(numNodePoints);
+		for (int i = 0; i < numNodePoints; i++)
+			firstDistances[i] = computeDistance(distance, _indices[start], _indices[start + i]);
+		int firstPivot = _indices[start + (std::max_element(firstDistances.begin(), firstDistances.end()) - firstDistances.begin())];
+		for (int i = 0; i < numNodePoints; i++)
+			firstDistances[i] = computeDistance(distance, firstPivot, _indices[start + i]);
+		int secondPivot = _indices[start + (std::max_element(firstDistances.begin(), firstDistances.end()) - firstDistances.begin())];
+		int center = 0;
+		for (int i = 0; i < numNodePoints; i++)
+		{
+			secondDistances[i] = computeDistance(distance, secondPivot, _indices[start + i]);
+			if (std::max(firstDistances[i], secondDistances[i]) < std::max(firstDistances[center], secondDistances[center]))
+				center = i;
+		}
+		center = _indices[start + center];
+		//Every node measures its points from its center, and the leaves, built last, keep their distances:
+		double radius = 0;
+		for (int i = start; i < end; i++)
+		{
+			_centerDistances[i] = computeDistance(distance, center, _indices[i]);
+			radius = std::max(radius, _centerDistances[i]);
+		}
+
+		metricTreeNode treeNode = { start, end, -1, -1, center, radius };
+		_nodes[node] = treeNode;
+		if (numNodePoints <= _leafSize)
+			return;
+
+		//Split at the median of the difference of the distances to the pivots:
+		std::vector<std::pair<double, int>> keys(numNodePoints);
+		for (int i = 0; i < numNodePoints; i++)
+			keys[i] = std::make_pair(firstDistances[i] - secondDistances[i], _indices[start + i]);
+		std::vector<double>().swap(firstDistances);
+		std::vector<double>().swap(secondDistances);
+		int middle = numNodePoints / 2;
+		std::nth_element(keys.begin(), keys.begin() + middle, keys.end());
+		for (int i = 0; i < numNodePoints; i++)
+			_indices[start + i] = keys[i].second;
+		std::vector<std::pair<double, int>>().swap(keys);
+		middle += start;
+		int left = node + 1;
+		int right = left + countNodes(middle - start, _leafSize);
+		_nodes[node].left = left;
+		_nodes[node].right = right;
+
+		if (parallelDepth > 0)
+		{
+			std::thread leftThread(&metricTree::buildNode, this, left, start, middle, parallelDepth - 1);
+			buildNode(right, middle, end, parallelDepth - 1);
+			leftThread.join();
+		}
+		else
+		{
+			buildNode(left, start, middle, 0);
+			buildNode(right, middle, end, 0);
+		}
+	}
+
+public:
+	/// <summary>
+	/// Builds the tree over the points in a row view, whose rows must outlive the tree.
+	/// </summary>
+	/// <param name="rows">The points</param>
+	/// <param name="numPoints">The number of points</param>
+	/// <param name="leafSize">The largest number of points kept in a leaf</param>
+	/// <param name="numThreads">The number of threads building subtrees; 0 uses all hardware threads</param>
+	/// <param name="distance">The distance policy, for policies that hold state such as quantization tables</param>
+	metricTree(const TRows& rows, int numPoints, int leafSize = 16, int numThreads = 1, const TDistance& distance = TDistance())
+		: _rows(rows), _distance(distance)
+	{
+		_numPoints = numPoints;
+		_leafSize = leafSize < 1 ? 1 : leafSize;
+		_indices.resize(numPoints);
+		for (int i = 0; i < numPoints; i++)
+			_indices[i] = i;
+		_centerDistances.resize(numPoints);
+		if (numPoints > 0)
+		{
+			_nodes.resize(countNodes(numPoints, _leafSize));
+			int parallelDepth = 0;
+			for (int threads = resolveNumThreads(numThreads); threads > 1; threads /= 2)
+				parallelDepth++;
+			buildNode(0, 0, numPoints, parallelDepth);
+		}
+	}
+
+	/// <summary>
+	/// The distance from a point, given by its index, to the center of a node. Less the node's radius, it
+	/// bounds the distance to every point of the node, and its difference with getCenterDistances() bounds
+	/// the distance to each point of a leaf.
+	/// </summary>
+	double centerDistance(TDistance& distance, int point, int node)
+	{
+		return computeDistance(distance, point, _nodes[node].center);
+	}
+
+	int getNumPoints()
+	{
+		return _numPoints;
+	}
+
+	TDistance& getDistance()
+	{
+		return _distance;
+	}
+
+	const TRows& getRows()
+	{
+		return _rows;
+	}
+
+	/// <summary>
+	/// The nodes in depth-first order; the root is node 0 and children follow their parents.
+	/// </summary>
+	const std::vector<metricTreeNode>& getNodes()
+	{
+		return _nodes;
+	}
+
+	/// <summary>
+	/// The distance from each point, in tree order, to the center of its leaf.
+	/// </summary>
+	const std::vector<double>& getCenterDistances()
+	{
+		return _centerDistances;
+	}
+
+	/// <summary>
+	/// The index of each point in tree order.
+	/// </summary>
+	const std::vector<int>& getIndices()
+	{
+		return _indices;
+	}
+};
@@ -0,0 +1,426 @@
+#pragma once
+#include<vector>
+#include<algorithm>
+#include<limits>
+#include<mutex>
+#include<cstdint>
+#include<cmath>
+#include"../Utils/parallelFor.hpp"
+#include"../Dataset/datasetRows.hpp"
+
+/// <summary>
+/// Settings of an nnDescent build.
+/// </summary>
+/// <param name="sampleRate">The fraction of each neighbor list taken into the local joins of an iteration</param>
+/// <param name="terminationRate">Stop once fewer than this fraction of the n * k graph entries changed in an iteration</param>
+/// <param name="maxIterations">The largest number of iterations</param>
+/// <param name="seed">Seeds the random initial graph and the sampling</param>
+struct nnDescentOptions
+{
+	double sampleRate = 0.5;
+	double terminationRate = 0.001;
+	int maxIterations = 12;
+	uint64_t seed = 42;
+};
+
+/// <summary>
+/// An approximate k-nearest-neighbor graph built with NN-Descent (Dong, Charikar and Li, 2011): starting from
+/// random neighbors, every iteration joins the sampled neighbors (and reverse neighbors) of each point with each
+/// other, on the premise that a neighbor of a neighbor is likely a neighbor. It needs no index over the space,
+/// so unlike the trees it keeps working for embeddings with hundreds of dimensions.
+///
+/// Local joins run in parallel and only propose updates, which are applied afterwards, grouped by the point
+/// whose list they change; for a fixed seed and thread count the graph is deterministic. A point's own row is
+/// never one of its neighbors. Points are read through a row view, denseRows by default, or csrRows, bitRows or
+/// codeRows with a distance policy for sparse, binary or quantized data.
+/// </summary>
+template<class TDistance, class TRows = denseRows>
+class nnDescent
+{
+private:
+	struct neighborUpdate
+	{
+		int point;
+		int neighbor;
+		double distance;
+	};
+
+	TRows _rows;
+	int _numPoints;
+	int _numNeighbors;
+	int _numIterations;
+	std::vector<int> _neighbors;
+	std::vector<double> _distances;
+	std::vector<char> _isNew;
+	TDistance _distance;
+
+	static uint64_t nextRandom(uint64_t& state)
+	{
+		uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+	double computeDistance(TDistance& distance, int pointOne, int pointTwo)
+	{
+		return distance.computeDistance(_rows.getRow(pointOne), _rows.getRow(pointTwo), _rows.getNumAttributes());
+	}
+
+	/// <summary>
+	/// Offers a neighbor to a point's list, which is a max-heap on distance; returns whether the list changed.
+	/// </summary>
+	bool push(int point, int neighbor, double distance)
+	{
+		int* neighbors = &_neighbors[(size_t)point * _numNeighbors];
+		double* distances = &_distances[(size_t)point * _numNeighbors];
+		char* isNew = &_isNew[(size_t)point * _numNeighbors];
+		if (distance >= distances[0])
+			return false;
+		for (int i = 0; i < _numNeighbors; i++)
+		{
+			if (neighbors[i] == neighbor)
+				return false;
+		}
+
+		int position = 0;
+		while (true)
+		{
+			int child = 2 * position + 1;
+			if (child >= _numNeighbors)
+				break;
+			if (child + 1 < _numNeighbors && distances[child + 1] > distances[child])
+				child++;
+			if (distances[child] <= distance)
+				break;
+			neighbors[position] = neighbors[child];
+			distances[position] = distances[child];
+			isNew[position] = isNew[child];
+			position = child;
+		}
+		neighbors[position] = neighbor;
+		distances[position] = distance;
+		isNew[position] = 1;
+		return true;
+	}
+
+	void initialize(uint64_t seed, int numThreads)
+	{
+		parallelFor(0, _numPoints, numThreads, [&](int begin, int end) {
+			TDistance distance = _distance;
+			for (int point = begin; point < end; point++)
+			{
+				uint64_t state = seed ^ ((uint64_t)point * 0xD1B54A32D192ED03ULL);
+				int numFilled = 0;
+				while (numFilled < _numNeighbors)
+				{
+					int neighbor = nextRandom(state) % (uint64_t)_numPoints;
+					if (neighbor != point && push(point, neighbor, computeDistance(distance, point, neighbor)))
+						numFilled++;
+				}
+			}
+		});
+	}
+
+	/// <summary>
+	/// Adds a reverse candidate to a list capped at sampleSize, replacing a random entry once it is full.
+	/// </summary>
+	static void sampleInto(std::vector<int>& candidates, int& numSeen, int candidate, int sampleSize, uint64_t& state)
+	{
+		numSeen++;
+		if ((int)candidates.size() < sampleSize)
+			candidates.push_back(candidate);
+		else
+		{
+			uint64_t slot = nextRandom(state) % (uint64_t)numSeen;
+			if (slot < (uint64_t)sampleSize)
+				candidates[slot] = candidate;
+		}
+	}
+
+	/// <summary>
+	/// Runs one iteration and returns the number of list entries it changed.
+	/// </summary>
+	long long iterate(int iteration, const nnDescentOptions& options, int numThreads)
+	{
+		int sampleSize = std::max(1, (int)std::ceil(options.sampleRate * _numNeighbors));
+		std::vector<std::vector<int>> newCandidates(_numPoints);
+		std::vector<std::vector<int>> oldCandidates(_numPoints);
+
+		//Sample each point's new neighbors for this iteration's joins; they become old ones afterwards:
+		parallelFor(0, _numPoints, numThreads, [&](int begin, int end) {
+			std::vector<int> newPositions;
+			for (int point = begin; point < end; point++)
+			{
+				uint64_t state = options.seed ^ ((uint64_t)(iteration + 1) << 32) ^ ((uint64_t)point * 0x9E3779B97F4A7C15ULL);
+				size_t offset = (size_t)point * _numNeighbors;
+				newPositions.clear();
+				for (int i = 0; i < _numNeighbors; i++)
+				{
+					if (_isNew[offset + i])
+						newPositions.push_back(i);
+					else
+						oldCandidates[point].push_back(_neighbors[offset + i]);
+				}
+				for (int i = 0; i < (int)newPositions.size() && i < sampleSize; i++)
+				{
+					int chosen = i + nextRandom(state) % (uint64_t)(newPositions.size() - i);
+					std::swap(newPositions[i], newPositions[chosen]);
+					_isNew[offset + newPositions[i]] = 0;
+					newCandidates[point].push_back(_neighbors[offset + newPositions[i]]);
+				}
+			}
+		});
+
+		//Add sampled reverse neighbors, so that points that are often chosen as neighbors join their choosers:
+		std::vector<std::vector<int>> newReverse(_numPoints);
+		std::vector<std::vector<int>> oldReverse(_numPoints);
+		std::vector<int> newSeen(_numPoints, 0);
+		std::vector<int> oldSeen(_numPoints, 0);
+		uint64_t state = options.seed ^ ((uint64_t)(iteration + 1) * 0xBF58476D1CE4E5B9ULL);
+		for (int point = 0; point < _numPoints; point++)
+		{
+			for (int neighbor : newCandidates[point])
+				sampleInto(newReverse[neighbor], newSeen[neighbor], point, sampleSize, state);
+			for (int neighbor : oldCandidates[point])
+				sampleInto(oldReverse[neighbor], oldSeen[neighbor], point, sampleSize, state);
+		}
+		parallelFor(0, _numPoints, numThreads, [&](int begin, int end) {
+			for (int point = begin; point < end; point++)
+			{
+				std::vector<int>& newList = newCandidates[point];
+				newList.insert(newList.end(), newReverse[point].begin(), newReverse[point].end());
+				std::sort(newList.begin(), newList.end());
+				newList.erase(std::unique(newList.begin(), newList.end()), newList.end());
+				std::vector<int>& oldList = oldCandidates[point];
+				oldList.insert(oldList.end(), oldReverse[point].begin(), oldReverse[point].end());
+				std::sort(oldList.begin(), oldList.end());
+				oldList.erase(std::unique(oldList.begin(), oldList.end()), oldList.end());
+			}
+		});
+
+		//Join new candidates with each other and with the old ones. Proposals that cannot enter a list at its
+		//current worst distance are dropped on the spot; the rest are applied below, grouped by point.
+		std::vector<double> thresholds(_numPoints);
+		for (int point = 0; point < _numPoints; point++)
+			thresholds[point] = _distances[(size_t)point * _numNeighbors];
+		int numBuckets = resolveNumThreads(numThreads) * 4;
+		std::vector<std::pair<int, std::vector<std::vector<neighborUpdate>>>> chunkUpdates;
+		std::mutex chunkMutex;
+		parallelFor(0, _numPoints, numThreads, [&](int begin, int end) {
+			TDistance distance = _distance;
+			std::vector<std::vector<neighborUpdate>> buckets(numBuckets);
+			auto propose = [&](int pointOne, int pointTwo) {
+				if (pointOne == pointTwo)
+					return;
+				double pointDistance = computeDistance(distance, pointOne, pointTwo);
+				if (pointDistance < thresholds[pointOne])
+					buckets[(long long)pointOne * numBuckets / _numPoints].push_back({ pointOne, pointTwo, pointDistance });
+				if (pointDistance < thresholds[pointTwo])
+					buckets[(long long)pointTwo * numBuckets / _numPoints].push_back({ pointTwo, pointOne, pointDistance });
+			};
+			for (int point = begin; point < end; point++)
+			{
+				const std::vector<int>& newList = newCandidates[point];
+				const std::vector<int>& oldList = oldCandidates[point];
+				for (size_t i = 0; i < newList.size(); i++)
+				{
+					for (size_t j = i + 1; j < newList.size(); j++)
+						propose(newList[i], newList[j]);
+					for (int other : oldList)
+						propose(newList[i], other);
+				}
+			}
+			std::lock_guard<std::mutex> lock(chunkMutex);
+			chunkUpdates.push_back(std::make_pair(begin, std::move(buckets)));
+		});
+		std::sort(chunkUpdates.begin(), chunkUpdates.end(),
+			[](const std::pair<int, std::vector<std::vector<neighborUpdate>>>& a, const std::pair<int, std::vector<std::vector<neighborUpdate>>>& b) {
+				return a.first < b.first;
+			});
+
+		std::vector<long long> bucketChanges(numBuckets, 0);
+		parallelFor(0, numBuckets, numThreads, [&](int begin, int end) {
+			for (int bucket = begin; bucket < end; bucket++)
+			{
+				for (const auto& chunk : chunkUpdates)
+				{
+					for (const neighborUpdate& update : chunk.second[bucket])
+					{
+						if (push(update.point, update.neighbor, update.distance))
+							bucketChanges[bucket]++;
+					}
+				}
+			}
+		});
+		long long numChanges = 0;
+		for (long long changes : bucketChanges)
+			numChanges += changes;
+		return numChanges;
+	}
+
+	void build(int numPoints, int numNeighbors, const nnDescentOptions& options, int numThreads)
+	{
+		_numPoints = numPoints;
+		_numNeighbors = std::max(0, std::min(numNeighbors, numPoints - 1));
+		_numIterations = 0;
+		_neighbors.assign((size_t)_numPoints * _numNeighbors, -1);
+		_distances.assign((size_t)_numPoints * _numNeighbors, std::numeric_limits<double>::infinity());
+		_isNew.assign((size_t)_numPoints * _numNeighbors, 1);
+		if (_numNeighbors == 0)
+			return;
+
+		initialize(options.seed, numThreads);
+		while (_numIterations < options.maxIterations)
+		{
+			long long numChanges = iterate(_numIterations, options, numThreads);
+			_numIterations++;
+			if (numChanges < options.terminationRate * _numPoints * _numNeighbors)
+				break;
+		}
+
+		//Sort every list by distance:
+		parallelFor(0, _numPoints, numThreads, [&](int begin, int end) {
+			std::vector<std::pair<double, int>> entries(_numNeighbors);
+			for (int point = begin; point < end; point++)
+			{
+				size_t offset = (size_t)point * _numNeighbors;
+				for (int i = 0; i < _numNeighbors; i++)
+					entries[i] = std::make_pair(_distances[offset + i], _neighbors[offset + i]);
+				std::sort(entries.begin(), entries.end());
+				for (int i = 0; i < _numNeighbors; i++)
+				{
+					_distances[offset + i] = entries[i].first;
+					_neighbors[offset + i] = entries[i].second;
+				}
+			}
+		});
+		_isNew.clear();
+	}
+
+public:
+	/// <summary>
+	/// Builds the k-nearest-neighbor graph of a row-major dataset, which must outlive the graph.
+	/// </summary>
+	/// <param name="dataset">numPoints rows of numAttributes values each</param>
+	/// <param name="numPoints">The number of points</param>
+	/// <param name="numAttributes">The number of attributes of each point</param>
+	/// <param name="numNeighbors">The neighbors kept per point, at most numPoints - 1</param>
+	/// <param name="options">The sampling and termination settings</param>
+	/// <param name="numThreads">The number of threads; 0 uses all hardware threads</param>
+	nnDescent(const double* dataset, int numPoints, int numAttributes, int numNeighbors,
+		const nnDescentOptions& options = nnDescentOptions(), int numThreads = 1)
+		: _rows(dataset, numAttributes)
+	{
+		build(numPoints, numNeighbors, options, numThreads);
+	}
+
+	/// <summary>
+	/// Builds the k-nearest-neighbor graph of the points in a row view, whose rows must outlive the graph.
+	/// </summary>
+	/// <param name="rows">The points</param>
+	/// <param name="numPoints">The number of points</param>
+	/// <param name="numNeighbors">The neighbors kept per point, at most numPoints - 1</param>
+	/// <param name="options">The sampling and termination settings</param>
+	/// <param name="numThreads">The number of threads; 0 uses all hardware threads</param>
+	/// <param name="distance">The distance policy, for policies that hold state such as quantization tables</param>
+	nnDescent(const TRows& rows, int numPoints, int numNeighbors, const nnDescentOptions& options = nnDescentOptions(), int numThreads = 1,
+		const TDistance& distance = TDistance())
+		: _rows(rows), _distance(distance)
+	{
+		build(numPoints, numNeighbors, options, numThreads);
+	}
+
+	/// <summary>
+	/// Estimates the recall of the graph: for sampleSize points spread over the dataset, the exact k nearest
+	/// neighbors are found by brute force, and the recall is the fraction of the graph's neighbors that are
+	/// no farther than the exact k-th neighbor (so ties at the k-th distance count as found).
+	/// </summary>
+	/// <param name="sampleSize">The number of points checked; at most the number of points</param>
+	/// <param name="numThreads">The number of threads; 0 uses all hardware threads</param>
+	/// <returns>The recall, between 0 and 1</returns>
+	double estimateRecall(int sampleSize, int numThreads = 1)
+	{
+		sampleSize = std::min(sampleSize, _numPoints);
+		if (sampleSize <= 0 || _numNeighbors == 0)
+			return 1;
+		std::vector<long long> sampleHits(sampleSize, 0);
+		parallelFor(0, sampleSize, numThreads, [&](int begin, int end) {
+			TDistance distance = _distance;
+			std::vector<double> exact(_numPoints - 1);
+			for (int sample = begin; sample < end; sample++)
+			{
+				int point = (int)((long long)sample * _numPoints / sampleSize);
+				int numExact = 0;
+				for (int other = 0; other < _numPoints; other++)
+				{
+					if (other != point)
+						exact[numExact++] = computeDistance(distance, point, other);
+				}
+				std::nth_element(exact.begin(), exact.begin() + _numNeighbors - 1, exact.end());
+				double kthDistance = exact[_numNeighbors - 1];
+				for (int i = 0; i < _numNeighbors; i++)
+				{
+					if (_distances[(size_t)point * _numNeighbors + i] <= kthDistance)
+						sampleHits[sample]++;
+				}
+			}
+		});
+		long long hits = 0;
+		for (long long sampleHit : sampleHits)
+			hits += sampleHit;
+		return (double)hits / ((double)sampleSize * _numNeighbors);
+	}
+
+	int getNumPoints()
+	{
+		return _numPoints;
+	}
+
+	int getNumAttributes()
+	{
+		return _rows.getNumAttributes();
+	}
+
+	/// <summary>
+	/// The number of neighbors kept per point.
+	/// </summary>
+	int getNumNeighbors()
+	{
+		return _numNeighbors;
+	}
+
+	/// <summary>
+	/// The number of iterations run before the update rate fell below the termination rate.
+	/// </summary>
+	int getNumIterations()
+	{
+		return _numIterations;
+	}
+
+	/// <summary>
+	/// The neighbors of each point, nearest first: point i's list is entries [i * k, (i + 1) * k).
+	/// </summary>
+	const std::vector<int>& getNeighbors()
+	{
+		return _neighbors;
+	}
+
+	/// <summary>
+	/// The distances matching getNeighbors().
+	/// </summary>
+	const std::vector<double>& getDistances()
+	{
+		return _distances;
+	}
+
+	TDistance& getDistance()
+	{
+		return _distance;
+	}
+
+	const TRows& getRows()
+	{
+		return _rows;
+	}
+};
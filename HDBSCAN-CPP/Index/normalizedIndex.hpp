@@ -0,0 +1,61 @@
+#pragma once
+#include<vector>
+#include<memory>
+#include"spatialIndex.hpp"
+#include"kdTree.hpp"
+#include"../Distance/EuclideanDistance.hpp"
+#include"../Distance/CosineDistance.hpp"
+
+/// <summary>
+/// Answers cosine or angular nearest neighbor queries with a Euclidean kd-tree over the normalized rows:
+/// the query is normalized too, and the chords the tree reports are converted to the distance.
+/// </summary>
+class normalizedIndex : public spatialIndex
+{
+private:
+	std::shared_ptr<kdTree<EuclideanDistance>> _tree;
+	CosineDistance _distance;
+
+public:
+	/// <summary>
+	/// Indexes rows which have already been normalized with CosineDistance::normalize().
+	/// </summary>
+	normalizedIndex(const double* unitVectors, int numPoints, int numAttributes, CosineDistance distance)
+		: _tree(std::make_shared<kdTree<EuclideanDistance>>(unitVectors, numPoints, numAttributes)), _distance(distance)
+	{
+	}
+
+	/// <summary>
+	/// Wraps an existing tree over normalized rows, for example one viewed from a model file.
+	/// </summary>
+	normalizedIndex(std::shared_ptr<kdTree<EuclideanDistance>> tree, CosineDistance distance)
+		: _tree(tree), _distance(distance)
+	{
+	}
+
+	int queryNearestNeighbors(const double* point, int k, int* indices, double* distances)
+	{
+		std::vector<double> unitVector(_tree->getNumAttributes());
+		CosineDistance::normalize(point, unitVector.size(), unitVector.data());
+		int numFound = _tree->queryNearestNeighbors(unitVector.data(), k, indices, distances);
+		CosineDistance distance = _distance;
+		for (int i = 0; i < numFound; i++)
+			distances[i] = distance.chordToDistance(distances[i]);
+		return numFound;
+	}
+
+	int getNumPoints()
+	{
+		return _tree->getNumPoints();
+	}
+
+	int getNumAttributes()
+	{
+		return _tree->getNumAttributes();
+	}
+
+	std::shared_ptr<kdTree<EuclideanDistance>> getTree()
+	{
+		return _tree;
+	}
+};
@@ -0,0 +1 @@
+#include "spatialIndex.hpp"
@@ -0,0 +1,26 @@
+#pragma once
+/// <summary>
+/// An interface for indexes which answer k nearest neighbor queries over a fixed set of points
+/// (where points are represented as contiguous rows of doubles).
+/// </summary>
+class spatialIndex
+{
+public:
+	virtual ~spatialIndex() {}
+
+	/// <summary>
+	/// Finds the k indexed points nearest to a query point. Queries do not modify the index, so several
+	/// threads may query it at the same time.
+	/// </summary>
+	/// <param name="point">The attributes of the query point</param>
+	/// <param name="k">The number of neighbors to find</param>
+	/// <param name="indices">Receives the indices of the neighbors, nearest first</param>
+	/// <param name="distances">Receives the distances to the neighbors, in ascending order</param>
+	/// <returns>The number of neighbors found, which is k unless fewer points are indexed</returns>
+	virtual int queryNearestNeighbors(const double* point, int k, int* indices, double* distances)=0;
+
+	virtual int getNumPoints()=0;
+
+	virtual int getNumAttributes()=0;
+};
+
@@ -0,0 +1,63 @@
+#pragma once
+#include<vector>
+#include<memory>
+#include"spatialIndex.hpp"
+#include"kdTree.hpp"
+#include"../Distance/EuclideanDistance.hpp"
+#include"../Distance/HaversineDistance.hpp"
+
+/// <summary>
+/// Answers Haversine nearest neighbor queries with a Euclidean kd-tree over the points' unit vectors: the
+/// (latitude, longitude) query is mapped onto the unit sphere too, and the chords the tree reports are
+/// converted to great-circle angles.
+/// </summary>
+class sphericalIndex : public spatialIndex
+{
+private:
+	std::shared_ptr<kdTree<EuclideanDistance>> _tree;
+
+public:
+	/// <summary>
+	/// Indexes rows which have already been mapped with HaversineDistance::toUnitVector().
+	/// </summary>
+	sphericalIndex(const double* unitVectors, int numPoints)
+		: _tree(std::make_shared<kdTree<EuclideanDistance>>(unitVectors, numPoints, 3))
+	{
+	}
+
+	/// <summary>
+	/// Wraps an existing tree over unit vectors, for example one viewed from a model file.
+	/// </summary>
+	sphericalIndex(std::shared_ptr<kdTree<EuclideanDistance>> tree)
+		: _tree(tree)
+	{
+	}
+
+	int queryNearestNeighbors(const double* point, int k, int* indices, double* distances)
+	{
+		double unitVector[3];
+		HaversineDistance::toUnitVector(point, unitVector);
+		int numFound = _tree->queryNearestNeighbors(unitVector, k, indices, distances);
+		for (int i = 0; i < numFound; i++)
+			distances[i] = HaversineDistance::chordToAngle(distances[i]);
+		return numFound;
+	}
+
+	int getNumPoints()
+	{
+		return _tree->getNumPoints();
+	}
+
+	/// <summary>
+	/// The attributes of a query: its latitude and longitude.
+	/// </summary>
+	int getNumAttributes()
+	{
+		return 2;
+	}
+
+	std::shared_ptr<kdTree<EuclideanDistance>> getTree()
+	{
+		return _tree;
+	}
+};
\ No newline at end of file
@@ -0,0 +1,207 @@
+#include "uniformGrid.hpp"
+#include"../Distance/EuclideanDistance.hpp"
+#include<algorithm>
+#include<cmath>
+#include<limits>
+
+static const uint64_t emptyKey = std::numeric_limits<uint64_t>::max();
+
+uniformGrid::uniformGrid(const double* dataset, int numPoints, int numAttributes, double cellSize) {
+	_dataset = dataset;
+	_numPoints = numPoints;
+	_numAttributes = numAttributes;
+	_lower.assign(numAttributes, numPoints ? std::numeric_limits<double>::max() : 0.0);
+	std::vector<double> upper(numAttributes, numPoints ? -std::numeric_limits<double>::max() : 0.0);
+	for (int i = 0; i < numPoints; i++) {
+		for (int attribute = 0; attribute < numAttributes; attribute++) {
+			_lower[attribute] = std::min(_lower[attribute], dataset[(size_t)i * numAttributes + attribute]);
+			upper[attribute] = std::max(upper[attribute], dataset[(size_t)i * numAttributes + attribute]);
+		}
+	}
+
+	//By default aim for two points per cell over the attributes the points spread along:
+	double volume = 1;
+	int spreadAttributes = 0;
+	double largestExtent = 0;
+	for (int attribute = 0; attribute < numAttributes; attribute++) {
+		double extent = upper[attribute] - _lower[attribute];
+		largestExtent = std::max(largestExtent, extent);
+		if (extent > 0) {
+			volume *= extent;
+			spreadAttributes++;
+		}
+	}
+	if (cellSize <= 0)
+		cellSize = spreadAttributes ? std::pow(2 * volume / numPoints, 1.0 / spreadAttributes) : 1;
+	//Cell coordinates must fit into a 64 bit key:
+	_cellSize = std::max(cellSize, largestExtent * 1e-9);
+	_numCells.resize(numAttributes);
+	while (true) {
+		double totalCells = 1;
+		for (int attribute = 0; attribute < numAttributes; attribute++) {
+			_numCells[attribute] = (int64_t)std::floor((upper[attribute] - _lower[attribute]) / _cellSize) + 1;
+			totalCells *= _numCells[attribute];
+		}
+		if (totalCells < 1e18)
+			break;
+		_cellSize *= 2;
+	}
+
+	//Sort the points by cell and index the cells which hold any in an open addressing hash table:
+	std::vector<std::pair<uint64_t, int>> pointKeys(numPoints);
+	std::vector<int64_t> cell(numAttributes);
+	for (int i = 0; i < numPoints; i++) {
+		findCell(dataset + (size_t)i * numAttributes, cell.data());
+		pointKeys[i] = std::make_pair(getCellKey(cell.data()), i);
+	}
+	std::sort(pointKeys.begin(), pointKeys.end());
+	_cellPoints.resize(numPoints);
+	std::vector<uint64_t> cellKeys;
+	for (int i = 0; i < numPoints; i++) {
+		if (i == 0 || pointKeys[i].first != pointKeys[i - 1].first) {
+			cellKeys.push_back(pointKeys[i].first);
+			_cellStarts.push_back(i);
+		}
+		_cellPoints[i] = pointKeys[i].second;
+	}
+	_cellStarts.push_back(numPoints);
+	size_t tableSize = 2;
+	while (tableSize < 2 * cellKeys.size())
+		tableSize *= 2;
+	_tableKeys.assign(tableSize, emptyKey);
+	_tableCells.assign(tableSize, -1);
+	for (size_t i = 0; i < cellKeys.size(); i++) {
+		size_t slot = (cellKeys[i] * 0x9E3779B97F4A7C15ull) & (tableSize - 1);
+		while (_tableKeys[slot] != emptyKey)
+			slot = (slot + 1) & (tableSize - 1);
+		_tableKeys[slot] = cellKeys[i];
+		_tableCells[slot] = i;
+	}
+}
+
+void uniformGrid::findCell(const double* point, int64_t* cell) {
+	for (int attribute = 0; attribute < _numAttributes; attribute++) {
+		double position = std::floor((point[attribute] - _lower[attribute]) / _cellSize);
+		cell[attribute] = (int64_t)std::max<double>(0, std::min<double>(position, (double)(_numCells[attribute] - 1)));
+	}
+}
+
+uint64_t uniformGrid::getCellKey(const int64_t* cell) {
+	uint64_t key = 0;
+	for (int attribute = 0; attribute < _numAttributes; attribute++)
+		key = key * _numCells[attribute] + cell[attribute];
+	return key;
+}
+
+int uniformGrid::findCellIndex(uint64_t key) {
+	size_t mask = _tableKeys.size() - 1;
+	for (size_t slot = (key * 0x9E3779B97F4A7C15ull) & mask; _tableKeys[slot] != emptyKey; slot = (slot + 1) & mask) {
+		if (_tableKeys[slot] == key)
+			return _tableCells[slot];
+	}
+	return -1;
+}
+
+/// <summary>
+/// Adds the points of every cell whose largest per-attribute offset from center is exactly ring. cell holds
+/// the coordinates chosen for the attributes before attribute; onRing tells whether one of them already sits
+/// on the ring, otherwise the last attribute is restricted to the two ring coordinates.
+/// </summary>
+void uniformGrid::visitRing(const double* point, int64_t* cell, const int64_t* center, int64_t ring, int attribute, bool onRing, std::vector<std::pair<double, int>>& candidates) {
+	if (attribute == _numAttributes) {
+		int index = onRing ? findCellIndex(getCellKey(cell)) : -1;
+		if (index < 0)
+			return;
+		EuclideanDistance distance;
+		for (int i = _cellStarts[index]; i < _cellStarts[index + 1]; i++) {
+			int candidate = _cellPoints[i];
+			candidates.push_back(std::make_pair(distance.computeDistance(point, _dataset + (size_t)candidate * _numAttributes, _numAttributes), candidate));
+		}
+		return;
+	}
+	int64_t first = std::max<int64_t>(0, center[attribute] - ring);
+	int64_t last = std::min<int64_t>(_numCells[attribute] - 1, center[attribute] + ring);
+	bool restrict = !onRing && attribute == _numAttributes - 1;
+	for (int64_t coordinate = first; coordinate <= last; coordinate++) {
+		bool coordinateOnRing = coordinate == center[attribute] - ring || coordinate == center[attribute] + ring;
+		if (restrict && !coordinateOnRing) {
+			coordinate = std::max(coordinate, center[attribute] + ring - 1);
+			continue;
+		}
+		cell[attribute] = coordinate;
+		visitRing(point, cell, center, ring, attribute + 1, onRing || coordinateOnRing, candidates);
+	}
+}
+
+double uniformGrid::queryNeighborhood(const double* point, int k, std::vector<std::pair<double, int>>& neighbors, int maxRing) {
+	neighbors.clear();
+	if (k <= 0 || k > _numPoints)
+		return std::numeric_limits<double>::max();
+	std::vector<int64_t> center(_numAttributes), cell(_numAttributes);
+	findCell(point, center.data());
+	int64_t lastRing = 0;
+	for (int attribute = 0; attribute < _numAttributes; attribute++)
+		lastRing = std::max(lastRing, std::max(center[attribute], _numCells[attribute] - 1 - center[attribute]));
+	bool complete = maxRing < 0 || lastRing <= maxRing;
+	if (!complete)
+		lastRing = maxRing;
+
+	//Every cell on ring r + 1 is at least r cells away from the query (less a margin for the rounding in
+	//findCell()), so the search stops once the k-th distance is below that. The candidates are gathered in
+	//neighbors itself:
+	std::vector<std::pair<double, int>>& candidates = neighbors;
+	double kthDistance = std::numeric_limits<double>::max();
+	for (int64_t ring = 0; ring <= lastRing; ring++) {
+		visitRing(point, cell.data(), center.data(), ring, 0, ring == 0, candidates);
+		if ((int)candidates.size() < k)
+			continue;
+		std::nth_element(candidates.begin(), candidates.begin() + k - 1, candidates.end());
+		kthDistance = candidates[k - 1].first;
+		if (kthDistance < (ring - 1e-6) * _cellSize) {
+			complete = true;
+			break;
+		}
+	}
+	if (!complete) {
+		neighbors.clear();
+		return std::numeric_limits<double>::max();
+	}
+	neighbors.erase(std::remove_if(neighbors.begin(), neighbors.end(),
+		[kthDistance](const std::pair<double, int>& candidate) { return candidate.first > kthDistance; }), neighbors.end());
+	std::sort(neighbors.begin(), neighbors.end());
+	return kthDistance;
+}
+
+int uniformGrid::queryNearestNeighbors(const double* point, int k, int* indices, double* distances) {
+	std::vector<std::pair<double, int>> neighbors;
+	queryNeighborhood(point, std::min(k, _numPoints), neighbors);
+	int numFound = std::min<int>(k, neighbors.size());
+	for (int i = 0; i < numFound; i++) {
+		indices[i] = neighbors[i].second;
+		distances[i] = neighbors[i].first;
+	}
+	return numFound;
+}
+
+double uniformGrid::getCrowding() {
+	double sum = 0;
+	for (size_t i = 0; i + 1 < _cellStarts.size(); i++)
+		sum += (double)(_cellStarts[i + 1] - _cellStarts[i]) * (_cellStarts[i + 1] - _cellStarts[i]);
+	return _numPoints ? sum / _numPoints : 0;
+}
+
+double uniformGrid::getCellSize() {
+	return _cellSize;
+}
+
+const std::vector<int>& uniformGrid::getCellPoints() {
+	return _cellPoints;
+}
+
+int uniformGrid::getNumPoints() {
+	return _numPoints;
+}
+
+int uniformGrid::getNumAttributes() {
+	return _numAttributes;
+}
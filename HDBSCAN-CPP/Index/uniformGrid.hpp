@@ -0,0 +1,73 @@
+#pragma once
+#include<vector>
+#include<utility>
+#include<cstddef>
+#include<cstdint>
+#include"spatialIndex.hpp"
+
+/// <summary>
+/// A uniform grid of cells over the Euclidean space of a fixed set of low-dimensional points. Only cells which
+/// hold points are stored, in a hash table, so the cells can be as small as the densest regions need. Neighbors
+/// are searched ring by ring around the query's cell until the next ring cannot hold anything closer, which
+/// takes expected constant time per query where the density is even at the scale of the cells.
+/// The points are referenced, not copied.
+/// </summary>
+class uniformGrid : public spatialIndex
+{
+private:
+	const double* _dataset;
+	int _numPoints;
+	int _numAttributes;
+	double _cellSize;
+	std::vector<double> _lower;
+	std::vector<int64_t> _numCells;
+	std::vector<uint64_t> _tableKeys;
+	std::vector<int> _tableCells;
+	std::vector<int> _cellStarts;
+	std::vector<int> _cellPoints;
+
+	void findCell(const double* point, int64_t* cell);
+	uint64_t getCellKey(const int64_t* cell);
+	int findCellIndex(uint64_t key);
+	void visitRing(const double* point, int64_t* cell, const int64_t* center, int64_t ring, int attribute, bool onRing, std::vector<std::pair<double, int>>& candidates);
+
+public:
+	/// <summary>
+	/// Buckets the points into cells.
+	/// </summary>
+	/// <param name="dataset">The points as contiguous rows, which must outlive the grid</param>
+	/// <param name="numPoints">The number of points</param>
+	/// <param name="numAttributes">The number of attributes per point</param>
+	/// <param name="cellSize">The side of the cells, or 0 for about two points per cell over the bounding box</param>
+	uniformGrid(const double* dataset, int numPoints, int numAttributes, double cellSize = 0);
+
+	/// <summary>
+	/// Finds the distance to the k-th nearest indexed point and every point which is not farther, so that ties
+	/// with the k-th neighbor are all included. Thread safe.
+	/// </summary>
+	/// <param name="point">The attributes of the query point</param>
+	/// <param name="k">The rank of the neighbor to find</param>
+	/// <param name="neighbors">Receives (distance, index) pairs of the neighbors in ascending order</param>
+	/// <param name="maxRing">The number of rings of cells around the query's cell to search at most, or -1 for no limit</param>
+	/// <returns>The distance to the k-th nearest point; the largest double when fewer points are indexed or
+	/// when the neighbors are not certain to lie within maxRing rings, in which case neighbors is empty</returns>
+	double queryNeighborhood(const double* point, int k, std::vector<std::pair<double, int>>& neighbors, int maxRing = -1);
+
+	int queryNearestNeighbors(const double* point, int k, int* indices, double* distances);
+
+	/// <summary>
+	/// How crowded the cells are from the points' view: the mean number of points in a point's cell.
+	/// </summary>
+	double getCrowding();
+
+	double getCellSize();
+
+	/// <summary>
+	/// The points sorted by cell: querying them in this order keeps the cells in the cache.
+	/// </summary>
+	const std::vector<int>& getCellPoints();
+
+	int getNumPoints();
+
+	int getNumAttributes();
+};
@@ -0,0 +1,645 @@
+#include "hdbscanIncremental.hpp"
+#include "hdbscanRunner.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include "../Distance/EuclideanDistance.hpp"
+#include "../Distance/ManhattanDistance.hpp"
+#include "../HdbscanStar/boruvkaMst.hpp"
+#include "../Index/ballTree.hpp"
+#include "../Index/dynamicKdTree.hpp"
+#include "../Utils/parallelFor.hpp"
+
+using namespace hdbscanStar;
+
+/// <summary>
+/// Indexes the initial points, finds their core neighbors and most reachable neighbors and builds their exact
+/// MST, returning the distance of every MST edge next to its mutual reachability.
+/// </summary>
+template<class TDistance>
+static std::shared_ptr<dynamicSpatialIndex> fitInitialPoints(const std::vector<double>& rows, int numPoints, int numAttributes, int numCoreNeighbors,
+	int numNeighbors, int numThreads, std::vector<int>& neighborIndices, std::vector<double>& neighborDistances, std::vector<double>& coreDistances,
+	std::vector<int>& candidateIndices, std::vector<double>& candidateDistances, undirectedGraph& mst, std::vector<double>& mstDistances) {
+	std::shared_ptr<dynamicKdTree<TDistance>> index = std::make_shared<dynamicKdTree<TDistance>>(rows.data(), numPoints, numAttributes);
+
+	//Each point finds itself among its numCoreNeighbors + 1 nearest, or is tied with the last of them:
+	neighborIndices.assign((size_t)numPoints * numCoreNeighbors, -1);
+	neighborDistances.assign((size_t)numPoints * numCoreNeighbors, std::numeric_limits<double>::max());
+	coreDistances.assign(numPoints, 0);
+	parallelFor(0, numPoints, numThreads, [&](int begin, int end) {
+		std::vector<int> indices(numCoreNeighbors + 1);
+		std::vector<double> distances(numCoreNeighbors + 1);
+		for (int i = begin; i < end; i++)
+		{
+			int numFound = index->queryNearestNeighbors(&rows[(size_t)i * numAttributes], numCoreNeighbors + 1, indices.data(), distances.data());
+			int numKept = 0;
+			for (int j = 0; j < numFound && numKept < numCoreNeighbors; j++)
+			{
+				if (indices[j] == i)
+					continue;
+				neighborIndices[(size_t)i * numCoreNeighbors + numKept] = indices[j];
+				neighborDistances[(size_t)i * numCoreNeighbors + numKept] = distances[j];
+				numKept++;
+			}
+			if (numCoreNeighbors > 0)
+				coreDistances[i] = neighborDistances[(size_t)i * numCoreNeighbors + numCoreNeighbors - 1];
+		}
+	});
+	for (int i = 0; i < numPoints; i++)
+		index->updateCoreDistance(i, coreDistances[i]);
+
+	candidateIndices.assign((size_t)numPoints * numNeighbors, -1);
+	candidateDistances.assign((size_t)numPoints * numNeighbors, 0);
+	parallelFor(0, numPoints, numThreads, [&](int begin, int end) {
+		std::vector<int> indices(numNeighbors + 1);
+		std::vector<double> distances(numNeighbors + 1);
+		for (int i = begin; i < end; i++)
+		{
+			int numFound = index->queryReachableNeighbors(&rows[(size_t)i * numAttributes], numNeighbors + 1, coreDistances, indices.data(), distances.data());
+			int numKept = 0;
+			for (int j = 0; j < numFound && numKept < numNeighbors; j++)
+			{
+				if (indices[j] == i)
+					continue;
+				candidateIndices[(size_t)i * numNeighbors + numKept] = indices[j];
+				candidateDistances[(size_t)i * numNeighbors + numKept] = distances[j];
+				numKept++;
+			}
+		}
+	});
+
+	ballTree<TDistance> tree(rows.data(), numPoints, numAttributes, 32, numThreads);
+	mst = boruvkaMst::constructMst(tree, coreDistances, false, numThreads);
+	TDistance distance;
+	mstDistances.resize(mst.getNumEdges());
+	for (int i = 0; i < mst.getNumEdges(); i++)
+	{
+		mstDistances[i] = distance.computeDistance(&rows[(size_t)mst.getFirstVertexAtIndex(i) * numAttributes],
+			&rows[(size_t)mst.getSecondVertexAtIndex(i) * numAttributes], numAttributes);
+	}
+	return index;
+}
+
+hdbscanIncremental::hdbscanIncremental(hdbscanParameters parameters) {
+	int numPoints = parameters.dataset.size();
+	if (numPoints == 0)
+		throw std::invalid_argument("The incremental model needs at least one initial point.");
+	int numAttributes = parameters.dataset[0].size();
+	std::vector<double> rows((size_t)numPoints * numAttributes);
+	for (int i = 0; i < numPoints; i++)
+	{
+		if ((int)parameters.dataset[i].size() != numAttributes)
+			throw std::invalid_argument("Every point must have the same number of attributes.");
+		std::copy(parameters.dataset[i].begin(), parameters.dataset[i].end(), rows.begin() + (size_t)i * numAttributes);
+	}
+
+	_minPoints = parameters.minPoints;
+	_minClusterSize = parameters.minClusterSize;
+	_numNeighbors = hdbscanRunner::getNumNeighbors(parameters);
+	_distanceFunction = parameters.distanceFunction;
+	_numThreads = parameters.numThreads;
+	_numRemoved = 0;
+	_visitRound = 0;
+	_modelCurrent = false;
+
+	undirectedGraph mst;
+	std::vector<double> mstDistances;
+	int numCoreNeighbors = getNumCoreNeighbors();
+	if (_distanceFunction.length() == 0 || _distanceFunction == "Euclidean")
+		_index = fitInitialPoints<EuclideanDistance>(rows, numPoints, numAttributes, numCoreNeighbors, _numNeighbors, _numThreads,
+			_neighborIndices, _neighborDistances, _coreDistances, _candidateIndices, _candidateDistances, mst, mstDistances);
+	else if (_distanceFunction == "Manhattan")
+		_index = fitInitialPoints<ManhattanDistance>(rows, numPoints, numAttributes, numCoreNeighbors, _numNeighbors, _numThreads,
+			_neighborIndices, _neighborDistances, _coreDistances, _candidateIndices, _candidateDistances, mst, mstDistances);
+	else
+		throw std::invalid_argument("The incremental model supports the Euclidean and Manhattan distances, not " + _distanceFunction + ".");
+
+	for (int i = 0; i < numPoints; i++)
+		addVertex();
+	for (int i = 0; i < mst.getNumEdges(); i++)
+		addEdge(mst.getFirstVertexAtIndex(i), mst.getSecondVertexAtIndex(i), mstDistances[i]);
+}
+
+int hdbscanIncremental::getNumCoreNeighbors() {
+	return _minPoints > 1 ? _minPoints - 1 : 0;
+}
+
+double hdbscanIncremental::calculateEdgeWeight(int vertexA, int vertexB, double distance) {
+	return std::max(distance, std::max(_coreDistances[vertexA], _coreDistances[vertexB]));
+}
+
+void hdbscanIncremental::addVertex() {
+	//Every vertex brings the slot of one edge, so a spanning tree always has a free slot for a new edge:
+	int vertex = _vertexEdges.size();
+	_vertexEdges.push_back(std::vector<int>());
+	_removed.push_back(0);
+	_visits.push_back(0);
+	_edgeVerticesA.push_back(-1);
+	_edgeVerticesB.push_back(-1);
+	_edgeDistances.push_back(0);
+	_freeEdges.push_back(vertex);
+	_forest.resize(2 * vertex + 2, -std::numeric_limits<double>::max());
+}
+
+void hdbscanIncremental::addEdge(int vertexA, int vertexB, double distance) {
+	int edge = _freeEdges.back();
+	_freeEdges.pop_back();
+	_edgeVerticesA[edge] = vertexA;
+	_edgeVerticesB[edge] = vertexB;
+	_edgeDistances[edge] = distance;
+	_vertexEdges[vertexA].push_back(edge);
+	_vertexEdges[vertexB].push_back(edge);
+	_forest.setValue(2 * edge + 1, calculateEdgeWeight(vertexA, vertexB, distance));
+	_forest.link(2 * vertexA, 2 * edge + 1);
+	_forest.link(2 * edge + 1, 2 * vertexB);
+}
+
+void hdbscanIncremental::removeEdge(int edge) {
+	int vertices[2] = { _edgeVerticesA[edge], _edgeVerticesB[edge] };
+	for (int vertex : vertices)
+	{
+		_forest.cut(2 * vertex, 2 * edge + 1);
+		std::vector<int>& edges = _vertexEdges[vertex];
+		std::vector<int>::iterator it = std::find(edges.begin(), edges.end(), edge);
+		*it = edges.back();
+		edges.pop_back();
+	}
+	_edgeVerticesA[edge] = -1;
+	_edgeVerticesB[edge] = -1;
+	_freeEdges.push_back(edge);
+}
+
+void hdbscanIncremental::offerEdge(int vertexA, int vertexB, double distance) {
+	//The tree spans every vertex but a new one until its first edge:
+	if (_vertexEdges[vertexA].empty() || _vertexEdges[vertexB].empty())
+	{
+		addEdge(vertexA, vertexB, distance);
+		return;
+	}
+	int heaviest = _forest.findPathMax(2 * vertexA, 2 * vertexB);
+	if (_forest.getValue(heaviest) > calculateEdgeWeight(vertexA, vertexB, distance))
+	{
+		removeEdge((heaviest - 1) / 2);
+		addEdge(vertexA, vertexB, distance);
+	}
+}
+
+int hdbscanIncremental::insert(const std::vector<double>& point) {
+	if ((int)point.size() != _index->getNumAttributes())
+		throw std::invalid_argument("New points must have the same number of attributes as the initial points.");
+
+	int numCoreNeighbors = getNumCoreNeighbors();
+	std::vector<int> indices(numCoreNeighbors + _numNeighbors);
+	std::vector<double> distances(numCoreNeighbors + _numNeighbors);
+	int numFound = _index->queryNearestNeighbors(point.data(), numCoreNeighbors, indices.data(), distances.data());
+	int numReachable = _index->queryReachableNeighbors(point.data(), _numNeighbors, _coreDistances, &indices[numFound], &distances[numFound]);
+	std::vector<std::pair<double, int>> reverseNeighbors;
+	_index->queryReverseNeighbors(point.data(), _coreDistances, reverseNeighbors);
+
+	int vertex = _index->insert(point.data());
+	for (int i = 0; i < numCoreNeighbors; i++)
+	{
+		_neighborIndices.push_back(i < numFound ? indices[i] : -1);
+		_neighborDistances.push_back(i < numFound ? distances[i] : std::numeric_limits<double>::max());
+	}
+	for (int i = 0; i < _numNeighbors; i++)
+	{
+		_candidateIndices.push_back(i < numReachable ? indices[numFound + i] : -1);
+		_candidateDistances.push_back(i < numReachable ? distances[numFound + i] : 0);
+	}
+	_coreDistances.push_back(numCoreNeighbors > 0 ? _neighborDistances.back() : 0);
+	_index->updateCoreDistance(vertex, _coreDistances[vertex]);
+	addVertex();
+	_modelCurrent = false;
+
+	//The new point replaces the least reachable candidate of its candidates if it is more reachable, so
+	//removals find the edges to it from both ends:
+	for (int i = 0; i < numReachable; i++)
+	{
+		int neighbor = indices[numFound + i];
+		int* neighborCandidates = &_candidateIndices[(size_t)neighbor * _numNeighbors];
+		double* neighborCandidateDistances = &_candidateDistances[(size_t)neighbor * _numNeighbors];
+		int worst = 0;
+		double worstReachability = -1;
+		for (int j = 0; j < _numNeighbors && worstReachability < std::numeric_limits<double>::max(); j++)
+		{
+			int candidate = neighborCandidates[j];
+			double reachability = candidate < 0 || _removed[candidate] ? std::numeric_limits<double>::max()
+				: std::max(neighborCandidateDistances[j], _coreDistances[candidate]);
+			if (reachability > worstReachability)
+			{
+				worst = j;
+				worstReachability = reachability;
+			}
+		}
+		if (std::max(distances[numFound + i], _coreDistances[vertex]) < worstReachability)
+		{
+			neighborCandidates[worst] = vertex;
+			neighborCandidateDistances[worst] = distances[numFound + i];
+		}
+	}
+
+	//The edges to the new point, and the pairs a reverse neighbor's old core distance held apart:
+	std::vector<std::pair<int, int>> candidateVertices;
+	std::vector<double> candidateDistances;
+	for (int i = 0; i < numFound + numReachable; i++)
+	{
+		candidateVertices.push_back(std::make_pair(vertex, indices[i]));
+		candidateDistances.push_back(distances[i]);
+	}
+	for (const std::pair<double, int>& reverseNeighbor : reverseNeighbors)
+	{
+		int neighbor = reverseNeighbor.second;
+		if (reverseNeighbor.first >= _coreDistances[neighbor])
+			continue;
+		int* neighborIndices = &_neighborIndices[(size_t)neighbor * numCoreNeighbors];
+		double* neighborDistances = &_neighborDistances[(size_t)neighbor * numCoreNeighbors];
+		candidateVertices.push_back(std::make_pair(vertex, neighbor));
+		candidateDistances.push_back(reverseNeighbor.first);
+		for (int i = 0; i < numCoreNeighbors && neighborDistances[i] < _coreDistances[neighbor]; i++)
+		{
+			candidateVertices.push_back(std::make_pair(neighbor, neighborIndices[i]));
+			candidateDistances.push_back(neighborDistances[i]);
+		}
+
+		//Insert the new point into the neighbor list:
+		int position = numCoreNeighbors - 1;
+		while (position > 0 && neighborDistances[position - 1] > reverseNeighbor.first)
+		{
+			neighborDistances[position] = neighborDistances[position - 1];
+			neighborIndices[position] = neighborIndices[position - 1];
+			position--;
+		}
+		neighborDistances[position] = reverseNeighbor.first;
+		neighborIndices[position] = vertex;
+		_coreDistances[neighbor] = neighborDistances[numCoreNeighbors - 1];
+		_index->updateCoreDistance(neighbor, _coreDistances[neighbor]);
+	}
+
+	//Lower core distances make the tree edges of the reverse neighbors lighter, which keeps them in the MST:
+	for (const std::pair<double, int>& reverseNeighbor : reverseNeighbors)
+	{
+		for (int edge : _vertexEdges[reverseNeighbor.second])
+			_forest.setValue(2 * edge + 1, calculateEdgeWeight(_edgeVerticesA[edge], _edgeVerticesB[edge], _edgeDistances[edge]));
+	}
+
+	//Offer the candidates lightest first, so the new point is linked by its lightest edge:
+	std::vector<std::pair<double, int>> order(candidateVertices.size());
+	for (size_t i = 0; i < order.size(); i++)
+		order[i] = std::make_pair(calculateEdgeWeight(candidateVertices[i].first, candidateVertices[i].second, candidateDistances[i]), (int)i);
+	std::sort(order.begin(), order.end());
+	for (const std::pair<double, int>& candidate : order)
+	{
+		const std::pair<int, int>& vertices = candidateVertices[candidate.second];
+		offerEdge(vertices.first, vertices.second, candidateDistances[candidate.second]);
+	}
+	return vertex;
+}
+
+void hdbscanIncremental::remove(const std::vector<int>& points) {
+	std::vector<int> sortedPoints(points);
+	std::sort(sortedPoints.begin(), sortedPoints.end());
+	for (size_t i = 0; i < sortedPoints.size(); i++)
+	{
+		int point = sortedPoints[i];
+		if (point < 0 || point >= getNumPoints() || _removed[point] || (i > 0 && sortedPoints[i - 1] == point))
+			throw std::invalid_argument("Only points which are in the model can be removed, and each only once.");
+	}
+	if (points.empty())
+		return;
+	_modelCurrent = false;
+
+	//The points which have a removed point among their core neighbors:
+	std::vector<int> changedPoints;
+	std::vector<std::pair<double, int>> reverseNeighbors;
+	for (int point : points)
+	{
+		_index->queryReverseNeighbors(_index->getPoint(point), _coreDistances, reverseNeighbors);
+		for (const std::pair<double, int>& reverseNeighbor : reverseNeighbors)
+			changedPoints.push_back(reverseNeighbor.second);
+	}
+	for (int point : points)
+	{
+		_removed[point] = 1;
+		_index->remove(point);
+	}
+	_numRemoved += points.size();
+	std::sort(changedPoints.begin(), changedPoints.end());
+	changedPoints.erase(std::unique(changedPoints.begin(), changedPoints.end()), changedPoints.end());
+
+	//Cut the edges of the removed points and the edges made heavier by larger core distances. The other tree
+	//edges were the lightest across a cut before and nothing got lighter, so they stay in the MST:
+	std::vector<int> cutVertices;
+	std::vector<std::pair<int, int>> candidateVertices;
+	std::vector<double> candidateDistances;
+	for (int point : points)
+	{
+		while (!_vertexEdges[point].empty())
+		{
+			int edge = _vertexEdges[point].back();
+			cutVertices.push_back(_edgeVerticesA[edge] == point ? _edgeVerticesB[edge] : _edgeVerticesA[edge]);
+			removeEdge(edge);
+		}
+	}
+	int numCoreNeighbors = getNumCoreNeighbors();
+	std::vector<int> indices(numCoreNeighbors + 1);
+	std::vector<double> distances(numCoreNeighbors + 1);
+	for (int point : changedPoints)
+	{
+		int* neighborIndices = &_neighborIndices[(size_t)point * numCoreNeighbors];
+		double* neighborDistances = &_neighborDistances[(size_t)point * numCoreNeighbors];
+		bool lostNeighbor = false;
+		for (int i = 0; i < numCoreNeighbors; i++)
+			lostNeighbor = lostNeighbor || (neighborIndices[i] >= 0 && _removed[neighborIndices[i]]);
+		if (_removed[point] || !lostNeighbor)
+			continue;
+
+		int numFound = _index->queryNearestNeighbors(_index->getPoint(point), numCoreNeighbors + 1, indices.data(), distances.data());
+		int numKept = 0;
+		for (int i = 0; i < numFound && numKept < numCoreNeighbors; i++)
+		{
+			if (indices[i] == point)
+				continue;
+			neighborIndices[numKept] = indices[i];
+			neighborDistances[numKept] = distances[i];
+			numKept++;
+		}
+		for (; numKept < numCoreNeighbors; numKept++)
+		{
+			neighborIndices[numKept] = -1;
+			neighborDistances[numKept] = std::numeric_limits<double>::max();
+		}
+		_coreDistances[point] = neighborDistances[numCoreNeighbors - 1];
+		_index->updateCoreDistance(point, _coreDistances[point]);
+
+		std::vector<int> edges(_vertexEdges[point]);
+		for (int edge : edges)
+		{
+			int vertexA = _edgeVerticesA[edge];
+			int vertexB = _edgeVerticesB[edge];
+			if (calculateEdgeWeight(vertexA, vertexB, _edgeDistances[edge]) > _forest.getValue(2 * edge + 1))
+			{
+				candidateVertices.push_back(std::make_pair(vertexA, vertexB));
+				candidateDistances.push_back(_edgeDistances[edge]);
+				cutVertices.push_back(vertexA);
+				cutVertices.push_back(vertexB);
+				removeEdge(edge);
+			}
+		}
+	}
+	reconnect(cutVertices, candidateVertices, candidateDistances);
+}
+
+void hdbscanIncremental::collectTree(int vertex, std::vector<int>& vertices) {
+	vertices.push_back(vertex);
+	_visits[vertex] = _visitRound;
+	for (size_t i = vertices.size() - 1; i < vertices.size(); i++)
+	{
+		for (int edge : _vertexEdges[vertices[i]])
+		{
+			int other = _edgeVerticesA[edge] == vertices[i] ? _edgeVerticesB[edge] : _edgeVerticesA[edge];
+			if (_visits[other] != _visitRound)
+			{
+				_visits[other] = _visitRound;
+				vertices.push_back(other);
+			}
+		}
+	}
+}
+
+void hdbscanIncremental::reconnect(std::vector<int>& cutVertices, std::vector<std::pair<int, int>>& candidateVertices, std::vector<double>& candidateDistances) {
+	//One vertex of every tree the cuts left:
+	std::vector<std::pair<int, int>> roots;
+	for (int vertex : cutVertices)
+	{
+		if (!_removed[vertex])
+			roots.push_back(std::make_pair(_forest.findRoot(2 * vertex), vertex));
+	}
+	std::sort(roots.begin(), roots.end());
+	std::vector<int> trees;
+	for (size_t i = 0; i < roots.size(); i++)
+	{
+		if (i == 0 || roots[i].first != roots[i - 1].first)
+			trees.push_back(roots[i].second);
+	}
+	if (trees.size() <= 1)
+		return;
+
+	//Search all the trees breadth first in lockstep until only the largest is left unfinished, so the
+	//search costs as much as the trees that were split off, not as much as the whole MST:
+	_visitRound++;
+	int numTrees = trees.size();
+	std::vector<std::vector<int>> treeVertices(numTrees);
+	std::vector<size_t> nextVertices(numTrees, 0);
+	for (int tree = 0; tree < numTrees; tree++)
+	{
+		_visits[trees[tree]] = _visitRound;
+		treeVertices[tree].push_back(trees[tree]);
+	}
+	int numUnfinished = numTrees;
+	while (numUnfinished > 1)
+	{
+		for (int tree = 0; tree < numTrees && numUnfinished > 1; tree++)
+		{
+			std::vector<int>& vertices = treeVertices[tree];
+			if (nextVertices[tree] == vertices.size())
+				continue;
+			int vertex = vertices[nextVertices[tree]++];
+			for (int edge : _vertexEdges[vertex])
+			{
+				int other = _edgeVerticesA[edge] == vertex ? _edgeVerticesB[edge] : _edgeVerticesA[edge];
+				if (_visits[other] != _visitRound)
+				{
+					_visits[other] = _visitRound;
+					vertices.push_back(other);
+				}
+			}
+			if (nextVertices[tree] == vertices.size())
+				numUnfinished--;
+		}
+	}
+	int largestTree = 0;
+	while (nextVertices[largestTree] == treeVertices[largestTree].size())
+		largestTree++;
+
+	//Kruskal's algorithm over the candidate edges of the split off trees:
+	int numCoreNeighbors = getNumCoreNeighbors();
+	for (int tree = 0; tree < numTrees; tree++)
+	{
+		if (tree == largestTree)
+			continue;
+		for (int vertex : treeVertices[tree])
+		{
+			for (int i = 0; i < numCoreNeighbors; i++)
+			{
+				int neighbor = _neighborIndices[(size_t)vertex * numCoreNeighbors + i];
+				if (neighbor >= 0 && !_removed[neighbor])
+				{
+					candidateVertices.push_back(std::make_pair(vertex, neighbor));
+					candidateDistances.push_back(_neighborDistances[(size_t)vertex * numCoreNeighbors + i]);
+				}
+			}
+			for (int i = 0; i < _numNeighbors; i++)
+			{
+				int neighbor = _candidateIndices[(size_t)vertex * _numNeighbors + i];
+				if (neighbor >= 0 && !_removed[neighbor])
+				{
+					candidateVertices.push_back(std::make_pair(vertex, neighbor));
+					candidateDistances.push_back(_candidateDistances[(size_t)vertex * _numNeighbors + i]);
+				}
+			}
+		}
+	}
+	std::vector<std::pair<double, int>> order(candidateVertices.size());
+	for (size_t i = 0; i < order.size(); i++)
+		order[i] = std::make_pair(calculateEdgeWeight(candidateVertices[i].first, candidateVertices[i].second, candidateDistances[i]), (int)i);
+	std::sort(order.begin(), order.end());
+	for (const std::pair<double, int>& candidate : order)
+	{
+		const std::pair<int, int>& vertices = candidateVertices[candidate.second];
+		if (!_forest.connected(2 * vertices.first, 2 * vertices.second))
+			addEdge(vertices.first, vertices.second, candidateDistances[candidate.second]);
+	}
+
+	//Trees the candidates could not reach are joined by their most reachable outside point, as in
+	//Boruvka's algorithm, searching more neighbors until one lies outside:
+	bool joined = false;
+	while (!joined)
+	{
+		joined = true;
+		for (int tree = 0; tree < numTrees; tree++)
+		{
+			if (tree == largestTree || _forest.connected(2 * trees[tree], 2 * trees[largestTree]))
+				continue;
+			joined = false;
+			_visitRound++;
+			std::vector<int> vertices;
+			collectTree(trees[tree], vertices);
+			double bestWeight = std::numeric_limits<double>::max();
+			int bestVertex = -1;
+			int bestNeighbor = -1;
+			double bestDistance = 0;
+			for (int vertex : vertices)
+			{
+				for (int k = _numNeighbors; ; k *= 2)
+				{
+					std::vector<int> indices(k);
+					std::vector<double> distances(k);
+					int numFound = _index->queryReachableNeighbors(_index->getPoint(vertex), k, _coreDistances, indices.data(), distances.data());
+					int outside = 0;
+					while (outside < numFound && _visits[indices[outside]] == _visitRound)
+						outside++;
+					if (outside < numFound)
+					{
+						double weight = calculateEdgeWeight(vertex, indices[outside], distances[outside]);
+						if (weight < bestWeight)
+						{
+							bestWeight = weight;
+							bestVertex = vertex;
+							bestNeighbor = indices[outside];
+							bestDistance = distances[outside];
+						}
+						break;
+					}
+					if (numFound < k)
+						break;
+				}
+			}
+			addEdge(bestVertex, bestNeighbor, bestDistance);
+		}
+	}
+}
+
+std::vector<int> hdbscanIncremental::compact() {
+	std::vector<int> newIndices(getNumPoints(), -1);
+	hdbscanParameters parameters;
+	for (int point = 0; point < getNumPoints(); point++)
+	{
+		if (_removed[point])
+			continue;
+		newIndices[point] = parameters.dataset.size();
+		const double* attributes = _index->getPoint(point);
+		parameters.dataset.push_back(std::vector<double>(attributes, attributes + _index->getNumAttributes()));
+	}
+	parameters.distanceFunction = _distanceFunction;
+	parameters.minPoints = _minPoints;
+	parameters.minClusterSize = _minClusterSize;
+	parameters.numNeighbors = _numNeighbors;
+	parameters.numThreads = _numThreads;
+	*this = hdbscanIncremental(parameters);
+	return newIndices;
+}
+
+std::vector<int> hdbscanIncremental::getLivePoints() {
+	std::vector<int> livePoints;
+	for (int point = 0; point < getNumPoints(); point++)
+	{
+		if (!_removed[point])
+			livePoints.push_back(point);
+	}
+	return livePoints;
+}
+
+undirectedGraph hdbscanIncremental::getMst() {
+	//Number the points that were not removed consecutively:
+	std::vector<int> liveIndices(getNumPoints(), -1);
+	int numLivePoints = 0;
+	for (int point = 0; point < getNumPoints(); point++)
+	{
+		if (!_removed[point])
+			liveIndices[point] = numLivePoints++;
+	}
+	std::vector<std::pair<double, int>> edges;
+	for (size_t edge = 0; edge < _edgeVerticesA.size(); edge++)
+	{
+		if (_edgeVerticesA[edge] >= 0)
+			edges.push_back(std::make_pair(_forest.getValue(2 * edge + 1), (int)edge));
+	}
+	std::sort(edges.begin(), edges.end());
+	std::vector<int> verticesA;
+	std::vector<int> verticesB;
+	std::vector<double> edgeWeights;
+	for (const std::pair<double, int>& edge : edges)
+	{
+		verticesA.push_back(liveIndices[_edgeVerticesA[edge.second]]);
+		verticesB.push_back(liveIndices[_edgeVerticesB[edge.second]]);
+		edgeWeights.push_back(edge.first);
+	}
+	return undirectedGraph(numLivePoints, verticesA, verticesB, edgeWeights);
+}
+
+hdbscanModel& hdbscanIncremental::getModel() {
+	if (!_modelCurrent)
+	{
+		undirectedGraph mst = getMst();
+		std::vector<double> coreDistances;
+		for (int point = 0; point < getNumPoints(); point++)
+		{
+			if (!_removed[point])
+				coreDistances.push_back(_coreDistances[point]);
+		}
+		_model = hdbscanModel(coreDistances, mst, _minPoints, _minClusterSize);
+		_modelCurrent = true;
+	}
+	return _model;
+}
+
+hdbscanResult hdbscanIncremental::select(hdbscanClusterSelectionMethod method, double clusterSelectionEpsilon) {
+	return getModel().select(method, clusterSelectionEpsilon);
+}
+
+const std::vector<double>& hdbscanIncremental::getCoreDistances() {
+	return _coreDistances;
+}
+
+int hdbscanIncremental::getNumPoints() {
+	return _coreDistances.size();
+}
+
+int hdbscanIncremental::getNumLivePoints() {
+	return getNumPoints() - _numRemoved;
+}
+
+int hdbscanIncremental::getNumRemovedPoints() {
+	return _numRemoved;
+}
@@ -0,0 +1,208 @@
+#include "hdbscanMicroClusters.hpp"
+#include "hdbscanRunner.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+//Point weights are rescaled to 1 before they pass 2^256, far from overflowing the sums:
+static const double maxPointWeight = std::ldexp(1.0, 256);
+
+static uint64_t hashCell(const int64_t* cell, int numAttributes) {
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	for (int attribute = 0; attribute < numAttributes; attribute++) {
+		hash = (hash ^ (uint64_t)cell[attribute]) * 0x100000001B3ULL;
+		hash ^= hash >> 32;
+	}
+	return hash;
+}
+
+hdbscanMicroClusters::hdbscanMicroClusters(hdbscanParameters parameters, int numAttributes, double cellSize, double halfLife, int maxMicroClusters) {
+	if (numAttributes < 1)
+		throw std::invalid_argument("Micro-clusters need at least one attribute.");
+	if (!(cellSize > 0) || std::isinf(cellSize))
+		throw std::invalid_argument("The cell size must be positive and finite.");
+	if (!(halfLife >= 0))
+		throw std::invalid_argument("The half-life must not be negative.");
+	if (maxMicroClusters < 1)
+		throw std::invalid_argument("At least one micro-cluster must be kept.");
+	_parameters = parameters;
+	_parameters.dataset.clear();
+	_parameters.sampleWeights.clear();
+	_numAttributes = numAttributes;
+	_cellSize = cellSize;
+	_halfLife = halfLife;
+	_maxMicroClusters = maxMicroClusters;
+	_referenceTime = 0;
+	_latestTime = -std::numeric_limits<double>::max();
+	_pointWeight = 1;
+	_cell.resize(numAttributes);
+}
+
+uint64_t hdbscanMicroClusters::findCell(const double* point, int64_t* cell) {
+	const double maxCoordinate = std::ldexp(1.0, 62);
+	for (int attribute = 0; attribute < _numAttributes; attribute++) {
+		double coordinate = std::floor(point[attribute] / _cellSize);
+		cell[attribute] = (int64_t)std::max(-maxCoordinate, std::min(maxCoordinate, coordinate));
+	}
+	return hashCell(cell, _numAttributes);
+}
+
+int hdbscanMicroClusters::findMicroCluster(uint64_t hash, const int64_t* cell) {
+	std::unordered_map<uint64_t, int>::iterator entry = _firstWithHash.find(hash);
+	for (int microCluster = entry == _firstWithHash.end() ? -1 : entry->second; microCluster != -1; microCluster = _nextWithHash[microCluster]) {
+		if (std::equal(cell, cell + _numAttributes, _cells.begin() + (size_t)microCluster * _numAttributes))
+			return microCluster;
+	}
+	return -1;
+}
+
+void hdbscanMicroClusters::rescale(double time) {
+	double factor = std::exp2(-(time - _referenceTime) / _halfLife);
+	for (double& weight : _weights)
+		weight *= factor;
+	for (double& sum : _sums)
+		sum *= factor;
+	for (double& squaredSum : _squaredSums)
+		squaredSum *= factor;
+	_referenceTime = time;
+	_pointWeight = 1;
+}
+
+void hdbscanMicroClusters::insert(const double* point, double timestamp) {
+	double pointWeight = _pointWeight;
+	if (_halfLife > 0 && timestamp != _latestTime) {
+		if (_latestTime == -std::numeric_limits<double>::max())
+			_referenceTime = timestamp;
+		pointWeight = std::exp2((timestamp - _referenceTime) / _halfLife);
+		if (timestamp > _latestTime) {
+			_latestTime = timestamp;
+			_pointWeight = pointWeight;
+			if (_pointWeight > maxPointWeight)
+				rescale(timestamp);
+			pointWeight = _pointWeight;
+		}
+	}
+	else
+		_latestTime = std::max(_latestTime, timestamp);
+
+	uint64_t hash = findCell(point, _cell.data());
+	int microCluster = findMicroCluster(hash, _cell.data());
+	if (microCluster == -1) {
+		microCluster = _weights.size();
+		_cells.insert(_cells.end(), _cell.begin(), _cell.end());
+		_weights.push_back(0);
+		_sums.resize(_sums.size() + _numAttributes, 0);
+		_squaredSums.push_back(0);
+		std::unordered_map<uint64_t, int>::iterator entry = _firstWithHash.find(hash);
+		_nextWithHash.push_back(entry == _firstWithHash.end() ? -1 : entry->second);
+		_firstWithHash[hash] = microCluster;
+		_labels.push_back(0);
+	}
+	double squaredNorm = 0;
+	double* sums = &_sums[(size_t)microCluster * _numAttributes];
+	for (int attribute = 0; attribute < _numAttributes; attribute++) {
+		sums[attribute] += pointWeight * point[attribute];
+		squaredNorm += point[attribute] * point[attribute];
+	}
+	_weights[microCluster] += pointWeight;
+	_squaredSums[microCluster] += pointWeight * squaredNorm;
+	if ((int)_weights.size() > _maxMicroClusters)
+		prune(_maxMicroClusters - _maxMicroClusters / 4);
+}
+
+/// <summary>
+/// Keeps the numKept heaviest micro-clusters, less those whose weight decayed to 0, in their order, and
+/// rebuilds the hash chains.
+/// </summary>
+void hdbscanMicroClusters::prune(int numKept) {
+	int numMicroClusters = _weights.size();
+	std::vector<int> kept;
+	for (int microCluster = 0; microCluster < numMicroClusters; microCluster++) {
+		if (_weights[microCluster] > 0)
+			kept.push_back(microCluster);
+	}
+	if ((int)kept.size() > numKept) {
+		std::nth_element(kept.begin(), kept.begin() + numKept, kept.end(), [this](int first, int second) {
+			return _weights[first] > _weights[second];
+		});
+		kept.resize(numKept);
+		std::sort(kept.begin(), kept.end());
+	}
+
+	_firstWithHash.clear();
+	for (size_t i = 0; i < kept.size(); i++) {
+		int microCluster = kept[i];
+		std::copy(_cells.begin() + (size_t)microCluster * _numAttributes, _cells.begin() + (size_t)(microCluster + 1) * _numAttributes, _cells.begin() + i * _numAttributes);
+		std::copy(_sums.begin() + (size_t)microCluster * _numAttributes, _sums.begin() + (size_t)(microCluster + 1) * _numAttributes, _sums.begin() + i * _numAttributes);
+		_weights[i] = _weights[microCluster];
+		_squaredSums[i] = _squaredSums[microCluster];
+		_labels[i] = _labels[microCluster];
+		uint64_t hash = hashCell(&_cells[i * _numAttributes], _numAttributes);
+		std::unordered_map<uint64_t, int>::iterator entry = _firstWithHash.find(hash);
+		_nextWithHash[i] = entry == _firstWithHash.end() ? -1 : entry->second;
+		_firstWithHash[hash] = i;
+	}
+	_cells.resize(kept.size() * _numAttributes);
+	_sums.resize(kept.size() * _numAttributes);
+	_weights.resize(kept.size());
+	_squaredSums.resize(kept.size());
+	_labels.resize(kept.size());
+	_nextWithHash.resize(kept.size());
+}
+
+hdbscanResult hdbscanMicroClusters::cluster() {
+	//Decay the weights to the latest time, and drop the micro-clusters they underflowed in:
+	if (_halfLife > 0 && !_weights.empty())
+		rescale(_latestTime);
+	prune(_weights.size());
+	hdbscanResult result;
+	result.hasInfiniteStability = false;
+	if (_weights.empty())
+		return result;
+	hdbscanParameters parameters = _parameters;
+	parameters.dataset = getCenters();
+	parameters.sampleWeights = getWeights();
+	result = hdbscanRunner::run(parameters);
+	_labels = result.labels;
+	return result;
+}
+
+int hdbscanMicroClusters::predict(const double* point) {
+	uint64_t hash = findCell(point, _cell.data());
+	int microCluster = findMicroCluster(hash, _cell.data());
+	return microCluster == -1 ? 0 : _labels[microCluster];
+}
+
+std::vector<std::vector<double>> hdbscanMicroClusters::getCenters() {
+	std::vector<std::vector<double>> centers(_weights.size(), std::vector<double>(_numAttributes));
+	for (size_t microCluster = 0; microCluster < _weights.size(); microCluster++) {
+		for (int attribute = 0; attribute < _numAttributes; attribute++)
+			centers[microCluster][attribute] = _sums[microCluster * _numAttributes + attribute] / _weights[microCluster];
+	}
+	return centers;
+}
+
+std::vector<double> hdbscanMicroClusters::getWeights() {
+	double decay = _halfLife > 0 && !_weights.empty() ? std::exp2(-(_latestTime - _referenceTime) / _halfLife) : 1;
+	std::vector<double> weights(_weights.size());
+	for (size_t microCluster = 0; microCluster < _weights.size(); microCluster++)
+		weights[microCluster] = _weights[microCluster] * decay;
+	return weights;
+}
+
+std::vector<double> hdbscanMicroClusters::getRadii() {
+	std::vector<std::vector<double>> centers = getCenters();
+	std::vector<double> radii(_weights.size());
+	for (size_t microCluster = 0; microCluster < _weights.size(); microCluster++) {
+		double squaredNorm = 0;
+		for (double value : centers[microCluster])
+			squaredNorm += value * value;
+		radii[microCluster] = std::sqrt(std::max(0.0, _squaredSums[microCluster] / _weights[microCluster] - squaredNorm));
+	}
+	return radii;
+}
+
+int hdbscanMicroClusters::getNumMicroClusters() {
+	return _weights.size();
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include<cstdint>
+#include<vector>
+#include<unordered_map>
+#include"hdbscanParameters.hpp"
+#include"hdbscanResult.hpp"
+
+/// <summary>
+/// Summarizes an unbounded stream of points in a bounded number of micro-clusters and clusters the summary
+/// with weighted HDBSCAN* on demand. Every cell of a uniform grid that a point falls into is a micro-cluster
+/// holding the weight, the sum and the sum of squared norms of its points, from which its center and radius
+/// follow, so adding a point takes a hash lookup and O(d) arithmetic. Weights decay exponentially with the
+/// given half-life: instead of decaying every micro-cluster, each point is added with a weight that grows
+/// as 2^(t / halfLife), and everything is rescaled when that factor gets large. When there are more than
+/// maxMicroClusters micro-clusters, the lightest are dropped until a quarter of the room is free, so the
+/// drops cost amortized constant time per point. cluster() runs the weighted Dense pipeline over the
+/// centers, whose cost grows quadratically with the number of micro-clusters, and points are labeled
+/// through the micro-cluster of their cell.
+/// </summary>
+class hdbscanMicroClusters
+{
+private:
+	hdbscanParameters _parameters;
+	int _numAttributes;
+	double _cellSize;
+	double _halfLife;
+	int _maxMicroClusters;
+
+	//The time the stored weights are relative to, the latest time seen and the weight of a point at it:
+	double _referenceTime;
+	double _latestTime;
+	double _pointWeight;
+
+	//Micro-clusters in the same cell are impossible, but cells with the same hash are chained:
+	std::vector<int64_t> _cells;
+	std::vector<double> _weights;
+	std::vector<double> _sums;
+	std::vector<double> _squaredSums;
+	std::vector<int> _nextWithHash;
+	std::unordered_map<uint64_t, int> _firstWithHash;
+
+	//The label of every micro-cluster at the last cluster(), 0 for those created since:
+	std::vector<int> _labels;
+	std::vector<int64_t> _cell;
+
+	uint64_t findCell(const double* point, int64_t* cell);
+	int findMicroCluster(uint64_t hash, const int64_t* cell);
+	void rescale(double time);
+	void prune(int numKept);
+
+public:
+	/// <summary>
+	/// Creates an empty summary.
+	/// </summary>
+	/// <param name="parameters">minPoints and minClusterSize, in units of weight, and the distance function of the macro clustering</param>
+	/// <param name="numAttributes">The number of attributes of every point</param>
+	/// <param name="cellSize">The side of the grid cells, which bounds the extent of a micro-cluster</param>
+	/// <param name="halfLife">The time over which a point's weight halves, 0 for no decay</param>
+	/// <param name="maxMicroClusters">The most micro-clusters kept</param>
+	hdbscanMicroClusters(hdbscanParameters parameters, int numAttributes, double cellSize, double halfLife = 0, int maxMicroClusters = 4096);
+
+	/// <summary>
+	/// Adds a point to the micro-cluster of its cell, creating it if the cell is empty.
+	/// </summary>
+	/// <param name="point">The attributes of the point</param>
+	/// <param name="timestamp">The time of the point; times may arrive out of order, decay is measured from the latest</param>
+	void insert(const double* point, double timestamp = 0);
+
+	/// <summary>
+	/// Clusters the micro-clusters with weighted HDBSCAN* as of the latest time seen.
+	/// </summary>
+	/// <returns>The result per micro-cluster, in the order of getCenters()</returns>
+	hdbscanResult cluster();
+
+	/// <summary>
+	/// Returns the label the last cluster() gave the micro-cluster of the point's cell, or 0 (noise) when the
+	/// cell has no micro-cluster or it was created since.
+	/// </summary>
+	int predict(const double* point);
+
+	std::vector<std::vector<double>> getCenters();
+
+	/// <summary>
+	/// Returns the weight of every micro-cluster decayed to the latest time seen.
+	/// </summary>
+	std::vector<double> getWeights();
+
+	/// <summary>
+	/// Returns the root mean square distance of every micro-cluster's points from its center.
+	/// </summary>
+	std::vector<double> getRadii();
+
+	int getNumMicroClusters();
+};
@@ -0,0 +1,265 @@
+#include "hdbscanModel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include "../HdbscanStar/outlierScore.hpp"
+#include "../Distance/EuclideanDistance.hpp"
+#include "../Distance/ManhattanDistance.hpp"
+#include "../Distance/HaversineDistance.hpp"
+#include "../Distance/CosineDistance.hpp"
+#include "../Index/kdTree.hpp"
+#include "../Index/normalizedIndex.hpp"
+#include "../Index/sphericalIndex.hpp"
+#include "../Utils/parallelFor.hpp"
+
+hdbscanModel::hdbscanModel() {
+	_numPoints = 0;
+	_minPoints = 0;
+	_minClusterSize = 0;
+}
+
+hdbscanModel::hdbscanModel(const std::vector<double>& coreDistances, undirectedGraph& sortedMst, uint32_t minPoints, uint32_t minClusterSize) {
+	_numPoints = coreDistances.size();
+	_minPoints = minPoints;
+	_coreDistances = coreDistances;
+	std::vector<int> mstVerticesA;
+	std::vector<int> mstVerticesB;
+	std::vector<double> mstWeights;
+	for (int i = 0; i < sortedMst.getNumEdges(); i++)
+	{
+		int vertexA = sortedMst.getFirstVertexAtIndex(i);
+		int vertexB = sortedMst.getSecondVertexAtIndex(i);
+		if (vertexA == vertexB)
+			continue;
+		mstVerticesA.push_back(vertexA);
+		mstVerticesB.push_back(vertexB);
+		mstWeights.push_back(sortedMst.getEdgeWeightAtIndex(i));
+	}
+	_mstVerticesA = mstVerticesA;
+	_mstVerticesB = mstVerticesB;
+	_mstWeights = mstWeights;
+	_singleLinkageTree = singleLinkageTree(_numPoints, _mstVerticesA, _mstVerticesB, _mstWeights);
+	condense(minClusterSize);
+}
+
+void hdbscanModel::condense(uint32_t minClusterSize) {
+	_condensedTree = condensedTree(_singleLinkageTree, minClusterSize);
+	_minClusterSize = minClusterSize;
+	_selectedClusters.clear();
+	_pointClusters = sharedArray<int>();
+}
+
+hdbscanResult hdbscanModel::select(hdbscanClusterSelectionMethod method, double clusterSelectionEpsilon) {
+	bool infiniteStability;
+	_selectedClusters = _condensedTree.selectClusters(method, clusterSelectionEpsilon, infiniteStability);
+
+	preparePrediction();
+
+	std::vector<int> labels = _condensedTree.labelPoints(_selectedClusters);
+	std::vector<double> membershipProbabilities = _condensedTree.calculateMembershipProbabilities(_selectedClusters);
+	std::vector<double> scores = _condensedTree.calculateOutlierScores();
+
+	std::vector<outlierScore> outlierScores(_numPoints);
+	for (int i = 0; i < _numPoints; i++)
+		outlierScores[i] = outlierScore(scores[i], _coreDistances[i], i);
+	std::sort(outlierScores.begin(), outlierScores.end());
+
+	return hdbscanResult(labels, outlierScores, membershipProbabilities, infiniteStability);
+}
+
+hdbscanResult hdbscanModel::select(uint32_t minClusterSize, hdbscanClusterSelectionMethod method, double clusterSelectionEpsilon) {
+	if (minClusterSize != _minClusterSize)
+		condense(minClusterSize);
+	return select(method, clusterSelectionEpsilon);
+}
+
+void hdbscanModel::buildIndex(const std::vector<std::vector<double>>& dataset, std::string distanceFunction) {
+	if ((int)dataset.size() != _numPoints)
+		throw std::invalid_argument("The dataset must hold the points the model was fitted on.");
+
+	int numAttributes = _numPoints > 0 ? dataset[0].size() : 0;
+	std::vector<double> rows((size_t)_numPoints * numAttributes);
+	for (int i = 0; i < _numPoints; i++)
+	{
+		if ((int)dataset[i].size() != numAttributes)
+			throw std::invalid_argument("Every point must have the same number of attributes.");
+		std::copy(dataset[i].begin(), dataset[i].end(), rows.begin() + (size_t)i * numAttributes);
+	}
+	buildIndex(rows.data(), _numPoints, numAttributes, distanceFunction);
+}
+
+void hdbscanModel::buildIndex(const double* rows, int numPoints, int numAttributes, std::string distanceFunction) {
+	if (numPoints != _numPoints)
+		throw std::invalid_argument("The dataset must hold the points the model was fitted on.");
+
+	if (distanceFunction.length() == 0 || distanceFunction == "Euclidean")
+		_index = std::make_shared<kdTree<EuclideanDistance>>(rows, _numPoints, numAttributes);
+	else if (distanceFunction == "Manhattan")
+		_index = std::make_shared<kdTree<ManhattanDistance>>(rows, _numPoints, numAttributes);
+	else if (distanceFunction == "Haversine" && numAttributes == 2)
+	{
+		std::vector<double> unitVectors((size_t)_numPoints * 3);
+		for (int i = 0; i < _numPoints; i++)
+			HaversineDistance::toUnitVector(&rows[(size_t)i * 2], &unitVectors[(size_t)i * 3]);
+		_index = std::make_shared<sphericalIndex>(unitVectors.data(), _numPoints);
+	}
+	else if (distanceFunction == "Cosine" || distanceFunction == "Angular")
+	{
+		std::vector<double> unitVectors((size_t)_numPoints * numAttributes);
+		for (int i = 0; i < _numPoints; i++)
+			CosineDistance::normalize(&rows[(size_t)i * numAttributes], numAttributes, &unitVectors[(size_t)i * numAttributes]);
+		_index = std::make_shared<normalizedIndex>(unitVectors.data(), _numPoints, numAttributes, CosineDistance(distanceFunction == "Angular"));
+	}
+	else
+		throw std::invalid_argument("No index is available for the distance function " + distanceFunction + ".");
+	_distanceFunction = distanceFunction;
+}
+
+void hdbscanModel::preparePrediction() {
+	_clusterParents = _condensedTree.getClusterParents();
+	_birthLambdas = _condensedTree.getBirthLambdas();
+	_maxLambdas = _condensedTree.getMaxLambdas();
+	_selectedAncestors = _condensedTree.getSelectedAncestors(_selectedClusters);
+	std::vector<int> pointClusters(_numPoints, _numPoints);
+	std::vector<double> pointLambdas(_numPoints, 0);
+	for (size_t row = 0; row < _condensedTree.child.size(); row++)
+	{
+		int point = _condensedTree.child[row];
+		if (point < _numPoints)
+		{
+			pointClusters[point] = _condensedTree.parent[row];
+			pointLambdas[point] = _condensedTree.lambda[row];
+		}
+	}
+	_pointClusters = pointClusters;
+	_pointLambdas = pointLambdas;
+}
+
+void hdbscanModel::predictPoint(const double* point, int* neighborIndices, double* neighborDistances, int& label, double& membershipProbability, double& outlierScore) {
+	int numNeighbors = std::max((int)_minPoints - 1, 1);
+	numNeighbors = _index->queryNearestNeighbors(point, numNeighbors, neighborIndices, neighborDistances);
+	label = 0;
+	membershipProbability = 0;
+	outlierScore = 0;
+	if (numNeighbors == 0)
+		return;
+
+	//The new point's core distance, with the same neighbor count as the training points:
+	double coreDistance = _minPoints > 1 ? neighborDistances[numNeighbors - 1] : 0;
+	int nearestNeighbor = -1;
+	double nearestMutualReachability = std::numeric_limits<double>::max();
+	for (int i = 0; i < numNeighbors; i++)
+	{
+		int neighbor = neighborIndices[i];
+		double mutualReachability = std::max(std::max(neighborDistances[i], coreDistance), _coreDistances[neighbor]);
+		if (mutualReachability < nearestMutualReachability)
+		{
+			nearestMutualReachability = mutualReachability;
+			nearestNeighbor = neighbor;
+		}
+	}
+	double pointLambda = nearestMutualReachability > 0 ? 1 / nearestMutualReachability : std::numeric_limits<double>::infinity();
+
+	//Place the point in the cluster its neighbor belonged to at the point's own density level:
+	int cluster = _pointClusters[nearestNeighbor];
+	if (_pointLambdas[nearestNeighbor] <= pointLambda)
+	{
+		pointLambda = _pointLambdas[nearestNeighbor];
+	}
+	else
+	{
+		while (cluster != _numPoints && _birthLambdas[cluster - _numPoints] >= pointLambda)
+			cluster = _clusterParents[cluster - _numPoints];
+	}
+
+	double clusterMaxLambda = _maxLambdas[cluster - _numPoints];
+	if (clusterMaxLambda > 0 && std::isfinite(pointLambda))
+		outlierScore = std::isfinite(clusterMaxLambda) ? std::max(0.0, (clusterMaxLambda - pointLambda) / clusterMaxLambda) : 1;
+
+	int selectedCluster = _selectedAncestors[cluster - _numPoints];
+	if (selectedCluster < 0)
+		return;
+	label = selectedCluster - _numPoints + 1;
+	double maxLambda = _maxLambdas[selectedCluster - _numPoints];
+	if (maxLambda > 0 && std::isfinite(pointLambda))
+		membershipProbability = std::min(pointLambda, maxLambda) / maxLambda;
+	else
+		membershipProbability = 1;
+}
+
+hdbscanPrediction hdbscanModel::approximatePredict(const std::vector<std::vector<double>>& points, int numThreads) {
+	if (!_index)
+		throw std::logic_error("approximatePredict() needs the training points; call buildIndex() first.");
+	if ((int)_pointClusters.size() != _numPoints)
+		throw std::logic_error("approximatePredict() needs a flat clustering; call select() first.");
+
+	int numPoints = points.size();
+	int numAttributes = _index->getNumAttributes();
+	for (int i = 0; i < numPoints; i++)
+	{
+		if ((int)points[i].size() != numAttributes)
+			throw std::invalid_argument("New points must have the same number of attributes as the training points.");
+	}
+
+	hdbscanPrediction prediction(numPoints);
+	int numNeighbors = std::max((int)_minPoints - 1, 1);
+	parallelFor(0, numPoints, numThreads, [&](int begin, int end) {
+		std::vector<int> neighborIndices(numNeighbors);
+		std::vector<double> neighborDistances(numNeighbors);
+		for (int i = begin; i < end; i++)
+		{
+			predictPoint(points[i].data(), neighborIndices.data(), neighborDistances.data(),
+				prediction.labels[i], prediction.membershipProbabilities[i], prediction.outlierScores[i]);
+		}
+	});
+	return prediction;
+}
+
+int hdbscanModel::getNumPoints() {
+	return _numPoints;
+}
+
+uint32_t hdbscanModel::getMinPoints() {
+	return _minPoints;
+}
+
+uint32_t hdbscanModel::getMinClusterSize() {
+	return _minClusterSize;
+}
+
+std::string hdbscanModel::getDistanceFunction() {
+	return _distanceFunction;
+}
+
+sharedArray<double>& hdbscanModel::getCoreDistances() {
+	return _coreDistances;
+}
+
+sharedArray<int>& hdbscanModel::getMstVerticesA() {
+	return _mstVerticesA;
+}
+
+sharedArray<int>& hdbscanModel::getMstVerticesB() {
+	return _mstVerticesB;
+}
+
+sharedArray<double>& hdbscanModel::getMstWeights() {
+	return _mstWeights;
+}
+
+singleLinkageTree& hdbscanModel::getSingleLinkageTree() {
+	return _singleLinkageTree;
+}
+
+condensedTree& hdbscanModel::getCondensedTree() {
+	return _condensedTree;
+}
+
+std::vector<int>& hdbscanModel::getSelectedClusters() {
+	return _selectedClusters;
+}
+
+std::shared_ptr<spatialIndex> hdbscanModel::getIndex() {
+	return _index;
+}
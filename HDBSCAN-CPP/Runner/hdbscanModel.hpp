@@ -0,0 +1,138 @@
+#pragma once
+#include<cstdint>
+#include<vector>
+#include<string>
+#include<memory>
+#include"hdbscanResult.hpp"
+#include"hdbscanPrediction.hpp"
+#include"../Index/spatialIndex.hpp"
+#include"../HdbscanStar/undirectedGraph.hpp"
+#include"../HdbscanStar/singleLinkageTree.hpp"
+#include"../HdbscanStar/condensedTree.hpp"
+
+/// <summary>
+/// A fitted HDBSCAN* model. It keeps the core distances, the MST sorted by mutual reachability and its
+/// single linkage tree, so the flat clustering can be re-condensed with another minimum cluster size or
+/// re-selected with another method or epsilon in linear time without touching the distances again.
+/// </summary>
+class hdbscanModel
+{
+private:
+	int _numPoints;
+	sharedArray<double> _coreDistances;
+	sharedArray<int> _mstVerticesA;
+	sharedArray<int> _mstVerticesB;
+	sharedArray<double> _mstWeights;
+	singleLinkageTree _singleLinkageTree;
+	condensedTree _condensedTree;
+	uint32_t _minPoints;
+	uint32_t _minClusterSize;
+	std::vector<int> _selectedClusters;
+
+	std::string _distanceFunction;
+	std::shared_ptr<spatialIndex> _index;
+
+	//Per cluster and per point lookups used to place new points in the condensed tree:
+	sharedArray<int> _clusterParents;
+	sharedArray<double> _birthLambdas;
+	sharedArray<double> _maxLambdas;
+	sharedArray<int> _selectedAncestors;
+	sharedArray<int> _pointClusters;
+	sharedArray<double> _pointLambdas;
+
+	void preparePrediction();
+
+	void predictPoint(const double* point, int* neighborIndices, double* neighborDistances, int& label, double& membershipProbability, double& outlierScore);
+
+public:
+	hdbscanModel();
+
+	/// <summary>
+	/// Creates a model from core distances and the MST built from them.
+	/// </summary>
+	/// <param name="coreDistances">The core distance of every point</param>
+	/// <param name="sortedMst">The mutual reachability MST, sorted by edge weight; self edges are ignored</param>
+	/// <param name="minPoints">The minPoints the core distances were calculated with</param>
+	/// <param name="minClusterSize">The minimum cluster size the tree is first condensed with</param>
+	hdbscanModel(const std::vector<double>& coreDistances, undirectedGraph& sortedMst, uint32_t minPoints, uint32_t minClusterSize);
+
+	/// <summary>
+	/// Indexes the training points so that new points can be labelled with approximatePredict().
+	/// </summary>
+	/// <param name="dataset">The points the model was fitted on, in the same order</param>
+	/// <param name="distanceFunction">The distance function the model was fitted with: Euclidean, Manhattan, Haversine, Cosine or Angular</param>
+	void buildIndex(const std::vector<std::vector<double>>& dataset, std::string distanceFunction);
+
+	/// <summary>
+	/// Indexes training points given as row-major attributes, such as a mappedDataset.
+	/// </summary>
+	/// <param name="rows">numPoints rows of numAttributes attributes, in the order the model was fitted on</param>
+	/// <param name="numPoints">The number of rows</param>
+	/// <param name="numAttributes">The number of attributes of each row</param>
+	/// <param name="distanceFunction">The distance function the model was fitted with: Euclidean, Manhattan, Haversine, Cosine or Angular</param>
+	void buildIndex(const double* rows, int numPoints, int numAttributes, std::string distanceFunction);
+
+	/// <summary>
+	/// Labels new points without refitting. Each point's minPoints - 1 nearest training points are found
+	/// through the index, its mutual reachability to each of them is computed from their core distances, and
+	/// it is attached to the condensed tree below its nearest neighbor by mutual reachability. This is the
+	/// approximation of attaching the point to the MST used by the reference implementation; the training
+	/// clustering itself does not change. select() must have been called, and buildIndex() too unless the
+	/// model was fitted from a dataset or mappedDataset.
+	/// </summary>
+	/// <param name="points">The new points, with the same attributes as the training points</param>
+	/// <param name="numThreads">The number of threads to split the batch over; 0 uses all hardware threads</param>
+	/// <returns>Labels matching the last select() (0 for noise), membership probabilities and GLOSH scores</returns>
+	hdbscanPrediction approximatePredict(const std::vector<std::vector<double>>& points, int numThreads = 0);
+
+	/// <summary>
+	/// Rebuilds the condensed tree for another minimum cluster size. Linear in the number of points.
+	/// </summary>
+	void condense(uint32_t minClusterSize);
+
+	/// <summary>
+	/// Selects flat clusters from the current condensed tree and labels every point. Linear in the
+	/// number of points (plus sorting the outlier scores).
+	/// </summary>
+	/// <param name="method">Excess of mass (the default) or leaf selection</param>
+	/// <param name="clusterSelectionEpsilon">Clusters born below this distance are merged into their ancestors</param>
+	hdbscanResult select(hdbscanClusterSelectionMethod method = excessOfMass, double clusterSelectionEpsilon = 0);
+
+	/// <summary>
+	/// Re-condenses with minClusterSize if it differs from the current one, then selects.
+	/// </summary>
+	hdbscanResult select(uint32_t minClusterSize, hdbscanClusterSelectionMethod method = excessOfMass, double clusterSelectionEpsilon = 0);
+
+	int getNumPoints();
+
+	uint32_t getMinPoints();
+
+	uint32_t getMinClusterSize();
+
+	std::string getDistanceFunction();
+
+	sharedArray<double>& getCoreDistances();
+
+	sharedArray<int>& getMstVerticesA();
+
+	sharedArray<int>& getMstVerticesB();
+
+	sharedArray<double>& getMstWeights();
+
+	singleLinkageTree& getSingleLinkageTree();
+
+	condensedTree& getCondensedTree();
+
+	/// <summary>
+	/// Returns the clusters chosen by the last call to select().
+	/// </summary>
+	std::vector<int>& getSelectedClusters();
+
+	/// <summary>
+	/// Returns the index of the training points, or an empty pointer if there is none.
+	/// </summary>
+	std::shared_ptr<spatialIndex> getIndex();
+
+	friend class hdbscanModelFile;
+};
+
@@ -0,0 +1,402 @@
+#include "hdbscanModelFile.hpp"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include "../Distance/EuclideanDistance.hpp"
+#include "../Distance/ManhattanDistance.hpp"
+#include "../Index/kdTree.hpp"
+#include "../Index/normalizedIndex.hpp"
+#include "../Index/sphericalIndex.hpp"
+#include "../Utils/mappedFile.hpp"
+
+namespace
+{
+	const char modelFileMagic[8] = { 'H', 'D', 'B', 'S', 'C', 'A', 'N', 'M' };
+	const uint32_t modelFileByteOrderMark = 0x01020304;
+	const uint64_t modelFileAlignment = 64;
+	const uint32_t hasSelectionFlag = 1;
+	const uint32_t hasIndexFlag = 2;
+
+	struct modelFileHeader
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t byteOrderMark;
+		uint64_t fileSize;
+		uint64_t checksum;
+		int32_t numPoints;
+		int32_t numAttributes;
+		uint32_t minPoints;
+		uint32_t minClusterSize;
+		int32_t numClusters;
+		uint32_t numSections;
+		uint32_t flags;
+		uint32_t reserved;
+		char distanceFunction[32];
+	};
+
+	struct modelFileSection
+	{
+		uint32_t id;
+		uint32_t elementSize;
+		uint64_t offset;
+		uint64_t count;
+	};
+
+	enum modelFileSectionId
+	{
+		coreDistancesSection = 1,
+		mstVerticesASection,
+		mstVerticesBSection,
+		mstWeightsSection,
+		treeLeftSection,
+		treeRightSection,
+		treeDistanceSection,
+		treeSizeSection,
+		condensedParentSection,
+		condensedChildSection,
+		condensedLambdaSection,
+		condensedChildSizeSection,
+		selectedClustersSection,
+		clusterParentsSection,
+		birthLambdasSection,
+		maxLambdasSection,
+		selectedAncestorsSection,
+		pointClustersSection,
+		pointLambdasSection,
+		indexDataSection,
+		indexIndicesSection,
+		indexNodesSection,
+		indexLowerBoundsSection,
+		indexUpperBoundsSection
+	};
+
+	/// <summary>
+	/// A streaming 64-bit checksum over 8-byte words, padding the final partial word with zeros.
+	/// </summary>
+	class modelFileChecksum
+	{
+	private:
+		uint64_t _hash;
+		unsigned char _pending[8];
+		size_t _numPending;
+
+		void mixWord(uint64_t word)
+		{
+			_hash = (_hash ^ word) * 0x9E3779B97F4A7C15ULL;
+			_hash ^= _hash >> 29;
+		}
+
+	public:
+		modelFileChecksum()
+		{
+			_hash = 0xCBF29CE484222325ULL;
+			_numPending = 0;
+		}
+
+		void update(const char* bytes, size_t length)
+		{
+			while (length && _numPending)
+			{
+				_pending[_numPending++] = *bytes++;
+				length--;
+				if (_numPending == 8)
+				{
+					uint64_t word;
+					memcpy(&word, _pending, 8);
+					mixWord(word);
+					_numPending = 0;
+				}
+			}
+			for (; length >= 8; bytes += 8, length -= 8)
+			{
+				uint64_t word;
+				memcpy(&word, bytes, 8);
+				mixWord(word);
+			}
+			//Fewer than 8 bytes remain, and any pending ones were mixed above:
+			memcpy(_pending + _numPending, bytes, length);
+			_numPending += length;
+		}
+
+		uint64_t finish()
+		{
+			if (_numPending)
+			{
+				memset(_pending + _numPending, 0, 8 - _numPending);
+				uint64_t word;
+				memcpy(&word, _pending, 8);
+				mixWord(word);
+				_numPending = 0;
+			}
+			return _hash;
+		}
+	};
+
+	struct pendingSection
+	{
+		modelFileSection section;
+		const char* data;
+	};
+
+	template<typename T>
+	void addSection(std::vector<pendingSection>& sections, uint32_t id, const sharedArray<T>& values)
+	{
+		pendingSection pending;
+		pending.section.id = id;
+		pending.section.elementSize = sizeof(T);
+		pending.section.offset = 0;
+		pending.section.count = values.size();
+		pending.data = (const char*)values.data();
+		sections.push_back(pending);
+	}
+
+	template<class TDistance>
+	bool addIndexSections(std::vector<pendingSection>& sections, std::shared_ptr<spatialIndex> index)
+	{
+		std::shared_ptr<kdTree<TDistance>> tree = std::dynamic_pointer_cast<kdTree<TDistance>>(index);
+		if (!tree)
+			return false;
+		addSection(sections, indexDataSection, tree->getData());
+		addSection(sections, indexIndicesSection, tree->getIndices());
+		addSection(sections, indexNodesSection, tree->getNodes());
+		addSection(sections, indexLowerBoundsSection, tree->getLowerBounds());
+		addSection(sections, indexUpperBoundsSection, tree->getUpperBounds());
+		return true;
+	}
+
+	class modelFileReader
+	{
+	private:
+		std::shared_ptr<mappedFile> _file;
+		const modelFileSection* _sections;
+		uint32_t _numSections;
+
+	public:
+		modelFileReader(std::shared_ptr<mappedFile> file, const modelFileSection* sections, uint32_t numSections)
+		{
+			_file = file;
+			_sections = sections;
+			_numSections = numSections;
+		}
+
+		template<typename T>
+		sharedArray<T> getSection(uint32_t id)
+		{
+			for (uint32_t i = 0; i < _numSections; i++)
+			{
+				const modelFileSection& section = _sections[i];
+				if (section.id != id)
+					continue;
+				if (section.elementSize != sizeof(T) || section.offset % modelFileAlignment != 0 ||
+					section.offset > _file->getSize() || section.count > (_file->getSize() - section.offset) / sizeof(T))
+					throw std::runtime_error("The model file has a malformed section.");
+				return sharedArray<T>(_file, (const T*)(_file->getData() + section.offset), section.count);
+			}
+			throw std::runtime_error("The model file is missing a section.");
+		}
+
+		/// <summary>
+		/// Views a section which must hold exactly the number of elements the header implies.
+		/// </summary>
+		template<typename T>
+		sharedArray<T> getSection(uint32_t id, uint64_t expectedCount)
+		{
+			sharedArray<T> values = getSection<T>(id);
+			if (values.size() != expectedCount)
+				throw std::runtime_error("The model file has a section whose size does not match its header.");
+			return values;
+		}
+	};
+}
+
+void hdbscanModelFile::save(hdbscanModel& model, std::string fileName) {
+	std::vector<pendingSection> sections;
+	uint32_t flags = 0;
+	addSection(sections, coreDistancesSection, model._coreDistances);
+	addSection(sections, mstVerticesASection, model._mstVerticesA);
+	addSection(sections, mstVerticesBSection, model._mstVerticesB);
+	addSection(sections, mstWeightsSection, model._mstWeights);
+	addSection(sections, treeLeftSection, model._singleLinkageTree.left);
+	addSection(sections, treeRightSection, model._singleLinkageTree.right);
+	addSection(sections, treeDistanceSection, model._singleLinkageTree.distance);
+	addSection(sections, treeSizeSection, model._singleLinkageTree.size);
+	addSection(sections, condensedParentSection, model._condensedTree.parent);
+	addSection(sections, condensedChildSection, model._condensedTree.child);
+	addSection(sections, condensedLambdaSection, model._condensedTree.lambda);
+	addSection(sections, condensedChildSizeSection, model._condensedTree.childSize);
+
+	sharedArray<int> selectedClusters(model._selectedClusters);
+	if ((int)model._pointClusters.size() == model._numPoints)
+	{
+		flags |= hasSelectionFlag;
+		addSection(sections, selectedClustersSection, selectedClusters);
+		addSection(sections, clusterParentsSection, model._clusterParents);
+		addSection(sections, birthLambdasSection, model._birthLambdas);
+		addSection(sections, maxLambdasSection, model._maxLambdas);
+		addSection(sections, selectedAncestorsSection, model._selectedAncestors);
+		addSection(sections, pointClustersSection, model._pointClusters);
+		addSection(sections, pointLambdasSection, model._pointLambdas);
+	}
+	//A cosine index is saved as its tree over the normalized rows and a Haversine one as its tree over unit vectors:
+	std::shared_ptr<spatialIndex> index = model._index;
+	std::shared_ptr<normalizedIndex> normalized = std::dynamic_pointer_cast<normalizedIndex>(index);
+	std::shared_ptr<sphericalIndex> spherical = std::dynamic_pointer_cast<sphericalIndex>(index);
+	if (normalized)
+		index = normalized->getTree();
+	else if (spherical)
+		index = spherical->getTree();
+	if (index)
+	{
+		if (!addIndexSections<EuclideanDistance>(sections, index) && !addIndexSections<ManhattanDistance>(sections, index))
+			throw std::runtime_error("The model index cannot be saved.");
+		flags |= hasIndexFlag;
+	}
+
+	//Lay the sections out after the header and the section table:
+	uint64_t offset = sizeof(modelFileHeader) + sections.size() * sizeof(modelFileSection);
+	for (pendingSection& pending : sections)
+	{
+		offset = (offset + modelFileAlignment - 1) / modelFileAlignment * modelFileAlignment;
+		pending.section.offset = offset;
+		offset += pending.section.count * pending.section.elementSize;
+	}
+
+	modelFileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, modelFileMagic, sizeof(header.magic));
+	header.version = formatVersion;
+	header.byteOrderMark = modelFileByteOrderMark;
+	header.fileSize = offset;
+	header.numPoints = model._numPoints;
+	header.numAttributes = index ? index->getNumAttributes() : 0;
+	header.minPoints = model._minPoints;
+	header.minClusterSize = model._minClusterSize;
+	header.numClusters = model._condensedTree.numClusters;
+	header.numSections = sections.size();
+	header.flags = flags;
+	if (model._distanceFunction.length() >= sizeof(header.distanceFunction))
+		throw std::runtime_error("The distance function name is too long to be saved.");
+	strncpy(header.distanceFunction, model._distanceFunction.c_str(), sizeof(header.distanceFunction) - 1);
+
+	std::ofstream file(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file)
+		throw std::runtime_error("Cannot create " + fileName + ".");
+	//The header is checksummed with its checksum field zeroed:
+	modelFileChecksum checksum;
+	file.write((const char*)&header, sizeof(header));
+	checksum.update((const char*)&header, sizeof(header));
+	for (pendingSection& pending : sections)
+	{
+		file.write((const char*)&pending.section, sizeof(modelFileSection));
+		checksum.update((const char*)&pending.section, sizeof(modelFileSection));
+	}
+	uint64_t position = sizeof(modelFileHeader) + sections.size() * sizeof(modelFileSection);
+	const char padding[modelFileAlignment] = { 0 };
+	for (pendingSection& pending : sections)
+	{
+		file.write(padding, pending.section.offset - position);
+		checksum.update(padding, pending.section.offset - position);
+		uint64_t length = pending.section.count * pending.section.elementSize;
+		file.write(pending.data, length);
+		checksum.update(pending.data, length);
+		position = pending.section.offset + length;
+	}
+	header.checksum = checksum.finish();
+	file.seekp(0);
+	file.write((const char*)&header, sizeof(header));
+	if (!file)
+		throw std::runtime_error("Cannot write " + fileName + ".");
+}
+
+hdbscanModel hdbscanModelFile::load(std::string fileName, bool verifyChecksum) {
+	std::shared_ptr<mappedFile> file = std::make_shared<mappedFile>(fileName);
+	if (file->getSize() < sizeof(modelFileHeader))
+		throw std::runtime_error(fileName + " is not an HDBSCAN model file.");
+	modelFileHeader header;
+	memcpy(&header, file->getData(), sizeof(header));
+	if (memcmp(header.magic, modelFileMagic, sizeof(header.magic)) != 0)
+		throw std::runtime_error(fileName + " is not an HDBSCAN model file.");
+	if (header.byteOrderMark != modelFileByteOrderMark)
+		throw std::runtime_error(fileName + " was written on a machine with a different byte order.");
+	if (header.version != formatVersion)
+		throw std::runtime_error(fileName + " has an unsupported model file version.");
+	if (header.fileSize != file->getSize() || header.numSections > (file->getSize() - sizeof(modelFileHeader)) / sizeof(modelFileSection))
+		throw std::runtime_error(fileName + " is truncated.");
+	if (verifyChecksum)
+	{
+		modelFileHeader checksummedHeader = header;
+		checksummedHeader.checksum = 0;
+		modelFileChecksum checksum;
+		checksum.update((const char*)&checksummedHeader, sizeof(checksummedHeader));
+		checksum.update(file->getData() + sizeof(modelFileHeader), file->getSize() - sizeof(modelFileHeader));
+		if (checksum.finish() != header.checksum)
+			throw std::runtime_error(fileName + " is corrupted: the checksum does not match.");
+	}
+	if (header.numPoints < 0 || header.numAttributes < 0 || header.numClusters < 0 || (header.numPoints > 0 && header.numClusters == 0))
+		throw std::runtime_error(fileName + " has a malformed header.");
+
+	//Every section must hold the number of elements the header implies before anything is built on it:
+	uint64_t numPoints = header.numPoints;
+	uint64_t numClusters = header.numClusters;
+	uint64_t numEdges = numPoints > 0 ? numPoints - 1 : 0;
+	uint64_t numCondensedRows = numPoints > 0 ? numPoints + numClusters - 1 : 0;
+
+	modelFileReader reader(file, (const modelFileSection*)(file->getData() + sizeof(modelFileHeader)), header.numSections);
+	hdbscanModel model;
+	header.distanceFunction[sizeof(header.distanceFunction) - 1] = 0;
+	model._numPoints = header.numPoints;
+	model._minPoints = header.minPoints;
+	model._minClusterSize = header.minClusterSize;
+	model._distanceFunction = header.distanceFunction;
+	model._coreDistances = reader.getSection<double>(coreDistancesSection, numPoints);
+	model._mstVerticesA = reader.getSection<int>(mstVerticesASection, numEdges);
+	model._mstVerticesB = reader.getSection<int>(mstVerticesBSection, numEdges);
+	model._mstWeights = reader.getSection<double>(mstWeightsSection, numEdges);
+	model._singleLinkageTree = singleLinkageTree(header.numPoints,
+		reader.getSection<int>(treeLeftSection, numEdges),
+		reader.getSection<int>(treeRightSection, numEdges),
+		reader.getSection<double>(treeDistanceSection, numEdges),
+		reader.getSection<int>(treeSizeSection, numEdges));
+	model._condensedTree = condensedTree(header.numPoints, header.numClusters,
+		reader.getSection<int>(condensedParentSection, numCondensedRows),
+		reader.getSection<int>(condensedChildSection, numCondensedRows),
+		reader.getSection<double>(condensedLambdaSection, numCondensedRows),
+		reader.getSection<int>(condensedChildSizeSection, numCondensedRows));
+
+	if (header.flags & hasSelectionFlag)
+	{
+		model._selectedClusters = reader.getSection<int>(selectedClustersSection).toVector();
+		if (model._selectedClusters.size() > numClusters)
+			throw std::runtime_error(fileName + " has more selected clusters than clusters.");
+		model._clusterParents = reader.getSection<int>(clusterParentsSection, numClusters);
+		model._birthLambdas = reader.getSection<double>(birthLambdasSection, numClusters);
+		model._maxLambdas = reader.getSection<double>(maxLambdasSection, numClusters);
+		model._selectedAncestors = reader.getSection<int>(selectedAncestorsSection, numClusters);
+		model._pointClusters = reader.getSection<int>(pointClustersSection, numPoints);
+		model._pointLambdas = reader.getSection<double>(pointLambdasSection, numPoints);
+	}
+	if (header.flags & hasIndexFlag)
+	{
+		sharedArray<double> data = reader.getSection<double>(indexDataSection, numPoints * (uint64_t)header.numAttributes);
+		sharedArray<int> indices = reader.getSection<int>(indexIndicesSection, numPoints);
+		sharedArray<kdTreeNode> nodes = reader.getSection<kdTreeNode>(indexNodesSection);
+		if (numPoints > 0 && (nodes.size() == 0 || nodes.size() > 2 * numPoints))
+			throw std::runtime_error(fileName + " has an index whose size does not match its header.");
+		sharedArray<double> lowerBounds = reader.getSection<double>(indexLowerBoundsSection, nodes.size() * (uint64_t)header.numAttributes);
+		sharedArray<double> upperBounds = reader.getSection<double>(indexUpperBoundsSection, nodes.size() * (uint64_t)header.numAttributes);
+		if (model._distanceFunction.length() == 0 || model._distanceFunction == "Euclidean")
+			model._index = std::make_shared<kdTree<EuclideanDistance>>(header.numPoints, header.numAttributes, data, indices, nodes, lowerBounds, upperBounds);
+		else if (model._distanceFunction == "Manhattan")
+			model._index = std::make_shared<kdTree<ManhattanDistance>>(header.numPoints, header.numAttributes, data, indices, nodes, lowerBounds, upperBounds);
+		else if (model._distanceFunction == "Cosine" || model._distanceFunction == "Angular")
+			model._index = std::make_shared<normalizedIndex>(std::make_shared<kdTree<EuclideanDistance>>(header.numPoints, header.numAttributes,
+				data, indices, nodes, lowerBounds, upperBounds), CosineDistance(model._distanceFunction == "Angular"));
+		else if (model._distanceFunction == "Haversine" && header.numAttributes == 3)
+			model._index = std::make_shared<sphericalIndex>(std::make_shared<kdTree<EuclideanDistance>>(header.numPoints, header.numAttributes,
+				data, indices, nodes, lowerBounds, upperBounds));
+		else
+			throw std::runtime_error(fileName + " has an index for an unknown distance function.");
+	}
+	return model;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include<cstdint>
+#include<string>
+#include"hdbscanModel.hpp"
+
+/// <summary>
+/// Saves fitted models to a versioned, checksummed binary file and loads them back by memory mapping the
+/// file. A loaded model views its core distances, MST, single linkage tree, condensed tree, selection and
+/// kd-tree directly in the mapping instead of deserializing them, so loading takes constant time and every
+/// process that loads the same file shares one read-only copy of it.
+///
+/// Layout: a fixed header (magic "HDBSCANM", format version, byte order mark, file size, checksum of the
+/// whole file with the checksum field zeroed, model scalars), a table with the id, element size, offset and
+/// element count of every section, then the sections themselves, each aligned to 64 bytes. Values are stored
+/// in the byte order of the machine that wrote the file; a mismatching byte order is rejected. Every section
+/// count is checked against the header's scalars before the model is built on the mapping.
+/// </summary>
+class hdbscanModelFile
+{
+public:
+	static const uint32_t formatVersion = 2;
+
+	/// <summary>
+	/// Writes the model to a file, throwing std::runtime_error if it cannot be written.
+	/// </summary>
+	/// <param name="model">The model to save, with or without a selection and an index</param>
+	/// <param name="fileName">The path of the file to write</param>
+	static void save(hdbscanModel& model, std::string fileName);
+
+	/// <summary>
+	/// Maps a model file, throwing std::runtime_error if it is not a valid model file of this version.
+	/// </summary>
+	/// <param name="fileName">The path of the file to map</param>
+	/// <param name="verifyChecksum">Whether to read the whole file once to verify its checksum</param>
+	/// <returns>A model backed by the mapping; re-condensing or re-selecting it creates in-memory arrays</returns>
+	static hdbscanModel load(std::string fileName, bool verifyChecksum = true);
+};
+
@@ -4,6 +4,11 @@
 #include<iostream>
 #include<vector>
 #include"../HdbscanStar/hdbscanConstraint.hpp"
+#include"../HdbscanStar/outlierScore.hpp"
+#include"../HdbscanStar/sparseDistanceGraph.hpp"
+#include"../Dataset/csrDataset.hpp"
+#include"../Dataset/bitDataset.hpp"
+#include"../Utils/sharedArray.hpp"
 
 using namespace std;
 class hdbscanParameters
@@ -16,14 +21,50 @@ public:
 	/// <param name="distances">The attributes of the first point</param>
 	/// <param name="dataset">The attributes of the second point</param>
 	/// <param name="dataset">The attributes of the second point</param>
-	/// <param name="distanceFunction">Defines the type of distance measure to use : Euclidean, Manhattan ,..</param>
+	/// <param name="mappedDataset">Points as row-major attributes, such as a binary dataset mapped with datasetFile::mapBinary(), used instead of dataset when it has rows; the BallTree, NNDescent and Delaunay engines and quantization read it in place</param>
+	/// <param name="numAttributes">The number of attributes of each row of mappedDataset</param>
+	/// <param name="sparseDataset">Points as sparse rows, used instead of dataset when it has rows (Dense and NNDescent engines)</param>
+	/// <param name="binaryDataset">Points as bit-packed rows, used instead of dataset when it has rows (Dense and NNDescent engines)</param>
+	/// <param name="sparseDistances">Distances known only for some pairs, used instead of distances and dataset when it has vertices</param>
+	/// <param name="distanceFunction">Defines the type of distance measure to use : Euclidean, Manhattan, Haversine (latitude and longitude in radians), Cosine or Angular; Hamming (the default) or Jaccard for binaryDataset</param>
 	/// <param name="minPoints">Min Points in the cluster</param>
 	/// <param name="minClusterSize">The minimum number of points which a cluster needs to be a valid cluster</param>
+	/// <param name="sampleWeights">Optional weight of each point, such as the count of pre-aggregated rows; empty weighs every point as 1</param>
+	/// <param name="collapseDuplicates">Whether run() merges identical rows of the dataset into weighted points first</param>
+	/// <param name="engine">How core distances and the MST are computed: Dense (default), BallTree, NNDescent, Delaunay or Auto, which lets hdbscanPlanner pick one</param>
+	/// <param name="numNeighbors">The neighbors per point in the NNDescent engine's kNN graph; 0 picks a default</param>
+	/// <param name="quantization">How the NNDescent engine compresses the dataset: none (the default), Scalar (one byte per attribute) or Product</param>
+	/// <param name="numSubspaces">The bytes per point of Product quantization; 0 picks one per 4 attributes</param>
+	/// <param name="refineFactor">With quantization, keeps refineFactor times the neighbors from the codes and re-ranks them by exact distance; 0 does not refine</param>
+	/// <param name="outlierSelection">Which outlier scores are returned: all sorted (the default), index-aligned, the top ones or those above a quantile</param>
+	/// <param name="numThreads">The number of threads for the parallel stages; 0 uses all hardware threads</param>
+	/// <param name="memoryBudget">The bytes the MST of sparseDistances may hold in memory, spilling sorted edge runs to workDirectory beyond it; 0 keeps every edge in memory. The Auto engine plans the whole run within it, or within most of the available memory when it is 0</param>
+	/// <param name="workDirectory">An existing directory for temporary files, the current directory when empty</param>
+	/// <param name="planLog">Where the Auto engine writes its estimates and choice and the NNDescent engine the recall of its kNN graph and how many MST edges it took from the graph unchecked; null writes nothing</param>
+	/// <param name="recallSampleSize">The points the NNDescent engine checks against brute force, each costing a distance to every point, to estimate its recall for planLog; 0 skips the estimate</param>
 	vector< vector <double> > distances;
 	vector< vector <double> > dataset;
+	sharedArray<double> mappedDataset;
+	int numAttributes = 0;
+	csrDataset sparseDataset;
+	bitDataset binaryDataset;
+	sparseDistanceGraph sparseDistances;
 	string distanceFunction;
 	uint32_t minPoints;
 	uint32_t minClusterSize;
 	vector<hdbscanConstraint> constraints;
+	vector<double> sampleWeights;
+	bool collapseDuplicates = false;
+	string engine;
+	int numNeighbors = 0;
+	string quantization;
+	int numSubspaces = 0;
+	int refineFactor = 0;
+	outlierScoreSelection outlierSelection;
+	int numThreads = 1;
+	size_t memoryBudget = 0;
+	string workDirectory;
+	ostream* planLog = NULL;
+	int recallSampleSize = 100;
 };
 
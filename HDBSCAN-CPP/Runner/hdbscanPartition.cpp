@@ -0,0 +1,398 @@
+#include "hdbscanPartition.hpp"
+#include "hdbscanRunner.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include "../Dataset/datasetFile.hpp"
+#include "../Distance/EuclideanDistance.hpp"
+#include "../Distance/ManhattanDistance.hpp"
+#include "../HdbscanStar/boruvkaMst.hpp"
+#include "../HdbscanStar/kruskalMst.hpp"
+#include "../Index/ballTree.hpp"
+#include "../Utils/parallelFor.hpp"
+#include "../Utils/parallelProcesses.hpp"
+#include "../Utils/unionFind.hpp"
+
+using namespace hdbscanStar;
+
+//The split values come from at most this many points spread evenly over the dataset:
+static const int maxSampleSize = 1 << 20;
+
+template<typename T>
+static void writeArray(std::string fileName, const T* values, size_t count) {
+	std::ofstream file(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+	file.write((const char*)values, count * sizeof(T));
+	if (!file)
+		throw std::runtime_error("Cannot write " + fileName + ".");
+}
+
+template<typename T>
+static std::vector<T> readArray(std::string fileName) {
+	std::ifstream file(fileName, std::ios::in | std::ios::binary | std::ios::ate);
+	if (!file)
+		throw std::runtime_error("Cannot open " + fileName + ".");
+	std::vector<T> values((size_t)file.tellg() / sizeof(T));
+	file.seekg(0);
+	file.read((char*)values.data(), values.size() * sizeof(T));
+	if (!file)
+		throw std::runtime_error("Cannot read " + fileName + ".");
+	return values;
+}
+
+/// <summary>
+/// A node of the kd partition: points with attribute below value go left. Leaves name their shard.
+/// </summary>
+struct partitionNode
+{
+	int attribute;
+	double value;
+	int left;
+	int right;
+	int shard;
+};
+
+/// <summary>
+/// Splits the sample points [begin, end) into numShards leaves numbered from firstShard, at the quantile of
+/// the widest attribute that leaves each side its share of the shards.
+/// </summary>
+static int buildPartition(std::vector<partitionNode>& nodes, const std::vector<double>& sample, int numAttributes,
+	std::vector<int>& samplePoints, int begin, int end, int firstShard, int numShards) {
+	int node = nodes.size();
+	nodes.push_back({ 0, 0, -1, -1, firstShard });
+	if (numShards == 1)
+		return node;
+
+	int widestAttribute = 0;
+	double widestRange = -1;
+	for (int attribute = 0; attribute < numAttributes && begin < end; attribute++) {
+		double lower = std::numeric_limits<double>::max();
+		double upper = -std::numeric_limits<double>::max();
+		for (int i = begin; i < end; i++) {
+			double value = sample[(size_t)samplePoints[i] * numAttributes + attribute];
+			lower = std::min(lower, value);
+			upper = std::max(upper, value);
+		}
+		if (upper - lower > widestRange) {
+			widestAttribute = attribute;
+			widestRange = upper - lower;
+		}
+	}
+	int leftShards = numShards / 2;
+	int middle = begin + (int)((long long)(end - begin) * leftShards / numShards);
+	double value = 0;
+	if (begin < end) {
+		std::nth_element(samplePoints.begin() + begin, samplePoints.begin() + std::min(middle, end - 1), samplePoints.begin() + end,
+			[&sample, numAttributes, widestAttribute](int first, int second) {
+				return sample[(size_t)first * numAttributes + widestAttribute] < sample[(size_t)second * numAttributes + widestAttribute];
+			});
+		value = sample[(size_t)samplePoints[std::min(middle, end - 1)] * numAttributes + widestAttribute];
+	}
+	nodes[node].attribute = widestAttribute;
+	nodes[node].value = value;
+	int left = buildPartition(nodes, sample, numAttributes, samplePoints, begin, middle, firstShard, leftShards);
+	int right = buildPartition(nodes, sample, numAttributes, samplePoints, middle, end, firstShard + leftShards, numShards - leftShards);
+	nodes[node].left = left;
+	nodes[node].right = right;
+	return node;
+}
+
+hdbscanPartition::hdbscanPartition(hdbscanParameters parameters, std::string datasetFileName, std::string workDirectory, int numShards, int numWorkers) {
+	if (numShards < 1)
+		throw std::invalid_argument("There must be at least one shard.");
+	_parameters = parameters;
+	_datasetFileName = datasetFileName;
+	_workDirectory = workDirectory;
+	_numShards = numShards;
+	_numWorkers = numWorkers;
+	_numPoints = 0;
+	_numAttributes = 0;
+	_numBridgePairs = 0;
+}
+
+std::string hdbscanPartition::getShardFileName(int shard, std::string extension) {
+	return _workDirectory + "/shard-" + std::to_string(shard) + extension;
+}
+
+void hdbscanPartition::partition() {
+	uint64_t numPoints;
+	sharedArray<double> dataset = datasetFile::mapBinary(_datasetFileName, numPoints, _numAttributes);
+	if (numPoints == 0 || numPoints >= (uint64_t)std::numeric_limits<int>::max())
+		throw std::invalid_argument("The partitioned dataset needs between 1 and 2^31 - 2 points.");
+	_numPoints = numPoints;
+
+	int sampleSize = std::min(_numPoints, maxSampleSize);
+	std::vector<double> sample((size_t)sampleSize * _numAttributes);
+	std::vector<int> samplePoints(sampleSize);
+	for (int i = 0; i < sampleSize; i++) {
+		size_t point = (size_t)i * _numPoints / sampleSize;
+		std::copy(dataset.data() + point * _numAttributes, dataset.data() + (point + 1) * _numAttributes, sample.begin() + (size_t)i * _numAttributes);
+		samplePoints[i] = i;
+	}
+	std::vector<partitionNode> nodes;
+	buildPartition(nodes, sample, _numAttributes, samplePoints, 0, sampleSize, 0, _numShards);
+
+	//Stream every point to the file of its shard, with its index in the dataset next to it:
+	std::vector<std::unique_ptr<datasetWriter>> shardWriters;
+	std::vector<std::unique_ptr<std::ofstream>> indexFiles;
+	for (int shard = 0; shard < _numShards; shard++) {
+		shardWriters.emplace_back(new datasetWriter(getShardFileName(shard, ".bin"), true, _numAttributes));
+		indexFiles.emplace_back(new std::ofstream(getShardFileName(shard, ".ids"), std::ios::out | std::ios::binary | std::ios::trunc));
+	}
+	_shardSizes.assign(_numShards, 0);
+	_shardLowerBounds.assign((size_t)_numShards * _numAttributes, std::numeric_limits<double>::max());
+	_shardUpperBounds.assign((size_t)_numShards * _numAttributes, -std::numeric_limits<double>::max());
+	for (int point = 0; point < _numPoints; point++) {
+		const double* attributes = dataset.data() + (size_t)point * _numAttributes;
+		int node = 0;
+		while (nodes[node].left >= 0)
+			node = attributes[nodes[node].attribute] < nodes[node].value ? nodes[node].left : nodes[node].right;
+		int shard = nodes[node].shard;
+		shardWriters[shard]->writeRows(attributes, 1);
+		indexFiles[shard]->write((const char*)&point, sizeof(point));
+		_shardSizes[shard]++;
+		for (int attribute = 0; attribute < _numAttributes; attribute++) {
+			double& lower = _shardLowerBounds[(size_t)shard * _numAttributes + attribute];
+			double& upper = _shardUpperBounds[(size_t)shard * _numAttributes + attribute];
+			lower = std::min(lower, attributes[attribute]);
+			upper = std::max(upper, attributes[attribute]);
+		}
+	}
+	for (int shard = 0; shard < _numShards; shard++) {
+		shardWriters[shard]->close();
+		indexFiles[shard]->close();
+		if (!*indexFiles[shard])
+			throw std::runtime_error("Cannot write " + getShardFileName(shard, ".ids") + ".");
+	}
+}
+
+/// <summary>
+/// The distance between the closest points of two boxes, for a distance which adds up per-attribute gaps.
+/// A box with a single point gives the distance from that point.
+/// </summary>
+template<class TDistance>
+double hdbscanPartition::calculateBoxDistance(const double* lowerA, const double* upperA, const double* lowerB, const double* upperB) {
+	std::vector<double> gaps(_numAttributes);
+	std::vector<double> origin(_numAttributes, 0);
+	for (int attribute = 0; attribute < _numAttributes; attribute++)
+		gaps[attribute] = std::max(0.0, std::max(lowerA[attribute] - upperB[attribute], lowerB[attribute] - upperA[attribute]));
+	TDistance distance;
+	return distance.computeDistance(gaps.data(), origin.data(), _numAttributes);
+}
+
+/// <summary>
+/// Computes the core distances of a shard's points over the whole dataset and the shard's local MST, and
+/// writes them next to the shard.
+/// </summary>
+template<class TDistance>
+void hdbscanPartition::processShard(int shard) {
+	int numThreads = _parameters.numThreads;
+	uint64_t numPoints;
+	int numAttributes;
+	sharedArray<double> rows = datasetFile::mapBinary(getShardFileName(shard, ".bin"), numPoints, numAttributes);
+	std::vector<int> pointIndices = readArray<int>(getShardFileName(shard, ".ids"));
+	ballTree<TDistance> tree(rows.data(), numPoints, numAttributes, 16, numThreads);
+
+	//The k nearest distances of every point, counting itself, nearest first:
+	int k = _parameters.minPoints;
+	std::vector<double> coreDistances(numPoints, 0);
+	if (k > 1) {
+		std::vector<double> nearestDistances((size_t)numPoints * k, std::numeric_limits<double>::max());
+		std::vector<int> positions;
+		std::vector<double> distances;
+		int numFound = tree.queryAllNearestNeighbors(k, numThreads, positions, distances);
+		const std::vector<int>& indices = tree.getIndices();
+		for (size_t i = 0; i < numPoints; i++)
+			std::copy(distances.begin() + i * numFound, distances.begin() + (i + 1) * numFound, nearestDistances.begin() + (size_t)indices[i] * k);
+
+		std::vector<std::pair<double, int>> otherShards;
+		for (int other = 0; other < _numShards; other++) {
+			if (other != shard && _shardSizes[other] != 0)
+				otherShards.push_back(std::make_pair(calculateBoxDistance<TDistance>(&_shardLowerBounds[(size_t)shard * _numAttributes],
+					&_shardUpperBounds[(size_t)shard * _numAttributes], &_shardLowerBounds[(size_t)other * _numAttributes], &_shardUpperBounds[(size_t)other * _numAttributes]), other));
+		}
+		std::sort(otherShards.begin(), otherShards.end());
+		for (const std::pair<double, int>& other : otherShards) {
+			double maxCoreDistance = 0;
+			for (size_t i = 0; i < numPoints; i++)
+				maxCoreDistance = std::max(maxCoreDistance, nearestDistances[i * k + k - 1]);
+			if (other.first >= maxCoreDistance)
+				break;
+
+			uint64_t numOtherPoints;
+			sharedArray<double> otherRows = datasetFile::mapBinary(getShardFileName(other.second, ".bin"), numOtherPoints, numAttributes);
+			ballTree<TDistance> otherTree(otherRows.data(), numOtherPoints, numAttributes, 16, numThreads);
+			const double* lower = &_shardLowerBounds[(size_t)other.second * _numAttributes];
+			const double* upper = &_shardUpperBounds[(size_t)other.second * _numAttributes];
+			parallelFor(0, numPoints, numThreads, [&](int begin, int end) {
+				std::vector<int> neighborIndices(k);
+				std::vector<double> neighborDistances(k);
+				std::vector<double> merged(2 * k);
+				for (int point = begin; point < end; point++) {
+					const double* attributes = rows.data() + (size_t)point * numAttributes;
+					double* nearest = &nearestDistances[(size_t)point * k];
+					if (calculateBoxDistance<TDistance>(attributes, attributes, lower, upper) >= nearest[k - 1])
+						continue;
+					int numOtherFound = otherTree.queryNearestNeighbors(attributes, k, neighborIndices.data(), neighborDistances.data());
+					std::merge(nearest, nearest + k, neighborDistances.begin(), neighborDistances.begin() + numOtherFound, merged.begin());
+					std::copy(merged.begin(), merged.begin() + k, nearest);
+				}
+			});
+		}
+		for (size_t i = 0; i < numPoints; i++)
+			coreDistances[i] = nearestDistances[i * k + k - 1];
+	}
+	writeArray(getShardFileName(shard, ".cores"), coreDistances.data(), numPoints);
+
+	undirectedGraph mst = boruvkaMst::constructMst(tree, coreDistances, false, numThreads);
+	std::vector<weightedEdge> edges(mst.getNumEdges());
+	for (int i = 0; i < mst.getNumEdges(); i++)
+		edges[i] = { mst.getEdgeWeightAtIndex(i), pointIndices[mst.getFirstVertexAtIndex(i)], pointIndices[mst.getSecondVertexAtIndex(i)] };
+	writeArray(getShardFileName(shard, ".mst"), edges.data(), edges.size());
+}
+
+/// <summary>
+/// Builds the MST of the union of two shards and writes the edges between them.
+/// </summary>
+template<class TDistance>
+void hdbscanPartition::processPair(int shardA, int shardB, std::string fileName) {
+	uint64_t numPointsA;
+	uint64_t numPointsB;
+	int numAttributes;
+	sharedArray<double> rowsA = datasetFile::mapBinary(getShardFileName(shardA, ".bin"), numPointsA, numAttributes);
+	sharedArray<double> rowsB = datasetFile::mapBinary(getShardFileName(shardB, ".bin"), numPointsB, numAttributes);
+	std::vector<double> rows(rowsA.begin(), rowsA.end());
+	rows.insert(rows.end(), rowsB.begin(), rowsB.end());
+	std::vector<int> pointIndices = readArray<int>(getShardFileName(shardA, ".ids"));
+	std::vector<int> pointIndicesB = readArray<int>(getShardFileName(shardB, ".ids"));
+	pointIndices.insert(pointIndices.end(), pointIndicesB.begin(), pointIndicesB.end());
+	std::vector<double> coreDistances = readArray<double>(getShardFileName(shardA, ".cores"));
+	std::vector<double> coreDistancesB = readArray<double>(getShardFileName(shardB, ".cores"));
+	coreDistances.insert(coreDistances.end(), coreDistancesB.begin(), coreDistancesB.end());
+
+	ballTree<TDistance> tree(rows.data(), numPointsA + numPointsB, numAttributes, 16, _parameters.numThreads);
+	undirectedGraph mst = boruvkaMst::constructMst(tree, coreDistances, false, _parameters.numThreads);
+	std::vector<weightedEdge> edges;
+	for (int i = 0; i < mst.getNumEdges(); i++) {
+		int vertexA = mst.getFirstVertexAtIndex(i);
+		int vertexB = mst.getSecondVertexAtIndex(i);
+		if ((vertexA < (int)numPointsA) != (vertexB < (int)numPointsA))
+			edges.push_back({ mst.getEdgeWeightAtIndex(i), pointIndices[vertexA], pointIndices[vertexB] });
+	}
+	writeArray(fileName, edges.data(), edges.size());
+}
+
+template<class TDistance>
+undirectedGraph hdbscanPartition::buildMst(std::vector<double>& coreDistances) {
+	partition();
+	parallelProcesses(_numShards, _numWorkers, [this](int shard) {
+		if (_shardSizes[shard] != 0)
+			processShard<TDistance>(shard);
+	});
+
+	//Gather the core distances and the local MSTs:
+	coreDistances.assign(_numPoints, 0);
+	std::vector<double> minCoreDistances(_numShards, std::numeric_limits<double>::max());
+	std::vector<weightedEdge> forest;
+	for (int shard = 0; shard < _numShards; shard++) {
+		if (_shardSizes[shard] == 0)
+			continue;
+		std::vector<int> pointIndices = readArray<int>(getShardFileName(shard, ".ids"));
+		std::vector<double> shardCoreDistances = readArray<double>(getShardFileName(shard, ".cores"));
+		for (size_t i = 0; i < pointIndices.size(); i++) {
+			coreDistances[pointIndices[i]] = shardCoreDistances[i];
+			minCoreDistances[shard] = std::min(minCoreDistances[shard], shardCoreDistances[i]);
+		}
+		std::vector<weightedEdge> edges = readArray<weightedEdge>(getShardFileName(shard, ".mst"));
+		forest.insert(forest.end(), edges.begin(), edges.end());
+	}
+
+	//Shard pairs by a lower bound on the weight of the edges between them:
+	std::vector<std::pair<double, std::pair<int, int>>> pairs;
+	for (int shardA = 0; shardA < _numShards; shardA++) {
+		for (int shardB = shardA + 1; shardB < _numShards; shardB++) {
+			if (_shardSizes[shardA] == 0 || _shardSizes[shardB] == 0)
+				continue;
+			double boxDistance = calculateBoxDistance<TDistance>(&_shardLowerBounds[(size_t)shardA * _numAttributes], &_shardUpperBounds[(size_t)shardA * _numAttributes],
+				&_shardLowerBounds[(size_t)shardB * _numAttributes], &_shardUpperBounds[(size_t)shardB * _numAttributes]);
+			double bound = std::max(boxDistance, std::max(minCoreDistances[shardA], minCoreDistances[shardB]));
+			pairs.push_back(std::make_pair(bound, std::make_pair(shardA, shardB)));
+		}
+	}
+	std::sort(pairs.begin(), pairs.end());
+
+	//Search the pairs in batches, merging their bridge edges into the forest after each batch:
+	_numBridgePairs = 0;
+	size_t nextPair = 0;
+	int batchSize = 2 * resolveNumThreads(_numWorkers);
+	while (nextPair < pairs.size()) {
+		double heaviestEdge = std::numeric_limits<double>::max();
+		if ((int)forest.size() == _numPoints - 1) {
+			heaviestEdge = 0;
+			for (const weightedEdge& edge : forest)
+				heaviestEdge = std::max(heaviestEdge, edge.weight);
+		}
+		std::vector<std::pair<int, int>> batch;
+		while (nextPair < pairs.size() && (int)batch.size() < batchSize && pairs[nextPair].first < heaviestEdge)
+			batch.push_back(pairs[nextPair++].second);
+		if (batch.empty())
+			break;
+		parallelProcesses(batch.size(), _numWorkers, [this, &batch](int index) {
+			processPair<TDistance>(batch[index].first, batch[index].second,
+				_workDirectory + "/bridge-" + std::to_string(batch[index].first) + "-" + std::to_string(batch[index].second) + ".edges");
+		});
+		for (const std::pair<int, int>& pair : batch) {
+			std::string fileName = _workDirectory + "/bridge-" + std::to_string(pair.first) + "-" + std::to_string(pair.second) + ".edges";
+			std::vector<weightedEdge> edges = readArray<weightedEdge>(fileName);
+			forest.insert(forest.end(), edges.begin(), edges.end());
+			std::remove(fileName.c_str());
+		}
+		unionFind components(_numPoints);
+		std::vector<weightedEdge> edges;
+		edges.swap(forest);
+		kruskalMst::constructForest(edges, components, forest);
+		_numBridgePairs += batch.size();
+	}
+
+	for (int shard = 0; shard < _numShards; shard++) {
+		const char* extensions[] = { ".bin", ".ids", ".cores", ".mst" };
+		for (const char* extension : extensions)
+			std::remove(getShardFileName(shard, extension).c_str());
+	}
+
+	for (int point = 0; point < _numPoints; point++)
+		forest.push_back({ coreDistances[point], point, point });
+	std::sort(forest.begin(), forest.end(), [](const weightedEdge& first, const weightedEdge& second) {
+		return first.weight < second.weight;
+	});
+	std::vector<int> verticesA(forest.size());
+	std::vector<int> verticesB(forest.size());
+	std::vector<double> edgeWeights(forest.size());
+	for (size_t i = 0; i < forest.size(); i++) {
+		verticesA[i] = forest[i].vertexA;
+		verticesB[i] = forest[i].vertexB;
+		edgeWeights[i] = forest[i].weight;
+	}
+	return undirectedGraph(_numPoints, verticesA, verticesB, edgeWeights);
+}
+
+undirectedGraph hdbscanPartition::constructMst(std::vector<double>& coreDistances) {
+	if (_parameters.distanceFunction.length() == 0 || _parameters.distanceFunction == "Euclidean")
+		return buildMst<EuclideanDistance>(coreDistances);
+	if (_parameters.distanceFunction == "Manhattan")
+		return buildMst<ManhattanDistance>(coreDistances);
+	throw std::invalid_argument("The partitioned mode supports the Euclidean and Manhattan distances, not " + _parameters.distanceFunction + ".");
+}
+
+hdbscanResult hdbscanPartition::run() {
+	std::vector<double> coreDistances;
+	undirectedGraph mst = constructMst(coreDistances);
+	return hdbscanRunner::clusterMst(mst, coreDistances, _parameters.minClusterSize, _parameters.constraints, std::vector<double>(),
+		_parameters.outlierSelection, _parameters.numThreads);
+}
+
+int hdbscanPartition::getNumBridgePairs() {
+	return _numBridgePairs;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include<string>
+#include<vector>
+#include"hdbscanParameters.hpp"
+#include"hdbscanResult.hpp"
+#include"../HdbscanStar/undirectedGraph.hpp"
+
+/// <summary>
+/// Clusters a binary dataset file which need not fit in memory by splitting it into spatial shards that
+/// worker processes handle one or two at a time, exchanging everything through files in a work directory.
+///  - The split is a kd partition whose split values are quantiles of a sample, so each shard gets about
+///    the same number of points; the points are streamed from the mapped dataset into one file per shard.
+///  - A worker computes the core distances of a shard from its own points and then from the other shards
+///    in order of their bounding box distance, skipping those farther than every core distance so far, and
+///    builds the shard's local MST with Boruvka's algorithm.
+///  - Bridge workers build the MST of the union of two shards and keep the edges between them. Every MST
+///    edge between two shards is in that pair's MST, and every other MST edge is in a local MST, so their
+///    union holds the global MST. Pairs are taken in order of a lower bound on their edges (the box distance
+///    and the smallest core distances), and once the merged forest spans the dataset the pairs whose bound
+///    is not below its heaviest edge are skipped, as each of their edges would close a cycle as its heaviest.
+/// The merged MST, the core distances and the condensed tree of the whole dataset are kept in the calling
+/// process, which needs memory for a few arrays of n values but not for the points.
+/// </summary>
+class hdbscanPartition
+{
+private:
+	hdbscanParameters _parameters;
+	std::string _datasetFileName;
+	std::string _workDirectory;
+	int _numShards;
+	int _numWorkers;
+
+	int _numPoints;
+	int _numAttributes;
+	std::vector<int> _shardSizes;
+	std::vector<double> _shardLowerBounds;
+	std::vector<double> _shardUpperBounds;
+	int _numBridgePairs;
+
+	std::string getShardFileName(int shard, std::string extension);
+	void partition();
+
+	template<class TDistance>
+	undirectedGraph buildMst(std::vector<double>& coreDistances);
+
+	template<class TDistance>
+	void processShard(int shard);
+
+	template<class TDistance>
+	void processPair(int shardA, int shardB, std::string fileName);
+
+	template<class TDistance>
+	double calculateBoxDistance(const double* lowerA, const double* upperA, const double* lowerB, const double* upperB);
+
+public:
+	/// <summary>
+	/// Prepares a run over a binary dataset file, as written by datasetWriter or hdbscan-generate.
+	/// </summary>
+	/// <param name="parameters">minPoints, minClusterSize, the Euclidean (default) or Manhattan distance, constraints,
+	/// outlierSelection and numThreads, the threads of each worker</param>
+	/// <param name="datasetFileName">The binary dataset, which is memory mapped</param>
+	/// <param name="workDirectory">An existing directory for the shard files, which are removed at the end</param>
+	/// <param name="numShards">The number of shards; each worker needs memory for two of them</param>
+	/// <param name="numWorkers">The most worker processes at a time, below 1 for the hardware concurrency</param>
+	hdbscanPartition(hdbscanParameters parameters, std::string datasetFileName, std::string workDirectory, int numShards, int numWorkers);
+
+	/// <summary>
+	/// Computes the core distances and the global MST, sorted by edge weight and with self edges.
+	/// </summary>
+	undirectedGraph constructMst(std::vector<double>& coreDistances);
+
+	/// <summary>
+	/// Builds the global MST and clusters it as hdbscanRunner::run() does.
+	/// </summary>
+	hdbscanResult run();
+
+	/// <summary>
+	/// The number of shard pairs the last constructMst() searched for bridge edges, out of numShards * (numShards - 1) / 2.
+	/// </summary>
+	int getNumBridgePairs();
+};
@@ -0,0 +1,418 @@
+#include "hdbscanPlanner.hpp"
+#include "hdbscanRunner.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include "../HdbscanStar/externalKruskalMst.hpp"
+#include "../Utils/parallelFor.hpp"
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+using namespace hdbscanStar;
+
+//When the budget is not given, the plan leaves this share of the available memory as headroom for the error
+//of the estimates and the allocator:
+static const double availableMemoryShare = 0.9;
+
+//Files are assumed to be read and written at this many bytes per second:
+static const double diskBytesPerSecond = 500e6;
+
+static bool supportsDistanceFunction(const hdbscanWorkload& workload) {
+	const std::string& distanceFunction = workload.distanceFunction;
+	if (workload.dataType == "Distances" || workload.dataType == "SparseDistances")
+		return true;
+	if (workload.dataType == "Binary")
+		return distanceFunction.empty() || distanceFunction == "Hamming" || distanceFunction == "Jaccard";
+	bool common = distanceFunction.empty() || distanceFunction == "Euclidean" || distanceFunction == "Manhattan" ||
+		distanceFunction == "Cosine" || distanceFunction == "Angular";
+	if (workload.dataType == "Sparse")
+		return common;
+	return common || distanceFunction == "Haversine";
+}
+
+//The bytes of the copy of the input which hdbscanRunner::run() takes with its parameters; a mapped dataset is
+//shared with the page cache instead:
+static double calculateInputBytes(const hdbscanWorkload& workload) {
+	double numPoints = workload.numPoints;
+	if (workload.mapped)
+		return 0;
+	if (workload.dataType == "Sparse")
+		return workload.numEntries * 12.0 + numPoints * 8;
+	if (workload.dataType == "Binary")
+		return numPoints * ((workload.numAttributes + 63) / 64) * 8.0;
+	if (workload.dataType == "Distances")
+		return numPoints * (8 * numPoints + 40);
+	if (workload.dataType == "SparseDistances")
+		return workload.numEntries * 16.0;
+	return numPoints * (8.0 * workload.numAttributes + 40);
+}
+
+//The attributes the engines compute distances over: the unit vectors of latitudes and longitudes have 3:
+static int getVectorAttributes(const hdbscanWorkload& workload) {
+	return workload.distanceFunction == "Haversine" ? 3 : workload.numAttributes;
+}
+
+//The cost of one distance, in units of a dense attribute:
+static double getDistanceCost(const hdbscanWorkload& workload) {
+	if (workload.dataType == "Sparse")
+		return workload.numPoints ? 2.0 * workload.numEntries / workload.numPoints : 0;
+	if (workload.dataType == "Binary")
+		return 2.0 * ((workload.numAttributes + 63) / 64);
+	return getVectorAttributes(workload);
+}
+
+/// <summary>
+/// The stage after the MST. hdbscanRunner::run() builds the hierarchy, which stores a row of labels for
+/// every level at which a cluster splits; there are at most about n / (2 minClusterSize) such levels on
+/// noisy data, and every one of the n levels of the MST copies a row, so this stage is quadratic in both
+/// time and memory. fit() condenses a single linkage tree instead, which is linear.
+/// </summary>
+static void estimateClusterStage(const hdbscanWorkload& workload, double& bytes, double& seconds) {
+	double numPoints = workload.numPoints;
+	if (!workload.hierarchy) {
+		bytes = numPoints * 200;
+		seconds = numPoints * std::log2(std::max(numPoints, 2.0)) * 1e-7;
+		return;
+	}
+	double numLevels = std::min(numPoints, numPoints / (2.0 * std::max<uint32_t>(workload.minClusterSize, 1)));
+	bytes = numPoints * 150 + numLevels * numPoints * 4;
+	seconds = numPoints * numPoints * (7.6e-8 + 2.1e-10 * numLevels);
+}
+
+static hdbscanEngineEstimate estimateDense(const hdbscanWorkload& workload, int numThreads) {
+	hdbscanEngineEstimate estimate;
+	estimate.engine = "Dense";
+	double numPoints = workload.numPoints;
+	if (workload.dataType == "Distances") {
+		estimate.peakBytes = numPoints * 150;
+		estimate.seconds = numPoints * numPoints * 1.6e-8;
+		return estimate;
+	}
+	//The matrix, the unit vectors of the Haversine, Cosine and Angular distances and, with weights, the
+	//neighbors sorted for each core distance:
+	estimate.peakBytes = numPoints * (8 * numPoints + 40) + numPoints * 150;
+	if (workload.dataType == "Dense" && workload.distanceFunction.length() != 0 && workload.distanceFunction != "Euclidean" && workload.distanceFunction != "Manhattan")
+		estimate.peakBytes += numPoints * (8.0 * getVectorAttributes(workload) + 40);
+	if (workload.weighted)
+		estimate.peakBytes += numPoints * 16;
+	//A mapped dataset is copied into rows for the matrix:
+	if (workload.mapped)
+		estimate.peakBytes += numPoints * (8.0 * workload.numAttributes + 40);
+	estimate.seconds = numPoints * numPoints * ((workload.weighted ? 3e-8 : 1.6e-8) + 5e-10 * getDistanceCost(workload) / numThreads);
+	return estimate;
+}
+
+static hdbscanEngineEstimate estimateBallTree(const hdbscanWorkload& workload, int numThreads) {
+	hdbscanEngineEstimate estimate;
+	estimate.engine = "BallTree";
+	if (workload.dataType != "Dense")
+		estimate.unsupportedReason = "needs dense points";
+	double numPoints = workload.numPoints;
+	int numAttributes = getVectorAttributes(workload);
+	estimate.peakBytes = numPoints * (230 + 17.0 * numAttributes);
+
+	//Pruning fades as the dimension grows, until every query compares against every point:
+	double treeSeconds = numPoints * std::log2(std::max(numPoints, 2.0)) * 1.5e-6 * std::exp2(std::max(numAttributes - 2, 0));
+	double bruteForceSeconds = numPoints * (1e-5 + numPoints * (2 + numAttributes) * 1e-9);
+	estimate.seconds = 1e-3 + std::min(treeSeconds, bruteForceSeconds) / numThreads;
+	return estimate;
+}
+
+static hdbscanEngineEstimate estimateDelaunay(const hdbscanWorkload& workload) {
+	hdbscanEngineEstimate estimate;
+	estimate.engine = "Delaunay";
+	if (workload.dataType != "Dense")
+		estimate.unsupportedReason = "needs dense points";
+	else if (workload.distanceFunction.length() != 0 && workload.distanceFunction != "Euclidean")
+		estimate.unsupportedReason = "only supports the Euclidean distance";
+	else if (workload.numAttributes != 2 && workload.numAttributes != 3)
+		estimate.unsupportedReason = "needs points with 2 or 3 attributes";
+	double numPoints = workload.numPoints;
+	bool planar = workload.numAttributes == 2;
+	estimate.peakBytes = numPoints * (planar ? 520 : 850);
+	estimate.seconds = numPoints * (planar ? 7e-6 : 3.5e-5);
+	return estimate;
+}
+
+static hdbscanEngineEstimate estimateNNDescent(const hdbscanWorkload& workload, int numThreads) {
+	hdbscanEngineEstimate estimate;
+	estimate.engine = "NNDescent";
+	estimate.exact = false;
+	double numPoints = workload.numPoints;
+	double numNeighbors = std::max<double>(workload.numNeighbors, workload.minPoints - 1.0);
+	//The graph with its candidate lists and, for dense points, the flattened rows, which a mapped dataset
+	//needs only for the distances that transform them:
+	estimate.peakBytes = numPoints * numNeighbors * 140;
+	bool transformed = workload.distanceFunction.length() != 0 && workload.distanceFunction != "Euclidean" && workload.distanceFunction != "Manhattan";
+	if (workload.dataType == "Dense" && (!workload.mapped || transformed))
+		estimate.peakBytes += numPoints * 8.0 * getVectorAttributes(workload);
+	else if (workload.dataType == "Sparse" && (workload.distanceFunction == "Cosine" || workload.distanceFunction == "Angular"))
+		estimate.peakBytes += calculateInputBytes(workload);
+	estimate.seconds = 1e-3 + numPoints * numNeighbors * numNeighbors * (1.2e-6 + 3e-8 * getDistanceCost(workload)) / numThreads;
+	return estimate;
+}
+
+/// <summary>
+/// A Partition run maps the dataset file instead of copying it, keeps the core distances, the MST and the
+/// cluster stage in the coordinator and runs a worker per thread, each holding two shards. The shards are
+/// the fewest (a power of 2) whose workers fit next to the coordinator.
+/// </summary>
+static hdbscanEngineEstimate estimatePartition(const hdbscanWorkload& workload, int numThreads, double memoryBudget, double clusterBytes, double clusterSeconds) {
+	hdbscanEngineEstimate estimate;
+	estimate.engine = "Partition";
+	if (workload.dataType != "Dense")
+		estimate.unsupportedReason = "needs dense points";
+	else if (workload.distanceFunction.length() != 0 && workload.distanceFunction != "Euclidean" && workload.distanceFunction != "Manhattan")
+		estimate.unsupportedReason = "only supports the Euclidean and Manhattan distances";
+	double numPoints = workload.numPoints;
+	int numAttributes = workload.numAttributes;
+	double coordinatorBytes = std::max(numPoints * 24, clusterBytes);
+	double shardPointBytes = 230 + 25.0 * numAttributes;
+	estimate.numShards = 2;
+	while (estimate.numShards < (1 << 16) && coordinatorBytes + numThreads * 2 * numPoints / estimate.numShards * shardPointBytes > memoryBudget)
+		estimate.numShards *= 2;
+	estimate.peakBytes = coordinatorBytes + numThreads * 2 * numPoints / estimate.numShards * shardPointBytes;
+	estimate.seconds = 2 * estimateBallTree(workload, numThreads).seconds + 3 * numPoints * numAttributes * 8 / diskBytesPerSecond + clusterSeconds;
+	return estimate;
+}
+
+static std::vector<hdbscanEngineEstimate> estimateSparseDistances(const hdbscanWorkload& workload, double memoryBudget, double inputBytes, double clusterBytes, double clusterSeconds) {
+	double numPoints = workload.numPoints;
+	double numEdges = workload.numEntries;
+	double sortSeconds = numEdges * std::log2(std::max(numEdges, 2.0)) * 2e-8;
+
+	hdbscanEngineEstimate inMemory;
+	inMemory.engine = "Kruskal";
+	inMemory.peakBytes = inputBytes + std::max(numEdges * 16 + numPoints * 40, clusterBytes);
+	inMemory.seconds = sortSeconds + clusterSeconds;
+
+	//Spill the edges beyond what the input and the core distances leave of the budget:
+	hdbscanEngineEstimate external;
+	external.engine = "ExternalKruskal";
+	double spillBudget = std::min(memoryBudget - inputBytes - numPoints * 8, numEdges * 16 + numPoints * 24);
+	external.spillBudget = (size_t)std::max(spillBudget, (double)externalKruskalMst::getMinMemoryBudget(workload.numPoints));
+	external.peakBytes = inputBytes + std::max((double)external.spillBudget, clusterBytes);
+	external.seconds = 1.5 * sortSeconds + 2 * numEdges * 16 / diskBytesPerSecond + clusterSeconds;
+	return std::vector<hdbscanEngineEstimate>{ inMemory, external };
+}
+
+static std::string formatBytes(double bytes) {
+	const char* units[] = { "B", "KiB", "MiB", "GiB", "TiB", "PiB" };
+	int unit = 0;
+	while (bytes >= 1024 && unit < 5) {
+		bytes /= 1024;
+		unit++;
+	}
+	char text[32];
+	snprintf(text, sizeof(text), unit == 0 ? "%.0f %s" : "%.1f %s", bytes, units[unit]);
+	return text;
+}
+
+static std::string formatSeconds(double seconds) {
+	char text[32];
+	if (seconds < 120)
+		snprintf(text, sizeof(text), "%.2g s", seconds);
+	else if (seconds < 7200)
+		snprintf(text, sizeof(text), "%.0f min", seconds / 60);
+	else
+		snprintf(text, sizeof(text), "%.0f h", seconds / 3600);
+	return text;
+}
+
+hdbscanWorkload hdbscanPlanner::describeWorkload(const hdbscanParameters& parameters, bool hierarchy) {
+	hdbscanWorkload workload;
+	if (parameters.sparseDistances.getNumVertices() != 0) {
+		workload.dataType = "SparseDistances";
+		workload.numPoints = parameters.sparseDistances.getNumVertices();
+		workload.numEntries = parameters.sparseDistances.getNumEdges();
+	}
+	else if (parameters.distances.size() != 0) {
+		workload.dataType = "Distances";
+		workload.numPoints = parameters.distances.size();
+	}
+	else if (parameters.sparseDataset.getNumRows() != 0) {
+		workload.dataType = "Sparse";
+		workload.numPoints = parameters.sparseDataset.getNumRows();
+		workload.numAttributes = parameters.sparseDataset.getNumColumns();
+		workload.numEntries = parameters.sparseDataset.getNumNonzeros();
+	}
+	else if (parameters.binaryDataset.getNumRows() != 0) {
+		workload.dataType = "Binary";
+		workload.numPoints = parameters.binaryDataset.getNumRows();
+		workload.numAttributes = parameters.binaryDataset.getNumBits();
+	}
+	else if (parameters.mappedDataset.size() != 0) {
+		workload.mapped = true;
+		workload.numPoints = parameters.numAttributes > 0 ? parameters.mappedDataset.size() / parameters.numAttributes : 0;
+		workload.numAttributes = parameters.numAttributes;
+	}
+	else {
+		workload.numPoints = parameters.dataset.size();
+		workload.numAttributes = parameters.dataset.size() ? parameters.dataset[0].size() : 0;
+	}
+	workload.distanceFunction = parameters.distanceFunction;
+	workload.minPoints = parameters.minPoints;
+	workload.minClusterSize = parameters.minClusterSize;
+	workload.numNeighbors = hdbscanRunner::getNumNeighbors(parameters);
+	workload.weighted = parameters.collapseDuplicates || parameters.sampleWeights.size() != 0;
+	workload.hierarchy = hierarchy;
+	workload.memoryBudget = parameters.memoryBudget;
+	workload.numThreads = parameters.numThreads;
+	return workload;
+}
+
+hdbscanPlan hdbscanPlanner::plan(const hdbscanWorkload& workload) {
+	hdbscanPlan plan;
+	plan.workload = workload;
+	plan.memoryBudget = workload.memoryBudget != 0 ? workload.memoryBudget : availableMemoryShare * getAvailableMemory();
+	if (plan.memoryBudget == 0)
+		plan.memoryBudget = std::numeric_limits<double>::infinity();
+	int numThreads = resolveNumThreads(workload.numThreads);
+	estimateClusterStage(workload, plan.clusterBytes, plan.clusterSeconds);
+	double inputBytes = calculateInputBytes(workload);
+
+	if (workload.dataType == "SparseDistances")
+		plan.estimates = estimateSparseDistances(workload, plan.memoryBudget, inputBytes, plan.clusterBytes, plan.clusterSeconds);
+	else {
+		plan.estimates.push_back(estimateDense(workload, numThreads));
+		plan.estimates.push_back(estimateBallTree(workload, numThreads));
+		plan.estimates.push_back(estimateDelaunay(workload));
+		plan.estimates.push_back(estimateNNDescent(workload, numThreads));
+		//The engines' own memory is freed before the cluster stage, but the copy of the input is kept:
+		for (hdbscanEngineEstimate& estimate : plan.estimates) {
+			estimate.peakBytes = inputBytes + std::max(estimate.peakBytes, plan.clusterBytes);
+			estimate.seconds += plan.clusterSeconds;
+		}
+		plan.estimates.push_back(estimatePartition(workload, numThreads, plan.memoryBudget, plan.clusterBytes, plan.clusterSeconds));
+	}
+	for (hdbscanEngineEstimate& estimate : plan.estimates) {
+		if (estimate.unsupportedReason.length() != 0)
+			continue;
+		if (!supportsDistanceFunction(workload))
+			estimate.unsupportedReason = "does not support the distance function " + workload.distanceFunction;
+		else if (workload.dataType == "Distances" && estimate.engine != "Dense")
+			estimate.unsupportedReason = "needs the points rather than their distances";
+		else if (workload.weighted && estimate.engine != "Dense")
+			estimate.unsupportedReason = "does not support weighted points";
+		else if (workload.distanceFunction == "Haversine" && workload.numAttributes != 2)
+			estimate.unsupportedReason = "needs a latitude and a longitude for the Haversine distance";
+	}
+
+	const hdbscanEngineEstimate* exact = NULL;
+	const hdbscanEngineEstimate* approximate = NULL;
+	const hdbscanEngineEstimate* partition = NULL;
+	const hdbscanEngineEstimate* smallest = NULL;
+	for (const hdbscanEngineEstimate& estimate : plan.estimates) {
+		if (estimate.unsupportedReason.length() != 0)
+			continue;
+		if (smallest == NULL || estimate.peakBytes < smallest->peakBytes)
+			smallest = &estimate;
+		if (estimate.peakBytes > plan.memoryBudget)
+			continue;
+		if (estimate.engine == "Partition")
+			partition = &estimate;
+		else if (!estimate.exact)
+			approximate = &estimate;
+		else if (exact == NULL || estimate.seconds < exact->seconds)
+			exact = &estimate;
+	}
+	if (exact != NULL && (approximate == NULL || 10 * approximate->seconds >= exact->seconds)) {
+		plan.engine = exact->engine;
+		plan.reason = "the fastest exact engine within the budget";
+	}
+	else if (exact != NULL) {
+		plan.engine = approximate->engine;
+		plan.reason = "estimated ten times faster than " + exact->engine + ", the fastest exact engine";
+	}
+	else if (approximate != NULL) {
+		plan.engine = approximate->engine;
+		plan.reason = "no exact engine fits the budget";
+	}
+	else if (partition != NULL) {
+		plan.engine = partition->engine;
+		plan.reason = "only a partitioned run over a binary dataset file fits the budget";
+	}
+	else if (smallest == NULL)
+		plan.reason = "no engine supports the workload";
+	else if (workload.dataType == "SparseDistances" && inputBytes > plan.memoryBudget)
+		plan.reason = "the copy of the edges a run takes alone needs more than the budget; stream them into externalKruskalMst instead";
+	else if (workload.hierarchy && inputBytes + plan.clusterBytes > plan.memoryBudget)
+		plan.reason = "the cluster hierarchy alone needs more than the budget; hdbscanRunner::fit() condenses the tree in linear memory";
+	else
+		plan.reason = "no engine fits the budget, the smallest being " + smallest->engine + " at " + formatBytes(smallest->peakBytes);
+	return plan;
+}
+
+std::string hdbscanPlanner::describe(const hdbscanPlan& plan) {
+	const hdbscanWorkload& workload = plan.workload;
+	int numThreads = resolveNumThreads(workload.numThreads);
+	std::string text = "Planning " + std::to_string(workload.numPoints) + " points";
+	if (workload.numAttributes != 0)
+		text += " of " + std::to_string(workload.numAttributes) + " attributes";
+	text += " (" + workload.dataType + (workload.distanceFunction.length() != 0 ? ", " + workload.distanceFunction : "") + ") on " +
+		std::to_string(numThreads) + (numThreads == 1 ? " thread" : " threads") + " within " +
+		(std::isinf(plan.memoryBudget) ? std::string("an unknown amount of memory") : formatBytes(plan.memoryBudget)) + ":\n";
+	for (const hdbscanEngineEstimate& estimate : plan.estimates) {
+		char line[160];
+		snprintf(line, sizeof(line), "  %-16s%-12s", estimate.engine.c_str(), estimate.exact ? "exact" : "approximate");
+		text += line;
+		if (estimate.unsupportedReason.length() != 0) {
+			text += estimate.unsupportedReason + "\n";
+			continue;
+		}
+		snprintf(line, sizeof(line), "peak %-12sabout %s", formatBytes(estimate.peakBytes).c_str(), formatSeconds(estimate.seconds).c_str());
+		text += line;
+		if (estimate.engine == "Partition")
+			text += " with " + std::to_string(estimate.numShards) + " shards";
+		text += estimate.peakBytes > plan.memoryBudget ? ", over the budget\n" : "\n";
+	}
+	text += "  The " + std::string(workload.hierarchy ? "cluster hierarchy" : "condensed tree") + " takes " + formatBytes(plan.clusterBytes) +
+		" and " + formatSeconds(plan.clusterSeconds) + " of each.\n";
+	if (plan.engine.length() != 0)
+		text += "Chose " + plan.engine + ": " + plan.reason + ".\n";
+	else
+		text += "Chose no engine: " + plan.reason + ".\n";
+	return text;
+}
+
+size_t hdbscanPlanner::getAvailableMemory() {
+#if defined(__linux__)
+	size_t available = 0;
+	std::ifstream memoryInfo("/proc/meminfo");
+	std::string key;
+	unsigned long long kibibytes;
+	while (memoryInfo >> key >> kibibytes) {
+		if (key == "MemAvailable:") {
+			available = kibibytes * 1024;
+			break;
+		}
+		memoryInfo.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+	}
+	//The memory limit of a container's cgroup (version 2, then 1) caps what the process may take, whatever
+	//the machine has free:
+	const char* cgroupFiles[][2] = {
+		{ "/sys/fs/cgroup/memory.max", "/sys/fs/cgroup/memory.current" },
+		{ "/sys/fs/cgroup/memory/memory.limit_in_bytes", "/sys/fs/cgroup/memory/memory.usage_in_bytes" } };
+	for (int version = 0; version < 2; version++) {
+		unsigned long long limit;
+		unsigned long long usage;
+		std::ifstream limitFile(cgroupFiles[version][0]);
+		std::ifstream usageFile(cgroupFiles[version][1]);
+		if (!(limitFile >> limit) || !(usageFile >> usage))
+			continue;
+		size_t remaining = limit > usage ? limit - usage : 0;
+		available = available == 0 ? remaining : std::min(available, remaining);
+		break;
+	}
+	return available;
+#elif !defined(_WIN32)
+	long numPages = sysconf(_SC_PHYS_PAGES);
+	long pageSize = sysconf(_SC_PAGESIZE);
+	return numPages > 0 && pageSize > 0 ? (size_t)numPages * pageSize : 0;
+#else
+	return 0;
+#endif
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include<cstddef>
+#include<cstdint>
+#include<string>
+#include<vector>
+#include"hdbscanParameters.hpp"
+
+/// <summary>
+/// The size and shape of a clustering problem, which is all the planner needs to know about it.
+/// </summary>
+struct hdbscanWorkload
+{
+	int64_t numPoints = 0;
+	int numAttributes = 0;
+	//Dense (rows of doubles), Sparse (CSR rows), Binary (bit-packed rows), Distances (a distance matrix) or
+	//SparseDistances (an edge list):
+	std::string dataType = "Dense";
+	//Whether dense points are viewed in a mapped file, which the run reads in place, rather than held as rows:
+	bool mapped = false;
+	//The nonzeros of a sparse dataset or the edges of sparse distances:
+	int64_t numEntries = 0;
+	std::string distanceFunction;
+	uint32_t minPoints = 5;
+	uint32_t minClusterSize = 5;
+	//The neighbors per point of the NNDescent engine's kNN graph:
+	int numNeighbors = 10;
+	//Whether there are sample weights or duplicates to collapse, which only the Dense engine handles:
+	bool weighted = false;
+	//Whether the run builds the cluster hierarchy of hdbscanRunner::run(), rather than the model of fit():
+	bool hierarchy = true;
+	//The bytes the run may take, 0 for most of the memory available to the process:
+	size_t memoryBudget = 0;
+	int numThreads = 1;
+};
+
+/// <summary>
+/// What one engine would cost on a workload. Estimates are rough: they come from measurements on a
+/// commodity x86 core and from the data structures each engine allocates, and real times depend on how
+/// well the data clusters, above all for the BallTree engine.
+/// </summary>
+struct hdbscanEngineEstimate
+{
+	std::string engine;
+	bool exact = true;
+	//Why the engine cannot run the workload, empty when it can:
+	std::string unsupportedReason;
+	//The peak bytes of the run, including the copy of the input the run takes and the cluster stage:
+	double peakBytes = 0;
+	double seconds = 0;
+	//The shards of a Partition run:
+	int numShards = 0;
+	//The budget an ExternalKruskal run spills its edges beyond:
+	size_t spillBudget = 0;
+};
+
+/// <summary>
+/// The estimates of every engine and the one chosen.
+/// </summary>
+struct hdbscanPlan
+{
+	hdbscanWorkload workload;
+	//The bytes the plan had to fit in:
+	double memoryBudget = 0;
+	//The cost of the stage which follows the MST, included in every estimate:
+	double clusterBytes = 0;
+	double clusterSeconds = 0;
+	std::vector<hdbscanEngineEstimate> estimates;
+	//The engine chosen, empty when none fits the budget, and why:
+	std::string engine;
+	std::string reason;
+};
+
+/// <summary>
+/// Estimates the peak memory and the runtime of every engine on a workload and picks one, so the size of a
+/// problem decides how it is clustered rather than a quadratic distance matrix taking the process down.
+/// The fastest exact engine which fits the memory budget is chosen, and the approximate NNDescent engine
+/// when no exact engine fits or it is estimated to be ten times faster. When nothing that runs in memory
+/// fits, the plan points at a Partition run (hdbscanPartition) for Euclidean and Manhattan points, or has
+/// no engine. Sparse distances have no engine to choose; their plan tells whether the edges fit in memory or
+/// have to spill to disk with externalKruskalMst. hdbscanRunner uses it for the "Auto" engine.
+/// </summary>
+class hdbscanPlanner
+{
+public:
+	/// <summary>
+	/// Describes the workload held in parameters.
+	/// </summary>
+	/// <param name="parameters">The dataset, distances or sparse distances, minPoints, minClusterSize, the weights, memoryBudget and numThreads</param>
+	/// <param name="hierarchy">Whether the run builds the cluster hierarchy, as hdbscanRunner::run() does</param>
+	static hdbscanWorkload describeWorkload(const hdbscanParameters& parameters, bool hierarchy);
+
+	/// <summary>
+	/// Estimates every engine on the workload and picks one.
+	/// </summary>
+	static hdbscanPlan plan(const hdbscanWorkload& workload);
+
+	/// <summary>
+	/// Returns the plan as lines of text: the workload, one line per engine and the decision.
+	/// </summary>
+	static std::string describe(const hdbscanPlan& plan);
+
+	/// <summary>
+	/// Returns the bytes of memory available to the process: the available physical memory, capped by the
+	/// cgroup limit of a container, or 0 when it cannot be told.
+	/// </summary>
+	static size_t getAvailableMemory();
+};
@@ -0,0 +1,11 @@
+#include "hdbscanPrediction.hpp"
+
+hdbscanPrediction::hdbscanPrediction() {
+	;
+}
+
+hdbscanPrediction::hdbscanPrediction(int numPoints) {
+	labels.resize(numPoints);
+	membershipProbabilities.resize(numPoints);
+	outlierScores.resize(numPoints);
+}
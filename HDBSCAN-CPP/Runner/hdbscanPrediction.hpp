@@ -0,0 +1,17 @@
+#pragma once
+#include<vector>
+using namespace std;
+/// <summary>
+/// Labels, membership probabilities and outlier scores predicted for new points, one entry per point in
+/// the order the points were given.
+/// </summary>
+class hdbscanPrediction
+{
+public:
+	vector <int> labels;
+	vector <double> membershipProbabilities;
+	vector <double> outlierScores;
+	hdbscanPrediction();
+	hdbscanPrediction(int numPoints);
+};
+
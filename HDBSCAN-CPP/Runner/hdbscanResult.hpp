@@ -7,6 +7,7 @@ class hdbscanResult
 public:
 	vector <int> labels;
 	vector <outlierScore> outliersScores;
+	vector <float> indexedOutlierScores;
 	vector <double> membershipProbabilities;
 	bool hasInfiniteStability;
 	hdbscanResult();
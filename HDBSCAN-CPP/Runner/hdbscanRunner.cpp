@@ -1,65 +1,692 @@
 #include "hdbscanRunner.hpp"
 #include "hdbscanResult.hpp"
 #include "hdbscanParameters.hpp"
+#include "hdbscanPlanner.hpp"
 #include"../Distance/EuclideanDistance.hpp"
 #include"../Distance/ManhattanDistance.hpp"
+#include"../Distance/HaversineDistance.hpp"
+#include"../Distance/CosineDistance.hpp"
+#include"../Distance/SparseEuclideanDistance.hpp"
+#include"../Distance/SparseManhattanDistance.hpp"
+#include"../Distance/HammingDistance.hpp"
+#include"../Distance/JaccardDistance.hpp"
+#include"../Distance/ScalarQuantizedDistance.hpp"
+#include"../Distance/ProductQuantizedDistance.hpp"
+#include"../Dataset/scalarQuantizer.hpp"
 #include"../HdbscanStar/hdbscanAlgorithm.hpp"
 #include"../HdbscanStar/undirectedGraph.hpp"
 #include"../HdbscanStar/cluster.hpp"
 #include"../HdbscanStar/outlierScore.hpp"
+#include"../HdbscanStar/boruvkaMst.hpp"
+#include"../HdbscanStar/kruskalMst.hpp"
+#include"../HdbscanStar/externalKruskalMst.hpp"
+#include"../HdbscanStar/delaunayMst.hpp"
+#include"../Index/ballTree.hpp"
+#include"../Index/nnDescent.hpp"
+#include"../Utils/parallelFor.hpp"
+#include"../Utils/duplicateCollapser.hpp"
+#include<algorithm>
+#include<functional>
+#include<limits>
+#include<stdexcept>
+#include<type_traits>
+#include<utility>
 
 using namespace hdbscanStar;
 
 hdbscanResult hdbscanRunner::run(hdbscanParameters parameters) {
-	int numPoints = parameters.dataset.size() != 0 ? parameters.dataset.size() : parameters.distances.size();
+	if (parameters.engine == "Auto")
+		selectEngine(parameters, true);
+	if (parameters.collapseDuplicates || parameters.sampleWeights.size() != 0)
+		return runWeighted(parameters);
 
-	hdbscanAlgorithm algorithm;
-	hdbscanResult result;
-	if (parameters.distances.size() == 0) {
-		std::vector<std::vector<double>> distances(numPoints);
-		for (int i = 0; i < numPoints; i++) {
-			distances[i].resize(numPoints);
-			//distances[i]=std::vector<double>(numPoints);
-			for (int j = 0; j < i; j++) {
-				if (parameters.distanceFunction.length() == 0) {
-					//Default to Euclidean
-					EuclideanDistance EDistance;
-					double distance;
-					distance = EDistance.computeDistance(parameters.dataset[i], parameters.dataset[j]);
-					distances[i][j] = distance;
-					distances[j][i] = distance;
+	std::vector<double> coreDistances;
+	undirectedGraph mst;
+	calculateCoreDistancesAndMst(parameters, coreDistances, mst);
+	//The distance matrix is not needed past the MST, and the cluster stage has memory of its own to take:
+	std::vector<std::vector<double>>().swap(parameters.distances);
+	mst.quicksortByEdgeWeight();
 
+	return clusterMst(mst, coreDistances, parameters.minClusterSize, parameters.constraints, std::vector<double>(), parameters.outlierSelection, parameters.numThreads);
+}
+
+static std::vector<double> flattenDataset(const hdbscanParameters& parameters, int& numAttributes) {
+	int numPoints = parameters.dataset.size();
+	numAttributes = numPoints ? parameters.dataset[0].size() : 0;
+	std::vector<double> dataset((size_t)numPoints * numAttributes);
+	for (int i = 0; i < numPoints; i++) {
+		if ((int)parameters.dataset[i].size() != numAttributes)
+			throw std::invalid_argument("The " + parameters.engine + " engine needs every point to have the same number of attributes.");
+		std::copy(parameters.dataset[i].begin(), parameters.dataset[i].end(), dataset.begin() + (size_t)i * numAttributes);
+	}
+	return dataset;
+}
+
+//The rows of a dense dataset: mappedDataset viewed in place, or dataset flattened into an owned array:
+static sharedArray<double> getDenseRows(const hdbscanParameters& parameters, int& numPoints, int& numAttributes) {
+	if (parameters.mappedDataset.size() == 0) {
+		numPoints = parameters.dataset.size();
+		return sharedArray<double>(flattenDataset(parameters, numAttributes));
+	}
+	numAttributes = parameters.numAttributes;
+	if (numAttributes <= 0 || parameters.mappedDataset.size() % numAttributes != 0)
+		throw std::invalid_argument("The size of mappedDataset must be a multiple of numAttributes.");
+	numPoints = parameters.mappedDataset.size() / numAttributes;
+	return parameters.mappedDataset;
+}
+
+//Copies mappedDataset into dataset for the stages which only read nested rows:
+static void loadMappedDataset(hdbscanParameters& parameters) {
+	if (parameters.mappedDataset.size() == 0)
+		return;
+	int numPoints;
+	int numAttributes;
+	sharedArray<double> rows = getDenseRows(parameters, numPoints, numAttributes);
+	parameters.dataset.resize(numPoints);
+	for (int i = 0; i < numPoints; i++)
+		parameters.dataset[i].assign(rows.begin() + (size_t)i * numAttributes, rows.begin() + (size_t)(i + 1) * numAttributes);
+	parameters.mappedDataset = sharedArray<double>();
+}
+
+template<class TDistance>
+static void calculateBallTreeCoreDistancesAndMst(hdbscanParameters& parameters, const sharedArray<double>& dataset, int numPoints, int numAttributes, std::vector<double>& coreDistances, undirectedGraph& mst) {
+	ballTree<TDistance> tree(dataset.data(), numPoints, numAttributes, 16, parameters.numThreads);
+
+	//A point's core distance is the distance to its minPoints-th nearest neighbor, counting itself:
+	int k = parameters.minPoints;
+	coreDistances.assign(numPoints, 0);
+	if (k > 1) {
+		std::vector<int> positions;
+		std::vector<double> distances;
+		int numFound = tree.queryAllNearestNeighbors(k, parameters.numThreads, positions, distances);
+		const std::vector<int>& indices = tree.getIndices();
+		for (int i = 0; i < numPoints; i++)
+			coreDistances[indices[i]] = numFound == k ? distances[(size_t)i * k + k - 1] : std::numeric_limits<double>::max();
+	}
+	mst = boruvkaMst::constructMst(tree, coreDistances, true, parameters.numThreads);
+}
+
+//Core distances from kNN lists sorted nearest first, which leave out the point itself; it counts as its own
+//first neighbor:
+static void calculateListCoreDistances(const std::vector<double>& neighborDistances, int numPoints, int numNeighbors, int minPoints, std::vector<double>& coreDistances) {
+	int k = minPoints;
+	coreDistances.assign(numPoints, 0);
+	if (k > 1) {
+		for (int i = 0; i < numPoints; i++)
+			coreDistances[i] = k - 1 <= numNeighbors ? neighborDistances[(size_t)i * numNeighbors + k - 2] : std::numeric_limits<double>::max();
+	}
+}
+
+//Writes the recall of an NNDescent graph, measured against brute force on recallSampleSize points, to planLog.
+//The graph over quantized codes is measured by the quantized distance:
+template<class TDistance, class TRows>
+static void logRecall(const hdbscanParameters& parameters, nnDescent<TDistance, TRows>& graph) {
+	if (parameters.planLog == NULL || parameters.recallSampleSize <= 0)
+		return;
+	int sampleSize = std::min(parameters.recallSampleSize, graph.getNumPoints());
+	double recall = graph.estimateRecall(sampleSize, parameters.numThreads);
+	*parameters.planLog << "NNDescent graph of " << graph.getNumNeighbors() << " neighbors has a recall of " << recall
+		<< " on " << sampleSize << " sampled points.\n";
+}
+
+//Writes to planLog how many MST edges the neighbor lists' bound certified. The bound only holds for exact
+//lists, so these edges may not be the lightest and the MST can be heavier than the exact one:
+static void logBoundEdges(const hdbscanParameters& parameters, int numBoundEdges, int numPoints) {
+	if (parameters.planLog == NULL)
+		return;
+	*parameters.planLog << "NNDescent MST took " << numBoundEdges << " of its " << std::max(numPoints - 1, 0)
+		<< " edges from the approximate neighbor lists without checking them outside the graph.\n";
+}
+
+template<class TDistance, class TRows>
+static void calculateNNDescentCoreDistancesAndMst(hdbscanParameters& parameters, const TRows& rows, int numPoints, std::vector<double>& coreDistances, undirectedGraph& mst,
+	const TDistance& distance = TDistance()) {
+	nnDescentOptions options;
+	nnDescent<TDistance, TRows> graph(rows, numPoints, hdbscanRunner::getNumNeighbors(parameters), options, parameters.numThreads, distance);
+	logRecall(parameters, graph);
+	int numNeighbors = graph.getNumNeighbors();
+	calculateListCoreDistances(graph.getDistances(), numPoints, numNeighbors, parameters.minPoints, coreDistances);
+	int numBoundEdges;
+	mst = boruvkaMst::constructMst(graph.getRows(), numPoints, graph.getDistance(), graph.getNeighbors(),
+		graph.getDistances(), numNeighbors, coreDistances, true, parameters.numThreads, &numBoundEdges);
+	logBoundEdges(parameters, numBoundEdges, numPoints);
+}
+
+//Builds the kNN graph over the codes with refineFactor times the neighbors, keeps the nearest by the exact
+//distance and runs Boruvka's algorithm on the exact rows, which are read where they are (a mapped dataset
+//stays in the page cache instead of being copied next to the codes):
+template<class TDistance, class TCodeDistance, class TCodeRows>
+static void calculateRefinedCoreDistancesAndMst(hdbscanParameters& parameters, const sharedArray<double>& dataset, int numPoints, int numAttributes,
+	const TCodeRows& codes, const TCodeDistance& codeDistance, std::vector<double>& coreDistances, undirectedGraph& mst) {
+	int numNeighbors = std::min(hdbscanRunner::getNumNeighbors(parameters), numPoints - 1);
+	nnDescentOptions options;
+	nnDescent<TCodeDistance, TCodeRows> candidates(codes, numPoints, numNeighbors * parameters.refineFactor, options, parameters.numThreads, codeDistance);
+	logRecall(parameters, candidates);
+	int numCandidates = candidates.getNumNeighbors();
+	numNeighbors = std::min(numNeighbors, numCandidates);
+
+	std::vector<int> neighbors((size_t)numPoints * numNeighbors);
+	std::vector<double> neighborDistances((size_t)numPoints * numNeighbors);
+	parallelFor(0, numPoints, parameters.numThreads, [&](int begin, int end) {
+		TDistance distance;
+		std::vector<std::pair<double, int>> entries(numCandidates);
+		for (int point = begin; point < end; point++) {
+			for (int i = 0; i < numCandidates; i++) {
+				int candidate = candidates.getNeighbors()[(size_t)point * numCandidates + i];
+				entries[i] = std::make_pair(distance.computeDistance(&dataset[(size_t)point * numAttributes], &dataset[(size_t)candidate * numAttributes], numAttributes), candidate);
+			}
+			std::partial_sort(entries.begin(), entries.begin() + numNeighbors, entries.end());
+			for (int i = 0; i < numNeighbors; i++) {
+				neighborDistances[(size_t)point * numNeighbors + i] = entries[i].first;
+				neighbors[(size_t)point * numNeighbors + i] = entries[i].second;
+			}
+		}
+	});
+	calculateListCoreDistances(neighborDistances, numPoints, numNeighbors, parameters.minPoints, coreDistances);
+	int numBoundEdges;
+	mst = boruvkaMst::constructMst(denseRows(dataset.data(), numAttributes), numPoints, TDistance(), neighbors,
+		neighborDistances, numNeighbors, coreDistances, true, parameters.numThreads, &numBoundEdges);
+	logBoundEdges(parameters, numBoundEdges, numPoints);
+}
+
+template<class TDistance>
+static void calculateQuantizedCoreDistancesAndMst(hdbscanParameters& parameters, sharedArray<double>& dataset, int numPoints, int numAttributes, std::vector<double>& coreDistances, undirectedGraph& mst) {
+	bool manhattan = std::is_same<TDistance, ManhattanDistance>::value;
+	if (parameters.quantization == "Scalar") {
+		scalarQuantizer quantizer(dataset.data(), numPoints, numAttributes, parameters.numThreads);
+		ScalarQuantizedDistance distance(quantizer.getScale(), manhattan);
+		if (parameters.refineFactor > 0) {
+			calculateRefinedCoreDistancesAndMst<TDistance>(parameters, dataset, numPoints, numAttributes, quantizer.getRows(), distance, coreDistances, mst);
+			return;
+		}
+		dataset = sharedArray<double>();
+		calculateNNDescentCoreDistancesAndMst(parameters, quantizer.getRows(), numPoints, coreDistances, mst, distance);
+	}
+	else if (parameters.quantization == "Product") {
+		int numSubspaces = parameters.numSubspaces > 0 ? std::min(parameters.numSubspaces, numAttributes) : std::max(1, numAttributes / 4);
+		productQuantizer quantizer(dataset.data(), numPoints, numAttributes, numSubspaces, manhattan, parameters.numThreads);
+		ProductQuantizedDistance distance(quantizer);
+		if (parameters.refineFactor > 0) {
+			calculateRefinedCoreDistancesAndMst<TDistance>(parameters, dataset, numPoints, numAttributes, quantizer.getRows(), distance, coreDistances, mst);
+			return;
+		}
+		nnDescentOptions options;
+		nnDescent<ProductQuantizedDistance, codeRows<uint8_t>> graph(quantizer.getRows(), numPoints, hdbscanRunner::getNumNeighbors(parameters),
+			options, parameters.numThreads, distance);
+		logRecall(parameters, graph);
+		int numNeighbors = graph.getNumNeighbors();
+
+		//Core distances are the smallest distances and suffer most from quantizing both ends, so each point
+		//measures them from its own attributes with its asymmetric table:
+		std::vector<double> queryDistances((size_t)numPoints * numNeighbors);
+		parallelFor(0, numPoints, parameters.numThreads, [&](int begin, int end) {
+			std::vector<float> table;
+			for (int point = begin; point < end; point++) {
+				quantizer.computeQueryTable(&dataset[(size_t)point * numAttributes], table);
+				for (int i = 0; i < numNeighbors; i++) {
+					size_t offset = (size_t)point * numNeighbors + i;
+					queryDistances[offset] = quantizer.computeQueryDistance(table, graph.getNeighbors()[offset]);
 				}
-				else if (parameters.distanceFunction == "Euclidean") {
-					EuclideanDistance EDistance;
-					double distance;
-					distance = EDistance.computeDistance(parameters.dataset[i], parameters.dataset[j]);
-					distances[i][j] = distance;
-					distances[j][i] = distance;
-				}
-				else if (parameters.distanceFunction == "Manhattan") {
-					ManhattanDistance MDistance;
-					double distance;
-					distance = MDistance.computeDistance(parameters.dataset[i], parameters.dataset[j]);
-					distances[i][j] = distance;
-					distances[j][i] = distance;
-				}
+				std::sort(queryDistances.begin() + (size_t)point * numNeighbors, queryDistances.begin() + (size_t)(point + 1) * numNeighbors);
 			}
+		});
+		dataset = sharedArray<double>();
+		calculateListCoreDistances(queryDistances, numPoints, numNeighbors, parameters.minPoints, coreDistances);
+		int numBoundEdges;
+		mst = boruvkaMst::constructMst(graph.getRows(), numPoints, graph.getDistance(), graph.getNeighbors(),
+			graph.getDistances(), numNeighbors, coreDistances, true, parameters.numThreads, &numBoundEdges);
+		logBoundEdges(parameters, numBoundEdges, numPoints);
+	}
+	else
+		throw std::invalid_argument("Unknown quantization " + parameters.quantization + ".");
+}
+
+template<class TDistance>
+static void calculateEngineCoreDistancesAndMst(hdbscanParameters& parameters, sharedArray<double>& dataset, int numPoints, int numAttributes, std::vector<double>& coreDistances, undirectedGraph& mst) {
+	if (parameters.engine == "BallTree")
+		calculateBallTreeCoreDistancesAndMst<TDistance>(parameters, dataset, numPoints, numAttributes, coreDistances, mst);
+	else if (parameters.quantization.length() != 0)
+		calculateQuantizedCoreDistancesAndMst<TDistance>(parameters, dataset, numPoints, numAttributes, coreDistances, mst);
+	else
+		calculateNNDescentCoreDistancesAndMst<TDistance>(parameters, denseRows(dataset.data(), numAttributes), numPoints, coreDistances, mst);
+}
+
+//Maps (latitude, longitude) rows onto the unit sphere, where chord distances order pairs as great-circle distances do:
+static std::vector<double> toUnitVectors(const sharedArray<double>& dataset, int numAttributes) {
+	if (numAttributes != 2)
+		throw std::invalid_argument("The Haversine distance needs points with a latitude and a longitude in radians.");
+	size_t numPoints = dataset.size() / 2;
+	std::vector<double> unitVectors(numPoints * 3);
+	for (size_t i = 0; i < numPoints; i++)
+		HaversineDistance::toUnitVector(&dataset[i * 2], &unitVectors[i * 3]);
+	return unitVectors;
+}
+
+//Converts core distances and MST weights computed as chords between points of the unit sphere with
+//chordToDistance. The conversion grows with the chord, so it commutes with the maximum in mutual reachability
+//and the MST is the one of the converted distance:
+static void convertChords(const std::function<double(double)>& chordToDistance, std::vector<double>& coreDistances, undirectedGraph& chordMst, undirectedGraph& mst) {
+	for (double& coreDistance : coreDistances)
+		coreDistance = chordToDistance(coreDistance);
+	std::vector<int> verticesA(chordMst.getNumEdges());
+	std::vector<int> verticesB(chordMst.getNumEdges());
+	std::vector<double> weights(chordMst.getNumEdges());
+	for (int i = 0; i < chordMst.getNumEdges(); i++) {
+		verticesA[i] = chordMst.getFirstVertexAtIndex(i);
+		verticesB[i] = chordMst.getSecondVertexAtIndex(i);
+		weights[i] = chordToDistance(chordMst.getEdgeWeightAtIndex(i));
+	}
+	mst = undirectedGraph(chordMst.getNumVertices(), verticesA, verticesB, weights);
+}
+
+static void calculateChordCoreDistancesAndMst(hdbscanParameters& parameters, sharedArray<double>& unitVectors, int numPoints, int numAttributes,
+	const std::function<double(double)>& chordToDistance, std::vector<double>& coreDistances, undirectedGraph& mst) {
+	undirectedGraph chordMst;
+	calculateEngineCoreDistancesAndMst<EuclideanDistance>(parameters, unitVectors, numPoints, numAttributes, coreDistances, chordMst);
+	convertChords(chordToDistance, coreDistances, chordMst, mst);
+}
+
+static void calculateSparseCoreDistancesAndMst(hdbscanParameters& parameters, std::vector<double>& coreDistances, undirectedGraph& mst) {
+	const csrDataset& sparseDataset = parameters.sparseDataset;
+	int numPoints = sparseDataset.getNumRows();
+	if (parameters.distanceFunction.length() == 0 || parameters.distanceFunction == "Euclidean")
+		calculateNNDescentCoreDistancesAndMst<SparseEuclideanDistance>(parameters, sparseDataset.getRows(), numPoints, coreDistances, mst);
+	else if (parameters.distanceFunction == "Manhattan")
+		calculateNNDescentCoreDistancesAndMst<SparseManhattanDistance>(parameters, sparseDataset.getRows(), numPoints, coreDistances, mst);
+	else if (parameters.distanceFunction == "Cosine" || parameters.distanceFunction == "Angular") {
+		CosineDistance distance(parameters.distanceFunction == "Angular");
+		csrDataset unitRows = sparseDataset;
+		unitRows.normalizeRows();
+		undirectedGraph chordMst;
+		calculateNNDescentCoreDistancesAndMst<SparseEuclideanDistance>(parameters, unitRows.getRows(), numPoints, coreDistances, chordMst);
+		convertChords([&distance](double chord) { return distance.chordToDistance(chord); }, coreDistances, chordMst, mst);
+	}
+	else
+		throw std::invalid_argument("Sparse datasets do not support the distance function " + parameters.distanceFunction + ".");
+}
+
+static void calculateBinaryCoreDistancesAndMst(hdbscanParameters& parameters, std::vector<double>& coreDistances, undirectedGraph& mst) {
+	const bitDataset& binaryDataset = parameters.binaryDataset;
+	int numPoints = binaryDataset.getNumRows();
+	if (parameters.distanceFunction.length() == 0 || parameters.distanceFunction == "Hamming")
+		calculateNNDescentCoreDistancesAndMst<HammingDistance>(parameters, binaryDataset.getRows(), numPoints, coreDistances, mst);
+	else if (parameters.distanceFunction == "Jaccard")
+		calculateNNDescentCoreDistancesAndMst<JaccardDistance>(parameters, binaryDataset.getRows(), numPoints, coreDistances, mst);
+	else
+		throw std::invalid_argument("Binary datasets do not support the distance function " + parameters.distanceFunction + ".");
+}
+
+static void calculateDelaunayCoreDistancesAndMst(hdbscanParameters& parameters, std::vector<double>& coreDistances, undirectedGraph& mst) {
+	if (parameters.distanceFunction.length() != 0 && parameters.distanceFunction != "Euclidean")
+		throw std::invalid_argument("The Delaunay engine only supports the Euclidean distance.");
+	int numPoints;
+	int numAttributes;
+	sharedArray<double> dataset = getDenseRows(parameters, numPoints, numAttributes);
+	if (numAttributes == 2)
+		mst = delaunayMst::constructMst<2>(dataset.data(), numPoints, parameters.minPoints, coreDistances, true, parameters.numThreads);
+	else if (numAttributes == 3)
+		mst = delaunayMst::constructMst<3>(dataset.data(), numPoints, parameters.minPoints, coreDistances, true, parameters.numThreads);
+	else
+		throw std::invalid_argument("The Delaunay engine needs points with 2 or 3 attributes.");
+}
+
+int hdbscanRunner::getNumNeighbors(const hdbscanParameters& parameters) {
+	if (parameters.numNeighbors > 0)
+		return std::max<int>(parameters.numNeighbors, parameters.minPoints - 1);
+	return std::max<int>(10, parameters.minPoints - 1);
+}
+
+void hdbscanRunner::selectEngine(hdbscanParameters& parameters, bool hierarchy) {
+	hdbscanPlan plan = hdbscanPlanner::plan(hdbscanPlanner::describeWorkload(parameters, hierarchy));
+	if (parameters.planLog != NULL)
+		*parameters.planLog << hdbscanPlanner::describe(plan);
+	if (plan.engine.length() == 0) {
+		bool supported = false;
+		for (const hdbscanEngineEstimate& estimate : plan.estimates)
+			supported |= estimate.unsupportedReason.length() == 0;
+		if (!supported)
+			throw std::invalid_argument("No engine supports this run:\n" + hdbscanPlanner::describe(plan));
+		throw std::runtime_error("No engine fits the memory budget:\n" + hdbscanPlanner::describe(plan));
+	}
+	if (plan.engine == "Partition")
+		throw std::runtime_error("Only a partitioned run fits the memory budget; write the dataset with datasetWriter and cluster it with hdbscanPartition:\n" +
+			hdbscanPlanner::describe(plan));
+	if (plan.engine == "Kruskal" || plan.engine == "ExternalKruskal") {
+		for (const hdbscanEngineEstimate& estimate : plan.estimates) {
+			if (estimate.engine == plan.engine)
+				parameters.memoryBudget = estimate.spillBudget;
 		}
+		parameters.engine = "";
+	}
+	else
+		parameters.engine = plan.engine;
+}
 
-		parameters.distances = distances;
+void hdbscanRunner::calculateCoreDistancesAndMst(hdbscanParameters& parameters, std::vector<double>& coreDistances, undirectedGraph& mst) {
+	if (parameters.engine == "Auto")
+		selectEngine(parameters, false);
+	if (parameters.sparseDistances.getNumVertices() != 0) {
+		coreDistances = hdbscanAlgorithm::calculateCoreDistances(parameters.sparseDistances, parameters.minPoints);
+		const std::vector<int>& verticesA = parameters.sparseDistances.getVerticesA();
+		const std::vector<int>& verticesB = parameters.sparseDistances.getVerticesB();
+		const std::vector<double>& distances = parameters.sparseDistances.getDistances();
+		if (parameters.memoryBudget != 0) {
+			externalKruskalMst edges(parameters.sparseDistances.getNumVertices(), parameters.workDirectory.empty() ? "." : parameters.workDirectory, parameters.memoryBudget);
+			for (size_t i = 0; i < distances.size(); i++)
+				edges.addEdge(verticesA[i], verticesB[i], std::max(distances[i], std::max(coreDistances[verticesA[i]], coreDistances[verticesB[i]])));
+			mst = edges.constructMst(coreDistances, true);
+			return;
+		}
+		std::vector<weightedEdge> edges;
+		edges.reserve(distances.size());
+		for (size_t i = 0; i < distances.size(); i++) {
+			if (verticesA[i] == verticesB[i])
+				continue;
+			double weight = std::max(distances[i], std::max(coreDistances[verticesA[i]], coreDistances[verticesB[i]]));
+			edges.push_back({ weight, verticesA[i], verticesB[i] });
+		}
+		mst = kruskalMst::constructMst(parameters.sparseDistances.getNumVertices(), edges, coreDistances, true);
+		return;
+	}
+	if (parameters.quantization.length() != 0 && parameters.engine != "NNDescent")
+		throw std::invalid_argument("Quantization is only supported by the NNDescent engine.");
+	if (parameters.quantization.length() != 0 && (parameters.sparseDataset.getNumRows() != 0 || parameters.binaryDataset.getNumRows() != 0))
+		throw std::invalid_argument("Quantization needs a dense dataset.");
+	if (parameters.sparseDataset.getNumRows() != 0 && parameters.engine == "NNDescent") {
+		calculateSparseCoreDistancesAndMst(parameters, coreDistances, mst);
+		return;
 	}
+	if (parameters.sparseDataset.getNumRows() != 0 && parameters.engine.length() != 0 && parameters.engine != "Dense")
+		throw std::invalid_argument("The " + parameters.engine + " engine does not support sparse datasets.");
+	if (parameters.binaryDataset.getNumRows() != 0 && parameters.engine == "NNDescent") {
+		calculateBinaryCoreDistancesAndMst(parameters, coreDistances, mst);
+		return;
+	}
+	if (parameters.binaryDataset.getNumRows() != 0 && parameters.engine.length() != 0 && parameters.engine != "Dense")
+		throw std::invalid_argument("The " + parameters.engine + " engine does not support binary datasets.");
+	if (parameters.engine == "BallTree" || parameters.engine == "NNDescent") {
+		if (parameters.dataset.size() == 0 && parameters.mappedDataset.size() == 0)
+			throw std::invalid_argument("The " + parameters.engine + " engine needs the dataset.");
+		int numPoints;
+		int numAttributes;
+		sharedArray<double> dataset = getDenseRows(parameters, numPoints, numAttributes);
+		if (parameters.distanceFunction.length() == 0 || parameters.distanceFunction == "Euclidean")
+			calculateEngineCoreDistancesAndMst<EuclideanDistance>(parameters, dataset, numPoints, numAttributes, coreDistances, mst);
+		else if (parameters.distanceFunction == "Manhattan")
+			calculateEngineCoreDistancesAndMst<ManhattanDistance>(parameters, dataset, numPoints, numAttributes, coreDistances, mst);
+		else if (parameters.distanceFunction == "Haversine") {
+			sharedArray<double> unitVectors(toUnitVectors(dataset, numAttributes));
+			dataset = sharedArray<double>();
+			calculateChordCoreDistancesAndMst(parameters, unitVectors, numPoints, 3, HaversineDistance::chordToAngle, coreDistances, mst);
+		}
+		else if (parameters.distanceFunction == "Cosine" || parameters.distanceFunction == "Angular") {
+			CosineDistance distance(parameters.distanceFunction == "Angular");
+			std::vector<double> normalizedRows(dataset.size());
+			for (size_t i = 0; i < (size_t)numPoints; i++)
+				CosineDistance::normalize(&dataset[i * numAttributes], numAttributes, &normalizedRows[i * numAttributes]);
+			dataset = sharedArray<double>();
+			sharedArray<double> normalized(std::move(normalizedRows));
+			calculateChordCoreDistancesAndMst(parameters, normalized, numPoints, numAttributes,
+				[&distance](double chord) { return distance.chordToDistance(chord); }, coreDistances, mst);
+		}
+		else
+			throw std::invalid_argument("The " + parameters.engine + " engine does not support the distance function " + parameters.distanceFunction + ".");
+		return;
+	}
+	if (parameters.engine == "Delaunay") {
+		if (parameters.dataset.size() == 0 && parameters.mappedDataset.size() == 0)
+			throw std::invalid_argument("The Delaunay engine needs the dataset.");
+		calculateDelaunayCoreDistancesAndMst(parameters, coreDistances, mst);
+		return;
+	}
+	if (parameters.engine.length() != 0 && parameters.engine != "Dense")
+		throw std::invalid_argument("Unknown engine " + parameters.engine + ".");
 
-	std::vector <double> coreDistances = algorithm.calculateCoreDistances(
+	if (parameters.distances.size() == 0) {
+		loadMappedDataset(parameters);
+		parameters.distances = calculateDistances(parameters);
+	}
+
+	coreDistances = hdbscanAlgorithm::calculateCoreDistances(
 		parameters.distances,
 		parameters.minPoints);
 
-	undirectedGraph mst = algorithm.constructMst(
+	mst = hdbscanAlgorithm::constructMst(
 		parameters.distances,
 		coreDistances,
 		true);
+}
+
+hdbscanResult hdbscanRunner::runWeighted(hdbscanParameters& parameters) {
+	if (parameters.sparseDistances.getNumVertices() != 0)
+		throw std::invalid_argument("Weighted points are not supported with sparse distances.");
+	if (parameters.engine.length() != 0 && parameters.engine != "Dense")
+		throw std::invalid_argument("Weighted points are only supported by the Dense engine.");
+	if (parameters.sparseDataset.getNumRows() != 0 || parameters.binaryDataset.getNumRows() != 0) {
+		if (parameters.collapseDuplicates)
+			throw std::invalid_argument("Duplicates can only be collapsed in a dense dataset.");
+		if (parameters.distances.size() == 0)
+			parameters.distances = calculateDistances(parameters);
+	}
+	loadMappedDataset(parameters);
+	int numRows = parameters.dataset.size() != 0 ? parameters.dataset.size() : parameters.distances.size();
+	duplicateCollapser collapser(numRows, parameters.dataset, parameters.sampleWeights, parameters.collapseDuplicates);
+	const std::vector<double>& weights = collapser.getWeights();
+	const std::vector<int>& rowRepresentatives = collapser.getRowRepresentatives();
+
+	//Cluster the representatives only:
+	if (parameters.distances.size() != 0)
+		parameters.distances = collapser.selectRows(parameters.distances, true);
+	if (parameters.dataset.size() != 0)
+		parameters.dataset = collapser.selectRows(parameters.dataset, false);
+	if (parameters.distances.size() == 0)
+		parameters.distances = calculateDistances(parameters);
+	std::vector<hdbscanConstraint> constraints;
+	for (hdbscanConstraint& constraint : parameters.constraints) {
+		constraints.push_back(hdbscanConstraint(rowRepresentatives[constraint.getPointA()],
+			rowRepresentatives[constraint.getPointB()], constraint.getConstraintType()));
+	}
+
+	std::vector<double> coreDistances = hdbscanAlgorithm::calculateCoreDistances(
+		parameters.distances,
+		parameters.minPoints,
+		weights);
+	undirectedGraph mst = hdbscanAlgorithm::constructMst(
+		parameters.distances,
+		coreDistances,
+		true);
+	std::vector<std::vector<double>>().swap(parameters.distances);
+	mst.quicksortByEdgeWeight();
+	outlierScoreSelection indexed;
+	indexed.output = indexedScores;
+	std::vector<double> representativeScores;
+	hdbscanResult result = clusterMst(mst, coreDistances, parameters.minClusterSize, constraints, weights, indexed, parameters.numThreads, representativeScores);
+
+	//Expand the result back to the original rows, with the scores still in double precision:
+	std::vector<double> scores(numRows);
+	std::vector<double> rowCoreDistances(numRows);
+	for (int row = 0; row < numRows; row++) {
+		int representative = rowRepresentatives[row];
+		scores[row] = representativeScores[representative];
+		rowCoreDistances[row] = coreDistances[representative];
+	}
+	hdbscanResult expanded(collapser.expand(result.labels), hdbscanAlgorithm::selectOutlierScores(scores, rowCoreDistances, parameters.outlierSelection, parameters.numThreads),
+		collapser.expand(result.membershipProbabilities), result.hasInfiniteStability);
+	if (parameters.outlierSelection.output == indexedScores)
+		expanded.indexedOutlierScores.assign(scores.begin(), scores.end());
+	return expanded;
+}
+
+hdbscanModel hdbscanRunner::fit(hdbscanParameters parameters) {
+	if (parameters.collapseDuplicates || parameters.sampleWeights.size() != 0)
+		throw std::invalid_argument("A model cannot be fitted to weighted points; use run() with sampleWeights or collapseDuplicates.");
+	std::vector<double> coreDistances;
+	undirectedGraph mst;
+	calculateCoreDistancesAndMst(parameters, coreDistances, mst);
+	std::vector<std::vector<double>>().swap(parameters.distances);
 	mst.quicksortByEdgeWeight();
 
+	hdbscanModel model(coreDistances, mst, parameters.minPoints, parameters.minClusterSize);
+	if (parameters.mappedDataset.size() != 0) {
+		int numPoints;
+		int numAttributes;
+		sharedArray<double> rows = getDenseRows(parameters, numPoints, numAttributes);
+		model.buildIndex(rows.data(), numPoints, numAttributes, parameters.distanceFunction);
+	}
+	else if (parameters.dataset.size() != 0)
+		model.buildIndex(parameters.dataset, parameters.distanceFunction);
+	return model;
+}
+
+/// <summary>
+/// A distance between rows already mapped onto the unit sphere, converted from the chord between them.
+/// </summary>
+class chordDistance
+{
+private:
+	std::function<double(double)> _chordToDistance;
+
+public:
+	chordDistance(std::function<double(double)> chordToDistance) {
+		_chordToDistance = chordToDistance;
+	}
+
+	double computeDistance(const double* attributesOne, const double* attributesTwo, int numAttributes) {
+		return _chordToDistance(EuclideanDistance().computeDistance(attributesOne, attributesTwo, numAttributes));
+	}
+};
+
+template<class TPairDistance>
+static void fillPairDistances(int numPoints, int numThreads, std::vector<std::vector<double>>& distances, TPairDistance pairDistance) {
+	//Row i computes its i lower-triangle entries, so rows are handed out in pairs (i, numPoints - 1 - i)
+	//to give every thread the same amount of work:
+	auto fillRow = [&](int i) {
+		for (int j = 0; j < i; j++) {
+			double distance = pairDistance(i, j);
+			distances[i][j] = distance;
+			distances[j][i] = distance;
+		}
+	};
+	parallelFor(0, (numPoints + 1) / 2, numThreads, [&](int begin, int end) {
+		for (int i = begin; i < end; i++) {
+			fillRow(i);
+			if (numPoints - 1 - i != i)
+				fillRow(numPoints - 1 - i);
+		}
+	});
+}
+
+template<class TDistance>
+static void fillDistances(const std::vector<std::vector<double>>& dataset, int numThreads, std::vector<std::vector<double>>& distances, TDistance distanceFunction = TDistance()) {
+	fillPairDistances(dataset.size(), numThreads, distances, [&](int i, int j) {
+		int numAttributes = std::min(dataset[i].size(), dataset[j].size());
+		return distanceFunction.computeDistance(dataset[i].data(), dataset[j].data(), numAttributes);
+	});
+}
+
+template<class TDistance, class TRows>
+static void fillRowDistances(const TRows& rows, int numPoints, int numThreads, std::vector<std::vector<double>>& distances,
+	const std::function<double(double)>& convert = std::function<double(double)>()) {
+	TDistance distanceFunction;
+	fillPairDistances(numPoints, numThreads, distances, [&](int i, int j) {
+		double distance = distanceFunction.computeDistance(rows.getRow(i), rows.getRow(j), rows.getNumAttributes());
+		return convert ? convert(distance) : distance;
+	});
+}
+
+static void calculateBinaryDistances(const hdbscanParameters& parameters, std::vector<std::vector<double>>& distances) {
+	const bitDataset& binaryDataset = parameters.binaryDataset;
+	int numPoints = binaryDataset.getNumRows();
+	if (parameters.distanceFunction.length() == 0 || parameters.distanceFunction == "Hamming")
+		fillRowDistances<HammingDistance>(binaryDataset.getRows(), numPoints, parameters.numThreads, distances);
+	else if (parameters.distanceFunction == "Jaccard")
+		fillRowDistances<JaccardDistance>(binaryDataset.getRows(), numPoints, parameters.numThreads, distances);
+	else
+		throw std::invalid_argument("Binary datasets do not support the distance function " + parameters.distanceFunction + ".");
+}
+
+static void calculateSparseDistances(const hdbscanParameters& parameters, std::vector<std::vector<double>>& distances) {
+	const csrDataset& sparseDataset = parameters.sparseDataset;
+	int numPoints = sparseDataset.getNumRows();
+	if (parameters.distanceFunction.length() == 0 || parameters.distanceFunction == "Euclidean")
+		fillRowDistances<SparseEuclideanDistance>(sparseDataset.getRows(), numPoints, parameters.numThreads, distances);
+	else if (parameters.distanceFunction == "Manhattan")
+		fillRowDistances<SparseManhattanDistance>(sparseDataset.getRows(), numPoints, parameters.numThreads, distances);
+	else if (parameters.distanceFunction == "Cosine" || parameters.distanceFunction == "Angular") {
+		CosineDistance distance(parameters.distanceFunction == "Angular");
+		csrDataset unitRows = sparseDataset;
+		unitRows.normalizeRows();
+		fillRowDistances<SparseEuclideanDistance>(unitRows.getRows(), numPoints, parameters.numThreads, distances,
+			[&distance](double chord) { return distance.chordToDistance(chord); });
+	}
+	else
+		throw std::invalid_argument("Sparse datasets do not support the distance function " + parameters.distanceFunction + ".");
+}
+
+std::vector<std::vector<double>> hdbscanRunner::calculateDistances(const hdbscanParameters& parameters) {
+	if (parameters.mappedDataset.size() != 0) {
+		hdbscanParameters loaded = parameters;
+		loadMappedDataset(loaded);
+		return calculateDistances(loaded);
+	}
+	int numPoints = parameters.dataset.size();
+	if (parameters.sparseDataset.getNumRows() != 0)
+		numPoints = parameters.sparseDataset.getNumRows();
+	else if (parameters.binaryDataset.getNumRows() != 0)
+		numPoints = parameters.binaryDataset.getNumRows();
+
+	std::vector<std::vector<double>> distances(numPoints);
+	for (int i = 0; i < numPoints; i++)
+		distances[i].resize(numPoints);
+
+	if (parameters.sparseDataset.getNumRows() != 0) {
+		calculateSparseDistances(parameters, distances);
+	}
+	else if (parameters.binaryDataset.getNumRows() != 0) {
+		calculateBinaryDistances(parameters, distances);
+	}
+	else if (parameters.distanceFunction.length() == 0) {
+		//Default to Euclidean
+		fillDistances<EuclideanDistance>(parameters.dataset, parameters.numThreads, distances);
+	}
+	else if (parameters.distanceFunction == "Euclidean") {
+		fillDistances<EuclideanDistance>(parameters.dataset, parameters.numThreads, distances);
+	}
+	else if (parameters.distanceFunction == "Manhattan") {
+		fillDistances<ManhattanDistance>(parameters.dataset, parameters.numThreads, distances);
+	}
+	else if (parameters.distanceFunction == "Haversine") {
+		std::vector<std::vector<double>> unitVectors(numPoints, std::vector<double>(3));
+		for (int i = 0; i < numPoints; i++) {
+			if (parameters.dataset[i].size() != 2)
+				throw std::invalid_argument("The Haversine distance needs points with a latitude and a longitude in radians.");
+			HaversineDistance::toUnitVector(parameters.dataset[i].data(), unitVectors[i].data());
+		}
+		fillDistances(unitVectors, parameters.numThreads, distances, chordDistance(HaversineDistance::chordToAngle));
+	}
+	else if (parameters.distanceFunction == "Cosine" || parameters.distanceFunction == "Angular") {
+		//Normalize every row once instead of once per pair:
+		CosineDistance distance(parameters.distanceFunction == "Angular");
+		std::vector<std::vector<double>> unitVectors(parameters.dataset);
+		for (std::vector<double>& unitVector : unitVectors)
+			CosineDistance::normalize(unitVector.data(), unitVector.size(), unitVector.data());
+		fillDistances(unitVectors, parameters.numThreads, distances,
+			chordDistance([&distance](double chord) { return distance.chordToDistance(chord); }));
+	}
+	return distances;
+}
+
+hdbscanResult hdbscanRunner::clusterMst(undirectedGraph& mst, const std::vector<double>& coreDistances, uint32_t minClusterSize, std::vector<hdbscanConstraint>& constraints,
+	const std::vector<double>& pointWeights, const outlierScoreSelection& outlierSelection, int numThreads) {
+	std::vector<double> scores;
+	return clusterMst(mst, coreDistances, minClusterSize, constraints, pointWeights, outlierSelection, numThreads, scores);
+}
+
+hdbscanResult hdbscanRunner::clusterMst(undirectedGraph& mst, const std::vector<double>& coreDistances, uint32_t minClusterSize, std::vector<hdbscanConstraint>& constraints,
+	const std::vector<double>& pointWeights, const outlierScoreSelection& outlierSelection, int numThreads, std::vector<double>& scores) {
+	int numPoints = coreDistances.size();
+	hdbscanAlgorithm algorithm;
+
 	std::vector<double> pointNoiseLevels(numPoints);
 	std::vector<int> pointLastClusters(numPoints);
 
@@ -68,21 +695,27 @@ hdbscanResult hdbscanRunner::run(hdbscanParameters parameters) {
 	std::vector<cluster*> clusters;
 	algorithm.computeHierarchyAndClusterTree(
 		&mst,
-		parameters.minClusterSize,
-		parameters.constraints,
+		minClusterSize,
+		constraints,
 		hierarchy,
 		pointNoiseLevels,
 		pointLastClusters,
-		clusters);
+		clusters,
+		pointWeights);
 	bool infiniteStability = algorithm.propagateTree(clusters);
 
 	std::vector<int> prominentClusters = algorithm.findProminentClusters(clusters, hierarchy, numPoints);
 	std::vector<double> membershipProbabilities = algorithm.findMembershipScore(prominentClusters, coreDistances);
-	std::vector<outlierScore> scores = algorithm.calculateOutlierScores(
+	scores = algorithm.calculateOutlierScoreValues(
 		clusters,
 		pointNoiseLevels,
-		pointLastClusters,
-		coreDistances);
+		pointLastClusters);
+
+	for (cluster* treeCluster : clusters)
+		delete treeCluster;
 
-	return hdbscanResult(prominentClusters, scores, membershipProbabilities,  infiniteStability);
+	hdbscanResult result(prominentClusters, algorithm.selectOutlierScores(scores, coreDistances, outlierSelection, numThreads), membershipProbabilities, infiniteStability);
+	if (outlierSelection.output == indexedScores)
+		result.indexedOutlierScores.assign(scores.begin(), scores.end());
+	return result;
 }
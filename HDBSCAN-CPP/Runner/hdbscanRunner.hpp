@@ -1,9 +1,86 @@
 #pragma once
 #include"hdbscanResult.hpp"
 #include"hdbscanParameters.hpp"
+#include"hdbscanModel.hpp"
+#include"../HdbscanStar/undirectedGraph.hpp"
 class hdbscanRunner
 {
 public:
+	/// <summary>
+	/// Runs HDBSCAN* on the dataset (or distances). With sample weights or collapseDuplicates set, the
+	/// points are clustered as weighted points and the result is expanded back to the original rows.
+	/// </summary>
 	static hdbscanResult run(hdbscanParameters parameters);
+
+	/// <summary>
+	/// Computes the core distances and the sorted MST once and returns them as a model which can be
+	/// re-condensed and re-selected without recomputing distances. Constraints are not used by the model, and
+	/// weighted points (sampleWeights or collapseDuplicates) throw std::invalid_argument. A model fitted from a
+	/// dataset or mappedDataset indexes it for approximatePredict().
+	/// </summary>
+	/// <param name="parameters">Parameters holding the dataset (or distances), minPoints and minClusterSize</param>
+	/// <returns>A model condensed with parameters.minClusterSize</returns>
+	static hdbscanModel fit(hdbscanParameters parameters);
+
+	/// <summary>
+	/// Fills the pairwise distance matrix for the dataset (or mappedDataset) using the configured distance
+	/// function, splitting the rows over parameters.numThreads threads.
+	/// </summary>
+	/// <param name="parameters">Parameters holding the dataset and distance function</param>
+	/// <returns>A symmetric matrix where index [i][j] is the distance between points i and j</returns>
+	static std::vector<std::vector<double>> calculateDistances(const hdbscanParameters& parameters);
+
+	/// <summary>
+	/// Runs the stages which follow MST construction: hierarchy and cluster tree, stability propagation,
+	/// flat cluster selection, membership probabilities and outlier scores.
+	/// </summary>
+	/// <param name="mst">An MST sorted by edge weight; it is consumed by the hierarchy construction</param>
+	/// <param name="coreDistances">The core distances the MST was built from</param>
+	/// <param name="minClusterSize">The minimum number of points which a cluster needs to be a valid cluster</param>
+	/// <param name="constraints">Optional constraints used during cluster selection</param>
+	/// <param name="pointWeights">Optional weight of each point; empty weighs every point as 1</param>
+	/// <param name="outlierSelection">Which outlier scores are returned, in outliersScores or, for indexedScores, in indexedOutlierScores</param>
+	/// <param name="numThreads">The number of threads for the outlier score selection</param>
+	/// <returns>The clustering result</returns>
+	static hdbscanResult clusterMst(undirectedGraph& mst, const std::vector<double>& coreDistances, uint32_t minClusterSize, std::vector<hdbscanConstraint>& constraints,
+		const std::vector<double>& pointWeights = std::vector<double>(), const outlierScoreSelection& outlierSelection = outlierScoreSelection(), int numThreads = 1);
+
+	/// <summary>
+	/// Computes the core distances and the (unsorted) MST with the engine named in the parameters:
+	/// "Dense" (the default) fills the pairwise distance matrix, "BallTree" indexes the dataset in a ball
+	/// tree and uses batched kNN queries and Boruvka's algorithm, which avoids the quadratic matrix.
+	/// "NNDescent" takes approximate core distances from an NN-Descent kNN graph, for high-dimensional data
+	/// where trees do not prune, and runs Boruvka's algorithm on the graph, completing it outside the graph
+	/// where the neighbor lists cannot bound the edges outside them. That bound only holds for exact lists, so
+	/// its MST is approximate too, and planLog gets how many edges rest on it. "Delaunay" handles 2D and 3D Euclidean points
+	/// exactly with a grid for core distances and Kruskal over Delaunay and core distance edges. With the
+	/// Haversine, Cosine and Angular distances, BallTree and NNDescent work on the points' unit vectors and
+	/// convert the chords between them. NNDescent can build its graph over scalar or product quantized codes,
+	/// optionally re-ranking refineFactor times the neighbors by exact distance. A sparse dataset is clustered by the Dense and NNDescent engines with
+	/// distances computed from the nonzeros of each pair, and a binary dataset by the same engines with the
+	/// Hamming or Jaccard distance counted with popcount.
+	/// Sparse distances, when given, take precedence over every engine: core distances come from each point's
+	/// edges and the MST from filter-Kruskal. "Auto" lets hdbscanPlanner choose the engine by the size of the
+	/// problem and parameters.memoryBudget, throwing std::runtime_error when nothing fits.
+	/// </summary>
+	static void calculateCoreDistancesAndMst(hdbscanParameters& parameters, std::vector<double>& coreDistances, undirectedGraph& mst);
+
+	/// <summary>
+	/// The number of neighbors the NNDescent engine keeps per point: parameters.numNeighbors, or 10 when it
+	/// is 0, and never fewer than the minPoints - 1 the core distances need.
+	/// </summary>
+	static int getNumNeighbors(const hdbscanParameters& parameters);
+
+private:
+	static hdbscanResult runWeighted(hdbscanParameters& parameters);
+
+	/// <summary>
+	/// clusterMst() which also hands back the outlier score of every point, indexed by point and in double
+	/// precision, for callers which expand the result before converting it.
+	/// </summary>
+	static hdbscanResult clusterMst(undirectedGraph& mst, const std::vector<double>& coreDistances, uint32_t minClusterSize, std::vector<hdbscanConstraint>& constraints,
+		const std::vector<double>& pointWeights, const outlierScoreSelection& outlierSelection, int numThreads, std::vector<double>& scores);
+
+	static void selectEngine(hdbscanParameters& parameters, bool hierarchy);
 };
 
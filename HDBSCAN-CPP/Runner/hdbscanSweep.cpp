@@ -0,0 +1,65 @@
+#include "hdbscanSweep.hpp"
+#include "hdbscanRunner.hpp"
+#include<stdexcept>
+#include"../HdbscanStar/hdbscanAlgorithm.hpp"
+
+using namespace hdbscanStar;
+
+hdbscanSweep::hdbscanSweep(hdbscanParameters parameters, uint32_t maxMinPoints) {
+	_parameters = parameters;
+	_maxMinPoints = maxMinPoints;
+	_mstMinPoints = 0;
+	if (_parameters.distances.size() == 0)
+		_parameters.distances = hdbscanRunner::calculateDistances(_parameters);
+	_nearestNeighborDistances = hdbscanAlgorithm::calculateNearestNeighborDistances(_parameters.distances, maxMinPoints);
+}
+
+void hdbscanSweep::ensureMst(uint32_t minPoints, uint32_t minClusterSize) {
+	if (minPoints > _maxMinPoints)
+		throw std::invalid_argument("minPoints exceeds the maximum the sweep was prepared for.");
+	if (_mstMinPoints == minPoints)
+		return;
+
+	_coreDistances = hdbscanAlgorithm::calculateCoreDistancesFromNeighbors(_nearestNeighborDistances, minPoints);
+	_mst = hdbscanAlgorithm::constructMst(_parameters.distances, _coreDistances, true);
+	_mst.quicksortByEdgeWeight();
+	_mstMinPoints = minPoints;
+	//The model's single linkage tree is built once per MST, and only condensing depends on minClusterSize:
+	if (_parameters.constraints.size() == 0)
+		_model = hdbscanModel(_coreDistances, _mst, minPoints, minClusterSize);
+}
+
+hdbscanResult hdbscanSweep::run(uint32_t minPoints, uint32_t minClusterSize) {
+	ensureMst(minPoints, minClusterSize);
+
+	if (_parameters.constraints.size() != 0) {
+		//The hierarchy construction removes edges from the graph it is given, so it works on a copy:
+		undirectedGraph mst = _mst;
+		return hdbscanRunner::clusterMst(mst, _coreDistances, minClusterSize, _parameters.constraints, std::vector<double>(),
+			_parameters.outlierSelection, _parameters.numThreads);
+	}
+
+	if (_model.getMinClusterSize() != minClusterSize)
+		_model.condense(minClusterSize);
+	condensedTree& tree = _model.getCondensedTree();
+	bool infiniteStability;
+	std::vector<int> labels = tree.labelPoints(tree.selectClusters(excessOfMass, 0, infiniteStability));
+	std::vector<double> scores = tree.calculateOutlierScores();
+
+	//Membership probabilities and the outlier score selection are those of clusterMst():
+	hdbscanResult result(labels, hdbscanAlgorithm::selectOutlierScores(scores, _coreDistances, _parameters.outlierSelection, _parameters.numThreads),
+		hdbscanAlgorithm::findMembershipScore(labels, _coreDistances), infiniteStability);
+	if (_parameters.outlierSelection.output == indexedScores)
+		result.indexedOutlierScores.assign(scores.begin(), scores.end());
+	return result;
+}
+
+std::vector<hdbscanResult> hdbscanSweep::run(const std::vector<uint32_t>& minPointsValues, const std::vector<uint32_t>& minClusterSizeValues) {
+	std::vector<hdbscanResult> results;
+	for (uint32_t minPoints : minPointsValues)
+	{
+		for (uint32_t minClusterSize : minClusterSizeValues)
+			results.push_back(run(minPoints, minClusterSize));
+	}
+	return results;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include<cstdint>
+#include<vector>
+#include"hdbscanResult.hpp"
+#include"hdbscanParameters.hpp"
+#include"hdbscanModel.hpp"
+#include"../HdbscanStar/undirectedGraph.hpp"
+
+/// <summary>
+/// Runs HDBSCAN* over many (minPoints, minClusterSize) combinations while sharing the expensive stages.
+/// The distance matrix and the sorted neighbor lists for the largest minPoints are computed once, core
+/// distances for every smaller minPoints are read off those lists, and the MST and its single linkage tree
+/// are rebuilt only when minPoints changes. When just minClusterSize changes, the tree is re-condensed and
+/// selected in linear time, giving the clusters of hdbscanRunner::run(); with constraints, which the
+/// condensed tree does not use, the hierarchy and cluster selection are rerun instead.
+/// </summary>
+class hdbscanSweep
+{
+private:
+	hdbscanParameters _parameters;
+	uint32_t _maxMinPoints;
+	std::vector<std::vector<double>> _nearestNeighborDistances;
+
+	uint32_t _mstMinPoints;
+	std::vector<double> _coreDistances;
+	undirectedGraph _mst;
+	hdbscanModel _model;
+
+	void ensureMst(uint32_t minPoints, uint32_t minClusterSize);
+
+public:
+	/// <summary>
+	/// Prepares a sweep over the dataset (or precomputed distances) held by the parameters.
+	/// </summary>
+	/// <param name="parameters">Dataset, distances, distance function and constraints shared by all runs</param>
+	/// <param name="maxMinPoints">The largest minPoints that will be requested</param>
+	hdbscanSweep(hdbscanParameters parameters, uint32_t maxMinPoints);
+
+	/// <summary>
+	/// Clusters with a single parameter combination, reusing the cached MST and tree when minPoints is unchanged.
+	/// </summary>
+	hdbscanResult run(uint32_t minPoints, uint32_t minClusterSize);
+
+	/// <summary>
+	/// Clusters with every combination of the given values. Results are ordered with minPoints as the
+	/// outer loop and minClusterSize as the inner loop, so each MST is built exactly once.
+	/// </summary>
+	std::vector<hdbscanResult> run(const std::vector<uint32_t>& minPointsValues, const std::vector<uint32_t>& minClusterSizeValues);
+};
+
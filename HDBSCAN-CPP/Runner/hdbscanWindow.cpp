@@ -0,0 +1,80 @@
+#include "hdbscanWindow.hpp"
+#include <chrono>
+#include <stdexcept>
+
+typedef std::chrono::steady_clock windowClock;
+
+static double secondsSince(windowClock::time_point start) {
+	return std::chrono::duration<double>(windowClock::now() - start).count();
+}
+
+hdbscanWindow::hdbscanWindow(hdbscanParameters parameters, const std::vector<double>& timestamps, double windowLength) :
+	_windowLength(windowLength), _model(parameters) {
+	if (timestamps.size() != parameters.dataset.size())
+		throw std::invalid_argument("Every initial point needs a timestamp.");
+	for (size_t i = 0; i < timestamps.size(); i++)
+	{
+		if (i > 0 && timestamps[i] < timestamps[i - 1])
+			throw std::invalid_argument("Timestamps must not decrease.");
+		_points.push_back(i);
+		_timestamps.push_back(timestamps[i]);
+	}
+}
+
+hdbscanResult hdbscanWindow::advance(const std::vector<std::vector<double>>& points, const std::vector<double>& timestamps, double now) {
+	if (timestamps.size() != points.size())
+		throw std::invalid_argument("Every point needs a timestamp.");
+	for (size_t i = 0; i < timestamps.size(); i++)
+	{
+		double previous = i > 0 ? timestamps[i - 1] : _timestamps.empty() ? timestamps[i] : _timestamps.back();
+		if (timestamps[i] < previous)
+			throw std::invalid_argument("Timestamps must not decrease.");
+	}
+	windowClock::time_point start = windowClock::now();
+	_latency = hdbscanWindowLatency();
+
+	windowClock::time_point stageStart = windowClock::now();
+	for (size_t i = 0; i < points.size(); i++)
+	{
+		_points.push_back(_model.insert(points[i]));
+		_timestamps.push_back(timestamps[i]);
+	}
+	_latency.insertSeconds = secondsSince(stageStart);
+
+	stageStart = windowClock::now();
+	std::vector<int> expired;
+	while (!_timestamps.empty() && _timestamps.front() <= now - _windowLength)
+	{
+		expired.push_back(_points.front());
+		_points.pop_front();
+		_timestamps.pop_front();
+	}
+	_model.remove(expired);
+	_latency.removeSeconds = secondsSince(stageStart);
+
+	stageStart = windowClock::now();
+	if (_model.getNumRemovedPoints() > _model.getNumLivePoints() && _model.getNumLivePoints() > 0)
+	{
+		std::vector<int> newIndices = _model.compact();
+		for (int& point : _points)
+			point = newIndices[point];
+	}
+	_latency.compactSeconds = secondsSince(stageStart);
+
+	stageStart = windowClock::now();
+	hdbscanResult result;
+	result.hasInfiniteStability = false;
+	if (_model.getNumLivePoints() > 0)
+		result = _model.select();
+	_latency.selectSeconds = secondsSince(stageStart);
+	_latency.totalSeconds = secondsSince(start);
+	return result;
+}
+
+const hdbscanWindowLatency& hdbscanWindow::getLatency() {
+	return _latency;
+}
+
+int hdbscanWindow::getNumPoints() {
+	return _points.size();
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include<deque>
+#include<vector>
+#include"hdbscanParameters.hpp"
+#include"hdbscanResult.hpp"
+#include"hdbscanIncremental.hpp"
+
+/// <summary>
+/// The seconds each stage of the last window took.
+/// </summary>
+struct hdbscanWindowLatency
+{
+	double insertSeconds = 0;
+	double removeSeconds = 0;
+	double compactSeconds = 0;
+	double selectSeconds = 0;
+	double totalSeconds = 0;
+};
+
+/// <summary>
+/// Clusters the points of a sliding time window. Every window inserts the points which arrived into an
+/// hdbscanIncremental model, removes the points which expired as one batch and selects clusters from the
+/// repaired MST, so a window costs as much as the points which changed and the condensed tree, not a refit.
+/// Removed points leave gaps in the model, which is refitted once they outnumber the live points.
+/// </summary>
+class hdbscanWindow
+{
+private:
+	double _windowLength;
+	hdbscanIncremental _model;
+
+	//The model index and timestamp of every live point, oldest first:
+	std::deque<int> _points;
+	std::deque<double> _timestamps;
+	hdbscanWindowLatency _latency;
+
+public:
+	/// <summary>
+	/// Fits the initial points of the window.
+	/// </summary>
+	/// <param name="parameters">The initial points and the parameters of hdbscanIncremental</param>
+	/// <param name="timestamps">The time of every initial point, not decreasing</param>
+	/// <param name="windowLength">How long a point stays in the window</param>
+	hdbscanWindow(hdbscanParameters parameters, const std::vector<double>& timestamps, double windowLength);
+
+	/// <summary>
+	/// Moves the window to the given time: inserts the points which arrived, removes the points with a
+	/// timestamp at most now - windowLength and clusters the points left.
+	/// </summary>
+	/// <param name="points">The points which arrived since the last window</param>
+	/// <param name="timestamps">Their times, not decreasing and not before the last point's</param>
+	/// <param name="now">The end of the window</param>
+	/// <returns>The clustering of the live points, oldest first</returns>
+	hdbscanResult advance(const std::vector<std::vector<double>>& points, const std::vector<double>& timestamps, double now);
+
+	/// <summary>
+	/// Returns how long the stages of the last advance() took.
+	/// </summary>
+	const hdbscanWindowLatency& getLatency();
+
+	int getNumPoints();
+};
@@ -0,0 +1,56 @@
+#include "concurrentUnionFind.hpp"
+
+concurrentUnionFind::concurrentUnionFind(int numElements) : _parents(numElements) {
+	for (int i = 0; i < numElements; i++)
+		_parents[i].store(i, std::memory_order_relaxed);
+}
+
+int concurrentUnionFind::find(int element) {
+	while (true)
+	{
+		int parent = _parents[element].load();
+		if (parent == element)
+			return element;
+		int grandparent = _parents[parent].load();
+		if (parent != grandparent)
+			_parents[element].compare_exchange_weak(parent, grandparent);
+		element = grandparent;
+	}
+}
+
+bool concurrentUnionFind::join(int elementOne, int elementTwo) {
+	while (true)
+	{
+		int rootOne = find(elementOne);
+		int rootTwo = find(elementTwo);
+		if (rootOne == rootTwo)
+			return false;
+		if (rootOne < rootTwo)
+		{
+			int temp = rootOne;
+			rootOne = rootTwo;
+			rootTwo = temp;
+		}
+		//Fails only if another thread linked rootOne meanwhile, in which case the roots are looked up again:
+		int expected = rootOne;
+		if (_parents[rootOne].compare_exchange_strong(expected, rootTwo))
+			return true;
+	}
+}
+
+bool concurrentUnionFind::sameSet(int elementOne, int elementTwo) {
+	while (true)
+	{
+		int rootOne = find(elementOne);
+		int rootTwo = find(elementTwo);
+		if (rootOne == rootTwo)
+			return true;
+		//Only a root that is still a root proves the sets differ:
+		if (_parents[rootOne].load() == rootOne)
+			return false;
+	}
+}
+
+int concurrentUnionFind::getNumElements() {
+	return _parents.size();
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include<vector>
+#include<atomic>
+/// <summary>
+/// Lock-free disjoint-set forest that many threads can find and join on at once. Roots are linked with a
+/// compare-and-swap, always the larger index under the smaller one, and finds halve their paths with
+/// compare-and-swaps as well, so no operation ever waits for another thread.
+/// </summary>
+class concurrentUnionFind
+{
+private:
+	std::vector<std::atomic<int>> _parents;
+public:
+	concurrentUnionFind(int numElements);
+
+	/// <summary>
+	/// Returns the representative of the set containing the element.
+	/// </summary>
+	int find(int element);
+
+	/// <summary>
+	/// Merges the sets containing the two elements; returns false when they already were one set.
+	/// </summary>
+	bool join(int elementOne, int elementTwo);
+
+	/// <summary>
+	/// Returns whether the two elements are in the same set.
+	/// </summary>
+	bool sameSet(int elementOne, int elementTwo);
+
+	int getNumElements();
+};
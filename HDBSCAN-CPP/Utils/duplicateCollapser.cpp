@@ -0,0 +1,103 @@
+#include "duplicateCollapser.hpp"
+#include<cmath>
+#include<cstdint>
+#include<cstring>
+#include<stdexcept>
+#include<unordered_map>
+
+static uint64_t hashRow(const std::vector<double>& row) {
+	uint64_t hash = 0xCBF29CE484222325ULL ^ row.size();
+	for (double value : row) {
+		//-0.0 and 0.0 are the same point, so they must hash alike:
+		if (value == 0)
+			value = 0;
+		uint64_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		hash = (hash ^ bits) * 0x100000001B3ULL;
+		hash ^= hash >> 32;
+	}
+	return hash;
+}
+
+duplicateCollapser::duplicateCollapser(int numRows, const std::vector<std::vector<double>>& dataset, const std::vector<double>& sampleWeights, bool collapse) {
+	if (sampleWeights.size() != 0 && (int)sampleWeights.size() != numRows)
+		throw std::invalid_argument("There must be one sample weight per point.");
+	for (double weight : sampleWeights) {
+		if (!(weight > 0) || std::isinf(weight))
+			throw std::invalid_argument("Sample weights must be positive and finite.");
+	}
+	if (collapse && (int)dataset.size() != numRows)
+		throw std::invalid_argument("Collapsing duplicates needs the dataset.");
+
+	_rowRepresentatives.resize(numRows);
+	if (!collapse) {
+		_representativeRows.resize(numRows);
+		for (int row = 0; row < numRows; row++) {
+			_representativeRows[row] = row;
+			_rowRepresentatives[row] = row;
+		}
+		_weights = sampleWeights.size() != 0 ? sampleWeights : std::vector<double>(numRows, 1.0);
+		return;
+	}
+
+	//Representatives with the same hash are chained through nextWithHash, so collisions are compared exactly:
+	std::unordered_map<uint64_t, int> firstWithHash;
+	std::vector<int> nextWithHash;
+	firstWithHash.reserve(numRows);
+	for (int row = 0; row < numRows; row++) {
+		double weight = sampleWeights.size() != 0 ? sampleWeights[row] : 1.0;
+		uint64_t hash = hashRow(dataset[row]);
+		std::unordered_map<uint64_t, int>::iterator entry = firstWithHash.find(hash);
+		int representative = entry == firstWithHash.end() ? -1 : entry->second;
+		while (representative != -1) {
+			const std::vector<double>& other = dataset[_representativeRows[representative]];
+			bool equal = other.size() == dataset[row].size();
+			for (size_t i = 0; equal && i < other.size(); i++)
+				equal = other[i] == dataset[row][i];
+			if (equal)
+				break;
+			representative = nextWithHash[representative];
+		}
+
+		if (representative == -1) {
+			representative = _representativeRows.size();
+			_representativeRows.push_back(row);
+			_weights.push_back(0);
+			nextWithHash.push_back(entry == firstWithHash.end() ? -1 : entry->second);
+			firstWithHash[hash] = representative;
+		}
+		_rowRepresentatives[row] = representative;
+		_weights[representative] += weight;
+	}
+}
+
+const std::vector<int>& duplicateCollapser::getRepresentativeRows() {
+	return _representativeRows;
+}
+
+const std::vector<int>& duplicateCollapser::getRowRepresentatives() {
+	return _rowRepresentatives;
+}
+
+const std::vector<double>& duplicateCollapser::getWeights() {
+	return _weights;
+}
+
+int duplicateCollapser::getNumRepresentatives() {
+	return _representativeRows.size();
+}
+
+std::vector<std::vector<double>> duplicateCollapser::selectRows(const std::vector<std::vector<double>>& rows, bool selectColumns) {
+	std::vector<std::vector<double>> selected(_representativeRows.size());
+	for (size_t i = 0; i < _representativeRows.size(); i++) {
+		const std::vector<double>& row = rows[_representativeRows[i]];
+		if (!selectColumns) {
+			selected[i] = row;
+			continue;
+		}
+		selected[i].resize(_representativeRows.size());
+		for (size_t j = 0; j < _representativeRows.size(); j++)
+			selected[i][j] = row[_representativeRows[j]];
+	}
+	return selected;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include<vector>
+#include<cstddef>
+
+/// <summary>
+/// Collapses exact duplicate rows of a dataset into weighted representatives, so that the distance matrix
+/// and the hierarchy only see each distinct point once. Results computed per representative are expanded
+/// back to the original rows with expand(). Without collapsing, every row is its own representative and the
+/// collapser just carries caller-provided sample weights.
+/// </summary>
+class duplicateCollapser
+{
+private:
+	std::vector<int> _representativeRows;
+	std::vector<int> _rowRepresentatives;
+	std::vector<double> _weights;
+
+public:
+	/// <summary>
+	/// Hashes the rows and groups identical ones, throwing std::invalid_argument for invalid weights.
+	/// </summary>
+	/// <param name="numRows">The number of rows</param>
+	/// <param name="dataset">The rows to compare; may be empty when collapse is false</param>
+	/// <param name="sampleWeights">The weight of each row, or empty to weigh every row as 1</param>
+	/// <param name="collapse">Whether identical rows are merged; their weights are added up</param>
+	duplicateCollapser(int numRows, const std::vector<std::vector<double>>& dataset, const std::vector<double>& sampleWeights, bool collapse);
+
+	/// <summary>
+	/// The original row each representative was taken from (its first occurrence).
+	/// </summary>
+	const std::vector<int>& getRepresentativeRows();
+
+	/// <summary>
+	/// The representative each original row was collapsed into.
+	/// </summary>
+	const std::vector<int>& getRowRepresentatives();
+
+	/// <summary>
+	/// The weight of each representative: the sum of the weights of the rows it stands for.
+	/// </summary>
+	const std::vector<double>& getWeights();
+
+	int getNumRepresentatives();
+
+	/// <summary>
+	/// Keeps the rows of a dataset, or the rows and columns of a distance matrix, which are representatives.
+	/// </summary>
+	std::vector<std::vector<double>> selectRows(const std::vector<std::vector<double>>& rows, bool selectColumns);
+
+	/// <summary>
+	/// Copies each representative's value to every original row it stands for.
+	/// </summary>
+	template<typename T>
+	std::vector<T> expand(const std::vector<T>& values)
+	{
+		std::vector<T> expanded(_rowRepresentatives.size());
+		for (size_t row = 0; row < _rowRepresentatives.size(); row++)
+			expanded[row] = values[_rowRepresentatives[row]];
+		return expanded;
+	}
+};
+
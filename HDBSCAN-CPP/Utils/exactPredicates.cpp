@@ -0,0 +1,211 @@
+#include "exactPredicates.hpp"
+#include<cmath>
+#include<limits>
+#include<vector>
+
+//An expansion is a sum of nonoverlapping doubles ordered by increasing magnitude, so it holds any sum or
+//product of doubles exactly and its sign is the sign of its last component.
+typedef std::vector<double> expansion;
+
+static void twoSum(double a, double b, double& sum, double& error) {
+	sum = a + b;
+	double bVirtual = sum - a;
+	double aVirtual = sum - bVirtual;
+	error = (a - aVirtual) + (b - bVirtual);
+}
+
+static expansion grow(const expansion& e, double b) {
+	expansion result;
+	result.reserve(e.size() + 1);
+	double carry = b;
+	for (double component : e) {
+		double sum, error;
+		twoSum(carry, component, sum, error);
+		if (error != 0)
+			result.push_back(error);
+		carry = sum;
+	}
+	if (carry != 0 || result.empty())
+		result.push_back(carry);
+	return result;
+}
+
+static expansion add(const expansion& e, const expansion& f) {
+	expansion result = e;
+	for (double component : f)
+		result = grow(result, component);
+	return result;
+}
+
+static expansion negate(const expansion& e) {
+	expansion result(e);
+	for (double& component : result)
+		component = -component;
+	return result;
+}
+
+static expansion multiply(const expansion& e, const expansion& f) {
+	expansion result(1, 0.0);
+	for (double a : e) {
+		for (double b : f) {
+			double product = a * b;
+			result = grow(result, std::fma(a, b, -product));
+			result = grow(result, product);
+		}
+	}
+	return result;
+}
+
+static int sign(const expansion& e) {
+	for (size_t i = e.size(); i > 0; i--) {
+		if (e[i - 1] != 0)
+			return e[i - 1] > 0 ? 1 : -1;
+	}
+	return 0;
+}
+
+//Determinants by cofactor expansion along the first row; rows and columns are picked by index lists.
+static expansion exactDeterminant(const expansion matrix[4][4], int size, const int* rows, const int* columns) {
+	if (size == 1)
+		return matrix[rows[0]][columns[0]];
+	expansion result(1, 0.0);
+	int minorColumns[4];
+	for (int i = 0; i < size; i++) {
+		for (int j = 0, k = 0; j < size; j++) {
+			if (j != i)
+				minorColumns[k++] = columns[j];
+		}
+		expansion term = multiply(matrix[rows[0]][columns[i]], exactDeterminant(matrix, size - 1, rows + 1, minorColumns));
+		result = add(result, i % 2 == 0 ? term : negate(term));
+	}
+	return result;
+}
+
+/// <summary>
+/// The exact sign of the determinant whose rows are points[i] - points[numRows] for i < numRows, each followed
+/// by its squared length when lifted is set.
+/// </summary>
+static int exactDifferenceDeterminantSign(int dimensions, const double* const* points, int numRows, bool lifted) {
+	static const int indices[4] = { 0, 1, 2, 3 };
+	const double* last = points[numRows];
+	expansion matrix[4][4];
+	for (int row = 0; row < numRows; row++) {
+		expansion squaredLength(1, 0.0);
+		for (int column = 0; column < dimensions; column++) {
+			double difference, error;
+			twoSum(points[row][column], -last[column], difference, error);
+			expansion exactDifference = grow(expansion(1, error), difference);
+			matrix[row][column] = exactDifference;
+			squaredLength = add(squaredLength, multiply(exactDifference, exactDifference));
+		}
+		if (lifted)
+			matrix[row][dimensions] = squaredLength;
+	}
+	return sign(exactDeterminant(matrix, numRows, indices, indices));
+}
+
+/// <summary>
+/// The sign of a determinant evaluated in floating point, or 0 when the rounding error could have flipped it.
+/// Each difference, square and product adds a relative error of at most one unit roundoff, and this bound
+/// stays well above the worst case of the 4 x 4 lifted determinant.
+/// </summary>
+static int filteredSign(double value, double permanent) {
+	double errorBound = 64 * std::numeric_limits<double>::epsilon() * permanent;
+	if (value > errorBound)
+		return 1;
+	if (value < -errorBound)
+		return -1;
+	return 0;
+}
+
+int exactPredicates::orient(int dimensions, const double* const* points) {
+	return dimensions == 2 ? orient2d(points[0], points[1], points[2]) : orient3d(points[0], points[1], points[2], points[3]);
+}
+
+int exactPredicates::inSphere(int dimensions, const double* const* points) {
+	return dimensions == 2 ? inCircle(points[0], points[1], points[2], points[3]) : inSphere(points[0], points[1], points[2], points[3], points[4]);
+}
+
+int exactPredicates::orient2d(const double* a, const double* b, const double* c) {
+	double left = (a[0] - c[0]) * (b[1] - c[1]);
+	double right = (a[1] - c[1]) * (b[0] - c[0]);
+	int result = filteredSign(left - right, std::fabs(left) + std::fabs(right));
+	if (result != 0)
+		return result;
+	const double* points[3] = { a, b, c };
+	return exactDifferenceDeterminantSign(2, points, 2, false);
+}
+
+int exactPredicates::inCircle(const double* a, const double* b, const double* c, const double* d) {
+	double adx = a[0] - d[0], ady = a[1] - d[1];
+	double bdx = b[0] - d[0], bdy = b[1] - d[1];
+	double cdx = c[0] - d[0], cdy = c[1] - d[1];
+	double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+	double cdxady = cdx * ady, adxcdy = adx * cdy;
+	double adxbdy = adx * bdy, bdxady = bdx * ady;
+	double aLift = adx * adx + ady * ady;
+	double bLift = bdx * bdx + bdy * bdy;
+	double cLift = cdx * cdx + cdy * cdy;
+	double value = aLift * (bdxcdy - cdxbdy) + bLift * (cdxady - adxcdy) + cLift * (adxbdy - bdxady);
+	double permanent = (std::fabs(bdxcdy) + std::fabs(cdxbdy)) * aLift + (std::fabs(cdxady) + std::fabs(adxcdy)) * bLift
+		+ (std::fabs(adxbdy) + std::fabs(bdxady)) * cLift;
+	int result = filteredSign(value, permanent);
+	if (result != 0)
+		return result;
+	const double* points[4] = { a, b, c, d };
+	return exactDifferenceDeterminantSign(2, points, 3, true);
+}
+
+int exactPredicates::orient3d(const double* a, const double* b, const double* c, const double* d) {
+	double adx = a[0] - d[0], ady = a[1] - d[1], adz = a[2] - d[2];
+	double bdx = b[0] - d[0], bdy = b[1] - d[1], bdz = b[2] - d[2];
+	double cdx = c[0] - d[0], cdy = c[1] - d[1], cdz = c[2] - d[2];
+	double bdycdz = bdy * cdz, bdzcdy = bdz * cdy;
+	double cdyadz = cdy * adz, cdzady = cdz * ady;
+	double adybdz = ady * bdz, adzbdy = adz * bdy;
+	double value = adx * (bdycdz - bdzcdy) + bdx * (cdyadz - cdzady) + cdx * (adybdz - adzbdy);
+	double permanent = (std::fabs(bdycdz) + std::fabs(bdzcdy)) * std::fabs(adx) + (std::fabs(cdyadz) + std::fabs(cdzady)) * std::fabs(bdx)
+		+ (std::fabs(adybdz) + std::fabs(adzbdy)) * std::fabs(cdx);
+	int result = filteredSign(value, permanent);
+	if (result != 0)
+		return result;
+	const double* points[4] = { a, b, c, d };
+	return exactDifferenceDeterminantSign(3, points, 3, false);
+}
+
+int exactPredicates::inSphere(const double* a, const double* b, const double* c, const double* d, const double* e) {
+	double aex = a[0] - e[0], aey = a[1] - e[1], aez = a[2] - e[2];
+	double bex = b[0] - e[0], bey = b[1] - e[1], bez = b[2] - e[2];
+	double cex = c[0] - e[0], cey = c[1] - e[1], cez = c[2] - e[2];
+	double dex = d[0] - e[0], dey = d[1] - e[1], dez = d[2] - e[2];
+	double aexbey = aex * bey, bexaey = bex * aey;
+	double bexcey = bex * cey, cexbey = cex * bey;
+	double cexdey = cex * dey, dexcey = dex * cey;
+	double dexaey = dex * aey, aexdey = aex * dey;
+	double aexcey = aex * cey, cexaey = cex * aey;
+	double bexdey = bex * dey, dexbey = dex * bey;
+	double ab = aexbey - bexaey, bc = bexcey - cexbey, cd = cexdey - dexcey;
+	double da = dexaey - aexdey, ac = aexcey - cexaey, bd = bexdey - dexbey;
+	double abc = aez * bc - bez * ac + cez * ab;
+	double bcd = bez * cd - cez * bd + dez * bc;
+	double cda = cez * da + dez * ac + aez * cd;
+	double dab = dez * ab + aez * bd + bez * da;
+	double aLift = aex * aex + aey * aey + aez * aez;
+	double bLift = bex * bex + bey * bey + bez * bez;
+	double cLift = cex * cex + cey * cey + cez * cez;
+	double dLift = dex * dex + dey * dey + dez * dez;
+	double value = (dLift * abc - cLift * dab) + (bLift * cda - aLift * bcd);
+
+	double abPermanent = std::fabs(aexbey) + std::fabs(bexaey), bcPermanent = std::fabs(bexcey) + std::fabs(cexbey);
+	double cdPermanent = std::fabs(cexdey) + std::fabs(dexcey), daPermanent = std::fabs(dexaey) + std::fabs(aexdey);
+	double acPermanent = std::fabs(aexcey) + std::fabs(cexaey), bdPermanent = std::fabs(bexdey) + std::fabs(dexbey);
+	double permanent = dLift * (std::fabs(aez) * bcPermanent + std::fabs(bez) * acPermanent + std::fabs(cez) * abPermanent)
+		+ cLift * (std::fabs(dez) * abPermanent + std::fabs(aez) * bdPermanent + std::fabs(bez) * daPermanent)
+		+ bLift * (std::fabs(cez) * daPermanent + std::fabs(dez) * acPermanent + std::fabs(aez) * cdPermanent)
+		+ aLift * (std::fabs(bez) * cdPermanent + std::fabs(cez) * bdPermanent + std::fabs(dez) * bcPermanent);
+	int result = filteredSign(value, permanent);
+	if (result != 0)
+		return result;
+	const double* points[5] = { a, b, c, d, e };
+	return exactDifferenceDeterminantSign(3, points, 4, true);
+}
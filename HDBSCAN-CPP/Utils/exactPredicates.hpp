@@ -0,0 +1,41 @@
+#pragma once
+/// <summary>
+/// Orientation and in-sphere tests in two and three dimensions whose signs are exact for any double
+/// coordinates. Each test first evaluates its determinant in floating point with an error bound; only when
+/// the result is too close to zero to trust is it evaluated again with exact expansion arithmetic (Shewchuk,
+/// "Adaptive Precision Floating-Point Arithmetic and Fast Robust Geometric Predicates", 1997).
+/// Points are arrays of 2 or 3 coordinates.
+/// </summary>
+class exactPredicates
+{
+public:
+	/// <summary>
+	/// The sign of det[a - c; b - c]: positive when a, b, c run counterclockwise.
+	/// </summary>
+	static int orient2d(const double* a, const double* b, const double* c);
+
+	/// <summary>
+	/// Positive when d lies inside the circle through a, b, c (given counterclockwise), zero when on it.
+	/// </summary>
+	static int inCircle(const double* a, const double* b, const double* c, const double* d);
+
+	/// <summary>
+	/// The sign of det[a - d; b - d; c - d].
+	/// </summary>
+	static int orient3d(const double* a, const double* b, const double* c, const double* d);
+
+	/// <summary>
+	/// Positive when e lies inside the sphere through a, b, c, d (given orient3d(a, b, c, d) > 0), zero when on it.
+	/// </summary>
+	static int inSphere(const double* a, const double* b, const double* c, const double* d, const double* e);
+
+	/// <summary>
+	/// orient2d() or orient3d() of dimensions + 1 points.
+	/// </summary>
+	static int orient(int dimensions, const double* const* points);
+
+	/// <summary>
+	/// inCircle() or inSphere() of dimensions + 2 points, the last one being tested.
+	/// </summary>
+	static int inSphere(int dimensions, const double* const* points);
+};
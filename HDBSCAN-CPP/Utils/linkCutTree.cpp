@@ -0,0 +1,177 @@
+#include "linkCutTree.hpp"
+
+linkCutTree::linkCutTree() {
+	;
+}
+
+linkCutTree::linkCutTree(int numNodes, double value) {
+	resize(numNodes, value);
+}
+
+void linkCutTree::resize(int numNodes, double value) {
+	int oldNumNodes = _values.size();
+	_left.resize(numNodes, -1);
+	_right.resize(numNodes, -1);
+	_parents.resize(numNodes, -1);
+	_reversed.resize(numNodes, 0);
+	_values.resize(numNodes, value);
+	_maxNodes.resize(numNodes);
+	for (int node = oldNumNodes; node < numNodes; node++)
+		_maxNodes[node] = node;
+}
+
+//A node is the root of its splay tree when its parent pointer is a path-parent pointer:
+bool linkCutTree::isSplayRoot(int node) {
+	int parent = _parents[node];
+	return parent < 0 || (_left[parent] != node && _right[parent] != node);
+}
+
+void linkCutTree::pushReversal(int node) {
+	if (!_reversed[node])
+		return;
+	int left = _left[node];
+	_left[node] = _right[node];
+	_right[node] = left;
+	if (_left[node] >= 0)
+		_reversed[_left[node]] ^= 1;
+	if (_right[node] >= 0)
+		_reversed[_right[node]] ^= 1;
+	_reversed[node] = 0;
+}
+
+void linkCutTree::update(int node) {
+	int maxNode = node;
+	if (_left[node] >= 0 && _values[_maxNodes[_left[node]]] > _values[maxNode])
+		maxNode = _maxNodes[_left[node]];
+	if (_right[node] >= 0 && _values[_maxNodes[_right[node]]] > _values[maxNode])
+		maxNode = _maxNodes[_right[node]];
+	_maxNodes[node] = maxNode;
+}
+
+void linkCutTree::rotate(int node) {
+	int parent = _parents[node];
+	int grandparent = _parents[parent];
+	if (!isSplayRoot(parent))
+	{
+		if (_left[grandparent] == parent)
+			_left[grandparent] = node;
+		else
+			_right[grandparent] = node;
+	}
+	_parents[node] = grandparent;
+	if (_left[parent] == node)
+	{
+		_left[parent] = _right[node];
+		if (_right[node] >= 0)
+			_parents[_right[node]] = parent;
+		_right[node] = parent;
+	}
+	else
+	{
+		_right[parent] = _left[node];
+		if (_left[node] >= 0)
+			_parents[_left[node]] = parent;
+		_left[node] = parent;
+	}
+	_parents[parent] = node;
+	update(parent);
+	update(node);
+}
+
+void linkCutTree::splay(int node) {
+	//Reversals are pushed down from the splay root before rotating:
+	_stack.clear();
+	for (int ancestor = node; ; ancestor = _parents[ancestor])
+	{
+		_stack.push_back(ancestor);
+		if (isSplayRoot(ancestor))
+			break;
+	}
+	for (int i = _stack.size() - 1; i >= 0; i--)
+		pushReversal(_stack[i]);
+
+	while (!isSplayRoot(node))
+	{
+		int parent = _parents[node];
+		if (!isSplayRoot(parent))
+		{
+			int grandparent = _parents[parent];
+			if ((_left[grandparent] == parent) == (_left[parent] == node))
+				rotate(parent);
+			else
+				rotate(node);
+		}
+		rotate(node);
+	}
+}
+
+void linkCutTree::access(int node) {
+	int last = -1;
+	for (int ancestor = node; ancestor >= 0; ancestor = _parents[ancestor])
+	{
+		splay(ancestor);
+		_right[ancestor] = last;
+		update(ancestor);
+		last = ancestor;
+	}
+	splay(node);
+}
+
+void linkCutTree::makeRoot(int node) {
+	access(node);
+	_reversed[node] ^= 1;
+}
+
+double linkCutTree::getValue(int node) {
+	return _values[node];
+}
+
+void linkCutTree::setValue(int node, double value) {
+	access(node);
+	_values[node] = value;
+	update(node);
+}
+
+void linkCutTree::link(int nodeOne, int nodeTwo) {
+	makeRoot(nodeOne);
+	_parents[nodeOne] = nodeTwo;
+}
+
+void linkCutTree::cut(int nodeOne, int nodeTwo) {
+	makeRoot(nodeOne);
+	access(nodeTwo);
+	//Adjacent nodes leave nodeOne alone before nodeTwo on the path from the root:
+	if (_left[nodeTwo] == nodeOne && _left[nodeOne] < 0 && _right[nodeOne] < 0)
+	{
+		_left[nodeTwo] = -1;
+		_parents[nodeOne] = -1;
+		update(nodeTwo);
+	}
+}
+
+int linkCutTree::findRoot(int node) {
+	access(node);
+	int root = node;
+	pushReversal(root);
+	while (_left[root] >= 0)
+	{
+		root = _left[root];
+		pushReversal(root);
+	}
+	splay(root);
+	return root;
+}
+
+bool linkCutTree::connected(int nodeOne, int nodeTwo) {
+	return findRoot(nodeOne) == findRoot(nodeTwo);
+}
+
+int linkCutTree::findPathMax(int nodeOne, int nodeTwo) {
+	makeRoot(nodeOne);
+	access(nodeTwo);
+	return _maxNodes[nodeTwo];
+}
+
+int linkCutTree::getNumNodes() {
+	return _values.size();
+}
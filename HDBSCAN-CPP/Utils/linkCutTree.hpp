@@ -0,0 +1,69 @@
+#pragma once
+#include<vector>
+/// <summary>
+/// A forest of rooted trees over weighted nodes that supports linking, cutting and finding the heaviest
+/// node on the path between two nodes in amortized logarithmic time (Sleator and Tarjan's link-cut tree).
+/// Edges of a weighted graph are represented by nodes of their own linked between their two vertices, so
+/// the heaviest node on a path is its heaviest edge.
+/// </summary>
+class linkCutTree
+{
+private:
+	std::vector<int> _left;
+	std::vector<int> _right;
+	std::vector<int> _parents;
+	std::vector<char> _reversed;
+	std::vector<double> _values;
+	std::vector<int> _maxNodes;
+	std::vector<int> _stack;
+
+	bool isSplayRoot(int node);
+	void pushReversal(int node);
+	void update(int node);
+	void rotate(int node);
+	void splay(int node);
+	void access(int node);
+	void makeRoot(int node);
+
+public:
+	linkCutTree();
+
+	linkCutTree(int numNodes, double value);
+
+	/// <summary>
+	/// Adds unlinked nodes with the given value until there are numNodes nodes.
+	/// </summary>
+	void resize(int numNodes, double value);
+
+	double getValue(int node);
+
+	void setValue(int node, double value);
+
+	/// <summary>
+	/// Links two nodes of different trees.
+	/// </summary>
+	void link(int nodeOne, int nodeTwo);
+
+	/// <summary>
+	/// Removes the link between two adjacent nodes.
+	/// </summary>
+	void cut(int nodeOne, int nodeTwo);
+
+	/// <summary>
+	/// Returns the current root of the node's tree. Every operation but this one may move the root, so only
+	/// roots found without other operations in between can be compared.
+	/// </summary>
+	int findRoot(int node);
+
+	/// <summary>
+	/// Returns whether the two nodes are in the same tree.
+	/// </summary>
+	bool connected(int nodeOne, int nodeTwo);
+
+	/// <summary>
+	/// Returns the node with the largest value on the path between two nodes of the same tree.
+	/// </summary>
+	int findPathMax(int nodeOne, int nodeTwo);
+
+	int getNumNodes();
+};
@@ -0,0 +1,63 @@
+#include "mappedFile.hpp"
+#include<fstream>
+#include<stdexcept>
+#if !defined(_WIN32)
+#include<fcntl.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<unistd.h>
+#endif
+
+mappedFile::mappedFile(std::string fileName) {
+	_data = NULL;
+	_size = 0;
+	_mapped = false;
+#if !defined(_WIN32)
+	int descriptor = open(fileName.c_str(), O_RDONLY);
+	if (descriptor < 0)
+		throw std::runtime_error("Cannot open " + fileName + ".");
+	struct stat fileStatus;
+	if (fstat(descriptor, &fileStatus) != 0)
+	{
+		close(descriptor);
+		throw std::runtime_error("Cannot read the size of " + fileName + ".");
+	}
+	_size = fileStatus.st_size;
+	if (_size > 0)
+	{
+		void* address = mmap(NULL, _size, PROT_READ, MAP_SHARED, descriptor, 0);
+		if (address == MAP_FAILED)
+		{
+			close(descriptor);
+			throw std::runtime_error("Cannot map " + fileName + ".");
+		}
+		_data = (const char*)address;
+		_mapped = true;
+	}
+	close(descriptor);
+#else
+	std::ifstream file(fileName, std::ios::in | std::ios::binary | std::ios::ate);
+	if (!file)
+		throw std::runtime_error("Cannot open " + fileName + ".");
+	_size = file.tellg();
+	_buffer.resize(_size);
+	file.seekg(0);
+	file.read(_buffer.data(), _size);
+	_data = _buffer.data();
+#endif
+}
+
+mappedFile::~mappedFile() {
+#if !defined(_WIN32)
+	if (_mapped)
+		munmap((void*)_data, _size);
+#endif
+}
+
+const char* mappedFile::getData() {
+	return _data;
+}
+
+size_t mappedFile::getSize() {
+	return _size;
+}
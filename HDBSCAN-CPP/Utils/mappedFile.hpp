@@ -0,0 +1,32 @@
+#pragma once
+#include<string>
+#include<vector>
+#include<cstddef>
+/// <summary>
+/// A read-only view of a whole file. On POSIX systems the file is memory mapped, so the pages are shared
+/// between every process which maps the same file; elsewhere the file is read into memory.
+/// </summary>
+class mappedFile
+{
+private:
+	const char* _data;
+	size_t _size;
+	bool _mapped;
+	std::vector<char> _buffer;
+
+	mappedFile(const mappedFile&);
+	mappedFile& operator=(const mappedFile&);
+
+public:
+	/// <summary>
+	/// Maps the file, throwing std::runtime_error if it cannot be opened.
+	/// </summary>
+	mappedFile(std::string fileName);
+
+	~mappedFile();
+
+	const char* getData();
+
+	size_t getSize();
+};
+
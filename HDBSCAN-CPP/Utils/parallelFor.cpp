@@ -0,0 +1,37 @@
+#include "parallelFor.hpp"
+#include<thread>
+#include<vector>
+
+int resolveNumThreads(int numThreads) {
+	if (numThreads >= 1)
+		return numThreads;
+	int hardwareThreads = std::thread::hardware_concurrency();
+	return hardwareThreads > 0 ? hardwareThreads : 1;
+}
+
+void parallelFor(int begin, int end, int numThreads, const std::function<void(int, int)>& body) {
+	int length = end - begin;
+	if (length <= 0)
+		return;
+	numThreads = resolveNumThreads(numThreads);
+	if (numThreads > length)
+		numThreads = length;
+	if (numThreads == 1)
+	{
+		body(begin, end);
+		return;
+	}
+
+	std::vector<std::thread> threads;
+	int chunkSize = length / numThreads;
+	int remainder = length % numThreads;
+	int chunkBegin = begin;
+	for (int thread = 0; thread < numThreads; thread++)
+	{
+		int chunkEnd = chunkBegin + chunkSize + (thread < remainder ? 1 : 0);
+		threads.push_back(std::thread(body, chunkBegin, chunkEnd));
+		chunkBegin = chunkEnd;
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+}
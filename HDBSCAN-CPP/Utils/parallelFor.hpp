@@ -0,0 +1,18 @@
+#pragma once
+#include<functional>
+/// <summary>
+/// Splits the range [begin, end) into contiguous chunks and runs body(chunkBegin, chunkEnd) on each chunk
+/// in its own thread. With numThreads below 1 the hardware concurrency is used; with a single thread (or
+/// a range too small to split) the body runs on the calling thread.
+/// </summary>
+/// <param name="begin">The first index of the range</param>
+/// <param name="end">One past the last index of the range</param>
+/// <param name="numThreads">The number of threads to use</param>
+/// <param name="body">The work to run for each chunk</param>
+void parallelFor(int begin, int end, int numThreads, const std::function<void(int, int)>& body);
+
+/// <summary>
+/// Resolves a requested thread count: values below 1 mean the hardware concurrency.
+/// </summary>
+int resolveNumThreads(int numThreads);
+
@@ -0,0 +1,67 @@
+#include "parallelProcesses.hpp"
+#include "parallelFor.hpp"
+#include<cstdio>
+#include<exception>
+#include<map>
+#include<stdexcept>
+#include<string>
+#if !defined(_WIN32)
+#include<sys/types.h>
+#include<sys/wait.h>
+#include<unistd.h>
+#endif
+
+void parallelProcesses(int numJobs, int numProcesses, const std::function<void(int)>& job) {
+#if !defined(_WIN32)
+	numProcesses = resolveNumThreads(numProcesses);
+	std::map<pid_t, int> runningJobs;
+	int nextJob = 0;
+	int failedJob = -1;
+	while (nextJob < numJobs || !runningJobs.empty())
+	{
+		if (nextJob < numJobs && (int)runningJobs.size() < numProcesses && failedJob < 0)
+		{
+			//Buffered output would otherwise be written again by the child:
+			fflush(NULL);
+			pid_t child = fork();
+			if (child < 0)
+				throw std::runtime_error("Cannot start a worker process.");
+			if (child == 0)
+			{
+				int status = 0;
+				try
+				{
+					job(nextJob);
+				}
+				catch (const std::exception& exception)
+				{
+					fprintf(stderr, "Job %d failed: %s\n", nextJob, exception.what());
+					status = 1;
+				}
+				fflush(NULL);
+				_exit(status);
+			}
+			runningJobs[child] = nextJob++;
+			continue;
+		}
+		if (failedJob >= 0 && runningJobs.empty())
+			break;
+
+		int status;
+		pid_t child = waitpid(-1, &status, 0);
+		if (child < 0)
+			throw std::runtime_error("Cannot wait for the worker processes.");
+		std::map<pid_t, int>::iterator entry = runningJobs.find(child);
+		if (entry == runningJobs.end())
+			continue;
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+			failedJob = entry->second;
+		runningJobs.erase(entry);
+	}
+	if (failedJob >= 0)
+		throw std::runtime_error("The worker process of job " + std::to_string(failedJob) + " failed.");
+#else
+	for (int index = 0; index < numJobs; index++)
+		job(index);
+#endif
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include<functional>
+/// <summary>
+/// Runs job(index) for every index in [0, numJobs) in its own child process, at most numProcesses at a time,
+/// and waits for all of them. The children start as copies of the calling process, so they see its memory
+/// as it was when they were forked, and hand their results back through files. A job which throws or
+/// crashes makes this throw std::runtime_error once every job has finished. Without fork(), on Windows, the
+/// jobs run one after the other in the calling process. With numProcesses below 1 the hardware concurrency
+/// is used.
+/// </summary>
+/// <param name="numJobs">The number of jobs</param>
+/// <param name="numProcesses">The most child processes at a time</param>
+/// <param name="job">The work of one job, which must not leave threads running</param>
+void parallelProcesses(int numJobs, int numProcesses, const std::function<void(int)>& job);
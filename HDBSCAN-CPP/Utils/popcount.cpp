@@ -0,0 +1,153 @@
+#include "popcount.hpp"
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define POPCOUNT_X86_KERNELS
+#include<immintrin.h>
+#endif
+
+namespace
+{
+	struct popcountKernel
+	{
+		const char* name;
+		uint64_t(*countBits)(const uint64_t*, int);
+		uint64_t(*countDifferentBits)(const uint64_t*, const uint64_t*, int);
+		void(*countCommonBits)(const uint64_t*, const uint64_t*, int, uint64_t&, uint64_t&);
+	};
+
+	inline uint64_t countWord(uint64_t word) {
+		word = word - ((word >> 1) & 0x5555555555555555ULL);
+		word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+		word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+		return (word * 0x0101010101010101ULL) >> 56;
+	}
+
+	uint64_t countBitsPortable(const uint64_t* words, int numWords) {
+		uint64_t count = 0;
+		for (int i = 0; i < numWords; i++)
+			count += countWord(words[i]);
+		return count;
+	}
+
+	uint64_t countDifferentBitsPortable(const uint64_t* wordsOne, const uint64_t* wordsTwo, int numWords) {
+		uint64_t count = 0;
+		for (int i = 0; i < numWords; i++)
+			count += countWord(wordsOne[i] ^ wordsTwo[i]);
+		return count;
+	}
+
+	void countCommonBitsPortable(const uint64_t* wordsOne, const uint64_t* wordsTwo, int numWords, uint64_t& numBoth, uint64_t& numEither) {
+		numBoth = 0;
+		numEither = 0;
+		for (int i = 0; i < numWords; i++) {
+			numBoth += countWord(wordsOne[i] & wordsTwo[i]);
+			numEither += countWord(wordsOne[i] | wordsTwo[i]);
+		}
+	}
+
+#ifdef POPCOUNT_X86_KERNELS
+	__attribute__((target("popcnt"))) uint64_t countBitsPopcnt(const uint64_t* words, int numWords) {
+		uint64_t count = 0;
+		for (int i = 0; i < numWords; i++)
+			count += _mm_popcnt_u64(words[i]);
+		return count;
+	}
+
+	__attribute__((target("popcnt"))) uint64_t countDifferentBitsPopcnt(const uint64_t* wordsOne, const uint64_t* wordsTwo, int numWords) {
+		uint64_t count = 0;
+		for (int i = 0; i < numWords; i++)
+			count += _mm_popcnt_u64(wordsOne[i] ^ wordsTwo[i]);
+		return count;
+	}
+
+	__attribute__((target("popcnt"))) void countCommonBitsPopcnt(const uint64_t* wordsOne, const uint64_t* wordsTwo, int numWords, uint64_t& numBoth, uint64_t& numEither) {
+		numBoth = 0;
+		numEither = 0;
+		for (int i = 0; i < numWords; i++) {
+			numBoth += _mm_popcnt_u64(wordsOne[i] & wordsTwo[i]);
+			numEither += _mm_popcnt_u64(wordsOne[i] | wordsTwo[i]);
+		}
+	}
+
+	__attribute__((target("avx512f"))) uint64_t sumLanes(__m512i counts) {
+		uint64_t lanes[8];
+		_mm512_storeu_si512(lanes, counts);
+		return lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+	}
+
+	//Eight words per step, with a masked load for the tail:
+	__attribute__((target("avx512f,avx512vpopcntdq"))) uint64_t countBitsAvx512(const uint64_t* words, int numWords) {
+		__m512i counts = _mm512_setzero_si512();
+		int i = 0;
+		for (; i + 8 <= numWords; i += 8)
+			counts = _mm512_add_epi64(counts, _mm512_popcnt_epi64(_mm512_loadu_si512(words + i)));
+		__mmask8 tail = (__mmask8)((1u << (numWords - i)) - 1);
+		counts = _mm512_add_epi64(counts, _mm512_popcnt_epi64(_mm512_maskz_loadu_epi64(tail, words + i)));
+		return sumLanes(counts);
+	}
+
+	__attribute__((target("avx512f,avx512vpopcntdq"))) uint64_t countDifferentBitsAvx512(const uint64_t* wordsOne, const uint64_t* wordsTwo, int numWords) {
+		__m512i counts = _mm512_setzero_si512();
+		int i = 0;
+		for (; i + 8 <= numWords; i += 8)
+			counts = _mm512_add_epi64(counts, _mm512_popcnt_epi64(_mm512_xor_si512(_mm512_loadu_si512(wordsOne + i), _mm512_loadu_si512(wordsTwo + i))));
+		__mmask8 tail = (__mmask8)((1u << (numWords - i)) - 1);
+		counts = _mm512_add_epi64(counts, _mm512_popcnt_epi64(_mm512_xor_si512(_mm512_maskz_loadu_epi64(tail, wordsOne + i),
+			_mm512_maskz_loadu_epi64(tail, wordsTwo + i))));
+		return sumLanes(counts);
+	}
+
+	__attribute__((target("avx512f,avx512vpopcntdq"))) void countCommonBitsAvx512(const uint64_t* wordsOne, const uint64_t* wordsTwo, int numWords, uint64_t& numBoth, uint64_t& numEither) {
+		__m512i both = _mm512_setzero_si512();
+		__m512i either = _mm512_setzero_si512();
+		int i = 0;
+		for (; i + 8 <= numWords; i += 8) {
+			__m512i one = _mm512_loadu_si512(wordsOne + i);
+			__m512i two = _mm512_loadu_si512(wordsTwo + i);
+			both = _mm512_add_epi64(both, _mm512_popcnt_epi64(_mm512_and_si512(one, two)));
+			either = _mm512_add_epi64(either, _mm512_popcnt_epi64(_mm512_or_si512(one, two)));
+		}
+		__mmask8 tail = (__mmask8)((1u << (numWords - i)) - 1);
+		__m512i one = _mm512_maskz_loadu_epi64(tail, wordsOne + i);
+		__m512i two = _mm512_maskz_loadu_epi64(tail, wordsTwo + i);
+		both = _mm512_add_epi64(both, _mm512_popcnt_epi64(_mm512_and_si512(one, two)));
+		either = _mm512_add_epi64(either, _mm512_popcnt_epi64(_mm512_or_si512(one, two)));
+		numBoth = sumLanes(both);
+		numEither = sumLanes(either);
+	}
+#endif
+
+	popcountKernel selectKernel() {
+#ifdef POPCOUNT_X86_KERNELS
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq")) {
+			popcountKernel kernel = { "AVX-512", countBitsAvx512, countDifferentBitsAvx512, countCommonBitsAvx512 };
+			return kernel;
+		}
+		if (__builtin_cpu_supports("popcnt")) {
+			popcountKernel kernel = { "POPCNT", countBitsPopcnt, countDifferentBitsPopcnt, countCommonBitsPopcnt };
+			return kernel;
+		}
+#endif
+		popcountKernel kernel = { "Portable", countBitsPortable, countDifferentBitsPortable, countCommonBitsPortable };
+		return kernel;
+	}
+
+	const popcountKernel kernel = selectKernel();
+}
+
+uint64_t popcount::countBits(const uint64_t* words, int numWords) {
+	return kernel.countBits(words, numWords);
+}
+
+uint64_t popcount::countDifferentBits(const uint64_t* wordsOne, const uint64_t* wordsTwo, int numWords) {
+	return kernel.countDifferentBits(wordsOne, wordsTwo, numWords);
+}
+
+void popcount::countCommonBits(const uint64_t* wordsOne, const uint64_t* wordsTwo, int numWords, uint64_t& numBoth, uint64_t& numEither) {
+	kernel.countCommonBits(wordsOne, wordsTwo, numWords, numBoth, numEither);
+}
+
+const char* popcount::getKernelName() {
+	return kernel.name;
+}
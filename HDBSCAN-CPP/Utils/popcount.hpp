@@ -0,0 +1,32 @@
+#pragma once
+#include<cstdint>
+
+/// <summary>
+/// Counts set bits of packed 64 bit words for the binary distances. On x86 the kernel is picked once at
+/// startup from what the processor supports: AVX-512 VPOPCNTDQ, which counts eight words per instruction,
+/// the POPCNT instruction, or else a portable bit-twiddling count, so the library needs no special compiler
+/// flags to use them.
+/// </summary>
+class popcount
+{
+public:
+	/// <summary>
+	/// The number of bits set in words.
+	/// </summary>
+	static uint64_t countBits(const uint64_t* words, int numWords);
+
+	/// <summary>
+	/// The number of bits that differ between wordsOne and wordsTwo.
+	/// </summary>
+	static uint64_t countDifferentBits(const uint64_t* wordsOne, const uint64_t* wordsTwo, int numWords);
+
+	/// <summary>
+	/// Counts the bits set in both wordsOne and wordsTwo, and in either of them.
+	/// </summary>
+	static void countCommonBits(const uint64_t* wordsOne, const uint64_t* wordsTwo, int numWords, uint64_t& numBoth, uint64_t& numEither);
+
+	/// <summary>
+	/// The name of the kernel in use: "AVX-512", "POPCNT" or "Portable".
+	/// </summary>
+	static const char* getKernelName();
+};
@@ -0,0 +1,76 @@
+#pragma once
+#include<vector>
+#include<memory>
+#include<cstddef>
+/// <summary>
+/// A read-only array which either owns its elements or views memory kept alive by another object, such as
+/// a mapped model file. Copies share the same elements, so they are cheap and safe to hand to other threads.
+/// </summary>
+template<typename T>
+class sharedArray
+{
+private:
+	std::shared_ptr<const void> _owner;
+	const T* _data;
+	size_t _size;
+
+public:
+	sharedArray()
+	{
+		_data = NULL;
+		_size = 0;
+	}
+
+	/// <summary>
+	/// Takes ownership of the elements of a vector.
+	/// </summary>
+	sharedArray(std::vector<T> values)
+	{
+		std::shared_ptr<std::vector<T>> ownedValues = std::make_shared<std::vector<T>>();
+		ownedValues->swap(values);
+		_owner = ownedValues;
+		_data = ownedValues->data();
+		_size = ownedValues->size();
+	}
+
+	/// <summary>
+	/// Views size elements at data, which stay valid for as long as owner is alive.
+	/// </summary>
+	sharedArray(std::shared_ptr<const void> owner, const T* data, size_t size)
+	{
+		_owner = owner;
+		_data = data;
+		_size = size;
+	}
+
+	const T& operator[](size_t index) const
+	{
+		return _data[index];
+	}
+
+	const T* data() const
+	{
+		return _data;
+	}
+
+	size_t size() const
+	{
+		return _size;
+	}
+
+	const T* begin() const
+	{
+		return _data;
+	}
+
+	const T* end() const
+	{
+		return _data + _size;
+	}
+
+	std::vector<T> toVector() const
+	{
+		return std::vector<T>(_data, _data + _size);
+	}
+};
+
@@ -0,0 +1,45 @@
+#include "unionFind.hpp"
+
+unionFind::unionFind() {
+	;
+}
+
+unionFind::unionFind(int numElements) {
+	_parents.resize(numElements);
+	_sizes.resize(numElements, 1);
+	for (int i = 0; i < numElements; i++)
+		_parents[i] = i;
+}
+
+int unionFind::find(int element) {
+	int root = element;
+	while (_parents[root] != root)
+		root = _parents[root];
+	while (_parents[element] != root)
+	{
+		int next = _parents[element];
+		_parents[element] = root;
+		element = next;
+	}
+	return root;
+}
+
+int unionFind::join(int elementOne, int elementTwo) {
+	int rootOne = find(elementOne);
+	int rootTwo = find(elementTwo);
+	if (rootOne == rootTwo)
+		return rootOne;
+	if (_sizes[rootOne] < _sizes[rootTwo])
+	{
+		int temp = rootOne;
+		rootOne = rootTwo;
+		rootTwo = temp;
+	}
+	_parents[rootTwo] = rootOne;
+	_sizes[rootOne] += _sizes[rootTwo];
+	return rootOne;
+}
+
+int unionFind::getNumElements() {
+	return _parents.size();
+}
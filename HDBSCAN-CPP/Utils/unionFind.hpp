@@ -0,0 +1,28 @@
+#pragma once
+#include<vector>
+/// <summary>
+/// Disjoint-set forest with path compression and union by size.
+/// </summary>
+class unionFind
+{
+private:
+	std::vector<int> _parents;
+	std::vector<int> _sizes;
+public:
+	unionFind();
+
+	unionFind(int numElements);
+
+	/// <summary>
+	/// Returns the representative of the set containing the element.
+	/// </summary>
+	int find(int element);
+
+	/// <summary>
+	/// Merges the sets containing the two elements and returns the representative of the merged set.
+	/// </summary>
+	int join(int elementOne, int elementTwo);
+
+	int getNumElements();
+};
+
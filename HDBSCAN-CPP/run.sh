@@ -1,4 +1,4 @@
-g++ -c -g -O3 */*.cpp
-g++ -g -O3 main.cpp *.o
+g++ -c -g -O3 -pthread */*.cpp
+g++ -g -O3 -pthread main.cpp *.o
 ./a.out
 rm  *.o
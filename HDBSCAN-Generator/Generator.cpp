@@ -0,0 +1,84 @@
+#include<cstdlib>
+#include<iostream>
+#include<stdexcept>
+#include<string>
+#include"../HDBSCAN-CPP/Dataset/datasetGenerator.hpp"
+#include"../HDBSCAN-CPP/Dataset/datasetFile.hpp"
+using namespace std;
+
+// Writes a reproducible synthetic dataset as CSV or as a binary dataset (chosen by the ".bin" extension
+// unless --format is given), streaming it in blocks so sizes far beyond memory can be produced.
+
+static void printUsage() {
+	cerr << "usage: hdbscan-generate --output FILE [options]" << endl
+		<< "  --shape NAME          blobs, nested, uniform, chains, duplicates, grid or highdim (default blobs)" << endl
+		<< "  --n N                 number of points (default 1000)" << endl
+		<< "  --d N                 number of attributes (default 2)" << endl
+		<< "  --clusters N          number of clusters or chains (default 8)" << endl
+		<< "  --noise F             fraction of uniform noise points (default 0.1)" << endl
+		<< "  --duplicates N        copies of each point for the duplicates shape (default 10)" << endl
+		<< "  --intrinsic-d N       subspace dimension for the highdim shape (default 8)" << endl
+		<< "  --seed N              (default 42)" << endl
+		<< "  --format csv|binary   overrides the format implied by the file name" << endl
+		<< "  --threads N           threads generating each block, 0 for all (default 0)" << endl;
+}
+
+int main(int argc, char** argv) {
+	datasetGeneratorOptions options;
+	string output;
+	string format;
+	int numThreads = 0;
+	for (int i = 1; i < argc; i++) {
+		string option = argv[i];
+		if (i + 1 >= argc) {
+			printUsage();
+			return 1;
+		}
+		string value = argv[++i];
+		if (option == "--shape") {
+			if (!datasetGenerator::parseShape(value, options.shape)) {
+				cerr << "unknown shape " << value << endl;
+				return 1;
+			}
+		}
+		else if (option == "--n")
+			options.numPoints = strtoull(value.c_str(), NULL, 10);
+		else if (option == "--d")
+			options.numAttributes = atoi(value.c_str());
+		else if (option == "--clusters")
+			options.numClusters = atoi(value.c_str());
+		else if (option == "--noise")
+			options.noiseFraction = atof(value.c_str());
+		else if (option == "--duplicates")
+			options.duplicateCount = atoi(value.c_str());
+		else if (option == "--intrinsic-d")
+			options.intrinsicDimension = atoi(value.c_str());
+		else if (option == "--seed")
+			options.seed = strtoull(value.c_str(), NULL, 10);
+		else if (option == "--format")
+			format = value;
+		else if (option == "--threads")
+			numThreads = atoi(value.c_str());
+		else if (option == "--output")
+			output = value;
+		else {
+			printUsage();
+			return 1;
+		}
+	}
+	if (output.length() == 0 || (format.length() != 0 && format != "csv" && format != "binary")) {
+		printUsage();
+		return 1;
+	}
+
+	try {
+		datasetGenerator generator(options);
+		bool binary = format.length() != 0 ? format == "binary" : datasetFile::isBinaryFileName(output);
+		generator.write(output, binary, numThreads);
+	}
+	catch (exception& error) {
+		cerr << error.what() << endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,243 @@
+#include<algorithm>
+#include<cmath>
+#include<iostream>
+#include<map>
+#include<stdexcept>
+#include<string>
+#include<vector>
+#include"../HDBSCAN-CPP/Runner/hdbscanRunner.hpp"
+#include"../HDBSCAN-CPP/Runner/hdbscanSweep.hpp"
+#include"../HDBSCAN-CPP/Runner/hdbscanParameters.hpp"
+#include"../HDBSCAN-CPP/Runner/hdbscanResult.hpp"
+#include"../HDBSCAN-CPP/Dataset/datasetGenerator.hpp"
+using namespace std;
+
+// Checks that the faster paths of the library give the same clustering as hdbscanRunner::run() on
+// generated datasets, and prints every configuration that does not. Exits with 1 if any check fails.
+
+static const char* testShapes[] = { "blobs", "nested", "uniform", "chains", "grid", "duplicates" };
+
+static vector<vector<double>> generateDataset(string shape, int numPoints) {
+	datasetGeneratorOptions options;
+	datasetGenerator::parseShape(shape, options.shape);
+	options.numPoints = numPoints;
+	options.duplicateCount = 4;
+	return datasetGenerator(options).generateAll();
+}
+
+//Whether two labellings have the same noise points and group the other points the same way:
+static bool samePartition(const vector<int>& labelsA, const vector<int>& labelsB) {
+	if (labelsA.size() != labelsB.size())
+		return false;
+	map<int, int> labelsAToB;
+	map<int, int> labelsBToA;
+	for (size_t i = 0; i < labelsA.size(); i++) {
+		if ((labelsA[i] == 0) != (labelsB[i] == 0))
+			return false;
+		if (labelsA[i] == 0)
+			continue;
+		if (labelsAToB.count(labelsA[i]) && labelsAToB[labelsA[i]] != labelsB[i])
+			return false;
+		if (labelsBToA.count(labelsB[i]) && labelsBToA[labelsB[i]] != labelsA[i])
+			return false;
+		labelsAToB[labelsA[i]] = labelsB[i];
+		labelsBToA[labelsB[i]] = labelsA[i];
+	}
+	return true;
+}
+
+//Whether two lists of membership probabilities are equal, counting NaN (which run() gives clusters of
+//duplicates, whose core distances are 0) as equal to NaN:
+static bool sameProbabilities(const vector<double>& probabilitiesA, const vector<double>& probabilitiesB) {
+	if (probabilitiesA.size() != probabilitiesB.size())
+		return false;
+	for (size_t i = 0; i < probabilitiesA.size(); i++) {
+		if (probabilitiesA[i] != probabilitiesB[i] && !(std::isnan(probabilitiesA[i]) && std::isnan(probabilitiesB[i])))
+			return false;
+	}
+	return true;
+}
+
+static vector<double> getIndexedScores(const hdbscanResult& result) {
+	vector<double> scores(result.labels.size());
+	for (const outlierScore& score : result.outliersScores)
+		scores[score.id] = score.score;
+	return scores;
+}
+
+//The largest difference between the outlier scores of two results, by point:
+static double getScoreDifference(const hdbscanResult& resultA, const hdbscanResult& resultB) {
+	vector<double> scoresA = getIndexedScores(resultA);
+	vector<double> scoresB = getIndexedScores(resultB);
+	double difference = 0;
+	for (size_t i = 0; i < scoresA.size(); i++)
+		difference = max(difference, fabs(scoresA[i] - scoresB[i]));
+	return difference;
+}
+
+/// <summary>
+/// A fitted model selects the same clusters and outlier scores as run(). Mutual reachability ties many MST
+/// edges at the same core distance, and the grid and duplicates shapes tie most of them, so this covers
+/// splits of a cluster into more than two components at one distance. Membership probabilities are left
+/// out: run() keeps its original core distance based definition. Outlier scores are only compared when run()
+/// finds a cluster: when the root never splits, run() has no child death level to score the points against. Outlier scores are only compared when
+/// run() finds a cluster, since it has no lowest child death level to score against when the root never splits.
+/// </summary>
+static int testFitMatchesRun() {
+	int numFailures = 0;
+	for (const char* shape : testShapes) {
+		for (int numPoints : { 200, 500, 1000 }) {
+			vector<vector<double>> dataset = generateDataset(shape, numPoints);
+			for (int minClusterSize : { 5, 15, 40 }) {
+				for (int minPoints : { 3, 8 }) {
+					hdbscanParameters parameters;
+					parameters.dataset = dataset;
+					parameters.distanceFunction = "Euclidean";
+					parameters.minPoints = minPoints;
+					parameters.minClusterSize = minClusterSize;
+					hdbscanResult expected = hdbscanRunner::run(parameters);
+					hdbscanResult actual = hdbscanRunner::fit(parameters).select();
+					bool hasClusters = count(expected.labels.begin(), expected.labels.end(), 0) != (int)expected.labels.size();
+					if (samePartition(expected.labels, actual.labels) && (!hasClusters || getScoreDifference(expected, actual) <= 1e-12))
+						continue;
+					numFailures++;
+					cerr << "fit().select() differs from run(): " << shape << ", n=" << numPoints << ", minClusterSize="
+						<< minClusterSize << ", minPoints=" << minPoints << endl;
+				}
+			}
+		}
+	}
+	return numFailures;
+}
+
+/// <summary>
+/// Every result of a sweep selects the clusters, outlier scores and membership probabilities of run().
+/// </summary>
+static int testSweepMatchesRun() {
+	int numFailures = 0;
+	for (const char* shape : testShapes) {
+		hdbscanParameters parameters;
+		parameters.dataset = generateDataset(shape, 500);
+		parameters.distanceFunction = "Euclidean";
+		hdbscanSweep sweep(parameters, 8);
+		for (int minPoints : { 3, 8 }) {
+			for (int minClusterSize : { 5, 15, 40 }) {
+				parameters.minPoints = minPoints;
+				parameters.minClusterSize = minClusterSize;
+				hdbscanResult expected = hdbscanRunner::run(parameters);
+				hdbscanResult actual = sweep.run(minPoints, minClusterSize);
+				bool hasClusters = count(expected.labels.begin(), expected.labels.end(), 0) != (int)expected.labels.size();
+				if (samePartition(expected.labels, actual.labels) && sameProbabilities(expected.membershipProbabilities, actual.membershipProbabilities)
+					&& (!hasClusters || getScoreDifference(expected, actual) <= 1e-12))
+					continue;
+				numFailures++;
+				cerr << "hdbscanSweep differs from run(): " << shape << ", minClusterSize=" << minClusterSize << ", minPoints=" << minPoints << endl;
+			}
+		}
+	}
+	return numFailures;
+}
+
+/// <summary>
+/// A sweep over a mappedDataset clusters the same rows as a sweep over the nested dataset.
+/// </summary>
+static int testSweepReadsMappedDataset() {
+	hdbscanParameters parameters;
+	parameters.dataset = generateDataset("blobs", 500);
+	parameters.distanceFunction = "Euclidean";
+	hdbscanParameters mappedParameters = parameters;
+	mappedParameters.numAttributes = parameters.dataset[0].size();
+	vector<double> rows;
+	for (const vector<double>& point : parameters.dataset)
+		rows.insert(rows.end(), point.begin(), point.end());
+	mappedParameters.mappedDataset = sharedArray<double>(rows);
+	mappedParameters.dataset.clear();
+
+	hdbscanResult expected = hdbscanSweep(parameters, 8).run(8, 15);
+	hdbscanResult actual = hdbscanSweep(mappedParameters, 8).run(8, 15);
+	if (expected.labels == actual.labels && getScoreDifference(expected, actual) == 0)
+		return 0;
+	cerr << "A sweep over a mappedDataset differs from one over the dataset" << endl;
+	return 1;
+}
+
+/// <summary>
+/// Weighing every point as 1 gives the unweighted clustering, with outlier scores equal to the last bit.
+/// </summary>
+static int testUnitWeightsMatchRun() {
+	int numFailures = 0;
+	for (const char* shape : testShapes) {
+		hdbscanParameters parameters;
+		parameters.dataset = generateDataset(shape, 500);
+		parameters.distanceFunction = "Euclidean";
+		parameters.minPoints = 5;
+		parameters.minClusterSize = 15;
+		hdbscanResult expected = hdbscanRunner::run(parameters);
+		parameters.sampleWeights.assign(parameters.dataset.size(), 1);
+		hdbscanResult actual = hdbscanRunner::run(parameters);
+		if (samePartition(expected.labels, actual.labels) && getScoreDifference(expected, actual) == 0)
+			continue;
+		numFailures++;
+		cerr << "Unit sample weights differ from run(): " << shape << endl;
+	}
+	return numFailures;
+}
+
+/// <summary>
+/// A model fitted from a mappedDataset predicts new points as one fitted from the nested dataset does, and
+/// fitting weighted points is rejected rather than silently unweighted.
+/// </summary>
+static int testFitFromMappedDataset() {
+	int numFailures = 0;
+	hdbscanParameters parameters;
+	parameters.dataset = generateDataset("blobs", 500);
+	parameters.distanceFunction = "Euclidean";
+	parameters.minPoints = 5;
+	parameters.minClusterSize = 15;
+	//The BallTree engine reads the mapped rows in place rather than loading them into dataset:
+	parameters.engine = "BallTree";
+	vector<vector<double>> points(parameters.dataset.begin(), parameters.dataset.begin() + 50);
+	hdbscanParameters mappedParameters = parameters;
+	mappedParameters.numAttributes = parameters.dataset[0].size();
+	vector<double> rows;
+	for (const vector<double>& point : parameters.dataset)
+		rows.insert(rows.end(), point.begin(), point.end());
+	mappedParameters.mappedDataset = sharedArray<double>(rows);
+	mappedParameters.dataset.clear();
+
+	hdbscanModel expectedModel = hdbscanRunner::fit(parameters);
+	expectedModel.select();
+	hdbscanModel actualModel = hdbscanRunner::fit(mappedParameters);
+	actualModel.select();
+	hdbscanPrediction expected = expectedModel.approximatePredict(points);
+	hdbscanPrediction actual = actualModel.approximatePredict(points);
+	if (expected.labels != actual.labels || expected.outlierScores != actual.outlierScores) {
+		numFailures++;
+		cerr << "A model fitted from a mappedDataset predicts differently" << endl;
+	}
+
+	parameters.sampleWeights.assign(parameters.dataset.size(), 2);
+	try {
+		hdbscanRunner::fit(parameters);
+		numFailures++;
+		cerr << "fit() accepted sample weights" << endl;
+	}
+	catch (const invalid_argument&) {
+	}
+	return numFailures;
+}
+
+int main() {
+	int numFailures = 0;
+	numFailures += testFitMatchesRun();
+	numFailures += testSweepMatchesRun();
+	numFailures += testSweepReadsMappedDataset();
+	numFailures += testUnitWeightsMatchRun();
+	numFailures += testFitFromMappedDataset();
+	if (numFailures != 0) {
+		cerr << numFailures << " checks failed" << endl;
+		return 1;
+	}
+	cout << "All checks passed" << endl;
+	return 0;
+}